@@ -248,6 +248,10 @@ https://man7.org/linux/man-pages/man3/termios.3.html
 
   if(ioctl(Cport[comport_number], TIOCMGET, &status) == -1)
   {
+    if((errno == ENOTTY) || (errno == EINVAL))  /* pseudo-terminal: no modem control lines */
+    {
+      return(0);
+    }
     tcsetattr(Cport[comport_number], TCSANOW, old_port_settings + comport_number);
     flock(Cport[comport_number], LOCK_UN);  /* free the port so that others can use it. */
     perror("unable to get portstatus");
@@ -917,6 +921,22 @@ int RS232_GetPortnr(const char *devname)
 }
 
 
+/* Replaces the device path of a port slot, e.g. to open a pseudo-terminal
+   or a by-id symlink that is not in the built-in list. The string must stay valid
+   while the port is used. */
+int RS232_SetPortName(int comport_number, const char *devname)
+{
+  if((comport_number>=RS232_PORTNR)||(comport_number<0)||(devname==NULL))
+  {
+    return -1;
+  }
+
+  comports[comport_number] = devname;
+
+  return 0;
+}
+
+
 
 
 
@@ -0,0 +1,488 @@
+// file bench.c
+//
+// Бенчмарк прийому і підготовки кадру: розбір пакетів, потоковий прийом через
+// read_usb_device(), пошук тригера, проріджування min/max, вершини draw_signal(),
+// гліфи і сітка. Малювання йде в порожню raylib (raylib_null.c), результат — JSON.
+// Збирається окремо від застосунку: make bench && build/bench/osc_bench --out bench.json
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "parse_data.h"
+#include "read_usb_device.h"
+#include "setup_channel_buffers.h"
+#include "trigger.h"
+#include "draw_signal.h"
+#include "draw_grid.h"
+#include "measurements.h"
+#include "recording.h"
+#include "replay.h"
+#include "glyphs.h"
+#include "Terminus12x6.h"
+#include "raylib_null.h"
+
+#ifndef BENCH_VERSION
+#define BENCH_VERSION "unknown"
+#endif
+#ifndef BENCH_OPT
+#define BENCH_OPT ""
+#endif
+
+#define BENCH_REPS 5              // Повторів на випадок; у звіт іде медіана і найкращий
+#define BENCH_OSC_WIDTH 1000.0f   // Ширина області сигналу, як у застосунку
+#define BENCH_COLUMNS 1000        // Стовпців для проріджування min/max
+
+// Глобальні параметри тексту, які застосунок визначає в main.c
+int LineSpacing = 0;
+int spacing = 2;
+int scale = 1;
+int padding = 3;
+int borderThickness = 1;
+
+typedef uint64_t (*BenchFn)(void *ctx); // Повертає кількість оброблених одиниць
+
+typedef struct {
+    const char *name;
+    const char *unit;
+    long points;
+    int channels;
+    double median_rate;
+    double best_rate;
+    double ns_per_item;
+    uint64_t items_per_rep;
+    unsigned long long draw_calls;    // Викликів малювання за одну ітерацію (0 — немає)
+} BenchResult;
+
+static double min_time_s = 0.5;
+static BenchResult results[256];
+static int result_count = 0;
+static volatile uint64_t sink;        // Щоб результати розбору не викидались оптимізатором
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static unsigned long long draw_calls(void)
+{
+    return null_draw_stats.lines + null_draw_stats.rects + null_draw_stats.pixels;
+}
+
+// Підбирає кількість ітерацій на повтор (~min_time / BENCH_REPS) і записує медіану
+static void run_case(const char *name, const char *unit, long points, int channels, BenchFn fn, void *ctx)
+{
+    unsigned long long calls_before = draw_calls();
+    double t0 = now_seconds();
+    uint64_t items = fn(ctx);                       // Прогрів і калібрування
+    double once = now_seconds() - t0;
+    unsigned long long calls = draw_calls() - calls_before;
+
+    long iterations = 1;
+    double target = min_time_s / BENCH_REPS;
+    if (once > 0.0 && once < target) iterations = (long)(target / once);
+
+    double rates[BENCH_REPS];
+    for (int r = 0; r < BENCH_REPS; r++) {
+        uint64_t total = 0;
+        t0 = now_seconds();
+        for (long i = 0; i < iterations; i++) total += fn(ctx);
+        double dt = now_seconds() - t0;
+        rates[r] = dt > 0.0 ? total / dt : 0.0;
+    }
+    qsort(rates, BENCH_REPS, sizeof(double), compare_double);
+
+    BenchResult *res = &results[result_count++];
+    res->name = name;
+    res->unit = unit;
+    res->points = points;
+    res->channels = channels;
+    res->median_rate = rates[BENCH_REPS / 2];
+    res->best_rate = rates[BENCH_REPS - 1];
+    res->ns_per_item = res->median_rate > 0.0 ? 1e9 / res->median_rate : 0.0;
+    res->items_per_rep = items * (uint64_t)iterations;
+    res->draw_calls = calls;
+
+    fprintf(stderr, "%-22s %9ld pts %d ch  %14.0f %s  (%.2f ns/item)\n",
+            name, points, channels, res->median_rate, unit, res->ns_per_item);
+}
+
+// ---- Стан осцилографа для одного розміру буфера ----
+
+static OscData osc;
+
+static void osc_setup(long points, int channels)
+{
+    init_osc_data(&osc);
+    osc.points_to_display = (int)points;
+    setup_channel_buffers(&osc);
+    for (int ch = 0; ch < DEVICE_CHANNELS; ch++) osc.channels[ch].active = ch < channels;
+}
+
+static void osc_set_channels(int channels)
+{
+    for (int ch = 0; ch < DEVICE_CHANNELS; ch++) osc.channels[ch].active = ch < channels;
+}
+
+static void osc_free(void)
+{
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+        free(osc.channels[ch].channel_history);
+        osc.channels[ch].channel_history = NULL;
+    }
+    measurements_free(&osc);
+}
+
+// Пакети як від прошивки: пилки різної частоти на 4 каналах
+static uint8_t *make_packets(long count)
+{
+    uint8_t *buf = (uint8_t*)malloc((size_t)count * PACKET_SIZE);
+    if (!buf) return NULL;
+    for (long i = 0; i < count; i++) {
+        uint8_t *p = buf + (size_t)i * PACKET_SIZE;
+        p[0] = 0xAA;
+        for (int ch = 0; ch < DEVICE_CHANNELS; ch++) {
+            int16_t v = (int16_t)(((i * (ch + 1) * 7) % 2000) - 1000);
+            p[1 + ch * 3] = (uint8_t)ch;
+            p[2 + ch * 3] = (uint8_t)(v & 0xFF);
+            p[3 + ch * 3] = (uint8_t)((uint16_t)v >> 8);
+        }
+    }
+    return buf;
+}
+
+// Ті самі значення, що й у make_packets, блоками 0xAE з усіма каналами (зміщення між
+// сусідніми семплами 7..28 — повільний сигнал, здебільшого байт на значення)
+static uint8_t *make_delta_blocks(long count, size_t *size)
+{
+    int scans = DELTA_BLOCK_VALUES / DEVICE_CHANNELS;
+    long blocks = (count + scans - 1) / scans;
+    uint8_t *buf = (uint8_t*)malloc((size_t)blocks * PACKET_DELTA_MAX);
+    if (!buf) return NULL;
+    uint8_t *p = buf;
+    for (long b = 0; b < blocks; b++) {
+        int16_t values[DELTA_BLOCK_VALUES];
+        for (int k = 0; k < DELTA_BLOCK_VALUES; k++) {
+            long i = b * scans + k / DEVICE_CHANNELS;
+            int ch = k % DEVICE_CHANNELS;
+            values[k] = (int16_t)(((i * (ch + 1) * 7) % 2000) - 1000);
+        }
+        int len = delta_encode(values, DELTA_BLOCK_VALUES, DEVICE_CHANNELS, p + PACKET_DELTA_HEADER);
+        p[0] = PACKET_START_DELTA;
+        p[1] = 0x0F;
+        p[2] = (uint8_t)b;
+        p[3] = (uint8_t)(b >> 8);
+        p[4] = (uint8_t)(b >> 16);
+        p[5] = (uint8_t)len;
+        p += PACKET_DELTA_HEADER + len;
+    }
+    *size = (size_t)(p - buf);
+    return buf;
+}
+
+// ---- Випадки ----
+
+typedef struct { const uint8_t *packets; long count; } ParseCtx;
+
+static uint64_t bench_parse(void *arg)
+{
+    ParseCtx *c = (ParseCtx*)arg;
+    uint64_t acc = 0;
+    uint16_t values[4];
+    for (long i = 0; i < c->count; i++) {
+        if (parse_binary_packet(c->packets + (size_t)i * PACKET_SIZE, values) == 0)
+            acc += values[0] + values[3];
+    }
+    sink += acc;
+    return (uint64_t)c->count;
+}
+
+typedef struct { const uint8_t *blocks; size_t size; } DeltaCtx;
+
+// Розбір блоків 0xAE до сканів: довжина з заголовка, delta_decode, розкладання по каналах
+static uint64_t bench_delta(void *arg)
+{
+    DeltaCtx *c = (DeltaCtx*)arg;
+    uint64_t acc = 0, samples = 0;
+    SamplePacket packet;
+    uint32_t seq;
+    for (size_t off = 0; off < c->size; ) {
+        int size = packet_size(c->blocks + off, (int)(c->size - off));
+        if (size <= 0) break;
+        if (parse_packet(c->blocks + off, &packet, &seq) == 0) {
+            acc += (uint16_t)packet.values[0][0] + (uint16_t)packet.values[packet.scans - 1][3];
+            samples += (uint64_t)packet.scans;
+        }
+        off += (size_t)size;
+    }
+    sink += acc;
+    return samples;
+}
+
+// Потоковий прийом: той самий шлях, що й з COM-порту, джерело — буфер у пам'яті
+static uint64_t bench_ingest(void *arg)
+{
+    ParseCtx *c = (ParseCtx*)arg;
+    ReplaySource *rp = &osc.replay;
+    memset(rp, 0, sizeof(*rp));
+    rp->active = true;
+    rp->format = REPLAY_RAW;
+    rp->loop = true;                 // Без підсумку наприкінці — зупиняємось за лічильником
+    rp->speed = 0.0f;
+    rp->raw = c->packets;
+    rp->raw_size = (size_t)c->count * PACKET_SIZE;
+    rp->raw_sample_bytes = PACKET_SIZE;
+    rp->start_time = -1.0;
+
+    unsigned long long start = osc.sample_count;
+    while (osc.sample_count - start < (unsigned long long)c->count)
+        read_usb_device(&osc);
+    rp->active = false;
+    return osc.sample_count - start;
+}
+
+// Найгірший випадок: фронту немає, кожен канал проглядається по всьому буферу
+static void fill_flat_history(void)
+{
+    for (int ch = 0; ch < DEVICE_CHANNELS; ch++) {
+        float level = osc.channels[ch].trigger_level * WORKSPACE_HEIGHT;
+        float v = level - 10.0f * osc.channels[ch].trigger_hysteresis_px - 1.0f;
+        for (int i = 0; i < osc.history_size; i++) osc.channels[ch].channel_history[i] = v;
+    }
+}
+
+static uint64_t bench_trigger(void *arg)
+{
+    int channels = *(int*)arg;
+    for (int ch = 0; ch < DEVICE_CHANNELS; ch++) {
+        osc.channels[ch].trigger_active = true;
+        osc.channels[ch].trigger_locked = false;
+    }
+    update_trigger_indices(&osc);
+    return (uint64_t)osc.history_size * channels;
+}
+
+typedef struct { RecordingFile file; long points; int channels; } DecimateCtx;
+
+static uint64_t bench_decimate(void *arg)
+{
+    DecimateCtx *c = (DecimateCtx*)arg;
+    int64_t acc = 0;
+    for (int ch = 0; ch < c->channels; ch++) {
+        for (int x = 0; x < BENCH_COLUMNS; x++) {
+            uint64_t first = (uint64_t)c->points * x / BENCH_COLUMNS;
+            uint64_t last = (uint64_t)c->points * (x + 1) / BENCH_COLUMNS;
+            if (last <= first) last = first + 1;
+            int16_t lo, hi;
+            if (recording_minmax(&c->file, ch, first, last, &lo, &hi)) acc += hi - lo;
+        }
+    }
+    sink += (uint64_t)acc;
+    return (uint64_t)c->points * c->channels;
+}
+
+static uint64_t bench_draw_signal(void *arg)
+{
+    int channels = *(int*)arg;
+    draw_signal(&osc, BENCH_OSC_WIDTH, 1.0f);
+    return (uint64_t)osc.points_to_display * channels;
+}
+
+static const char *glyph_text = "CH1 1.250V  dt 12.5ms  Fs 100000 S/s  UART 0x55 'U' [PARITY]";
+
+static uint64_t bench_glyphs(void *arg)
+{
+    (void)arg;
+    int n = 0;
+    for (int row = 0; row < 16; row++) {
+        DrawTextScaled(Terminus12x6_font, 10, 10 + row * 14, glyph_text, spacing, 1, WHITE);
+        n += (int)strlen(glyph_text);
+    }
+    return (uint64_t)n;
+}
+
+typedef struct { int width, height; } GridCtx;
+
+static uint64_t bench_grid(void *arg)
+{
+    GridCtx *g = (GridCtx*)arg;
+    draw_grid(g->width, g->height, 50, 49);
+    return 1;
+}
+
+// Запис для проріджування, створюється тим самим записувачем, що й F3.
+// Прийом чекає на потік запису, щоб жоден чанк не був викинутий.
+static int make_recording(const char *path, const uint8_t *packets, long count)
+{
+    if (recording_start(&osc, path) != 0) return -1;
+    Recorder *r = &osc.recorder;
+    uint16_t values[4];
+    for (long i = 0; i < count; i++) {
+        if (r->fill_count == REC_CHUNK_SAMPLES - 1) {
+            pthread_mutex_lock(&r->lock);
+            while (r->full[(r->fill + 1) % REC_QUEUE_DEPTH]) pthread_cond_wait(&r->cond, &r->lock);
+            pthread_mutex_unlock(&r->lock);
+        }
+        parse_binary_packet(packets + (size_t)i * PACKET_SIZE, values);
+        recording_on_sample(&osc, (const int16_t*)values);
+    }
+    recording_stop(&osc);
+    return 0;
+}
+
+// ---- Звіт ----
+
+static void write_json(FILE *f, long max_points)
+{
+    char date[32];
+    time_t t = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"version\": \"%s\",\n", BENCH_VERSION);
+    fprintf(f, "  \"date\": \"%s\",\n", date);
+    fprintf(f, "  \"compiler\": \"%s\",\n", __VERSION__);
+    fprintf(f, "  \"opt\": \"%s\",\n", BENCH_OPT);
+    fprintf(f, "  \"min_time_s\": %.3f,\n", min_time_s);
+    fprintf(f, "  \"max_points\": %ld,\n", max_points);
+    fprintf(f, "  \"results\": [\n");
+    for (int i = 0; i < result_count; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"points\": %ld, \"channels\": %d, \"unit\": \"%s\", "
+                   "\"median\": %.1f, \"best\": %.1f, \"ns_per_item\": %.3f, \"items\": %llu, \"draw_calls\": %llu}%s\n",
+                r->name, r->points, r->channels, r->unit, r->median_rate, r->best_rate,
+                r->ns_per_item, (unsigned long long)r->items_per_rep, r->draw_calls,
+                i + 1 < result_count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+static void print_usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --out FILE        write the JSON report to FILE (default: stdout)\n"
+        "  --max-points N    largest buffer size (default 10000000)\n"
+        "  --quick           sizes up to 100000 points\n"
+        "  --min-time S      measuring time per case in seconds (default 0.5)\n"
+        "  --filter NAME     run only cases whose name contains NAME\n", prog);
+}
+
+static const char *filter = NULL;
+
+static bool enabled(const char *name)
+{
+    return !filter || strstr(name, filter) != NULL;
+}
+
+int main(int argc, char **argv)
+{
+    const char *out_path = NULL;
+    long max_points = 10000000;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) max_points = 100000;
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) out_path = argv[++i];
+        else if (strcmp(argv[i], "--max-points") == 0 && i + 1 < argc) max_points = atol(argv[++i]);
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) min_time_s = atof(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else { print_usage(argv[0]); return 1; }
+    }
+
+    // Повідомлення модулів (запис, відтворення) — у stderr, stdout лишається для JSON
+    FILE *json = stdout;
+    if (!out_path) {
+        int fd = dup(STDOUT_FILENO);
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+        json = fdopen(fd, "w");
+    }
+
+    static const long sizes[] = { 500, 10000, 100000, 1000000, 10000000 };
+    const char *tmp = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char rec_path[256];
+    snprintf(rec_path, sizeof(rec_path), "%s/osc_bench_%d.oscrec", tmp, (int)getpid());
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        long n = sizes[s];
+        if (n > max_points) break;
+
+        uint8_t *packets = make_packets(n);
+        if (!packets) { fprintf(stderr, "Out of memory at %ld points\n", n); break; }
+        osc_setup(n, DEVICE_CHANNELS);
+
+        ParseCtx pc = { packets, n };
+        if (enabled("parse_binary_packet"))
+            run_case("parse_binary_packet", "samples/s", n, DEVICE_CHANNELS, bench_parse, &pc);
+        if (enabled("delta_decode")) {
+            DeltaCtx dc = {0};
+            uint8_t *blocks = make_delta_blocks(n, &dc.size);
+            if (blocks) {
+                dc.blocks = blocks;
+                run_case("delta_decode", "samples/s", n, DEVICE_CHANNELS, bench_delta, &dc);
+                free(blocks);
+            }
+        }
+
+        // Після прийому буфер історії заповнений — далі тригер і малювання працюють з ним
+        for (int ch = 1; ch <= DEVICE_CHANNELS; ch++) {
+            osc_set_channels(ch);
+            if (enabled("read_usb_device"))
+                run_case("read_usb_device", "samples/s", n, ch, bench_ingest, &pc);
+            else if (ch == 1)
+                bench_ingest(&pc);
+        }
+
+        fill_flat_history();
+        for (int ch = 1; ch <= DEVICE_CHANNELS; ch++) {
+            osc_set_channels(ch);
+            if (enabled("trigger_search"))
+                run_case("trigger_search", "samples/s", n, ch, bench_trigger, &ch);
+            for (int c = 0; c < DEVICE_CHANNELS; c++) osc.channels[c].trigger_active = false;
+            if (enabled("draw_signal"))
+                run_case("draw_signal", "samples/s", n, ch, bench_draw_signal, &ch);
+        }
+
+        if (enabled("decimate_minmax") && make_recording(rec_path, packets, n) == 0) {
+            DecimateCtx dc = { .points = n };
+            if (recording_open(&dc.file, rec_path) == 0) {
+                for (int ch = 1; ch <= DEVICE_CHANNELS; ch++) {
+                    dc.channels = ch;
+                    run_case("decimate_minmax", "samples/s", n, ch, bench_decimate, &dc);
+                }
+                recording_close(&dc.file);
+            }
+            unlink(rec_path);
+        }
+
+        osc_free();
+        free(packets);
+    }
+
+    if (enabled("glyphs"))
+        run_case("glyphs", "glyphs/s", (long)strlen(glyph_text), 0, bench_glyphs, NULL);
+
+    static GridCtx grids[] = { { 1000, 600 }, { 1920, 1080 } };
+    for (size_t g = 0; g < sizeof(grids) / sizeof(grids[0]); g++) {
+        if (enabled("grid"))
+            run_case("grid", "frames/s", (long)grids[g].width * grids[g].height, 0, bench_grid, &grids[g]);
+    }
+
+    if (out_path) json = fopen(out_path, "w");
+    if (!json) { perror(out_path); return 1; }
+    write_json(json, max_points);
+    fclose(json);
+    return 0;
+}
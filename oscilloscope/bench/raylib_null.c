@@ -0,0 +1,103 @@
+// file raylib_null.c
+//
+// Порожня заміна raylib для бенчмарку: функції малювання лише рахують виклики,
+// тож вимірюється підготовка вершин і пікселів без вікна та GPU.
+
+#include "raylib.h"
+#include "raylib_null.h"
+#include <stdio.h>
+#include <stdarg.h>
+
+NullDrawStats null_draw_stats;
+
+void DrawPixel(int posX, int posY, Color color)
+{
+    (void)posX; (void)posY; (void)color;
+    null_draw_stats.pixels++;
+}
+
+void DrawLine(int startPosX, int startPosY, int endPosX, int endPosY, Color color)
+{
+    (void)startPosX; (void)startPosY; (void)endPosX; (void)endPosY; (void)color;
+    null_draw_stats.lines++;
+}
+
+void DrawLineEx(Vector2 startPos, Vector2 endPos, float thick, Color color)
+{
+    (void)thick; (void)color;
+    null_draw_stats.lines++;
+    // Сума координат не дає компілятору викинути обчислення вершин
+    null_draw_stats.checksum += startPos.x + startPos.y + endPos.x + endPos.y;
+}
+
+void DrawLineV(Vector2 startPos, Vector2 endPos, Color color)
+{
+    (void)color;
+    null_draw_stats.lines++;
+    null_draw_stats.checksum += startPos.x + startPos.y + endPos.x + endPos.y;
+}
+
+void DrawRectangle(int posX, int posY, int width, int height, Color color)
+{
+    (void)posX; (void)posY; (void)width; (void)height; (void)color;
+    null_draw_stats.rects++;
+}
+
+void DrawRectangleRec(Rectangle rec, Color color)
+{
+    (void)rec; (void)color;
+    null_draw_stats.rects++;
+}
+
+void DrawRectangleLines(int posX, int posY, int width, int height, Color color)
+{
+    (void)posX; (void)posY; (void)width; (void)height; (void)color;
+    null_draw_stats.rects++;
+}
+
+void DrawRectangleLinesEx(Rectangle rec, float lineThick, Color color)
+{
+    (void)rec; (void)lineThick; (void)color;
+    null_draw_stats.rects++;
+}
+
+Color Fade(Color color, float alpha)
+{
+    if (alpha < 0.0f) alpha = 0.0f;
+    if (alpha > 1.0f) alpha = 1.0f;
+    color.a = (unsigned char)(255.0f * alpha);
+    return color;
+}
+
+bool IsKeyPressed(int key)
+{
+    (void)key;
+    return false;
+}
+
+int GetCharPressed(void)
+{
+    return 0;
+}
+
+int MeasureText(const char *text, int fontSize)
+{
+    int n = 0;
+    while (text && text[n]) n++;
+    return n * fontSize / 2;
+}
+
+// Як у raylib: кілька статичних буферів по колу
+const char *TextFormat(const char *text, ...)
+{
+    static char buffers[4][1024];
+    static int index = 0;
+    char *buf = buffers[index];
+    index = (index + 1) % 4;
+
+    va_list args;
+    va_start(args, text);
+    vsnprintf(buf, sizeof(buffers[0]), text, args);
+    va_end(args);
+    return buf;
+}
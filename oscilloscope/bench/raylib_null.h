@@ -0,0 +1,16 @@
+// file raylib_null.h
+
+#ifndef RAYLIB_NULL_H
+#define RAYLIB_NULL_H
+
+// Лічильники викликів порожньої raylib
+typedef struct {
+    unsigned long long lines;
+    unsigned long long rects;
+    unsigned long long pixels;
+    double checksum;
+} NullDrawStats;
+
+extern NullDrawStats null_draw_stats;
+
+#endif // RAYLIB_NULL_H
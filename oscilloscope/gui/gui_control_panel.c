@@ -17,7 +17,6 @@
 #include "cam_switch.h"
 #include "knob_gui.h"
 #include "setup_channel_buffers.h"
-#include "rs232.h"
 // #include "gui_radiobutton.h"
 #include "gui_radiobutton_row.h"
 #include "trigger_control.h"
@@ -31,13 +30,10 @@ static bool radiobuttonOpen[MAX_CHANNELS] = { false };
 // static const char *radiobuttonItems[] = { "Rising", "Falling", "Auto" };
 static const char *radiobuttonItems[] = { "R", "F", "A" };
 
-void send_command(OscData *data, char* command, size_t buffer_size, int number);
-// void write_usb_device(OscData *data, unsigned char* str);
-void write_usb_device(OscData *data, unsigned char* str, size_t len);
 
 // Функція відображає панель керування параметрами осцилографа
 // Масив кольорів каналів
-static Color channel_colors[MAX_CHANNELS] = { YELLOW, GREEN, RED, BLUE };
+static Color channel_colors[MAX_CHANNELS] = CHANNEL_COLORS;
 
 void gui_control_panel(OscData *oscData, int screenWidth, int screenHeight) {
     // Позиції і розміри панелі
@@ -53,16 +49,26 @@ void gui_control_panel(OscData *oscData, int screenWidth, int screenHeight) {
     // DrawText("Control Panel", panelX + 10, panelY + 10, 20, WHITE);
     // DrawPSFText(font12, panelX + 20, panelY + 10, "Панель Керування", 1, WHITE);
 
-    // Кнопки вибору активного каналу з кольорами
-    for (int i = 0; i < MAX_CHANNELS; i++) {
-        Rectangle btnRect = { panelX + 20 + i * 80, panelY + 20, 60, 30 };
+    // Кнопки вибору активного каналу з кольорами: 4 канали плати активного каналу,
+    // інша плата — клавіша B
+    int bank = oscData->active_channel / DEVICE_CHANNELS * DEVICE_CHANNELS;
+    for (int i = bank; i < bank + DEVICE_CHANNELS && i < oscData->channel_count; i++) {
+        Rectangle btnRect = { panelX + 20 + (i - bank) * 80, panelY + 20, 60, 30 };
         Color btnColor = (oscData->active_channel == i) ? channel_colors[i] : Fade(channel_colors[i], 0.5f);
+        if (!oscData->channels[i].active) btnColor = Fade(btnColor, 0.3f); // Вимкнено клавішею V
 
         if (Gui_Button(btnRect, TerminusBold18x10_font, TextFormat("CH%d", i + 1), btnColor, GRAY, DARKGRAY, (Color){0,0,0,0})) {
             oscData->active_channel = i;
         }
     }
 
+    if (oscData->channel_count > DEVICE_CHANNELS) {
+        DrawTextScaled(Terminus12x6_font, panelX + 20, panelY + 58,
+                       TextFormat("Плата %d/%d  (B - наступна)", bank / DEVICE_CHANNELS + 1,
+                                  oscData->channel_count / DEVICE_CHANNELS),
+                       spacing, 1, WHITE);
+    }
+
     // розміри слайдерів
     int W_size = 200;
     int H_size = 30;
@@ -166,14 +172,8 @@ void gui_control_panel(OscData *oscData, int screenWidth, int screenHeight) {
     // - Таким чином користувач бачить і змінює значення слайдера з кроком 5.
     // oscData->refresh_rate_ms = ((int)(oscData->refresh_rate_ms + 2.5f) / 5) * 5;
 
-    static float old_refresh_rate_ms;
-    char command[24] = "Rate:";  // достатній розмір буфера
-
-    if (old_refresh_rate_ms != oscData->refresh_rate_ms)
-    {
-        old_refresh_rate_ms = oscData->refresh_rate_ms;
-        send_command(oscData, command, sizeof(command), (int)oscData->refresh_rate_ms);
-    }
+    // Бажане значення: control_service надішле його платі й дочекається підтвердження
+    control_set(&oscData->control, CTRL_PARAM_RATE, (int32_t)oscData->refresh_rate_ms);
 
     // Регулятор горизонтального зміщення тригера
     int Cam6 = Gui_Knob_Channel(6, Terminus12x6_font, TerminusBold18x10_font,
@@ -220,8 +220,7 @@ void gui_control_panel(OscData *oscData, int screenWidth, int screenHeight) {
         Ch->trigger_edge = newSelection;
 
         // Відправка команди на пристрій
-        char cmd[32] = "TriggerEdge:";
-        send_command(oscData, cmd, sizeof(cmd), newSelection);
+        control_set(&oscData->control, CTRL_PARAM_TRIGGER_EDGE, newSelection);
     }
 
     sliderY += spacingY /2 - 25;
@@ -231,14 +230,7 @@ void gui_control_panel(OscData *oscData, int screenWidth, int screenHeight) {
                  &oscData->test_signal,
                  TerminusBold24x12_font ,"Тестовий\nсигнал", NULL, DARKGRAY);
 
-    static bool test_signal;
-    char command2[24] = "Test signal:";  // достатній розмір буфера
-
-    if (test_signal != oscData->test_signal)
-    {
-        test_signal = oscData->test_signal;
-        send_command(oscData, command2, sizeof(command2), (int)oscData->test_signal);
-    }
+    control_set(&oscData->control, CTRL_PARAM_TEST_SIGNAL, oscData->test_signal);
 
     // sliderY += spacingY / 2;
 
@@ -293,10 +285,10 @@ void gui_control_panel(OscData *oscData, int screenWidth, int screenHeight) {
     int sliderWidth = 10;
     int sliderHeight = 500;
     Rectangle sliderBounds = { sliderX - 35, 50, sliderWidth, sliderHeight };
-    RegisterSlider(0, sliderBounds, &oscData->channels[0].offset_y, 250.0f, -250.0f, true, YELLOW, NULL, NULL);
-    RegisterSlider(1, sliderBounds, &oscData->channels[1].offset_y, 250.0f, -250.0f, true, GREEN, NULL, NULL);
-    RegisterSlider(2, sliderBounds, &oscData->channels[2].offset_y, 250.0f, -250.0f, true, RED, NULL, NULL);
-    RegisterSlider(3, sliderBounds, &oscData->channels[3].offset_y, 250.0f, -250.0f, true, SKYBLUE, NULL, NULL);
+    RegisterSlider(0, sliderBounds, &oscData->channels[bank + 0].offset_y, 250.0f, -250.0f, true, YELLOW, NULL, NULL);
+    RegisterSlider(1, sliderBounds, &oscData->channels[bank + 1].offset_y, 250.0f, -250.0f, true, GREEN, NULL, NULL);
+    RegisterSlider(2, sliderBounds, &oscData->channels[bank + 2].offset_y, 250.0f, -250.0f, true, RED, NULL, NULL);
+    RegisterSlider(3, sliderBounds, &oscData->channels[bank + 3].offset_y, 250.0f, -250.0f, true, SKYBLUE, NULL, NULL);
 
     // Централізована функція, яка обробляє взаємодію і малює всі слайдери
     UpdateSlidersAndDraw(TerminusBold18x10_font, 2);
@@ -306,89 +298,13 @@ void gui_control_panel(OscData *oscData, int screenWidth, int screenHeight) {
     // Оновлюємо та реєструємо стан слайдерів
     Rectangle Bounds = { sliderX - 50, 50, 6, sliderHeight };
     // RegisterCircleKnobSlider(0, Bounds, &Ch->scale_y, 0.2f, 2.20f, true, WHITE, NULL, NULL);
-    RegisterCircleKnobSlider(0, Bounds, &oscData->channels[0].scale_y, 0.2f, 2.20f, true, YELLOW, NULL, NULL);
-    RegisterCircleKnobSlider(1, Bounds, &oscData->channels[1].scale_y, 0.2f, 2.20f, true, GREEN, NULL, NULL);
-    RegisterCircleKnobSlider(2, Bounds, &oscData->channels[2].scale_y, 0.2f, 2.20f, true, RED, NULL, NULL);
-    RegisterCircleKnobSlider(3, Bounds, &oscData->channels[3].scale_y, 0.2f, 2.20f, true, SKYBLUE, NULL, NULL);
+    RegisterCircleKnobSlider(0, Bounds, &oscData->channels[bank + 0].scale_y, 0.2f, 2.20f, true, YELLOW, NULL, NULL);
+    RegisterCircleKnobSlider(1, Bounds, &oscData->channels[bank + 1].scale_y, 0.2f, 2.20f, true, GREEN, NULL, NULL);
+    RegisterCircleKnobSlider(2, Bounds, &oscData->channels[bank + 2].scale_y, 0.2f, 2.20f, true, RED, NULL, NULL);
+    RegisterCircleKnobSlider(3, Bounds, &oscData->channels[bank + 3].scale_y, 0.2f, 2.20f, true, SKYBLUE, NULL, NULL);
 
     // Централізована функція, яка обробляє взаємодію і малює всі слайдери
     UpdateCircleKnobSlidersAndDraw(TerminusBold18x10_font, 2);
     // Синхронізуємо активний регулятор зі слайдером (встановлює крок слайдера для активного каналу)
     Ch->scale_y = roundf(Ch->scale_y / 0.02f) * 0.02f; // кратність 0.02f
 }
-
-void send_command(OscData *data, char* command, size_t buffer_size, int number)
-{
-    //snprintf(command, command_size, "Rate: %d", number);
-    size_t len = strlen(command);
-
-    // Перед викликом snprintf добре перевірити,
-    // що buffer_size > len щоб уникнути переповнення:
-    if (buffer_size > len) {
-        snprintf(command + len, buffer_size - len, "%d", number);
-    } else {
-        // Обробка помилки: недостатньо місця в буфері
-        fprintf(stderr, "Buffer overflow prevented in send_command\n");
-        return;
-    }
-
-    if (buffer_size > len) {
-        command[len] = '\0';
-    }
-
-    /*
-    // Якщо потрібно, щоб між текстом і числом був пробіл,
-    // двокрапка або інший символ, додай його перед snprintf:
-    if (buffer_size > len) {
-        command[len] = ':';  // або ':', або інший символ
-        command[len + 1] = ' ';  // або ':', або інший символ
-        command[len + 2] = '\0';
-        len += 2;
-    }
-    */
-
-    snprintf(command + len, buffer_size - len, "%d\n", number);
-    // printf("command: %s\n", command);
-    // printf("number: %d\n", number);
-
-
-    len = strlen(command);
-    write_usb_device(data, command, len);
-}
-
-void write_usb_device(OscData *data, unsigned char* str, size_t len)
-{
-    // RS232_cputs(data->comport_number, str); // не працює ???
-    // size_t len = strlen(str);
-    RS232_SendBuf(data->comport_number, str, len);
-    // printf("%s\n", str);
-
-    // Код перевірки парсингу
-    int new_rate;
-    if (strncmp(str, "Rate:", 5) == 0)
-    {
-        new_rate = atoi(str + 5);
-        // set_adc_sampling_rate(new_rate);
-    }
-
-    /*
-    if (strncmp(str, "Rate:", 5) == 0)
-    {
-        new_rate = atoi(str + 6);
-        // set_adc_sampling_rate(new_rate);
-        // printf("new_rate %d \n", new_rate);
-    }*/
-
-    /*
-    int parse;
-    if (strncmp(str, "Test signal:", 12) == 0)
-    {
-        parse = atoi(str + 12);
-        printf("parse %d\n", parse);
-    }
-    */
-
-    printf("%s", str);
-    // printf("new_rate: %d\n\n", new_rate);
-}
-
@@ -23,6 +23,22 @@
 #include "draw_signal.h"
 #include "generate_test_signals.h"
 #include "cursor.h"
+#include "cursor_readout.h"
+#include "segments.h"
+#include "draw_segments.h"
+#include "measurements.h"
+#include "draw_measurements.h"
+#include "spectrum.h"
+#include "draw_spectrum.h"
+#include "decoder.h"
+#include "draw_decoder.h"
+#include "recording.h"
+#include "draw_recording.h"
+#include "replay.h"
+#include "app_options.h"
+#include "telemetry.h"
+#include "draw_telemetry.h"
+#include <time.h>
 
 #include "all_font.h" // Опис шрифтів як структури RasterFont
 #include "glyphs.h"
@@ -38,7 +54,11 @@ int borderThickness = 1;
 // float current_time = 0.0f;// Ініціалізація часу і кроку оновлення тестового сигналу
 // const float time_step = 0.025f; // крок часу для формування нового значення тестового сигналу
 
-int main(void) {
+int main(int argc, char **argv) {
+    AppOptions options;
+    int parsed = parse_app_options(argc, argv, &options);
+    if (parsed != 0) return parsed < 0 ? 1 : 0;
+
     const int screenWidth = 1000;
     const int screenHeight = 600;
 
@@ -63,11 +83,53 @@ int main(void) {
         .isDragging = false                      // спочатку не перетягується
     };
 
+    // Горизонтальні курсори рівня (клавіша H), ручки біля правого краю осцилографа
+    HCursor hcursors[2];
+    hcursors[0] = InitHCursor(200.0f, 0, DEFAULT_CURSOR_WIDTH, DEFAULT_CURSOR_WIDTH, ORANGE);
+    hcursors[1] = InitHCursor(350.0f, 0, DEFAULT_CURSOR_WIDTH, DEFAULT_CURSOR_WIDTH, PURPLE);
+    bool show_hcursors = false;
+
     OscData oscData = {0};
     init_osc_data(&oscData);
-    setup_channel_buffers(&oscData);
+    if (options.gap_mode >= 0) oscData.gap_mode = (GapMode)options.gap_mode;
+    oscData.transport = options.transport;
+    if (options.compress) control_set(&oscData.control, CTRL_PARAM_COMPRESSION, 1);
+    if (options.oversample) control_set(&oscData.control, CTRL_PARAM_OVERSAMPLE, options.oversample);
+    if (options.ets_steps) control_set(&oscData.control, CTRL_PARAM_ETS_STEPS, options.ets_steps);
+    oscData.control.profile = options.profile;
+    // Без міток шкала часу й вимірювання спираються на час прибуття пакетів
+    if (!options.no_timestamps) control_set(&oscData.control, CTRL_PARAM_TIMESTAMPS, 1);
+    for (int ch = 0; ch < CTRL_TEST_CHANNELS; ch++) {
+        const TestWaveOption *w = &options.test_waves[ch];
+        if (w->wave >= 0) control_set(&oscData.control, CTRL_PARAM_TEST_WAVE + ch, w->wave);
+        if (w->freq_dhz >= 0) control_set(&oscData.control, CTRL_PARAM_TEST_FREQ + ch, w->freq_dhz);
+        if (w->amplitude >= 0) control_set(&oscData.control, CTRL_PARAM_TEST_AMPLITUDE + ch, w->amplitude);
+        if (w->noise >= 0) control_set(&oscData.control, CTRL_PARAM_TEST_NOISE + ch, w->noise);
+    }
 
-    find_usb_device(&oscData);
+    // Джерело даних: файл відтворення (--replay), вказаний порт (--port), кілька плат
+    // (--port кілька разів, --devices N) або автопошук COM-порту
+    if (options.replay_path) {
+        if (replay_open(&oscData.replay, options.replay_path, options.replay_speed,
+                        options.replay_rate_hz, options.replay_loop) != 0) {
+            CloseWindow();
+            return 1;
+        }
+        oscData.nominal_rate_hz = oscData.replay.rate_hz;
+        snprintf(oscData.com_port_name_input, sizeof(oscData.com_port_name_input), "Replay");
+    } else {
+        usb_watch_init(&oscData.usb_watch, options.sysfs_root, options.dev_root, options.usb_vid, options.usb_pid);
+        if (options.port_count > 1) open_usb_devices(&oscData, options.port_paths, options.port_count);
+        else if (options.device_count > 1) find_usb_devices(&oscData, options.device_count);
+        else if (options.port_count == 1) open_usb_device_port(&oscData, options.port_paths[0]);
+        else find_usb_device(&oscData);
+        if (options.dump_path) {
+            if (oscData.devices.count > 0) printf("--dump записує лише потік однієї плати, пропущено\n");
+            else oscData.raw_dump = replay_dump_open(options.dump_path);
+        }
+    }
+    setup_channel_buffers(&oscData); // Після вибору джерела: кількість каналів залежить від кількості плат
+    spectrum_start(&oscData.spectrum);
 
     float frameTime = 0.0f;
 
@@ -75,14 +137,105 @@ int main(void) {
         frameTime += GetFrameTime();
 
         if (frameTime * 1000.0f >= oscData.refresh_rate_ms) {
+            telemetry_stage_begin(&oscData.telemetry, TELEMETRY_STAGE_READ);
+            usb_device_service(&oscData);
+            control_service(&oscData, telemetry_now());
             read_usb_device(&oscData);
-            update_trigger_indices(&oscData);
+            telemetry_stage_end(&oscData.telemetry, TELEMETRY_STAGE_READ);
+
+            telemetry_stage_begin(&oscData.telemetry, TELEMETRY_STAGE_PROCESS);
+            measurements_update(&oscData);
+            decoder_update(&oscData);
+            if (oscData.segments.enabled)
+                segments_update(&oscData); // у сегментованому режимі тригер обробляється при прийомі
+            else
+                update_trigger_indices(&oscData);
+            telemetry_stage_end(&oscData.telemetry, TELEMETRY_STAGE_PROCESS);
             frameTime = 0.0f;
         }
 
         static bool control_panel_visible = true;
+        SpectrumAnalyzer *sa = &oscData.spectrum;
+
+        // Декодер: D - протокол, E - таблиця подій, / - пошук (поки вводиться, інші клавіші вимкнені)
+        bool typing = decoder_handle_keys(&oscData);
+
         // Обробка введення для керування панеллю та масштабом
-        if (IsKeyPressed(KEY_TAB)) control_panel_visible = !control_panel_visible;
+        if (!typing) {
+            if (IsKeyPressed(KEY_TAB)) control_panel_visible = !control_panel_visible;
+            if (IsKeyPressed(KEY_M)) oscData.show_measurements = !oscData.show_measurements;
+            if (IsKeyPressed(KEY_H)) show_hcursors = !show_hcursors;
+            if (IsKeyPressed(KEY_F5)) oscData.telemetry.show_hud = !oscData.telemetry.show_hud;
+            // F6 - профіль прошивки: стати читаються між запитами керування, поки увімкнено
+            if (IsKeyPressed(KEY_F6)) oscData.control.profile = !oscData.control.profile;
+            // B - наступна плата: панель керування переходить на її канали
+            if (IsKeyPressed(KEY_B) && oscData.channel_count > DEVICE_CHANNELS)
+                oscData.active_channel = (oscData.active_channel / DEVICE_CHANNELS + 1) * DEVICE_CHANNELS
+                                         % oscData.channel_count;
+            // V - вимкнути/увімкнути активний канал: плата перестає його вимірювати й передавати,
+            // і решта каналів іде з більшою частотою дискретизації
+            if (IsKeyPressed(KEY_V)) {
+                oscData.channels[oscData.active_channel].active = !oscData.channels[oscData.active_channel].active;
+                control_set_channels(&oscData);
+            }
+            // Z - стиснення потоку на платі: блоки 0xAE замість 0xAD (коефіцієнт — у HUD, F5)
+            if (IsKeyPressed(KEY_Z)) {
+                ControlLink *c = &oscData.control;
+                int32_t current = (c->wanted & (1u << CTRL_PARAM_COMPRESSION)) ? c->desired[CTRL_PARAM_COMPRESSION]
+                                                                               : c->device[CTRL_PARAM_COMPRESSION];
+                control_set(c, CTRL_PARAM_COMPRESSION, !current);
+            }
+            // X - передискретизація на платі: 1 -> 4 -> 16 -> 64 -> 256 -> 1 відліків на семпл
+            // (кожен крок — ще біт роздільності, частота семплів падає)
+            if (IsKeyPressed(KEY_X)) {
+                ControlLink *c = &oscData.control;
+                int32_t current = (c->wanted & (1u << CTRL_PARAM_OVERSAMPLE)) ? c->desired[CTRL_PARAM_OVERSAMPLE]
+                                                                              : c->device[CTRL_PARAM_OVERSAMPLE];
+                control_set(c, CTRL_PARAM_OVERSAMPLE, current + 2 > CTRL_OVERSAMPLE_MAX ? 0 : (current / 2 + 1) * 2);
+            }
+
+            // Спектр: F - показати/сховати, W - вікно, A - усереднення, +/- - розмір ППФ
+            if (IsKeyPressed(KEY_F)) sa->enabled = !sa->enabled;
+            if (sa->enabled) {
+                if (IsKeyPressed(KEY_W)) sa->window = (sa->window + 1) % FFT_WINDOW_COUNT;
+                if (IsKeyPressed(KEY_A)) sa->averaging = (sa->averaging + 1) % SPECTRUM_AVG_COUNT;
+                if (IsKeyPressed(KEY_EQUAL) && sa->fft_size < FFT_MAX_SIZE) sa->fft_size *= 2;
+                if (IsKeyPressed(KEY_MINUS) && sa->fft_size > FFT_MIN_SIZE) sa->fft_size /= 2;
+            }
+
+            // Сегментована пам'ять: F2 - увімкнути/вимкнути, стрілки - перегляд сегментів,
+            // O - накладання всіх сегментів, R - скинути і заново озброїти тригер
+            if (IsKeyPressed(KEY_F2)) {
+                if (oscData.segments.enabled) segments_free(&oscData);
+                else segments_setup(&oscData, DEFAULT_SEGMENTS, DEFAULT_SEGMENT_PRE, DEFAULT_SEGMENT_POST);
+            }
+            if (oscData.segments.enabled) {
+                if (IsKeyPressed(KEY_RIGHT) && oscData.segments.view_segment < oscData.segments.captured - 1)
+                    oscData.segments.view_segment++;
+                if (IsKeyPressed(KEY_LEFT) && oscData.segments.view_segment > 0)
+                    oscData.segments.view_segment--;
+                if (IsKeyPressed(KEY_O)) oscData.segments.overlay = !oscData.segments.overlay;
+                if (IsKeyPressed(KEY_R)) segments_rearm(&oscData);
+            }
+
+            // Запис: F3 - почати/зупинити запис у файл, F4 - відкрити/закрити останній запис
+            if (IsKeyPressed(KEY_F3)) {
+                if (oscData.recorder.active) {
+                    recording_stop(&oscData);
+                } else {
+                    char path[64];
+                    time_t now = time(NULL);
+                    strftime(path, sizeof(path), "capture_%Y%m%d_%H%M%S.oscrec", localtime(&now));
+                    recording_start(&oscData, path);
+                }
+            }
+            if (IsKeyPressed(KEY_F4)) {
+                if (oscData.viewer.active) recording_viewer_close(&oscData);
+                else if (!oscData.recorder.active && oscData.recorder.path[0])
+                    recording_viewer_open(&oscData, oscData.recorder.path, screenWidth - 60);
+            }
+        }
+        if (sa->enabled) spectrum_submit(&oscData);
 
         int panel_width = control_panel_visible ? 350 : 0;
         int osc_width = screenWidth - panel_width;
@@ -91,7 +244,11 @@ int main(void) {
         // Обмеження виходу курсорів за визначені межі
         cursors[0].min_X = cursors[1].min_X = 20;
         cursors[0].max_X = cursors[1].max_X = osc_width - 18;
+        hcursors[0].x = hcursors[1].x = osc_width - 8;
+        hcursors[0].min_Y = hcursors[1].min_Y = 30;
+        hcursors[0].max_Y = hcursors[1].max_Y = osc_height - 70;
 
+        telemetry_stage_begin(&oscData.telemetry, TELEMETRY_STAGE_DRAW);
         BeginDrawing();
         ClearBackground(RAYWHITE);
 
@@ -100,15 +257,20 @@ int main(void) {
 
         // Малювання курсорів, ліній, ручки та тексту
         DrawCursorsAndDistance(cursors, 2, Terminus12x6_font, &centerRect);
+        CursorReadout cursorReadout = cursors_bind_to_samples(&oscData, cursors, osc_width);
+        if (show_hcursors)
+            DrawHCursors(hcursors, 2, 0, osc_width - 14);
         DrawTextScaled(Terminus12x6_font, 180, 10, "простий осцилограф на бібліотеці raylib", spacing, scale, GREEN);
         // DrawTextWithAutoInvertedBackground(Terminus12x6_font, 180, 10, "простий осцилограф на бібліотеці raylib", spacing, scale, GREEN, 4,1);
 
         // Малювання поточних значень каналів в лівому верхнньому куті осцилоскопа
-        Color channel_colors[MAX_CHANNELS] = { YELLOW, GREEN, RED, SKYBLUE };
-        for (int i = 0; i < MAX_CHANNELS; i++) {
+        // (з кількох плат — лише канали плати активного каналу, щоб рядки не закривали сигнал)
+        Color channel_colors[MAX_CHANNELS] = CHANNEL_TEXT_COLORS;
+        int bank = oscData.active_channel / DEVICE_CHANNELS * DEVICE_CHANNELS;
+        for (int i = bank; i < bank + DEVICE_CHANNELS; i++) {
             if (oscData.channels[i].active && oscData.channels[i].channel_history != NULL) {
                 float last_value = oscData.channels[i].channel_history[(oscData.history_index + oscData.history_size - 1) % oscData.history_size];
-                Vector2 textPos = {82, 10 + i*20};
+                Vector2 textPos = {82, 10 + (i - bank)*20};
                 DrawTextWithAutoInvertedBackground(Terminus12x6_font, textPos.x, textPos.y,
                                                   TextFormat("Ch%d: %.0f", i+1, last_value),
                                                    spacing, scale,
@@ -117,6 +279,10 @@ int main(void) {
             }
         }
 
+        // Панель автоматичних вимірювань під поточними значеннями каналів
+        if (oscData.show_measurements)
+            draw_measurements(&oscData, 82, 10 + DEVICE_CHANNELS * 20, Terminus12x6_font);
+
         ChannelSettings *Ch = &oscData.channels[oscData.active_channel];
         Rectangle scaleArea = { 1, 0, 5, 600};
         // DrawVerticalScale(1, Ch->scale_y, Ch->offset_y, scaleArea, font12, WHITE);
@@ -125,8 +291,16 @@ int main(void) {
         // Виклик горизонтальної шкали у тій самій області (або зміщеній для видимості)
         //  area - прямокутна область (x, y, width, height), де малюється шкала
         Rectangle horScaleArea = { 50, osc_height - 60, osc_width - 100 , 50 };
-        DrawHorizontalScale(0, scale, 275 - oscData.trigger_offset_x,
-                            horScaleArea, Terminus12x6_font, WHITE);
+        SignalLayout timeLayout = signal_layout(&oscData, osc_width);
+        if (timeLayout.valid && oscData.sample_rate_hz > 0.0f && !oscData.segments.enabled) {
+            // Від'ємний крок у реверсі: пізніші семпли лівіше
+            float px_per_sample = signal_offset_to_x(&timeLayout, 1) - signal_offset_to_x(&timeLayout, 0);
+            DrawHorizontalTimeScale(1.0f / (px_per_sample * oscData.sample_rate_hz),
+                                    signal_offset_to_x(&timeLayout, 0), horScaleArea, Terminus12x6_font, WHITE);
+        } else {
+            DrawHorizontalScale(0, scale, 275 - oscData.trigger_offset_x,
+                                horScaleArea, Terminus12x6_font, WHITE);
+        }
 
         // // Малювання горизонтальної лінії тригера (якщо тригер активний)
         // if (Ch->active && Ch->trigger_active) {
@@ -147,25 +321,83 @@ int main(void) {
         // update_test_signals(&oscData, &current_time, time_step);
         // generate_test_signals_extended(&oscData, oscData.history_size, 2.0f);
 
-        draw_signal(&oscData, osc_width, 2.0f);
+        Rectangle viewerArea = { 40, 0, osc_width - 60, osc_height - 60 };
+        if (oscData.viewer.active) {
+            recording_viewer_handle_input(&oscData, viewerArea);
+            draw_recording_view(&oscData, viewerArea, Terminus12x6_font);
+        } else if (oscData.segments.enabled) {
+            draw_segments(&oscData, osc_width, 2.0f, Terminus12x6_font);
+        } else {
+            draw_signal(&oscData, osc_width, 2.0f);
+        }
+
+        // Покази курсорів поверх сигналу: маркери семплів, Δt і ΔV
+        draw_cursor_readout(&oscData, cursors, &centerRect, &cursorReadout, osc_width - 270, 30, Terminus12x6_font);
+        if (show_hcursors)
+            draw_hcursor_readout(&oscData, hcursors, osc_width - 270, osc_height - 90, Terminus12x6_font);
+
+        // Спектр у нижній половині робочої області
+        if (sa->enabled) {
+            Rectangle spectrumArea = { 40, osc_height / 2, osc_width - 60, osc_height / 2 - 70 };
+            draw_spectrum(&oscData, spectrumArea, Terminus12x6_font);
+        }
+
+        // Стан запису: обсяг на диску і чанки, втрачені через відставання диска
+        if (oscData.recorder.active) {
+            Recorder *rec = &oscData.recorder;
+            DrawTextWithAutoInvertedBackground(Terminus12x6_font, osc_width - 270, 10,
+                                               TextFormat("REC %.1f MB  drop %llu%s", rec->bytes_written / 1048576.0,
+                                                          rec->dropped_chunks, rec->error ? "  ERROR" : ""),
+                                               spacing, scale, RED, padding, borderThickness);
+        }
+
+        // Таблиця декодованих подій у правій частині осцилографа
+        Rectangle decoderArea = { osc_width - 420, 130, 410, 300 };
+        draw_decoder_table(&oscData, decoderArea, Terminus12x6_font);
 
         // gui_control_panel(&oscData, screenWidth, screenHeight);
         if (control_panel_visible) {
             gui_control_panel(&oscData, screenWidth, screenHeight);
         }
 
+        // Телеметрія конвеєра над горизонтальною шкалою
+        if (oscData.telemetry.show_hud)
+            draw_telemetry_hud(&oscData, 50, osc_height - 65, Terminus12x6_font);
+        telemetry_stage_end(&oscData.telemetry, TELEMETRY_STAGE_DRAW);
+
+        telemetry_stage_begin(&oscData.telemetry, TELEMETRY_STAGE_PRESENT);
         EndDrawing();
+        telemetry_stage_end(&oscData.telemetry, TELEMETRY_STAGE_PRESENT);
+        telemetry_frame_presented(&oscData.telemetry);
     }
 
     if (oscData.comport_number != -1) {
         RS232_CloseComport(oscData.comport_number);
         printf("COM порт %d закрито.\n", oscData.comport_number);
     }
+    usb_bulk_close(&oscData.usb_bulk);
+    devices_close(&oscData.devices);
+    usb_watch_close(&oscData.usb_watch);
+    replay_close(&oscData.replay);
+
+    // Підсумок телеметрії (JSON) у файл --telemetry або в stdout
+    FILE *telemetry_out = options.telemetry_path ? fopen(options.telemetry_path, "w") : stdout;
+    if (telemetry_out) {
+        telemetry_dump(&oscData, telemetry_out);
+        if (telemetry_out != stdout) fclose(telemetry_out);
+    }
+    if (oscData.raw_dump) fclose(oscData.raw_dump);
 
     for (int i = 0; i < MAX_CHANNELS; i++) {
         free(oscData.channels[i].channel_history);
         oscData.channels[i].channel_history = NULL;
     }
+    spectrum_stop(&oscData.spectrum);
+    segments_free(&oscData);
+    measurements_free(&oscData);
+    decoder_free(&oscData);
+    recording_stop(&oscData); // незбережений хвіст запису дописується перед виходом
+    recording_viewer_close(&oscData);
 
     // Після виходу з циклу звільняємо пам'ять шрифту
 
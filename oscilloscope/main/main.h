@@ -8,7 +8,14 @@
 #include "init_osc_data.h"
 
 #define WORKSPACE_HEIGHT 550
-#define MAX_CHANNELS 4
+#define MAX_CHANNELS 16
+
+// Кольори каналів: перша плата — як і раніше, наступні — власні відтінки.
+// Для тексту четвертий канал світліший (SKYBLUE), щоб читався на темному тлі.
+#define CHANNEL_COLORS      { YELLOW, GREEN, RED, BLUE, GOLD, LIME, PINK, VIOLET, \
+                              ORANGE, DARKGREEN, MAROON, PURPLE, BEIGE, MAGENTA, BROWN, LIGHTGRAY }
+#define CHANNEL_TEXT_COLORS { YELLOW, GREEN, RED, SKYBLUE, GOLD, LIME, PINK, VIOLET, \
+                              ORANGE, DARKGREEN, MAROON, PURPLE, BEIGE, MAGENTA, BROWN, LIGHTGRAY }
 #define PACKET_SIZE 13
 
 #endif // MAIN_H
@@ -0,0 +1,212 @@
+// file app_options.c
+
+#include "app_options.h"
+#include "sequence.h"
+#include "usb_discovery.h"
+#include "usb_bulk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void print_usage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  --port PATH     open this serial device or pty (e.g. from osc_sim) instead of probing;\n"
+           "                  repeat for several boards (channels 1-4, 5-8, ... in that order)\n"
+           "  --devices N     probe for N boards (up to %d) and merge their channels\n"
+           "  --usb-id VID:PID find boards with this USB id (hex, default %04x:%04x)\n"
+           "  --sysfs-root DIR look for boards under DIR instead of /sys (e.g. a prepared test tree)\n"
+           "  --dev-root DIR  device nodes of found boards are DIR/<tty> instead of /dev/<tty>\n"
+           "  --transport T   tty = through the serial driver (default), usbfs = bulk IN endpoint\n"
+           "                  directly (found board, or --port /dev/bus/usb/BBB/DDD), sim = the same\n"
+           "                  transfer queue fed from --port PATH (e.g. an osc_sim pty)\n"
+           "  --replay FILE   play a raw byte dump or .oscrec recording instead of the serial port\n"
+           "  --speed X|max   replay speed: 1 = real time (default), 2 = twice as fast, max = unthrottled\n"
+           "  --rate HZ       sample rate of a raw dump (default 1000; recordings store their own)\n"
+           "  --loop          restart the replay when it reaches the end\n"
+           "  --dump FILE     save raw bytes received from the serial port for later replay\n"
+           "  --gaps MODE     lost packets (sequenced stream): mark = break the trace (default),\n"
+           "                  interp = linear interpolation, ignore = count only\n"
+           "  --compress      ask the board for delta-compressed sample blocks (Z toggles at run time)\n"
+           "  --no-timestamps don't ask the board to timestamp packets (4 bytes each): the time axis\n"
+           "                  and multi-board alignment then rely on arrival times\n"
+           "  --oversample N  average N = 4..256 (power of two) ADC readings per sample on the board:\n"
+           "                  +1 bit of resolution per 4x, lower sample rate (X cycles at run time)\n"
+           "  --ets M         equivalent-time sampling of a repetitive signal: M = 2..%d triggered\n"
+           "                  captures, each delayed by a fraction of the sample period, interleave\n"
+           "                  into one trace M times denser (single board; PA8 is the ADC trigger input)\n"
+           "  --profile       read the board's cycle profile (load per firmware section, USB IRQ latency)\n"
+           "                  into the F5 HUD and the telemetry summary (F6 toggles at run time)\n"
+           "  --test-wave CH=KIND[:FREQ[:AMP[:NOISE]]]\n"
+           "                  test signal of board channel CH (0..3): sine, square, triangle, saw, pulse, dc;\n"
+           "                  FREQ in Hz (0.1 Hz steps), AMP and NOISE peak in ADC counts\n"
+           "  --telemetry FILE write the telemetry summary (JSON) to FILE on exit (default: stdout)\n"
+           "  --help          show this help\n", prog, MAX_DEVICES, USB_BOARD_VID, USB_BOARD_PID,
+           CTRL_ETS_STEPS_MAX);
+}
+
+static int usage_error(const char *prog)
+{
+    print_usage(prog);
+    return -1;
+}
+
+// CH=KIND[:FREQ[:AMP[:NOISE]]]; не вказані поля лишаються -1
+static bool parse_test_wave(const char *spec, TestWaveOption *waves)
+{
+    int ch = -1, amplitude = -1, noise = -1;
+    char kind[16] = {0};
+    double freq = -1.0;
+    int n = sscanf(spec, "%d=%15[a-z]:%lf:%d:%d", &ch, kind, &freq, &amplitude, &noise);
+    int wave = n >= 2 ? control_test_wave_parse(kind) : -1;
+    if (ch < 0 || ch >= CTRL_TEST_CHANNELS || wave < 0) return false;
+    if (freq > CTRL_TEST_FREQ_MAX / 10.0 || amplitude > CTRL_TEST_AMPLITUDE_MAX || noise > CTRL_TEST_AMPLITUDE_MAX)
+        return false;
+
+    TestWaveOption *w = &waves[ch];
+    w->wave = wave;
+    w->freq_dhz = freq >= 0.0 ? (int)(freq * 10.0 + 0.5) : -1;
+    w->amplitude = amplitude;
+    w->noise = noise;
+    return true;
+}
+
+// Значення опції або NULL, якщо його не вказано
+static const char *option_value(int argc, char **argv, int *i)
+{
+    if (*i + 1 >= argc) {
+        fprintf(stderr, "Option %s needs a value\n", argv[*i]);
+        return NULL;
+    }
+    return argv[++*i];
+}
+
+int parse_app_options(int argc, char **argv, AppOptions *options)
+{
+    memset(options, 0, sizeof(*options));
+    options->replay_speed = 1.0f;
+    options->gap_mode = -1;
+    memset(options->test_waves, -1, sizeof(options->test_waves));
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value;
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            print_usage(argv[0]);
+            return 1;
+        } else if (strcmp(arg, "--loop") == 0) {
+            options->replay_loop = true;
+        } else if (strcmp(arg, "--compress") == 0) {
+            options->compress = true;
+        } else if (strcmp(arg, "--no-timestamps") == 0) {
+            options->no_timestamps = true;
+        } else if (strcmp(arg, "--profile") == 0) {
+            options->profile = true;
+        } else if (strcmp(arg, "--oversample") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            char *end;
+            long ratio = strtol(value, &end, 10);
+            int log2_ratio = 0;
+            while (log2_ratio < CTRL_OVERSAMPLE_MAX && (1L << log2_ratio) < ratio) log2_ratio++;
+            if (*end != '\0' || ratio < 1 || (1L << log2_ratio) != ratio) {
+                fprintf(stderr, "Invalid oversampling ratio: %s\n", value);
+                return usage_error(argv[0]);
+            }
+            options->oversample = log2_ratio;
+        } else if (strcmp(arg, "--ets") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            char *end;
+            options->ets_steps = (int)strtol(value, &end, 10);
+            if (*end != '\0' || options->ets_steps < 2 || options->ets_steps > CTRL_ETS_STEPS_MAX) {
+                fprintf(stderr, "Invalid ETS step count: %s\n", value);
+                return usage_error(argv[0]);
+            }
+        } else if (strcmp(arg, "--test-wave") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            if (!parse_test_wave(value, options->test_waves)) {
+                fprintf(stderr, "Invalid test wave: %s\n", value);
+                return usage_error(argv[0]);
+            }
+        } else if (strcmp(arg, "--port") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            if (options->port_count == MAX_DEVICES) {
+                fprintf(stderr, "At most %d ports\n", MAX_DEVICES);
+                return usage_error(argv[0]);
+            }
+            options->port_paths[options->port_count++] = value;
+        } else if (strcmp(arg, "--usb-id") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            if (!usb_parse_id(value, &options->usb_vid, &options->usb_pid)) {
+                fprintf(stderr, "Invalid USB id: %s\n", value);
+                return usage_error(argv[0]);
+            }
+        } else if (strcmp(arg, "--sysfs-root") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            options->sysfs_root = value;
+        } else if (strcmp(arg, "--dev-root") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            options->dev_root = value;
+        } else if (strcmp(arg, "--transport") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            int transport = usb_transport_parse(value);
+            if (transport < 0) {
+                fprintf(stderr, "Invalid transport: %s\n", value);
+                return usage_error(argv[0]);
+            }
+            options->transport = (UsbTransport)transport;
+        } else if (strcmp(arg, "--devices") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            char *end;
+            options->device_count = (int)strtol(value, &end, 10);
+            if (*end != '\0' || options->device_count < 1 || options->device_count > MAX_DEVICES) {
+                fprintf(stderr, "Invalid device count: %s\n", value);
+                return usage_error(argv[0]);
+            }
+        } else if (strcmp(arg, "--replay") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            options->replay_path = value;
+        } else if (strcmp(arg, "--telemetry") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            options->telemetry_path = value;
+        } else if (strcmp(arg, "--gaps") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            if ((options->gap_mode = gap_mode_parse(value)) < 0) {
+                fprintf(stderr, "Invalid gap mode: %s\n", value);
+                return usage_error(argv[0]);
+            }
+        } else if (strcmp(arg, "--dump") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            options->dump_path = value;
+        } else if (strcmp(arg, "--speed") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            if (strcmp(value, "max") == 0) {
+                options->replay_speed = 0.0f;
+            } else {
+                char *end;
+                options->replay_speed = strtof(value, &end);
+                if (*end != '\0' || options->replay_speed <= 0.0f) {
+                    fprintf(stderr, "Invalid speed: %s\n", value);
+                    return usage_error(argv[0]);
+                }
+            }
+        } else if (strcmp(arg, "--rate") == 0) {
+            if (!(value = option_value(argc, argv, &i))) return usage_error(argv[0]);
+            char *end;
+            options->replay_rate_hz = strtof(value, &end);
+            if (*end != '\0' || options->replay_rate_hz <= 0.0f) {
+                fprintf(stderr, "Invalid rate: %s\n", value);
+                return usage_error(argv[0]);
+            }
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return usage_error(argv[0]);
+        }
+    }
+    // Захоплення різних плат не мають спільного фронту
+    if (options->ets_steps && (options->port_count > 1 || options->device_count > 0)) {
+        fprintf(stderr, "--ets works with a single board\n");
+        return usage_error(argv[0]);
+    }
+    return 0;
+}
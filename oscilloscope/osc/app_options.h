@@ -0,0 +1,49 @@
+// file app_options.h
+
+#ifndef APP_OPTIONS_H
+#define APP_OPTIONS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "devices.h"
+#include "usb_bulk.h"
+#include "control_protocol.h"
+
+// --test-wave: форма тестового сигналу каналу плати; -1 — лишити, як на платі
+typedef struct {
+    int wave;                  // CtrlTestWave
+    int freq_dhz;              // 0.1 Гц
+    int amplitude;             // Пік, відліки АЦП
+    int noise;
+} TestWaveOption;
+
+// Параметри командного рядка
+typedef struct {
+    const char *port_paths[MAX_DEVICES]; // --port PATH: відкрити вказаний порт замість автопошуку;
+    int port_count;            //   кілька --port — кілька плат одночасно
+    int device_count;          // --devices N: знайти N плат автопошуком, 0 — одна плата
+    const char *sysfs_root;    // --sysfs-root DIR: де шукати плату замість /sys (підготовлене дерево)
+    const char *dev_root;      // --dev-root DIR: каталог вузлів пристроїв замість /dev
+    uint16_t usb_vid;          // --usb-id VID:PID: інша плата, 0 — USB_BOARD_VID/USB_BOARD_PID
+    uint16_t usb_pid;
+    UsbTransport transport;    // --transport tty|usbfs|sim: як читати плату (usb_bulk.h)
+    const char *replay_path;   // --replay FILE: відтворення замість COM-порту
+    float replay_speed;        // --speed X|max: 1 — реальний час, 0 — якнайшвидше
+    float replay_rate_hz;      // --rate HZ: частота семплів сирого дампу (0 — за замовчуванням)
+    bool replay_loop;          // --loop: повторювати файл по колу
+    const char *dump_path;     // --dump FILE: зберігати сирі байти з порту для відтворення
+    const char *telemetry_path;// --telemetry FILE: куди записати підсумок телеметрії при виході
+    int gap_mode;              // --gaps MODE: GapMode для втрачених пакетів, -1 — за замовчуванням
+    bool compress;             // --compress: попросити плату стискати потік (CTRL_PARAM_COMPRESSION)
+    bool no_timestamps;        // --no-timestamps: не просити в плати мітки часу (CTRL_PARAM_TIMESTAMPS)
+    int oversample;            // --oversample N: log2 N, 0 — без передискретизації (CTRL_PARAM_OVERSAMPLE)
+    bool profile;              // --profile: читати профіль прошивки (CTRL_OP_STAT) у HUD і телеметрію
+    int ets_steps;             // --ets M: захоплення в еквівалентному часі, 0 — вимкнено (CTRL_PARAM_ETS_STEPS)
+    TestWaveOption test_waves[CTRL_TEST_CHANNELS]; // --test-wave CH=KIND[:FREQ[:AMP[:NOISE]]]
+} AppOptions;
+
+// Розбирає argv. 0 — продовжувати, 1 — показано довідку, -1 — помилка (довідку надруковано).
+int parse_app_options(int argc, char **argv, AppOptions *options);
+
+#endif // APP_OPTIONS_H
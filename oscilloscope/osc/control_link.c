@@ -0,0 +1,217 @@
+// file control_link.c
+
+#include "main.h"
+#include "control_link.h"
+#include "find_usb_device.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PARAM_BIT(p) (1u << (p))
+#define ALL_PARAMS (PARAM_BIT(CTRL_PARAM_COUNT) - 1)
+
+_Static_assert(CTRL_PARAM_COUNT < 32, "бітові маски параметрів ControlLink — uint32_t");
+
+void control_link_init(ControlLink *link)
+{
+    memset(link, 0, sizeof(*link));
+    link->next_id = 1;
+}
+
+void control_set(ControlLink *link, CtrlParam param, int32_t value)
+{
+    if (param < 0 || param >= CTRL_PARAM_COUNT) return;
+    if ((link->rejected & PARAM_BIT(param)) && link->desired[param] == value) return;
+    link->rejected &= ~PARAM_BIT(param);
+    link->desired[param] = value;
+    link->wanted |= PARAM_BIT(param);
+    if ((link->known & PARAM_BIT(param)) && link->device[param] == value)
+        link->dirty &= ~PARAM_BIT(param);
+    else
+        link->dirty |= PARAM_BIT(param);
+}
+
+void control_set_channels(OscData *data)
+{
+    int32_t mask = 0;
+    for (int i = 0; i < data->channel_count; i++)
+        if (data->channels[i].active) mask |= 1 << (i % DEVICE_CHANNELS);
+    if (mask != 0) control_set(&data->control, CTRL_PARAM_CHANNEL_MASK, mask);
+}
+
+void control_on_frame(ControlLink *link, const uint8_t *buf, int size)
+{
+    ControlFrame frame;
+    if (!control_decode(buf, size, &frame)) {
+        link->bad_frames++;
+        return;
+    }
+    ControlReply reply = control_parse_reply(&frame);
+    if (reply.valid) link->reply = reply;
+}
+
+// Відповідь на запит у дорозі: від єдиної плати або від усіх плат набору (NAK будь-якої — NAK)
+static bool take_reply(OscData *data, ControlReply *out)
+{
+    ControlLink *link = &data->control;
+    DeviceSet *set = &data->devices;
+
+    if (set->count == 0) {
+        if (!link->reply.valid || link->reply.id != link->request.id) return false;
+        *out = link->reply;
+        link->reply.valid = false;
+        return true;
+    }
+
+    ControlReply merged = { .valid = false };
+    for (int d = 0; d < set->count; d++) {
+        ControlReply r = control_reply_unpack(atomic_load(&set->devices[d].ctrl_reply));
+        if (!r.valid || r.id != link->request.id) return false;
+        if (!merged.valid || !r.ack) merged = r;
+    }
+    *out = merged;
+    return true;
+}
+
+static void send_request(OscData *data, double now)
+{
+    ControlLink *link = &data->control;
+    uint8_t buf[CTRL_FRAME_MAX];
+    int len = control_encode(buf, &link->request);
+    usb_device_write(data, buf, len);
+    link->sent_at = now;
+    link->tries++;
+}
+
+// Стат профілю: повний обхід стає видимим разом, щоб усі значення були з одного вікна плати
+static void handle_stat_reply(ControlLink *link, const ControlReply *r, double now)
+{
+    if (!r->ack) {
+        if (r->error == CTRL_ERR_CRC) return;
+        printf("Плата не віддає профіль прошивки: %s\n", control_error_name(r->error));
+        link->profile = false;
+        return;
+    }
+    if (r->param != link->stat_next) return;
+    link->stats_sweep[link->stat_next++] = (uint32_t)r->value;
+    if (link->stat_next < CTRL_STAT_COUNT) return;
+    memcpy(link->stats, link->stats_sweep, sizeof(link->stats));
+    link->stat_sweeps++;
+    link->stat_next = 0;
+    link->stats_due = now + CTRL_STATS_PERIOD_S;
+}
+
+static void handle_reply(ControlLink *link, const ControlReply *r, double now)
+{
+    int param = link->request.len > 0 ? link->request.payload[0] : -1;
+    link->busy = false;
+    link->rtt_ms = (now - link->first_sent_at) * 1000.0;
+
+    if (link->request.op == CTRL_OP_STAT) {
+        if (r->ack) link->acks++;
+        else link->naks++;
+        handle_stat_reply(link, r, now);
+        return;
+    }
+
+    if (!r->ack) {
+        link->naks++;
+        if (r->error == CTRL_ERR_CRC) {
+            // Запит пошкоджено по дорозі: наступний виклик надішле його знову з новим ID
+            return;
+        }
+        printf("Плата відхилила %s %s: %s\n", link->request.op == CTRL_OP_SET ? "SET" : "GET",
+               control_param_name(param), control_error_name(r->error));
+        if (param >= 0 && param < CTRL_PARAM_COUNT) {
+            // Відхилене значення не повторюється; що діє на платі — зчитується
+            link->dirty &= ~PARAM_BIT(param);
+            link->wanted &= ~PARAM_BIT(param);
+            if (link->request.op == CTRL_OP_SET) link->rejected |= PARAM_BIT(param);
+            if (link->request.op == CTRL_OP_SET && r->error == CTRL_ERR_RANGE) link->query |= PARAM_BIT(param);
+            else link->query &= ~PARAM_BIT(param);
+        }
+        return;
+    }
+
+    link->acks++;
+    if (r->op != CTRL_OP_GET && r->op != CTRL_OP_SET) return;
+    if (r->param >= CTRL_PARAM_COUNT) return;
+
+    link->device[r->param] = r->value;
+    link->known |= PARAM_BIT(r->param);
+    link->query &= ~PARAM_BIT(r->param);
+    // Поки запит був у дорозі, бажане значення могло змінитись — тоді SET піде ще раз
+    if (!(link->wanted & PARAM_BIT(r->param)) || link->desired[r->param] == r->value)
+        link->dirty &= ~PARAM_BIT(r->param);
+}
+
+// Наступний запит: спершу SET заданих параметрів, потім GET решти, потім стати профілю
+static bool next_request(ControlLink *link, double now)
+{
+    for (int p = 0; p < CTRL_PARAM_COUNT; p++) {
+        if (link->dirty & PARAM_BIT(p)) {
+            link->request = control_request(link->next_id, CTRL_OP_SET, (uint8_t)p, link->desired[p]);
+            return true;
+        }
+    }
+    for (int p = 0; p < CTRL_PARAM_COUNT; p++) {
+        if (link->query & PARAM_BIT(p)) {
+            link->request = control_request(link->next_id, CTRL_OP_GET, (uint8_t)p, 0);
+            return true;
+        }
+    }
+    if (link->profile && (link->stat_next > 0 || now >= link->stats_due)) {
+        link->request = control_request(link->next_id, CTRL_OP_STAT, (uint8_t)link->stat_next, 0);
+        return true;
+    }
+    return false;
+}
+
+void control_service(OscData *data, double now)
+{
+    ControlLink *link = &data->control;
+    bool connected = usb_device_connected(data) || data->devices.count > 0;
+
+    if (connected != link->connected) {
+        // Нова плата (або та сама після перепідключення) нічого не знає про налаштування хоста
+        link->connected = connected;
+        link->busy = false;
+        link->reply.valid = false;
+        link->known = 0;
+        link->dirty = link->wanted;
+        link->query = ALL_PARAMS & ~link->wanted;
+        link->resume_at = 0.0;
+        link->stat_next = 0;
+        link->stats_due = 0.0;
+        link->stat_sweeps = 0;
+    }
+    if (!connected) return;
+
+    if (link->busy) {
+        ControlReply reply;
+        if (take_reply(data, &reply)) {
+            handle_reply(link, &reply, now);
+        } else if (now - link->sent_at >= CTRL_TIMEOUT_S) {
+            if (link->tries < CTRL_RETRIES) {
+                // Той самий ID: SET і GET ідемпотентні, тож повтор безпечний, навіть якщо
+                // загубилась лише відповідь
+                link->retries++;
+                send_request(data, now);
+            } else {
+                link->timeouts++;
+                link->busy = false;
+                link->resume_at = now + CTRL_BACKOFF_S;
+                printf("Плата не відповідає на запити керування, повтор через %.0f с\n", CTRL_BACKOFF_S);
+            }
+        }
+        if (link->busy) return;
+    }
+
+    if (now < link->resume_at || !next_request(link, now)) return;
+    link->next_id = (uint8_t)(link->next_id + 1);
+    if (link->next_id == 0) link->next_id = 1; // 0 — у плати ще не було відповіді
+    link->busy = true;
+    link->tries = 0;
+    link->first_sent_at = now;
+    link->requests++;
+    send_request(data, now);
+}
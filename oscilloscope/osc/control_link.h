@@ -0,0 +1,73 @@
+// file control_link.h
+
+#ifndef CONTROL_LINK_H
+#define CONTROL_LINK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "control_protocol.h"
+
+#define CTRL_TIMEOUT_S 0.1     // Без відповіді довше — повтор того самого запиту (той самий ID)
+#define CTRL_RETRIES 3         // Спроб на запит, далі пауза CTRL_BACKOFF_S
+#define CTRL_BACKOFF_S 1.0
+#define CTRL_STATS_PERIOD_S 1.0 // Обхід статів профілю прошивки — не частіше (вікно плати — 1 с)
+
+// Параметри плати як бажаний стан: панель лише змінює desired[], а control_service по одному
+// запиту (стоп-і-чекай) доводить плату до нього, повторюючи запити без відповіді. Після
+// перепідключення плати задані параметри надсилаються знову, решта зчитується (GET).
+typedef struct {
+    int32_t desired[CTRL_PARAM_COUNT];
+    int32_t device[CTRL_PARAM_COUNT];  // Підтверджені платою значення
+    uint32_t wanted;                   // Біт параметра: desired[] задано хостом
+    uint32_t dirty;                    // Треба надіслати SET
+    uint32_t query;                    // Треба надіслати GET
+    uint32_t known;                    // device[] відоме
+    uint32_t rejected;                 // Плата відхилила desired[]: не надсилати, доки воно не зміниться
+
+    bool connected;                    // Стан з'єднання на минулому виклику control_service
+    bool busy;                         // Запит у дорозі
+    ControlFrame request;
+    double sent_at;
+    double first_sent_at;
+    int tries;
+    double resume_at;                  // Після CTRL_RETRIES невдалих спроб
+    uint8_t next_id;
+    ControlReply reply;                // Відповідь однієї плати (пише розбір потоку)
+
+    // Профіль прошивки: з profile стати CTRL_OP_STAT читаються по одному між запитами
+    // параметрів; кілька плат — профіль першої
+    bool profile;
+    int stat_next;                     // Наступний стат обходу
+    double stats_due;                  // Початок наступного обходу
+    uint32_t stats_sweep[CTRL_STAT_COUNT];
+    uint32_t stats[CTRL_STAT_COUNT];   // Останній повний обхід — одне вікно плати
+    unsigned long long stat_sweeps;
+
+    unsigned long long requests;
+    unsigned long long acks;
+    unsigned long long naks;
+    unsigned long long retries;
+    unsigned long long timeouts;
+    unsigned long long bad_frames;     // Кадри керування з хибною CRC або довжиною
+    double rtt_ms;                     // Від першої спроби до відповіді, останній запит
+} ControlLink;
+
+struct OscData;
+
+void control_link_init(ControlLink *link);
+
+// Бажане значення параметра; надсилається, якщо плата ще не має саме його
+void control_set(ControlLink *link, CtrlParam param, int32_t value);
+
+// CTRL_PARAM_CHANNEL_MASK з ChannelSettings.active: канал n кожної плати — біт n.
+// Без жодного увімкненого каналу плата лишається з попередньою маскою
+void control_set_channels(struct OscData *data);
+
+// Кадр керування з потоку даних (одна плата): відповідь для control_service
+void control_on_frame(ControlLink *link, const uint8_t *buf, int size);
+
+// Щокадру: відповіді, повтори, наступний запит
+void control_service(struct OscData *data, double now);
+
+#endif // CONTROL_LINK_H
@@ -0,0 +1,181 @@
+// file control_protocol.c
+
+#include "control_protocol.h"
+#include <string.h>
+
+static const char *param_names[CTRL_PARAM_COUNT] = {
+    "rate", "test_signal", "trigger_edge", "led", "channel_mask", "compression", "oversample",
+    "test_wave0", "test_wave1", "test_wave2", "test_wave3",
+    "test_freq0", "test_freq1", "test_freq2", "test_freq3",
+    "test_amplitude0", "test_amplitude1", "test_amplitude2", "test_amplitude3",
+    "test_noise0", "test_noise1", "test_noise2", "test_noise3",
+    "timestamps", "ets_steps",
+};
+static const char *prof_section_names[CTRL_PROF_SECTIONS] = {
+    "acquire", "pace", "encode", "transmit", "control", "usb_irq", "usb_latency",
+};
+static const char *test_wave_names[CTRL_TEST_WAVE_COUNT] = { "sine", "square", "triangle", "saw", "pulse", "dc" };
+static const char *error_names[CTRL_ERR_COUNT] = { "ok", "crc", "opcode", "length", "param", "range" };
+
+uint16_t control_crc16(const uint8_t *buf, int len)
+{
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < len; i++) {
+        crc ^= (uint16_t)buf[i] << 8;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+int control_encode(uint8_t *out, const ControlFrame *frame)
+{
+    int len = frame->len > CTRL_PAYLOAD_MAX ? CTRL_PAYLOAD_MAX : frame->len;
+    out[0] = CTRL_START;
+    out[1] = (uint8_t)len;
+    out[2] = frame->id;
+    out[3] = frame->op;
+    memcpy(out + CTRL_HEADER, frame->payload, (size_t)len);
+
+    uint16_t crc = control_crc16(out + 1, CTRL_HEADER - 1 + len);
+    out[CTRL_HEADER + len] = (uint8_t)(crc & 0xFF);
+    out[CTRL_HEADER + len + 1] = (uint8_t)(crc >> 8);
+    return CTRL_HEADER + len + 2;
+}
+
+int control_frame_size(const uint8_t *buf, int have)
+{
+    if (have < 2) return 0;
+    if (buf[1] > CTRL_PAYLOAD_MAX) return -1;
+    return CTRL_HEADER + buf[1] + 2;
+}
+
+bool control_decode(const uint8_t *buf, int size, ControlFrame *frame)
+{
+    if (size < CTRL_HEADER + 2 || buf[0] != CTRL_START || control_frame_size(buf, size) != size)
+        return false;
+
+    int len = buf[1];
+    uint16_t crc = (uint16_t)(buf[CTRL_HEADER + len] | (buf[CTRL_HEADER + len + 1] << 8));
+    if (control_crc16(buf + 1, CTRL_HEADER - 1 + len) != crc) return false;
+
+    frame->len = (uint8_t)len;
+    frame->id = buf[2];
+    frame->op = buf[3];
+    memcpy(frame->payload, buf + CTRL_HEADER, (size_t)len);
+    return true;
+}
+
+static void put_i32(uint8_t *p, int32_t value)
+{
+    uint32_t v = (uint32_t)value;
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static int32_t get_i32(const uint8_t *p)
+{
+    return (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+ControlFrame control_request(uint8_t id, uint8_t op, uint8_t param, int32_t value)
+{
+    ControlFrame f = { .id = id, .op = op, .len = 0 };
+    if (op == CTRL_OP_GET || op == CTRL_OP_SET || op == CTRL_OP_STAT) {
+        f.payload[f.len++] = param;
+        if (op == CTRL_OP_SET) {
+            put_i32(&f.payload[f.len], value);
+            f.len += 4;
+        }
+    }
+    return f;
+}
+
+ControlFrame control_ack(const ControlFrame *request, uint8_t param, int32_t value)
+{
+    ControlFrame f = { .id = request->id, .op = CTRL_OP_ACK, .len = 1 };
+    f.payload[0] = request->op;
+    if (request->op == CTRL_OP_GET || request->op == CTRL_OP_SET || request->op == CTRL_OP_STAT) {
+        f.payload[f.len++] = param;
+        put_i32(&f.payload[f.len], value);
+        f.len += 4;
+    }
+    return f;
+}
+
+ControlFrame control_nak(const ControlFrame *request, CtrlError error)
+{
+    ControlFrame f = { .id = request->id, .op = CTRL_OP_NAK, .len = 2 };
+    f.payload[0] = request->op;
+    f.payload[1] = (uint8_t)error;
+    return f;
+}
+
+ControlReply control_parse_reply(const ControlFrame *frame)
+{
+    ControlReply r = { .valid = false };
+    if (frame->len < 1 || (frame->op != CTRL_OP_ACK && frame->op != CTRL_OP_NAK)) return r;
+
+    r.valid = true;
+    r.id = frame->id;
+    r.ack = frame->op == CTRL_OP_ACK;
+    r.op = frame->payload[0];
+    if (!r.ack) {
+        r.error = frame->len >= 2 ? frame->payload[1] : CTRL_ERR_LENGTH;
+    } else if (frame->len >= 6) {
+        r.param = frame->payload[1];
+        r.value = get_i32(&frame->payload[2]);
+    }
+    return r;
+}
+
+// Біти: 63 — valid, 62 — ack, 48..55 id, 40..47 op, 32..39 error/param, 0..31 value
+uint64_t control_reply_pack(const ControlReply *reply)
+{
+    if (!reply->valid) return 0;
+    uint8_t code = reply->ack ? reply->param : reply->error;
+    return (1ull << 63) | ((uint64_t)reply->ack << 62) | ((uint64_t)reply->id << 48) |
+           ((uint64_t)reply->op << 40) | ((uint64_t)code << 32) | (uint32_t)reply->value;
+}
+
+ControlReply control_reply_unpack(uint64_t packed)
+{
+    ControlReply r = { .valid = (packed >> 63) & 1 };
+    if (!r.valid) return r;
+    r.ack = (packed >> 62) & 1;
+    r.id = (uint8_t)(packed >> 48);
+    r.op = (uint8_t)(packed >> 40);
+    if (r.ack) r.param = (uint8_t)(packed >> 32);
+    else r.error = (uint8_t)(packed >> 32);
+    r.value = (int32_t)(uint32_t)packed;
+    return r;
+}
+
+const char *control_param_name(int param)
+{
+    return (param >= 0 && param < CTRL_PARAM_COUNT) ? param_names[param] : "?";
+}
+
+const char *control_prof_section_name(int section)
+{
+    return (section >= 0 && section < CTRL_PROF_SECTIONS) ? prof_section_names[section] : "?";
+}
+
+const char *control_error_name(int error)
+{
+    return (error >= 0 && error < CTRL_ERR_COUNT) ? error_names[error] : "?";
+}
+
+const char *control_test_wave_name(int wave)
+{
+    return (wave >= 0 && wave < CTRL_TEST_WAVE_COUNT) ? test_wave_names[wave] : "?";
+}
+
+int control_test_wave_parse(const char *name)
+{
+    for (int i = 0; i < CTRL_TEST_WAVE_COUNT; i++)
+        if (strcmp(name, test_wave_names[i]) == 0) return i;
+    return -1;
+}
@@ -0,0 +1,156 @@
+// file control_protocol.h
+
+#ifndef CONTROL_PROTOCOL_H
+#define CONTROL_PROTOCOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Кадр керування (обидва напрямки, спільний з прошивкою — Core/control_protocol.h):
+//   START LEN ID OP payload[LEN] CRC16
+// CRC-16/CCITT-FALSE рахується від LEN до кінця payload і передається молодшим байтом вперед.
+// Відповіді плати йдуть тим самим каналом, що й семпли, одразу за пакетом 0xAA/0xAB:
+// стартовий байт відрізняється від стартових байтів пакетів семплів.
+#define CTRL_START 0xAC
+#define CTRL_HEADER 4                // START, LEN, ID, OP
+#define CTRL_PAYLOAD_MAX 8
+#define CTRL_FRAME_MAX (CTRL_HEADER + CTRL_PAYLOAD_MAX + 2)
+
+// Запити хоста
+#define CTRL_OP_PING 0x01            // Без даних; відповідь ACK без даних
+#define CTRL_OP_GET  0x02            // [param]
+#define CTRL_OP_SET  0x03            // [param, value int32 LE]
+#define CTRL_OP_STAT 0x04            // [stat] — лічильник профілю прошивки (CTRL_STAT_*)
+// Відповіді плати (ID — як у запиту)
+#define CTRL_OP_ACK  0x80            // [op запиту] + для GET/SET: [param, value int32 LE] — значення, що діє;
+                                     // для STAT: [stat, value uint32 LE]
+#define CTRL_OP_NAK  0x81            // [op запиту, CtrlError]
+
+typedef enum {
+    CTRL_ERR_NONE,
+    CTRL_ERR_CRC,                    // Кадр пошкоджено (ID теж може бути хибним)
+    CTRL_ERR_OPCODE,                 // Невідома операція
+    CTRL_ERR_LENGTH,                 // Довжина даних не відповідає операції
+    CTRL_ERR_PARAM,                  // Невідомий параметр
+    CTRL_ERR_RANGE,                  // Значення поза межами — не застосовано
+    CTRL_ERR_COUNT
+} CtrlError;
+
+// Параметри збору даних (GET/SET)
+#define CTRL_RATE_MAX 1000           // Найбільша затримка CTRL_PARAM_RATE
+#define CTRL_CHANNEL_MASK_ALL 0x0F   // Усі канали плати (CTRL_PARAM_CHANNEL_MASK)
+#define CTRL_OVERSAMPLE_MAX 8        // Найбільше 2^8 = 256 сканів АЦП на семпл (CTRL_PARAM_OVERSAMPLE)
+#define CTRL_TEST_CHANNELS 4         // Генератор тестового сигналу: по параметру кожного виду на канал плати
+#define CTRL_TEST_FREQ_MAX 65535     // CTRL_PARAM_TEST_FREQ у 0.1 Гц
+#define CTRL_TEST_AMPLITUDE_MAX 2047 // CTRL_PARAM_TEST_AMPLITUDE/NOISE: пік у відліках АЦП
+#define CTRL_ETS_STEPS_MAX 64        // Найбільше кроків еквівалентного часу (CTRL_PARAM_ETS_STEPS)
+
+// Форми тестового сигналу (DdsWave у прошивці)
+typedef enum {
+    CTRL_TEST_WAVE_SINE,
+    CTRL_TEST_WAVE_SQUARE,
+    CTRL_TEST_WAVE_TRIANGLE,
+    CTRL_TEST_WAVE_SAW,
+    CTRL_TEST_WAVE_PULSE,            // 1/8 періоду вгорі
+    CTRL_TEST_WAVE_DC,               // Рівень амплітуди
+    CTRL_TEST_WAVE_COUNT
+} CtrlTestWave;
+
+typedef enum {
+    CTRL_PARAM_RATE,                 // Затримка між пакетами: N*1000 ітерацій nop у прошивці, 0..CTRL_RATE_MAX
+    CTRL_PARAM_TEST_SIGNAL,          // 0 — АЦП, 1 — генератор тестового сигналу (параметри CTRL_PARAM_TEST_*)
+    CTRL_PARAM_TRIGGER_EDGE,         // Фронт тригера (як радіокнопки панелі): для захоплень CTRL_PARAM_ETS_STEPS, будь-який — як зростаючий
+    CTRL_PARAM_LED,                  // Світлодіод PC13: 1 — увімкнено
+    CTRL_PARAM_CHANNEL_MASK,         // Канали, які плата вимірює і передає (пакети 0xAD), 1..CTRL_CHANNEL_MASK_ALL
+    CTRL_PARAM_COMPRESSION,          // 1 — стиснені блоки 0xAE замість пакетів 0xAD (delta_codec.h)
+    CTRL_PARAM_OVERSAMPLE,           // N: семпл — сума 2^N сканів АЦП, N/2 додаткових біт у пакеті; 0 — вимкнено
+    // Тестовий сигнал каналу ch: параметр + ch
+    CTRL_PARAM_TEST_WAVE,            // CtrlTestWave
+    CTRL_PARAM_TEST_FREQ = CTRL_PARAM_TEST_WAVE + CTRL_TEST_CHANNELS,           // 0.1 Гц, до CTRL_TEST_FREQ_MAX
+    CTRL_PARAM_TEST_AMPLITUDE = CTRL_PARAM_TEST_FREQ + CTRL_TEST_CHANNELS,      // Пік від середини шкали
+    CTRL_PARAM_TEST_NOISE = CTRL_PARAM_TEST_AMPLITUDE + CTRL_TEST_CHANNELS,     // Пік рівномірного шуму
+    CTRL_PARAM_TIMESTAMPS = CTRL_PARAM_TEST_NOISE + CTRL_TEST_CHANNELS, // 1 — мітка часу плати в пакетах 0xAD/0xAE (PACKET_TIME_FLAG)
+    CTRL_PARAM_ETS_STEPS,            // M > 1 — захоплення 0xAF від фронту в еквівалентному часі (osc/ets.h), 0 — вимкнено
+    CTRL_PARAM_COUNT
+} CtrlParam;
+
+// Профіль прошивки (CTRL_OP_STAT): облік тактів DWT за останнє завершене вікно плати (1 с).
+// Стат CTRL_STAT_WINDOW фіксує знімок вікна, решта читається з нього ж
+#define CTRL_PROF_CLOCK_HZ 72e6      // Такти CYCCNT за секунду
+#define CTRL_STAT_WINDOW        0    // Номер вікна
+#define CTRL_STAT_WINDOW_CYCLES 1    // Тривалість вікна, такти
+#define CTRL_STAT_SCANS         2    // Скани в сформованих пакетах
+#define CTRL_STAT_PACKETS       3    // Сформовані пакети
+#define CTRL_STAT_TX_BUSY       4    // Пакети, не передані: кільце передавання плати повне (хост бачить розрив номерів)
+#define CTRL_STAT_RX_OVERFLOWS  5    // Байти запитів, що не вмістились у кільце прийому плати
+#define CTRL_STAT_PMA_OVERRUNS  6    // ISTR.PMAOVR: ядро USB не встигло до пам'яті пакетів
+#define CTRL_STAT_USB_ERRORS    7    // ISTR.ERR: помилки на шині
+#define CTRL_STAT_SECTIONS      8    // Далі по CTRL_PROF_FIELDS статів на ділянку CtrlProfSection
+
+typedef enum {
+    CTRL_PROF_ACQUIRE,               // Скани АЦП, генератора чи захоплення ETS
+    CTRL_PROF_PACE,                  // Затримка CTRL_PARAM_RATE між сканами; у потоці DMA (0xB0) — сон ядра
+    CTRL_PROF_ENCODE,                // Заголовок і значення пакета; у потоці DMA — переривання DMA
+    CTRL_PROF_TRANSMIT,              // Пакет у кільце передавання плати
+    CTRL_PROF_CONTROL,               // Розбір запитів керування
+    CTRL_PROF_USB_IRQ,               // Переривання USB (його такти входять і в ділянку, яку воно перервало)
+    CTRL_PROF_USB_LATENCY,           // Запізнення обробки SOF понад період 1 мс
+    CTRL_PROF_SECTIONS
+} CtrlProfSection;
+
+// Поля ділянки: сума тактів, кількість, найдовша, гістограма тривалостей
+#define CTRL_PROF_CYCLES  0
+#define CTRL_PROF_COUNT   1
+#define CTRL_PROF_MAX     2
+#define CTRL_PROF_HIST    3
+#define CTRL_PROF_BUCKETS 6          // < 256 тактів, далі межі x4, останній — від 64K тактів
+#define CTRL_PROF_FIELDS (CTRL_PROF_HIST + CTRL_PROF_BUCKETS)
+#define CTRL_STAT_COUNT (CTRL_STAT_SECTIONS + CTRL_PROF_SECTIONS * CTRL_PROF_FIELDS)
+
+typedef struct {
+    uint8_t id;
+    uint8_t op;
+    uint8_t len;
+    uint8_t payload[CTRL_PAYLOAD_MAX];
+} ControlFrame;
+
+// Розібрана відповідь (для хоста). valid == false — ще не отримано
+typedef struct {
+    bool valid;
+    uint8_t id;
+    bool ack;
+    uint8_t op;                      // Операція запиту
+    uint8_t error;                   // CtrlError для NAK
+    uint8_t param;
+    int32_t value;
+} ControlReply;
+
+uint16_t control_crc16(const uint8_t *buf, int len);
+
+// Кадр у out (щонайменше CTRL_FRAME_MAX байтів); повертає його довжину
+int control_encode(uint8_t *out, const ControlFrame *frame);
+
+// Повна довжина кадру за вже прийнятими байтами (buf[0] == CTRL_START):
+// 0 — ще невідома, -1 — LEN неможливий (це не кадр)
+int control_frame_size(const uint8_t *buf, int have);
+
+// Перевіряє CRC і розбирає повний кадр; false — пошкоджений
+bool control_decode(const uint8_t *buf, int size, ControlFrame *frame);
+
+// Запити і відповіді з параметром (або статом для CTRL_OP_STAT): значення int32 у payload
+ControlFrame control_request(uint8_t id, uint8_t op, uint8_t param, int32_t value);
+ControlFrame control_ack(const ControlFrame *request, uint8_t param, int32_t value);
+ControlFrame control_nak(const ControlFrame *request, CtrlError error);
+ControlReply control_parse_reply(const ControlFrame *frame);
+
+// Відповідь в одному 64-бітному слові: потоки плат передають її головному потоку атомарно
+uint64_t control_reply_pack(const ControlReply *reply);
+ControlReply control_reply_unpack(uint64_t packed);
+
+const char *control_param_name(int param);
+const char *control_prof_section_name(int section);
+const char *control_error_name(int error);
+const char *control_test_wave_name(int wave);
+int control_test_wave_parse(const char *name); // -1 — невідома форма
+
+#endif // CONTROL_PROTOCOL_H
@@ -0,0 +1,142 @@
+// file cursor_readout.c
+
+#include "cursor_readout.h"
+#include "draw_signal.h"
+#include "read_usb_device.h"
+#include "glyphs.h"
+
+#include "raylib.h"
+#include <stdio.h>
+
+extern int spacing;
+extern int padding;
+extern int borderThickness;
+
+// Форматування часу зі знаком і автоматичним вибором одиниць (с, мс, мкс)
+static void format_time(char *buf, size_t size, float seconds)
+{
+    float a = seconds < 0.0f ? -seconds : seconds;
+    if (a >= 1.0f) snprintf(buf, size, "%+.3fs", seconds);
+    else if (a >= 1e-3f) snprintf(buf, size, "%+.3fms", seconds * 1e3f);
+    else snprintf(buf, size, "%+.1fus", seconds * 1e6f);
+}
+
+CursorReadout cursors_bind_to_samples(OscData *oscData, Cursor *cursors, float osc_width)
+{
+    CursorReadout r = {0};
+
+    // Сегменти мають власну розкладку — там курсори лишаються піксельними
+    SignalLayout layout = signal_layout(oscData, osc_width);
+    bool bind = layout.valid && !oscData->segments.enabled;
+    cursors[0].bound = cursors[1].bound = bind;
+    if (!bind) return r;
+
+    for (int k = 0; k < 2; k++) {
+        Cursor *c = &cursors[k];
+        r.offset[k] = signal_x_to_offset(&layout, c->x);
+        r.marker_x[k] = signal_offset_to_x(&layout, r.offset[k]);
+
+        // Під час перетягування X іде за мишею, після відпускання стає точно на семпл
+        if (!c->isDragging && r.marker_x[k] >= c->min_X && r.marker_x[k] <= c->max_X)
+            c->x = r.marker_x[k];
+        c->value = r.offset[k];
+    }
+
+    r.valid = true;
+    r.delta_samples = r.offset[1] - r.offset[0];
+    if (oscData->sample_rate_hz > 0.0f)
+        r.delta_t_s = r.delta_samples / oscData->sample_rate_hz;
+
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        ChannelSettings *ch = &oscData->channels[i];
+        if (!ch->active || ch->channel_history == NULL) continue;
+
+        r.channel_valid[i] = true;
+        for (int k = 0; k < 2; k++) {
+            int idx = signal_offset_to_index(oscData, &layout, i, r.offset[k]);
+            r.volts[i][k] = history_to_volts(oscData, i, ch->channel_history[idx]);
+            r.marker_y[i][k] = ch->offset_y - ch->channel_history[idx] * ch->scale_y;
+        }
+    }
+    return r;
+}
+
+float hcursor_to_volts(const OscData *oscData, int channel, float y)
+{
+    const ChannelSettings *ch = &oscData->channels[channel];
+    if (ch->scale_y == 0.0f) return 0.0f;
+    // Обернене до y = offset_y - value * scale_y у draw_signal()
+    return history_to_volts(oscData, channel, (ch->offset_y - y) / ch->scale_y);
+}
+
+void draw_cursor_readout(OscData *oscData, const Cursor *cursors, const DragRect *centerRect,
+                         const CursorReadout *readout, int x, int y, RasterFont font)
+{
+    if (!readout->valid) return;
+
+    Color channel_colors[MAX_CHANNELS] = CHANNEL_TEXT_COLORS;
+    int line_height = font.glyph_height + 2 * padding + 2;
+    float rate = oscData->sample_rate_hz;
+
+    // Маркери на семплах, до яких прив'язані курсори
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        if (!readout->channel_valid[i]) continue;
+        for (int k = 0; k < 2; k++)
+            DrawCircle(readout->marker_x[k], readout->marker_y[i][k], 3, cursors[k].color);
+    }
+
+    // Δt над горизонтальною лінією між курсорами (замість пікселів)
+    int n = readout->delta_samples < 0 ? -readout->delta_samples : readout->delta_samples;
+    char dt[24];
+    if (rate > 0.0f) format_time(dt, sizeof(dt), readout->delta_t_s);
+    else snprintf(dt, sizeof(dt), "---");
+    const char *mid_text = (rate > 0.0f && n != 0)
+        ? TextFormat("dt %s  1/dt %.2fHz  %+dsmp", dt, rate / n, readout->delta_samples)
+        : TextFormat("dt %s  %+dsmp", dt, readout->delta_samples);
+    int text_width = MeasureText(mid_text, font.glyph_height);
+    DrawTextScaled(font, centerRect->x - text_width / 2, centerRect->y - 15 - font.glyph_height - 5,
+                   mid_text, spacing, 1, LIGHTGRAY);
+
+    // Час кожного курсора відносно тригера
+    char ta[24], tb[24];
+    if (rate > 0.0f) {
+        format_time(ta, sizeof(ta), readout->offset[0] / rate);
+        format_time(tb, sizeof(tb), readout->offset[1] / rate);
+    } else {
+        snprintf(ta, sizeof(ta), "%+dsmp", readout->offset[0]);
+        snprintf(tb, sizeof(tb), "%+dsmp", readout->offset[1]);
+    }
+    DrawTextWithAutoInvertedBackground(font, x, y, TextFormat("A %s", ta), spacing, 1,
+                                       cursors[0].color, padding, borderThickness);
+    DrawTextWithAutoInvertedBackground(font, x + 110, y, TextFormat("B %s", tb), spacing, 1,
+                                       cursors[1].color, padding, borderThickness);
+    y += line_height;
+
+    // Напруга в точках A, B і різниця по кожному активному каналу
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        if (!readout->channel_valid[i]) continue;
+        const char *text = TextFormat("Ch%d A %.3f B %.3f dV %+.3f", i + 1,
+                                      readout->volts[i][0], readout->volts[i][1],
+                                      readout->volts[i][1] - readout->volts[i][0]);
+        DrawTextWithAutoInvertedBackground(font, x, y, text, spacing, 1,
+                                           channel_colors[i], padding, borderThickness);
+        y += line_height;
+    }
+}
+
+void draw_hcursor_readout(OscData *oscData, const HCursor *hcursors, int x, int y, RasterFont font)
+{
+    int ch = oscData->active_channel;
+    float v1 = hcursor_to_volts(oscData, ch, hcursors[0].y);
+    float v2 = hcursor_to_volts(oscData, ch, hcursors[1].y);
+
+    // Значення біля ручок
+    for (int k = 0; k < 2; k++) {
+        float v = k == 0 ? v1 : v2;
+        DrawTextScaled(font, hcursors[k].x - 80, hcursors[k].y - font.glyph_height - 4,
+                       TextFormat("%.3fV", v), spacing, 1, hcursors[k].color);
+    }
+
+    const char *text = TextFormat("Ch%d Y1 %.3f Y2 %.3f dV %+.3f", ch + 1, v1, v2, v2 - v1);
+    DrawTextWithAutoInvertedBackground(font, x, y, text, spacing, 1, WHITE, padding, borderThickness);
+}
@@ -0,0 +1,36 @@
+// file cursor_readout.h
+
+#ifndef CURSOR_READOUT_H
+#define CURSOR_READOUT_H
+
+#include "main.h"
+#include "cursor.h"
+#include "all_font.h" // Опис шрифтів як структури RasterFont
+
+// Покази курсорів, прив'язаних до реальних семплів буфера історії
+typedef struct {
+    bool valid;                          // Курсори прив'язані (є що малювати)
+    int offset[2];                       // Зсув семплів A/B відносно точки тригера
+    int delta_samples;                   // B - A у семплах
+    float delta_t_s;                     // B - A у секундах (0, поки частота дискретизації невідома)
+    bool channel_valid[MAX_CHANNELS];
+    float volts[MAX_CHANNELS][2];        // Напруга каналу в семплах A і B
+    float marker_x[2];                   // Положення семплів A і B на екрані
+    float marker_y[MAX_CHANNELS][2];
+} CursorReadout;
+
+// Прив'язує вертикальні курсори до найближчих семплів тієї ж розкладки, що й draw_signal().
+// Поки курсор не тягнуть, його X переставляється точно на семпл. O(1) на курсор і канал.
+CursorReadout cursors_bind_to_samples(OscData *oscData, Cursor *cursors, float osc_width);
+
+// Напруга активного каналу на висоті y (для горизонтальних курсорів)
+float hcursor_to_volts(const OscData *oscData, int channel, float y);
+
+// Маркери семплів на сигналах, Δt над лінією курсорів і таблиця ΔV по каналах
+void draw_cursor_readout(OscData *oscData, const Cursor *cursors, const DragRect *centerRect,
+                         const CursorReadout *readout, int x, int y, RasterFont font);
+
+// Підписи горизонтальних курсорів і ΔV між ними для активного каналу
+void draw_hcursor_readout(OscData *oscData, const HCursor *hcursors, int x, int y, RasterFont font);
+
+#endif // CURSOR_READOUT_H
@@ -0,0 +1,402 @@
+// file decoder.c
+//
+// Декодування UART, SPI і I2C. Семпли каналів перетворюються на біти з гістерезисом
+// і пакуються по 64 у слово; автомати обробляють цілі слова, переходячи лише між
+// фронтами (__builtin_ctzll по масках фронтів), тож тихі ділянки коштують O(1) на слово.
+
+#include "main.h"
+#include "decoder.h"
+#include "parse_data.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(((ADC_RAW_MIDSCALE - 1) << ADC_EXTRA_BITS_MAX) <= INT16_MAX &&
+               (DECODER_IDLE_HYST << ADC_EXTRA_BITS_MAX) <= INT16_MAX,
+               "пороги DigitalChannel вміщаються в int16 на найбільшій роздільності");
+
+static inline uint64_t bits_mask(int n)
+{
+    return n >= 64 ? ~0ULL : ((1ULL << n) - 1);
+}
+
+// Слово зі зсувом на один семпл: біт k містить рівень семпла k - 1
+static inline uint64_t prev_bits(const DigitalChannel *c)
+{
+    return (c->word << 1) | c->last;
+}
+
+static void emit(ProtocolDecoder *d, DecodeEventType type, unsigned long long start,
+                 unsigned long long end, uint16_t value, uint16_t value2, uint8_t flags)
+{
+    if (!d->events) return;
+    DecodedEvent *e = &d->events[d->total % DECODER_MAX_EVENTS];
+    e->start = start;
+    e->end = end;
+    e->value = value;
+    e->value2 = value2;
+    e->type = (uint8_t)type;
+    e->flags = flags;
+    d->total++;
+}
+
+// --- UART (лінія в спокої — одиниця, молодший біт першим) ---
+
+static void uart_process(ProtocolDecoder *d, int n)
+{
+    if (d->samples_per_bit < 2.0) return;
+
+    const DigitalChannel *rx = &d->dig[d->uart_rx];
+    uint64_t w = rx->word;
+    uint64_t falls = ~w & prev_bits(rx) & bits_mask(n);
+    unsigned long long n0 = d->word_start;
+    double spb = d->samples_per_bit;
+    int last_bit = d->uart_data_bits + (d->uart_parity ? 1 : 0); // індекс стоп-біта
+    int pos = 0;
+
+    for (;;) {
+        if (!d->uart.busy) {
+            uint64_t m = pos < 64 ? falls & (~0ULL << pos) : 0;
+            if (!m) return;
+            int k = __builtin_ctzll(m);
+            d->uart.busy = true;
+            d->uart.bit = -1;
+            d->uart.start = n0 + k;
+            d->uart.next = (double)(n0 + k) + 0.5 * spb; // центр старт-біта
+            d->uart.shift = 0;
+            d->uart.flags = 0;
+        }
+
+        long long k = (long long)d->uart.next - (long long)n0;
+        if (k >= n) return; // центр наступного біта — у наступному слові
+        if (k < 0) k = 0;
+        int b = (int)((w >> k) & 1);
+        int bit = d->uart.bit;
+
+        if (bit == -1) {
+            if (b) { // імпульс коротший за півбіта — завада, а не старт
+                d->uart.busy = false;
+                pos = (int)k + 1;
+                continue;
+            }
+        } else if (bit < d->uart_data_bits) {
+            d->uart.shift |= (uint16_t)(b << bit);
+        } else if (bit < last_bit) {
+            int ones = __builtin_popcount(d->uart.shift) + b;
+            if ((d->uart_parity == 1) != (ones & 1)) d->uart.flags |= DECODE_FLAG_PARITY;
+        } else {
+            if (!b) d->uart.flags |= DECODE_FLAG_FRAMING;
+            emit(d, DECODE_EVT_UART_BYTE, d->uart.start,
+                 (unsigned long long)(d->uart.next + 0.5 * spb), d->uart.shift, 0, d->uart.flags);
+            d->uart.busy = false;
+            pos = (int)k + 1; // наступний старт шукаємо після центру стоп-біта
+            continue;
+        }
+
+        d->uart.bit++;
+        d->uart.next += spb;
+    }
+}
+
+// --- SPI (CS активний нулем, фронт вибірки за CPOL/CPHA) ---
+
+static void spi_finish(ProtocolDecoder *d, uint8_t flags)
+{
+    emit(d, DECODE_EVT_SPI_WORD, d->spi.start, d->spi.last_edge, d->spi.mosi, d->spi.miso, flags);
+    d->spi.bits = 0;
+    d->spi.mosi = d->spi.miso = 0;
+}
+
+static void spi_process(ProtocolDecoder *d, int n)
+{
+    const DigitalChannel *clk = &d->dig[d->spi_sclk];
+    uint64_t valid = bits_mask(n);
+    uint64_t c = clk->word, cp = prev_bits(clk);
+    // Режими 0 і 3 читають дані по наростанню, 1 і 2 — по спаду
+    uint64_t sample = (d->spi_cpol == d->spi_cpha ? (c & ~cp) : (~c & cp)) & valid;
+
+    uint64_t cs = 0, cs_edges = 0, cs_rise = 0;
+    if (d->spi_cs >= 0) {
+        const DigitalChannel *sel = &d->dig[d->spi_cs];
+        cs = sel->word;
+        cs_rise = cs & ~prev_bits(sel) & valid;
+        cs_edges = (cs ^ prev_bits(sel)) & valid;
+    }
+    uint64_t mosi = d->spi_mosi >= 0 ? d->dig[d->spi_mosi].word : 0;
+    uint64_t miso = d->spi_miso >= 0 ? d->dig[d->spi_miso].word : 0;
+    unsigned long long n0 = d->word_start;
+
+    uint64_t all = sample | cs_edges;
+    while (all) {
+        int k = __builtin_ctzll(all);
+        all &= all - 1;
+        uint64_t bit = 1ULL << k;
+
+        // Будь-яка зміна CS завершує поточне слово
+        if (cs_edges & bit) {
+            if (d->spi.bits > 0 && (cs_rise & bit)) spi_finish(d, DECODE_FLAG_PARTIAL);
+            d->spi.bits = 0;
+            d->spi.mosi = d->spi.miso = 0;
+        }
+        if (!(sample & bit) || (cs & bit)) continue;
+
+        unsigned long long t = n0 + k;
+        // Без CS слова розділяються паузами на шині довшими за чотири періоди такту
+        if (d->spi_cs < 0 && d->spi.bits > 0 && d->spi.period > 0 &&
+            t - d->spi.last_edge > 4 * d->spi.period) {
+            spi_finish(d, DECODE_FLAG_PARTIAL);
+        }
+        if (d->spi.last_edge > 0 && t > d->spi.last_edge) d->spi.period = t - d->spi.last_edge;
+
+        if (d->spi.bits == 0) d->spi.start = t;
+        d->spi.mosi = (uint16_t)((d->spi.mosi << 1) | ((mosi >> k) & 1));
+        d->spi.miso = (uint16_t)((d->spi.miso << 1) | ((miso >> k) & 1));
+        d->spi.last_edge = t;
+        if (++d->spi.bits == d->spi_word_bits) spi_finish(d, 0);
+    }
+}
+
+// --- I2C (START/STOP — зміна SDA при високому SCL, дані по наростанню SCL) ---
+
+static void i2c_process(ProtocolDecoder *d, int n)
+{
+    const DigitalChannel *scl = &d->dig[d->i2c_scl];
+    const DigitalChannel *sda = &d->dig[d->i2c_sda];
+    uint64_t valid = bits_mask(n);
+    uint64_t s = scl->word, sp = prev_bits(scl);
+    uint64_t a = sda->word, ap = prev_bits(sda);
+
+    uint64_t scl_rise = s & ~sp & valid;
+    uint64_t sda_edges = (a ^ ap) & s & sp & valid; // SCL високий до і після зміни SDA
+    unsigned long long n0 = d->word_start;
+
+    uint64_t all = scl_rise | sda_edges;
+    while (all) {
+        int k = __builtin_ctzll(all);
+        all &= all - 1;
+        uint64_t bit = 1ULL << k;
+        unsigned long long t = n0 + k;
+
+        if (sda_edges & bit) {
+            if (!(a & bit)) { // SDA впала — START
+                emit(d, DECODE_EVT_I2C_START, t, t, 0, 0, d->i2c.state ? DECODE_FLAG_RESTART : 0);
+                d->i2c.state = 1;
+            } else {          // SDA піднялась — STOP
+                emit(d, DECODE_EVT_I2C_STOP, t, t, 0, 0, 0);
+                d->i2c.state = 0;
+            }
+            d->i2c.bits = 0;
+            d->i2c.shift = 0;
+            continue;
+        }
+
+        if (d->i2c.state == 0) continue;
+        int b = (a & bit) ? 1 : 0;
+        if (d->i2c.bits == 0) d->i2c.start = t;
+
+        if (d->i2c.bits < 8) {
+            d->i2c.shift = (uint16_t)((d->i2c.shift << 1) | b);
+            d->i2c.bits++;
+            continue;
+        }
+
+        // Дев'ятий такт — підтвердження
+        uint8_t flags = b ? DECODE_FLAG_NAK : 0;
+        if (d->i2c.state == 1) {
+            if (d->i2c.shift & 1) flags |= DECODE_FLAG_READ;
+            emit(d, DECODE_EVT_I2C_ADDRESS, d->i2c.start, t, d->i2c.shift >> 1, 0, flags);
+            d->i2c.state = 2;
+        } else {
+            emit(d, DECODE_EVT_I2C_DATA, d->i2c.start, t, d->i2c.shift, 0, flags);
+        }
+        d->i2c.bits = 0;
+        d->i2c.shift = 0;
+    }
+}
+
+// Обробка накопичених n семплів і початок нових слів
+static void process_words(ProtocolDecoder *d, int n)
+{
+    if (n <= 0) return;
+
+    switch (d->protocol) {
+        case DECODE_UART: uart_process(d, n); break;
+        case DECODE_SPI: spi_process(d, n); break;
+        case DECODE_I2C: i2c_process(d, n); break;
+        default: break;
+    }
+
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        DigitalChannel *c = &d->dig[i];
+        c->last = (c->word >> (n - 1)) & 1;
+        c->word = 0;
+    }
+    d->word_start += n;
+    d->nbits = 0;
+}
+
+static void update_bit_time(ProtocolDecoder *d, float sample_rate)
+{
+    d->samples_per_bit = (sample_rate > 0.0f && d->uart_baud > 0) ? (double)sample_rate / d->uart_baud : 0.0;
+}
+
+void decoder_set_protocol(OscData *oscData, DecodeProtocol protocol)
+{
+    ProtocolDecoder *d = &oscData->decoder;
+
+    if (protocol != DECODE_NONE && !d->events) {
+        d->events = (DecodedEvent*)malloc(DECODER_MAX_EVENTS * sizeof(DecodedEvent));
+        if (!d->events) {
+            fprintf(stderr, "Memory allocation failed for decoder events\n");
+            protocol = DECODE_NONE;
+        }
+    }
+
+    d->protocol = protocol;
+    d->total = 0;
+    d->selected = -1;
+    d->nbits = 0;
+    d->word_start = oscData->sample_count;
+    update_bit_time(d, oscData->sample_rate_hz);
+    memset(&d->uart, 0, sizeof(d->uart));
+    memset(&d->spi, 0, sizeof(d->spi));
+    memset(&d->i2c, 0, sizeof(d->i2c));
+
+    d->channel_mask = 0;
+    switch (protocol) {
+        case DECODE_UART:
+            d->channel_mask = 1u << d->uart_rx;
+            break;
+        case DECODE_SPI:
+            d->channel_mask = 1u << d->spi_sclk;
+            if (d->spi_mosi >= 0) d->channel_mask |= 1u << d->spi_mosi;
+            if (d->spi_miso >= 0) d->channel_mask |= 1u << d->spi_miso;
+            if (d->spi_cs >= 0) d->channel_mask |= 1u << d->spi_cs;
+            break;
+        case DECODE_I2C:
+            d->channel_mask = (1u << d->i2c_scl) | (1u << d->i2c_sda);
+            break;
+        default:
+            break;
+    }
+
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        DigitalChannel *c = &d->dig[i];
+        c->word = 0;
+        // Шини в спокої — одиниця; пороги — навколо середини шкали, поки немає вимірювань
+        // (семпли центровані: нуль — ADC_RAW_MIDSCALE)
+        c->last = 1;
+        c->level = true;
+        c->lo = (int16_t)-(DECODER_IDLE_HYST << oscData->adc_extra_bits);
+        c->hi = (int16_t)(DECODER_IDLE_HYST << oscData->adc_extra_bits);
+    }
+}
+
+void decoder_free(OscData *oscData)
+{
+    ProtocolDecoder *d = &oscData->decoder;
+    free(d->events);
+    d->events = NULL;
+    d->protocol = DECODE_NONE;
+    d->total = 0;
+}
+
+// Поріг у межах шкали лишається в int16 (див. _Static_assert вище); обмеження — на випадок
+// порогу поза шкалою, щоб гістерезис не перевернувся при переповненні
+static int16_t threshold_rescale(int value, int from_bits, int to_bits)
+{
+    int v = adc_rescale(value, from_bits, to_bits);
+    return (int16_t)(v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : v);
+}
+
+void decoder_rescale(OscData *oscData, int from_bits, int to_bits)
+{
+    ProtocolDecoder *d = &oscData->decoder;
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        d->dig[i].lo = threshold_rescale(d->dig[i].lo, from_bits, to_bits);
+        d->dig[i].hi = threshold_rescale(d->dig[i].hi, from_bits, to_bits);
+    }
+}
+
+void decoder_on_sample(OscData *oscData, const int16_t *raw_values)
+{
+    ProtocolDecoder *d = &oscData->decoder;
+    if (d->protocol == DECODE_NONE) return;
+
+    uint64_t bit = 1ULL << d->nbits;
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        if (!(d->channel_mask & (1u << i))) continue;
+        DigitalChannel *c = &d->dig[i];
+        c->level = c->level ? raw_values[i] > c->lo : raw_values[i] >= c->hi;
+        if (c->level) c->word |= bit;
+    }
+
+    if (++d->nbits == 64) process_words(d, 64);
+}
+
+void decoder_update(OscData *oscData)
+{
+    ProtocolDecoder *d = &oscData->decoder;
+    if (d->protocol == DECODE_NONE) return;
+
+    // Пороги 40% / 60% розмаху з вікна вимірювань (O(1): голови монотонних черг)
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        if (!(d->channel_mask & (1u << i))) continue;
+        const ChannelMeasurements *m = &oscData->measurements[i];
+        if (!m->raw || m->count == 0) continue;
+        int vmin = m->qmin.value[m->qmin.head];
+        int vmax = m->qmax.value[m->qmax.head];
+        if (vmax - vmin < DECODER_MIN_SWING << oscData->adc_extra_bits) continue;
+        d->dig[i].lo = (int16_t)(vmin + (vmax - vmin) * 2 / 5);
+        d->dig[i].hi = (int16_t)(vmin + (vmax - vmin) * 3 / 5);
+    }
+
+    update_bit_time(d, oscData->sample_rate_hz);
+
+    // Неповні слова декодуються одразу, щоб журнал не відставав на 64 семпли
+    process_words(d, d->nbits);
+}
+
+const DecodedEvent *decoder_event(const ProtocolDecoder *dec, long long seq)
+{
+    if (!dec->events || seq < 0 || (unsigned long long)seq >= dec->total) return NULL;
+    if (dec->total - (unsigned long long)seq > DECODER_MAX_EVENTS) return NULL;
+    return &dec->events[seq % DECODER_MAX_EVENTS];
+}
+
+long long decoder_find(const ProtocolDecoder *dec, long long from_seq, int value, bool older)
+{
+    long long oldest = dec->total > DECODER_MAX_EVENTS ? (long long)(dec->total - DECODER_MAX_EVENTS) : 0;
+    long long newest = (long long)dec->total - 1;
+    long long step = older ? -1 : 1;
+
+    for (long long seq = from_seq + step; seq >= oldest && seq <= newest; seq += step) {
+        const DecodedEvent *e = &dec->events[seq % DECODER_MAX_EVENTS];
+        if (e->type == DECODE_EVT_I2C_START || e->type == DECODE_EVT_I2C_STOP) continue;
+        if (e->value == value || (e->type == DECODE_EVT_SPI_WORD && e->value2 == value)) return seq;
+    }
+    return -1;
+}
+
+const char *decoder_protocol_name(DecodeProtocol protocol)
+{
+    switch (protocol) {
+        case DECODE_UART: return "UART";
+        case DECODE_SPI: return "SPI";
+        case DECODE_I2C: return "I2C";
+        default: return "Off";
+    }
+}
+
+const char *decoder_event_name(const DecodedEvent *event)
+{
+    switch (event->type) {
+        case DECODE_EVT_UART_BYTE: return "RX";
+        case DECODE_EVT_SPI_WORD: return "XFER";
+        case DECODE_EVT_I2C_START: return (event->flags & DECODE_FLAG_RESTART) ? "Sr" : "S";
+        case DECODE_EVT_I2C_STOP: return "P";
+        case DECODE_EVT_I2C_ADDRESS: return (event->flags & DECODE_FLAG_READ) ? "ADDR R" : "ADDR W";
+        case DECODE_EVT_I2C_DATA: return "DATA";
+        default: return "?";
+    }
+}
@@ -0,0 +1,140 @@
+// file decoder.h
+
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef MAX_CHANNELS
+#define MAX_CHANNELS 16
+#endif
+
+#define DECODER_MAX_EVENTS 4096      // Ємність кільцевого журналу декодованих подій
+#define DECODER_DEFAULT_BAUD 9600
+#define DECODER_SEARCH_LEN 4         // Кількість шістнадцяткових цифр у пошуку
+#define DECODER_MIN_SWING 200        // Мінімальний розмах (відліки АЦП) для авто-порогу
+#define DECODER_IDLE_HYST 64         // Пороги ± навколо середини шкали, поки розмах невідомий
+
+struct OscData;
+
+typedef enum {
+    DECODE_NONE = 0,
+    DECODE_UART,
+    DECODE_SPI,
+    DECODE_I2C,
+    DECODE_PROTOCOL_COUNT
+} DecodeProtocol;
+
+typedef enum {
+    DECODE_EVT_UART_BYTE = 0,
+    DECODE_EVT_SPI_WORD,
+    DECODE_EVT_I2C_START,
+    DECODE_EVT_I2C_STOP,
+    DECODE_EVT_I2C_ADDRESS,
+    DECODE_EVT_I2C_DATA
+} DecodeEventType;
+
+#define DECODE_FLAG_FRAMING  0x01    // UART: стоп-біт не в одиниці
+#define DECODE_FLAG_PARITY   0x02    // UART: помилка парності
+#define DECODE_FLAG_NAK      0x04    // I2C: відсутнє підтвердження
+#define DECODE_FLAG_READ     0x08    // I2C: адреса з бітом читання
+#define DECODE_FLAG_PARTIAL  0x10    // SPI: слово обірване (CS або пауза)
+#define DECODE_FLAG_RESTART  0x20    // I2C: повторний START
+
+// Одна декодована подія; час — номери семплів (OscData.sample_count)
+typedef struct {
+    unsigned long long start;
+    unsigned long long end;
+    uint16_t value;   // Байт UART, MOSI для SPI, адреса або дані I2C
+    uint16_t value2;  // MISO для SPI
+    uint8_t type;     // DecodeEventType
+    uint8_t flags;    // DECODE_FLAG_*
+} DecodedEvent;
+
+// Канал після порогового перетворення: 64 семпли в слові, біт 0 — найстаріший
+typedef struct {
+    uint64_t word;
+    uint64_t last;    // Рівень останнього семпла попереднього слова (0 або 1)
+    int16_t lo, hi;   // Пороги з гістерезисом (відліки АЦП)
+    bool level;
+} DigitalChannel;
+
+typedef struct {
+    DecodeProtocol protocol;
+
+    // Призначення каналів (0..MAX_CHANNELS-1, -1 — не використовується)
+    int uart_rx;
+    int uart_baud;
+    int uart_data_bits;
+    int uart_parity;                 // 0 — немає, 1 — непарність, 2 — парність
+    int spi_sclk, spi_mosi, spi_miso, spi_cs;
+    bool spi_cpol, spi_cpha;
+    int spi_word_bits;
+    int i2c_scl, i2c_sda;
+
+    // Цифровий потік
+    DigitalChannel dig[MAX_CHANNELS];
+    unsigned int channel_mask;       // Канали, які використовує поточний протокол
+    int nbits;                       // Заповнення поточних слів
+    unsigned long long word_start;   // Номер семпла біта 0 поточних слів
+    double samples_per_bit;          // UART: семплів на біт (0 — частота невідома)
+
+    // Стан автоматів
+    struct {
+        bool busy;
+        int bit;                     // -1 — старт-біт, далі біти даних, парність, стоп
+        double next;                 // Номер семпла центру наступного біта
+        unsigned long long start;
+        uint16_t shift;
+        uint8_t flags;
+    } uart;
+    struct {
+        int bits;
+        uint16_t mosi, miso;
+        unsigned long long start, last_edge;
+        unsigned long long period;
+    } spi;
+    struct {
+        int state;                   // 0 — шина вільна, 1 — адреса, 2 — дані
+        int bits;
+        uint16_t shift;
+        unsigned long long start;
+    } i2c;
+
+    // Журнал подій: подія з порядковим номером seq лежить у events[seq % DECODER_MAX_EVENTS]
+    DecodedEvent *events;
+    unsigned long long total;
+
+    // Таблиця подій і пошук
+    bool show_table;
+    bool search_active;              // Вводиться шістнадцяткове значення для пошуку
+    char search[DECODER_SEARCH_LEN + 1];
+    long long selected;              // Порядковий номер вибраної події, -1 — немає
+} ProtocolDecoder;
+
+// Вибір протоколу: скидає автомати і журнал, виділяє журнал при першому увімкненні
+void decoder_set_protocol(struct OscData *oscData, DecodeProtocol protocol);
+
+void decoder_free(struct OscData *oscData);
+
+// Пороги в масштабі нової роздільності потоку (read_usb_device.c, set_resolution)
+void decoder_rescale(struct OscData *oscData, int from_bits, int to_bits);
+
+// Порогове перетворення одного семпла (викликається при прийомі, як measurements_on_sample)
+void decoder_on_sample(struct OscData *oscData, const int16_t *raw_values);
+
+// Раз на кадр: пороги з вікна вимірювань, семплів на біт, декодування неповних слів
+void decoder_update(struct OscData *oscData);
+
+// Подія з порядковим номером seq або NULL, якщо її вже витіснено
+const DecodedEvent *decoder_event(const ProtocolDecoder *dec, long long seq);
+
+// Найближча до from_seq (не включно) подія зі значенням value у напрямку старіших
+// (older = true) або новіших подій. Повертає порядковий номер або -1.
+long long decoder_find(const ProtocolDecoder *dec, long long from_seq, int value, bool older);
+
+const char *decoder_protocol_name(DecodeProtocol protocol);
+const char *decoder_event_name(const DecodedEvent *event);
+
+#endif // DECODER_H
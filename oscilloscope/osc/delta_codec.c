@@ -0,0 +1,74 @@
+// file delta_codec.c
+
+#include "delta_codec.h"
+#include <string.h>
+
+#define SWAR_HIGH_BITS 0x8080808080808080ull
+#define SWAR_LOW_BITS  0x0101010101010101ull
+#define SWAR_HALF_BITS 0x3F3F3F3F3F3F3F3Full // Байт без біта продовження, зсунутий на 1
+
+int delta_encode(const int16_t *values, int count, int stride, uint8_t *out)
+{
+    uint8_t *p = out;
+    for (int i = 0; i < count; i++) {
+        uint16_t prev = i >= stride ? (uint16_t)values[i - stride] : 0;
+        int16_t delta = (int16_t)((uint16_t)values[i] - prev);
+        uint16_t zz = (uint16_t)(((uint16_t)delta << 1) ^ (uint16_t)(delta >> 15));
+        while (zz >= 0x80) {
+            *p++ = (uint8_t)(zz | 0x80);
+            zz >>= 7;
+        }
+        *p++ = (uint8_t)zz;
+    }
+    return (int)(p - out);
+}
+
+// Одне значення varint; -1 — довше за DELTA_VALUE_MAX_BYTES, більше за 16 біт або обірване
+static int read_varint(const uint8_t **p, const uint8_t *end)
+{
+    uint32_t value = 0;
+    for (int shift = 0; shift < 7 * DELTA_VALUE_MAX_BYTES; shift += 7) {
+        if (*p == end) return -1;
+        uint8_t byte = *(*p)++;
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value <= 0xFFFF ? (int)value : -1;
+    }
+    return -1;
+}
+
+static inline int16_t unzigzag(uint32_t zz)
+{
+    return (int16_t)((zz >> 1) ^ -(zz & 1));
+}
+
+int delta_decode(const uint8_t *in, int len, int16_t *out, int count, int stride)
+{
+    const uint8_t *p = in;
+    const uint8_t *end = in + len;
+    int i = 0;
+
+    while (i < count) {
+        // Повільний сигнал: різниці до ±63 — по байту без біта продовження. Вісім таких байтів
+        // розгортаються з zig-zag разом: (b >> 1) ^ -(b & 1) побайтно, без переносів між байтами.
+        // Байт k слова — p[k] (хост little-endian)
+        if (i >= stride && i + 8 <= count && end - p >= 8) {
+            uint64_t word;
+            memcpy(&word, p, sizeof(word));
+            if (!(word & SWAR_HIGH_BITS)) {
+                uint64_t sign = (word & SWAR_LOW_BITS) * 0xFF;
+                uint64_t deltas = ((word >> 1) & SWAR_HALF_BITS) ^ sign;
+                for (int k = 0; k < 8; k++, i++)
+                    out[i] = (int16_t)((uint16_t)out[i - stride] + (uint16_t)(int8_t)(deltas >> (8 * k)));
+                p += 8;
+                continue;
+            }
+        }
+
+        int zz = read_varint(&p, end);
+        if (zz < 0) return -1;
+        uint16_t prev = i >= stride ? (uint16_t)out[i - stride] : 0;
+        out[i] = (int16_t)(prev + (uint16_t)unzigzag((uint32_t)zz));
+        i++;
+    }
+    return p == end ? 0 : -1;
+}
@@ -0,0 +1,22 @@
+// file delta_codec.h
+
+#ifndef DELTA_CODEC_H
+#define DELTA_CODEC_H
+
+#include <stdint.h>
+
+// Стиснення блоку значень без втрат (пакет 0xAE, parse_data.h). Кожне значення — різниця з
+// попереднім значенням того самого каналу (stride значень назад) за модулем 2^16, zig-zag,
+// varint: 7 біт на байт, старший біт — продовження. Перші stride значень блоку — різниця
+// з нулем, тож блок розбирається незалежно від попередніх
+#define DELTA_BLOCK_VALUES 48      // Значень у блоці 0xAE: ділиться на 1..4 канали
+#define DELTA_VALUE_MAX_BYTES 3    // 16-бітна різниця після zig-zag
+
+// Кодує count значень у out (до count * DELTA_VALUE_MAX_BYTES байтів). Повертає кількість байтів
+int delta_encode(const int16_t *values, int count, int stride, uint8_t *out);
+
+// Розбирає рівно count значень з рівно len байтів. Вісім однобайтових різниць поспіль
+// розбираються одним 64-бітним словом. 0 при успіху, -1 — блок пошкоджено
+int delta_decode(const uint8_t *in, int len, int16_t *out, int count, int stride);
+
+#endif // DELTA_CODEC_H
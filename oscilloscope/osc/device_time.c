@@ -0,0 +1,135 @@
+// file device_time.c
+
+#include "device_time.h"
+#include <string.h>
+#include <math.h>
+
+void device_time_reset(DeviceTime *t)
+{
+    memset(t, 0, sizeof(*t));
+}
+
+static void segment_start(DeviceTime *t, uint64_t index, uint64_t us)
+{
+    t->have_segment = true;
+    t->seg_index = t->last_index = index;
+    t->seg_us = t->last_us = us;
+    t->period_us = 0.0;
+    t->jump_pending = false;
+    t->segments++;
+}
+
+// Мітки плати точні до мікросекунди, а тремтіння між блоками (очікування USB) не накопичується:
+// досить прямої через першу й останню мітки сегмента. Дві мітки поспіль далеко від прямої —
+// новий темп (або пропуск на платі), сегмент починається з першої з них
+static void segment_observe(DeviceTime *t, uint64_t index)
+{
+    if (!t->have_segment || index <= t->last_index) {
+        segment_start(t, index, t->now_us);
+        return;
+    }
+    if (t->period_us > 0.0) {
+        double expected = (double)t->seg_us + (double)(index - t->seg_index) * t->period_us;
+        double error = fabs((double)t->now_us - expected);
+        double interval = (double)(t->now_us - t->last_us);
+        if (error > DEVICE_TIME_JUMP_US && error > DEVICE_TIME_JUMP_REL * interval) {
+            if (!t->jump_pending) {
+                t->jump_pending = true;
+                t->jump_index = index;
+                t->jump_us = t->now_us;
+                return;
+            }
+            segment_start(t, t->jump_index, t->jump_us);
+        }
+    }
+    t->jump_pending = false;
+    t->last_index = index;
+    t->last_us = t->now_us;
+    if ((double)(t->now_us - t->seg_us) >= DEVICE_TIME_SEGMENT_S * 1e6)
+        t->period_us = (double)(t->now_us - t->seg_us) / (double)(index - t->seg_index);
+}
+
+// Зсув хоста відносно плати — затримка прийому плюс різниця годинників. Найменший зсув
+// за проміжок належить пакету, що дійшов найшвидше; перша і поточна такі опори дають дрейф
+static void offset_observe(DeviceTime *t, double dev_s, double host_now)
+{
+    double offset = host_now - dev_s;
+
+    if (t->recent_count == 0 && t->bucket_start == 0.0) {
+        t->start_host = t->bucket_start = host_now;
+        t->anchor_dev = t->bucket_dev = dev_s;
+        t->anchor_offset = t->bucket_offset = offset;
+    }
+    if (!t->anchor_fixed) {
+        if (offset < t->anchor_offset) {
+            t->anchor_offset = offset;
+            t->anchor_dev = dev_s;
+        }
+        if (host_now - t->start_host >= DEVICE_TIME_ANCHOR_S) t->anchor_fixed = true;
+    }
+
+    if (offset < t->bucket_offset) {
+        t->bucket_offset = offset;
+        t->bucket_dev = dev_s;
+    }
+    if (host_now - t->bucket_start < DEVICE_TIME_BUCKET_S) return;
+    t->recent_dev[t->recent_pos] = t->bucket_dev;
+    t->recent_offset[t->recent_pos] = t->bucket_offset;
+    t->recent_pos = (t->recent_pos + 1) % DEVICE_TIME_RECENT;
+    if (t->recent_count < DEVICE_TIME_RECENT) t->recent_count++;
+    t->bucket_start = host_now;
+    t->bucket_dev = dev_s;
+    t->bucket_offset = offset;
+
+    if (!t->anchor_fixed) return;
+    int best = 0;
+    for (int i = 1; i < t->recent_count; i++)
+        if (t->recent_offset[i] < t->recent_offset[best]) best = i;
+    double span = t->recent_dev[best] - t->anchor_dev;
+    if (span >= DEVICE_TIME_DRIFT_SPAN_S)
+        t->drift = (t->recent_offset[best] - t->anchor_offset) / span;
+}
+
+void device_time_observe(DeviceTime *t, uint64_t index, uint32_t raw_us, double host_now)
+{
+    if (t->have_raw) {
+        uint32_t step = raw_us - t->last_raw;
+        // Мітка пішла назад: лічильник плати почав з нуля, старі опори вже нічого не кажуть
+        if (step >= 0x80000000u) device_time_reset(t);
+        else t->now_us += step;
+    }
+    if (!t->have_raw) {
+        t->have_raw = true;
+        t->now_us = raw_us;
+    }
+    t->last_raw = raw_us;
+
+    segment_observe(t, index);
+    offset_observe(t, (double)t->now_us * 1e-6, host_now);
+}
+
+DeviceClock device_time_clock(const DeviceTime *t)
+{
+    DeviceClock c = { .timestamped = true, .drift_ppm = device_time_drift_ppm(t) };
+    if (!t->have_segment || t->period_us <= 0.0) return c;
+
+    // t(k) = host(us(k)), us(k) = seg_us + (k - seg_index) * period_us,
+    // host(s) = s + anchor_offset + drift * (s - anchor_dev)
+    double scale = 1.0 + t->drift;
+    double us0 = (double)t->seg_us - (double)t->seg_index * t->period_us;
+    c.period = t->period_us * 1e-6 * scale;
+    c.offset = us0 * 1e-6 * scale + t->anchor_offset - t->drift * t->anchor_dev;
+    c.valid = true;
+    return c;
+}
+
+double device_time_rate(const DeviceTime *t)
+{
+    DeviceClock c = device_time_clock(t);
+    return c.valid ? 1.0 / c.period : 0.0;
+}
+
+double device_time_drift_ppm(const DeviceTime *t)
+{
+    return (1.0 / (1.0 + t->drift) - 1.0) * 1e6;
+}
@@ -0,0 +1,77 @@
+// file device_time.h
+
+#ifndef DEVICE_TIME_H
+#define DEVICE_TIME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DEVICE_TIME_RECENT 64          // Останні проміжки для поточного зсуву годинника плати
+#define DEVICE_TIME_BUCKET_S 0.1       // Проміжок, мінімум зсуву в якому стає одним спостереженням
+#define DEVICE_TIME_ANCHOR_S 1.0       // Перша опора зсуву — мінімум за стільки секунд прийому
+#define DEVICE_TIME_DRIFT_SPAN_S 2.0   // Дрейф оцінюється, коли опори розійшлися хоча б на стільки
+#define DEVICE_TIME_SEGMENT_S 0.1      // Період семпла — після стількох секунд сегмента
+#define DEVICE_TIME_JUMP_US 100.0      // Менші відхилення від прямої сегмента — тремтіння, не зміна темпу
+#define DEVICE_TIME_JUMP_REL 0.05      // ... а також у межах 5% від інтервалу між мітками
+
+// Відповідність номера семпла часу хоста: t(k) = offset + k * period.
+// timestamped — за мітками плати (без тремтіння прийому), інакше — за часом прибуття
+typedef struct {
+    bool valid;
+    bool timestamped;
+    double offset;
+    double period;
+    double drift_ppm;              // Наскільки кварц плати швидший за годинник хоста (лише з мітками)
+} DeviceClock;
+
+// Годинник плати за мітками пакетів (CTRL_PARAM_TIMESTAMPS). Дві окремі відповідності:
+// номер семпла -> мкс плати — пряма в межах сегмента (новий сегмент — після зміни темпу
+// чи перезапуску плати); мкс плати -> час хоста — зсув з найменшою затримкою прийому
+// і дрейф кварцу плати відносно хоста між першою і поточною опорами.
+typedef struct {
+    bool have_raw;
+    uint32_t last_raw;
+    uint64_t now_us;               // Розгорнутий 32-бітний лічильник плати
+
+    // Сегмент: перша і остання мітки (номер семпла, мкс плати)
+    bool have_segment;
+    uint64_t seg_index;
+    uint64_t seg_us;
+    uint64_t last_index;
+    uint64_t last_us;
+    double period_us;              // 0 — сегмент ще короткий
+    unsigned segments;
+    bool jump_pending;             // Попередня мітка відійшла від прямої: одна — тремтіння, дві поспіль — новий темп
+    uint64_t jump_index;
+    uint64_t jump_us;
+
+    // Зсув (час хоста - час плати): перша опора і мінімум серед останніх
+    double start_host;
+    bool anchor_fixed;
+    double anchor_dev;
+    double anchor_offset;
+    double bucket_start;           // Поточний проміжок DEVICE_TIME_BUCKET_S і його мінімум
+    double bucket_dev;
+    double bucket_offset;
+    double recent_dev[DEVICE_TIME_RECENT];
+    double recent_offset[DEVICE_TIME_RECENT];
+    int recent_count;
+    int recent_pos;
+    double drift;                  // Хост проходить (1 + drift) с за секунду плати
+} DeviceTime;
+
+void device_time_reset(DeviceTime *t);
+
+// Пакет з міткою raw_us, перший скан якого — семпл index, прийнято в момент host_now (с)
+void device_time_observe(DeviceTime *t, uint64_t index, uint32_t raw_us, double host_now);
+
+// Годинник поточного сегмента в часі хоста (valid == false без міток або поки сегмент короткий)
+DeviceClock device_time_clock(const DeviceTime *t);
+
+// Частота семплів за годинником плати в секундах хоста; 0 — невідома
+double device_time_rate(const DeviceTime *t);
+
+// Наскільки кварц плати швидший за годинник хоста, ppm
+double device_time_drift_ppm(const DeviceTime *t);
+
+#endif // DEVICE_TIME_H
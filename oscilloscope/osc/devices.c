@@ -0,0 +1,346 @@
+// file devices.c
+
+#include "devices.h"
+#include "parse_data.h"
+#include "read_usb_device.h"
+#include "telemetry.h"
+#include "rs232.h"
+#include "find_usb_device.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h> // usleep
+
+#define DEVICE_RING_MASK ((uint64_t)DEVICE_RING_SAMPLES - 1)
+#define DEVICE_IDLE_US 250          // Пауза потоку, коли порт порожній
+
+// Дописує семпл у кільце; head публікується після запису слота
+static void device_push(Device *dev, const int16_t *values, bool gap)
+{
+    DeviceSample *slot = &dev->ring[dev->next_index & DEVICE_RING_MASK];
+    slot->index = dev->next_index;
+    slot->gap = gap;
+    slot->extra_bits = dev->extra_bits;
+    memcpy(slot->values, values, sizeof(slot->values));
+    dev->next_index++;
+    atomic_store_explicit(&dev->head, dev->next_index, memory_order_release);
+
+    if (!gap) {
+        memcpy(dev->last_values, values, sizeof(dev->last_values));
+        dev->started = true;
+        dev->packets++;
+    }
+}
+
+// Втрачені семпли теж займають номери: індекси в кільці лишаються суцільними, і головний
+// потік бачить розрив як семпли з gap. Довше за кільце — пропускаються лише номери.
+static void device_fill_gap(Device *dev, uint32_t lost, const int16_t *next)
+{
+    uint32_t skip = lost > DEVICE_RING_SAMPLES ? lost - DEVICE_RING_SAMPLES : 0;
+    int16_t values[DEVICE_CHANNELS];
+
+    dev->next_index += skip;
+    for (uint32_t k = skip + 1; k <= lost; k++) {
+        for (int ch = 0; ch < DEVICE_CHANNELS; ch++)
+            values[ch] = seq_gap_value(dev->gap_mode, dev->last_values[ch], next[ch], (int)k, (int)lost);
+        device_push(dev, values, true);
+    }
+}
+
+static void device_clock_reset(Device *dev)
+{
+    pthread_mutex_lock(&dev->clock_lock);
+    dev->have_first = false;
+    dev->obs_count = 0;
+    dev->obs_pos = 0;
+    device_time_reset(&dev->time);
+    pthread_mutex_unlock(&dev->clock_lock);
+}
+
+// Нова роздільність плати: від last_values заповнюється наступний розрив, тож вони
+// переводяться в її масштаб
+static void device_resolution(Device *dev, int extra_bits)
+{
+    if (extra_bits == dev->extra_bits) return;
+    for (int ch = 0; ch < DEVICE_CHANNELS; ch++)
+        dev->last_values[ch] = (int16_t)adc_rescale(dev->last_values[ch], dev->extra_bits, extra_bits);
+    dev->extra_bits = (uint8_t)extra_bits;
+}
+
+// Скани пакета — окремі семпли кільця; мітка часу пакета належить першому з них
+// Захоплення еквівалентного часу (0xAF) не мають спільної осі з іншими платами і відкидаються
+static void device_push_packet(Device *dev, const SamplePacket *packet, double now)
+{
+    if (packet->ets_steps) return;
+    device_resolution(dev, packet->extra_bits);
+    if (packet->has_time) {
+        pthread_mutex_lock(&dev->clock_lock);
+        device_time_observe(&dev->time, dev->next_index, packet->time_us, now);
+        pthread_mutex_unlock(&dev->clock_lock);
+    }
+    for (int s = 0; s < packet->scans; s++)
+        device_push(dev, packet->values[s], false);
+}
+
+// Те саме, що accept_sequenced у read_usb_device.c, але для кільця плати
+static void device_sequenced(Device *dev, uint32_t seq, const SamplePacket *packet, double now)
+{
+    SamplePacket released;
+    uint32_t lost;
+
+    switch (seq_check(&dev->seq, seq, packet, &released, &lost)) {
+    case SEQ_HOLD:
+        return;
+    case SEQ_GAP:
+        lost *= (uint32_t)released.scans;
+        dev->seq_gaps++;
+        dev->seq_lost += lost;
+        device_resolution(dev, released.extra_bits);
+        if (!released.ets_steps) device_fill_gap(dev, lost, released.values[0]);
+        device_push_packet(dev, &released, now);
+        break;
+    case SEQ_CORRUPT:
+        dev->seq_errors++;
+        device_push_packet(dev, &released, now);
+        break;
+    case SEQ_RESTART:
+        // Скільки семплів пропало під час перезапуску, невідомо — годинник оцінюється заново
+        dev->seq_restarts++;
+        device_clock_reset(dev);
+        device_push_packet(dev, &released, now);
+        break;
+    case SEQ_DUPLICATE:
+        dev->seq_duplicates++;
+        break;
+    default:
+        break;
+    }
+
+    if (!dev->seq.holding) device_push_packet(dev, packet, now);
+}
+
+// Кадр керування між пакетами семплів: відповідь передається головному потоку (control_service)
+static void device_control_byte(Device *dev)
+{
+    int size = control_frame_size(dev->packet, dev->packet_pos);
+    if (size == 0 || (size > 0 && dev->packet_pos < size)) return;
+    dev->packet_pos = 0;
+
+    ControlFrame frame;
+    if (size < 0 || !control_decode(dev->packet, size, &frame)) {
+        dev->bad_packets++;
+        return;
+    }
+    ControlReply reply = control_parse_reply(&frame);
+    if (reply.valid) atomic_store(&dev->ctrl_reply, control_reply_pack(&reply));
+}
+
+static void device_parse(Device *dev, const uint8_t *buf, int len, double now)
+{
+    for (int i = 0; i < len; i++) {
+        uint8_t byte = buf[i];
+
+        if (dev->packet_pos == 0) {
+            if (packet_start(byte) || byte == CTRL_START) {
+                dev->packet[dev->packet_pos++] = byte;
+                dev->hunting = false;
+            } else {
+                if (!dev->hunting) dev->resyncs++;
+                dev->hunting = true;
+                dev->resync_bytes++;
+            }
+            continue;
+        }
+
+        dev->packet[dev->packet_pos++] = byte;
+        if (dev->packet[0] == CTRL_START) {
+            device_control_byte(dev);
+            continue;
+        }
+        int size = packet_size(dev->packet, dev->packet_pos);
+        if (size < 0) {
+            dev->packet_pos = 0;
+            dev->bad_packets++;
+            continue;
+        }
+        if (size == 0 || dev->packet_pos < size) continue;
+        dev->packet_pos = 0;
+        if (dev->packet[0] == PACKET_START_DELTA || dev->packet[0] == PACKET_START_ETS) {
+            dev->delta_blocks++;
+            dev->delta_bytes += (unsigned long long)size;
+        }
+
+        SamplePacket packet;
+        uint32_t seq;
+        if (parse_packet(dev->packet, &packet, &seq) != 0)
+            dev->bad_packets++;
+        else if (seq == SEQ_NONE)
+            device_push_packet(dev, &packet, now);
+        else
+            device_sequenced(dev, seq, &packet, now);
+    }
+}
+
+// Спостереження годинника: останній прийнятий семпл прибув не раніше за now
+static void device_observe(Device *dev, double now)
+{
+    if (!dev->started) return;
+    uint64_t index = dev->next_index - 1;
+
+    pthread_mutex_lock(&dev->clock_lock);
+    if (!dev->have_first) {
+        dev->have_first = true;
+        dev->first_index = index;
+        dev->first_time = now;
+    }
+    dev->obs_index[dev->obs_pos] = index;
+    dev->obs_time[dev->obs_pos] = now;
+    dev->obs_pos = (dev->obs_pos + 1) % DEVICE_CLOCK_OBS;
+    if (dev->obs_count < DEVICE_CLOCK_OBS) dev->obs_count++;
+    pthread_mutex_unlock(&dev->clock_lock);
+}
+
+static void *device_thread(void *arg)
+{
+    Device *dev = (Device*)arg;
+    uint8_t buf[READ_CHUNK_BYTES];
+    bool drained = false;
+
+    while (atomic_load(&dev->running)) {
+        int n = RS232_PollComport(dev->port, buf, sizeof(buf));
+        if (n <= 0) {
+            drained = true;
+            usleep(DEVICE_IDLE_US);
+            continue;
+        }
+        double now = telemetry_now();
+        dev->bytes += (unsigned long long)n;
+        device_parse(dev, buf, n, now);
+        // Поки порт не спорожнів хоч раз, читається накопичене до відкриття:
+        // час прибуття таких семплів нічого не каже про час їх вимірювання
+        if (drained) device_observe(dev, now);
+        atomic_store(&dev->last_arrival, now);
+    }
+    return NULL;
+}
+
+bool devices_add(DeviceSet *set, const char *path, int port)
+{
+    char mode[] = {'8','N','1',0};
+    if (set->count >= MAX_DEVICES) {
+        printf("Не більше %d плат одночасно, %s пропущено\n", MAX_DEVICES, path);
+        return false;
+    }
+
+    Device *dev = &set->devices[set->count];
+    memset(dev, 0, sizeof(*dev));
+    dev->ring = (DeviceSample*)calloc(DEVICE_RING_SAMPLES, sizeof(DeviceSample));
+    if (!dev->ring) {
+        fprintf(stderr, "Memory allocation failed for device %s\n", path);
+        return false;
+    }
+    snprintf(dev->name, sizeof(dev->name), "%s", path);
+    if (port < 0) port = usb_port_for_path(dev->name, USB_CUSTOM_PORT + set->count);
+    if (RS232_OpenComport(port, 115200, mode, 0) != 0) {
+        free(dev->ring);
+        dev->ring = NULL;
+        return false;
+    }
+
+    dev->port = port;
+    seq_reset(&dev->seq);
+    pthread_mutex_init(&dev->clock_lock, NULL);
+    printf("Плата %d: %s (канали %d..%d)\n", set->count + 1, path,
+           set->count * DEVICE_CHANNELS + 1, (set->count + 1) * DEVICE_CHANNELS);
+    set->count++;
+    return true;
+}
+
+bool devices_start(DeviceSet *set, GapMode gap_mode)
+{
+    for (int d = 0; d < set->count; d++) {
+        Device *dev = &set->devices[d];
+        dev->gap_mode = gap_mode;
+        atomic_store(&dev->running, true);
+        if (pthread_create(&dev->thread, NULL, device_thread, dev) != 0) {
+            fprintf(stderr, "Failed to start reader thread for %s\n", dev->name);
+            atomic_store(&dev->running, false);
+            // Плати без потоку закриваються тут же, решту закриє devices_close
+            for (int k = d; k < set->count; k++) {
+                RS232_CloseComport(set->devices[k].port);
+                pthread_mutex_destroy(&set->devices[k].clock_lock);
+                free(set->devices[k].ring);
+                set->devices[k].ring = NULL;
+            }
+            set->count = d;
+            return false;
+        }
+    }
+    return true;
+}
+
+void devices_close(DeviceSet *set)
+{
+    for (int d = 0; d < set->count; d++) {
+        Device *dev = &set->devices[d];
+        atomic_store(&dev->running, false);
+        pthread_join(dev->thread, NULL);
+        RS232_CloseComport(dev->port);
+        pthread_mutex_destroy(&dev->clock_lock);
+        free(dev->ring);
+        dev->ring = NULL;
+        printf("Плату %s закрито.\n", dev->name);
+    }
+    set->count = 0;
+    set->merging = false;
+}
+
+void devices_send(DeviceSet *set, const unsigned char *buf, int len)
+{
+    for (int d = 0; d < set->count; d++)
+        RS232_SendBuf(set->devices[d].port, (unsigned char*)buf, len);
+}
+
+// Без міток: період — нахил між першим і останнім спостереженням (похибка прибуття ділиться
+// на весь інтервал), зсув — мінімум (t - k*T) серед останніх: найменш затриманий пакет
+DeviceClock devices_clock(Device *dev)
+{
+    pthread_mutex_lock(&dev->clock_lock);
+    DeviceClock c = device_time_clock(&dev->time);
+    if (c.valid) {
+        pthread_mutex_unlock(&dev->clock_lock);
+        return c;
+    }
+    c = (DeviceClock){ .valid = false };
+    if (dev->have_first && dev->obs_count > 0) {
+        int last = (dev->obs_pos + DEVICE_CLOCK_OBS - 1) % DEVICE_CLOCK_OBS;
+        double span_t = dev->obs_time[last] - dev->first_time;
+        uint64_t span_k = dev->obs_index[last] - dev->first_index;
+
+        if (span_t >= DEVICE_WARMUP_S && span_k > 0) {
+            c.period = span_t / (double)span_k;
+            c.offset = dev->obs_time[0] - (double)dev->obs_index[0] * c.period;
+            for (int i = 1; i < dev->obs_count; i++) {
+                double offset = dev->obs_time[i] - (double)dev->obs_index[i] * c.period;
+                if (offset < c.offset) c.offset = offset;
+            }
+            c.valid = true;
+        }
+    }
+    pthread_mutex_unlock(&dev->clock_lock);
+    return c;
+}
+
+bool devices_read(Device *dev, uint64_t index, DeviceSample *out)
+{
+    uint64_t head = atomic_load_explicit(&dev->head, memory_order_acquire);
+    if (index >= head || head - index >= DEVICE_RING_SAMPLES) return false;
+
+    *out = dev->ring[index & DEVICE_RING_MASK];
+
+    // Слот могли почати перезаписувати під час копіювання (seqlock без лічильника:
+    // потік плати пише слот index + DEVICE_RING_SAMPLES лише після head == index + DEVICE_RING_SAMPLES)
+    atomic_thread_fence(memory_order_acquire);
+    head = atomic_load_explicit(&dev->head, memory_order_relaxed);
+    return head - index < DEVICE_RING_SAMPLES && out->index == index;
+}
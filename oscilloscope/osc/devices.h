@@ -0,0 +1,117 @@
+// file devices.h
+
+#ifndef DEVICES_H
+#define DEVICES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "sequence.h"
+#include "parse_data.h"
+#include "control_protocol.h"
+#include "device_time.h"
+
+#define MAX_DEVICES 4                  // Плат одночасно (--port кілька разів або --devices N)
+#define DEVICE_CHANNELS SEQ_CHANNELS   // Каналів на плату: плата d дає канали d*4 .. d*4+3
+#define DEVICE_RING_SAMPLES (1 << 16)  // Семплів у кільці однієї плати (степінь двійки)
+#define DEVICE_CLOCK_OBS 64            // Останні спостереження (номер, час прибуття) для оцінки зсуву
+#define DEVICE_WARMUP_S 0.3            // Скільки спостерігати годинник плати перед об'єднанням
+#define DEVICE_STALE_S 0.2             // Плата без даних довше — її канали заповнюються як розрив
+
+// Семпл однієї плати. index — номер семпла від початку прийому (розгорнутий 24-бітний seq),
+// gap — семпл вигаданий замість втраченого (значення утримане або інтерпольоване)
+typedef struct {
+    uint64_t index;
+    bool gap;
+    uint8_t extra_bits;            // Роздільність значень (SamplePacket.extra_bits)
+    int16_t values[DEVICE_CHANNELS];
+} DeviceSample;
+
+// Одна плата: власний потік читання, розбір пакетів і перевірка номерів.
+// Потік лише дописує кільце; головний потік читає його в merge_devices (read_usb_device.c).
+typedef struct {
+    int port;                      // Номер порту бібліотеки RS-232
+    char name[96];                 // Шлях пристрою (RS-232 зберігає вказівник на нього)
+    pthread_t thread;
+    atomic_bool running;
+
+    // Стан потоку читання
+    uint8_t packet[PACKET_MAX_SIZE]; // Пакет семплів або кадр керування
+    int packet_pos;
+    bool hunting;
+    SeqTracker seq;
+    bool started;                  // Прийнято перший семпл
+    uint64_t next_index;           // Номер наступного семпла
+    int16_t last_values[DEVICE_CHANNELS];
+    uint8_t extra_bits;            // Роздільність останнього пакета
+    GapMode gap_mode;
+
+    DeviceSample *ring;
+    _Atomic uint64_t head;         // Записано семплів 0 .. head-1
+
+    // Годинник: перше і останні спостереження (номер останнього семпла, час прибуття)
+    pthread_mutex_t clock_lock;
+    bool have_first;
+    uint64_t first_index;
+    double first_time;
+    uint64_t obs_index[DEVICE_CLOCK_OBS];
+    double obs_time[DEVICE_CLOCK_OBS];
+    int obs_count;
+    int obs_pos;
+    DeviceTime time;               // Годинник за мітками пакетів (пише потік плати під clock_lock)
+    _Atomic double last_arrival;
+    _Atomic uint64_t ctrl_reply;   // Остання відповідь на запит керування (control_reply_pack)
+
+    // Лічильники (пише лише потік плати)
+    unsigned long long bytes;
+    unsigned long long packets;
+    unsigned long long bad_packets;
+    unsigned long long resyncs;
+    unsigned long long resync_bytes;
+    unsigned long long seq_gaps;
+    unsigned long long seq_lost;
+    unsigned long long seq_duplicates;
+    unsigned long long seq_errors;
+    unsigned long long seq_restarts;
+    unsigned long long delta_blocks;   // Стиснені блоки 0xAE
+    unsigned long long delta_bytes;
+
+    unsigned long long merge_gaps; // Семпли, яких не виявилось при об'єднанні (пише головний потік)
+} Device;
+
+// Набір плат, що об'єднуються в один список каналів. Плата 0 — опорна:
+// її семпли задають часову вісь, семпли інших вибираються за найближчим часом.
+typedef struct {
+    int count;
+    Device devices[MAX_DEVICES];
+
+    bool merging;                  // Годинники всіх плат оцінено, об'єднання йде
+    uint64_t merge_next;           // Наступний семпл опорної плати
+    unsigned long long merge_overruns; // Семпли опорної плати, перезаписані до об'єднання
+    int16_t merged[MAX_DEVICES * DEVICE_CHANNELS]; // Останній об'єднаний семпл: утримується для відсутніх плат
+    unsigned long long seen_bytes; // Байти, вже враховані в телеметрії
+} DeviceSet;
+
+// Відкриває плату за шляхом; port >= 0 — номер зі списку RS-232 (path лише для повідомлень),
+// -1 — порт визначається за шляхом (usb_port_for_path). false — порт не відкрито
+bool devices_add(DeviceSet *set, const char *path, int port);
+
+// Запускає потоки читання всіх доданих плат
+bool devices_start(DeviceSet *set, GapMode gap_mode);
+
+// Зупиняє потоки і закриває порти
+void devices_close(DeviceSet *set);
+
+// Надсилає команду всім платам
+void devices_send(DeviceSet *set, const unsigned char *buf, int len);
+
+// Поточна оцінка годинника плати: за мітками пакетів, якщо плата їх ставить, інакше за часом
+// прибуття (valid == false, поки даних замало)
+DeviceClock devices_clock(Device *dev);
+
+// Копіює семпл index; false — ще не прийнято або вже перезаписано
+bool devices_read(Device *dev, uint64_t index, DeviceSample *out);
+
+#endif // DEVICES_H
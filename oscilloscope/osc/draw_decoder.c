@@ -0,0 +1,225 @@
+// file draw_decoder.c
+
+#include "draw_decoder.h"
+#include "decoder.h"
+#include "read_usb_device.h"
+#include "glyphs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+extern int spacing;
+extern int padding;
+extern int borderThickness;
+
+#define DECODE_BAND_HEIGHT 14   // Висота смуги підписів під сигналом
+
+// Канал, під сигналом якого малюються підписи
+static int overlay_channel(const ProtocolDecoder *d)
+{
+    switch (d->protocol) {
+        case DECODE_UART: return d->uart_rx;
+        case DECODE_SPI: return d->spi_mosi >= 0 ? d->spi_mosi : d->spi_sclk;
+        case DECODE_I2C: return d->i2c_sda;
+        default: return -1;
+    }
+}
+
+// Зсув семпла з номером n відносно тригера каналу ch у розкладці екрана
+static bool sample_to_offset(const OscData *oscData, const SignalLayout *layout, int ch,
+                             unsigned long long n, int *offset)
+{
+    if (n >= oscData->sample_count) return false;
+    unsigned long long age = oscData->sample_count - n; // 1 — найновіший семпл
+    if (age > (unsigned long long)oscData->valid_points) return false;
+
+    int size = oscData->history_size;
+    int ring = (int)(((long long)oscData->history_index - (long long)(age % size) + size) % size);
+    int off = (ring - layout->base_index - oscData->channels[ch].trigger_index) % size;
+    if (off < 0) off += size;
+    if (off > layout->points_right - 1) off -= size;
+    if (off < -layout->points_left) return false;
+
+    *offset = off;
+    return true;
+}
+
+static void format_value(char *buf, size_t size, const ProtocolDecoder *d, const DecodedEvent *e)
+{
+    switch (e->type) {
+        case DECODE_EVT_UART_BYTE:
+            if (isprint(e->value)) snprintf(buf, size, "%02X'%c'", e->value, e->value);
+            else snprintf(buf, size, "%02X", e->value);
+            break;
+        case DECODE_EVT_SPI_WORD:
+            if (d->spi_miso >= 0) snprintf(buf, size, "%02X/%02X", e->value, e->value2);
+            else snprintf(buf, size, "%02X", e->value);
+            break;
+        case DECODE_EVT_I2C_ADDRESS:
+            snprintf(buf, size, "%02X%s", e->value, (e->flags & DECODE_FLAG_READ) ? "R" : "W");
+            break;
+        case DECODE_EVT_I2C_DATA:
+            snprintf(buf, size, "%02X", e->value);
+            break;
+        default:
+            snprintf(buf, size, "%s", decoder_event_name(e));
+            break;
+    }
+    if (e->flags & (DECODE_FLAG_FRAMING | DECODE_FLAG_PARITY | DECODE_FLAG_NAK | DECODE_FLAG_PARTIAL)) {
+        size_t len = strlen(buf);
+        if (len + 1 < size) { buf[len] = '!'; buf[len + 1] = '\0'; }
+    }
+}
+
+void draw_decode_overlay(const OscData *oscData, const SignalLayout *layout)
+{
+    const ProtocolDecoder *d = &oscData->decoder;
+    int ch = overlay_channel(d);
+    if (ch < 0 || !d->events || d->total == 0 || !layout->valid) return;
+
+    const ChannelSettings *cs = &oscData->channels[ch];
+    // Смуга одразу під нульовим рівнем каналу
+    float y = cs->offset_y + HISTORY_SCALE_OFFSET * cs->scale_y + 6;
+    int oldest = d->total > DECODER_MAX_EVENTS ? (int)(d->total - DECODER_MAX_EVENTS) : 0;
+
+    for (long long seq = (long long)d->total - 1; seq >= oldest; seq--) {
+        const DecodedEvent *e = &d->events[seq % DECODER_MAX_EVENTS];
+        // Події впорядковані за часом: далі лише старіші за видиму історію
+        if (oscData->sample_count - e->end > (unsigned long long)oscData->valid_points) break;
+
+        int off0, off1;
+        if (!sample_to_offset(oscData, layout, ch, e->start, &off0) ||
+            !sample_to_offset(oscData, layout, ch, e->end, &off1)) continue;
+
+        float x0 = signal_offset_to_x(layout, off0);
+        float x1 = signal_offset_to_x(layout, off1);
+        if (x1 < x0) { float t = x0; x0 = x1; x1 = t; }
+
+        bool error = e->flags & (DECODE_FLAG_FRAMING | DECODE_FLAG_PARITY | DECODE_FLAG_NAK);
+        Color color = (seq == d->selected) ? YELLOW : (error ? RED : SKYBLUE);
+
+        if (e->type == DECODE_EVT_I2C_START || e->type == DECODE_EVT_I2C_STOP) {
+            DrawLine(x0, y - 4, x0, y + DECODE_BAND_HEIGHT + 4, color);
+            DrawTextScaled(Terminus12x6_font, x0 + 2, y + 1, decoder_event_name(e), spacing, 1, color);
+            continue;
+        }
+
+        DrawRectangleLines(x0, y, x1 - x0 > 2 ? x1 - x0 : 2, DECODE_BAND_HEIGHT, color);
+
+        char text[16];
+        format_value(text, sizeof(text), d, e);
+        int w = MeasureText(text, Terminus12x6_font.glyph_height);
+        if (w + 4 <= x1 - x0)
+            DrawTextScaled(Terminus12x6_font, (x0 + x1) / 2 - w / 2, y + 1, text, spacing, 1, color);
+    }
+}
+
+void draw_decoder_table(OscData *oscData, Rectangle area, RasterFont font)
+{
+    ProtocolDecoder *d = &oscData->decoder;
+    if (!d->show_table || d->protocol == DECODE_NONE) return;
+
+    int line_height = font.glyph_height + 4;
+    float rate = oscData->sample_rate_hz;
+
+    DrawRectangleRec(area, Fade(BLACK, 0.8f));
+    DrawRectangleLinesEx(area, 1, DARKGRAY);
+
+    // Заголовок: протокол, параметри і рядок пошуку
+    const char *params = "";
+    if (d->protocol == DECODE_UART)
+        params = TextFormat("%d %d%c1", d->uart_baud, d->uart_data_bits, "NOE"[d->uart_parity]);
+    else if (d->protocol == DECODE_SPI)
+        params = TextFormat("mode %d", (d->spi_cpol ? 2 : 0) + (d->spi_cpha ? 1 : 0));
+    DrawTextScaled(font, area.x + 4, area.y + 4,
+                   TextFormat("%s %s  events %llu  /%s%s", decoder_protocol_name(d->protocol), params,
+                              d->total, d->search, d->search_active ? "_" : ""),
+                   spacing, 1, d->search_active ? YELLOW : WHITE);
+
+    int rows = (int)((area.height - 8) / line_height) - 1;
+    if (rows <= 0 || d->total == 0) return;
+
+    // Список від новіших до старіших; вибрана подія тримається у видимій частині
+    long long newest = (long long)d->total - 1;
+    long long oldest = d->total > DECODER_MAX_EVENTS ? (long long)(d->total - DECODER_MAX_EVENTS) : 0;
+    long long top = newest;
+    if (d->selected >= 0 && d->selected < newest - rows / 2) top = d->selected + rows / 2;
+
+    float y = area.y + 4 + line_height;
+    for (long long seq = top; seq >= oldest && seq > top - rows; seq--) {
+        const DecodedEvent *e = &d->events[seq % DECODER_MAX_EVENTS];
+
+        char when[24], value[16];
+        if (rate > 0.0f) snprintf(when, sizeof(when), "%.6fs", e->start / rate);
+        else snprintf(when, sizeof(when), "#%llu", e->start);
+        format_value(value, sizeof(value), d, e);
+
+        const char *flags = (e->flags & DECODE_FLAG_FRAMING) ? "FRAME" :
+                            (e->flags & DECODE_FLAG_PARITY) ? "PARITY" :
+                            (e->flags & DECODE_FLAG_NAK) ? "NAK" :
+                            (e->flags & DECODE_FLAG_PARTIAL) ? "PART" : "";
+
+        Color color = (seq == d->selected) ? YELLOW : (flags[0] ? RED : LIGHTGRAY);
+        DrawTextScaled(font, area.x + 4, y,
+                       TextFormat("%6lld %14s %-6s %-8s %s", seq, when, decoder_event_name(e), value, flags),
+                       spacing, 1, color);
+        y += line_height;
+    }
+}
+
+// Пошук за текстом із рядка пошуку від вибраної (або найновішої) події
+static void search_step(ProtocolDecoder *d, bool older)
+{
+    if (d->search[0] == '\0') return;
+    int value = (int)strtol(d->search, NULL, 16);
+    long long from = d->selected >= 0 ? d->selected : (older ? (long long)d->total : -1);
+    long long found = decoder_find(d, from, value, older);
+    if (found >= 0) d->selected = found;
+}
+
+bool decoder_handle_keys(OscData *oscData)
+{
+    ProtocolDecoder *d = &oscData->decoder;
+
+    if (d->search_active) {
+        int len = (int)strlen(d->search);
+        int c;
+        while ((c = GetCharPressed()) > 0) {
+            if (isxdigit(c) && len < DECODER_SEARCH_LEN) {
+                d->search[len++] = (char)toupper(c);
+                d->search[len] = '\0';
+            }
+        }
+        if (IsKeyPressed(KEY_BACKSPACE) && len > 0) d->search[--len] = '\0';
+        if (IsKeyPressed(KEY_ENTER)) {
+            d->search_active = false;
+            d->selected = -1;
+            search_step(d, true);
+        }
+        return true;
+    }
+
+    if (IsKeyPressed(KEY_D)) decoder_set_protocol(oscData, (d->protocol + 1) % DECODE_PROTOCOL_COUNT);
+    if (IsKeyPressed(KEY_E)) d->show_table = !d->show_table;
+    if (!d->show_table || d->protocol == DECODE_NONE) return false;
+
+    if (IsKeyPressed(KEY_SLASH)) {
+        d->search_active = true;
+        d->search[0] = '\0';
+        while (GetCharPressed() > 0) {} // символ '/' не потрапляє в рядок пошуку
+        return true;
+    }
+    if (IsKeyPressed(KEY_N)) search_step(d, true);
+    if (IsKeyPressed(KEY_P)) search_step(d, false);
+
+    long long newest = (long long)d->total - 1;
+    long long oldest = d->total > DECODER_MAX_EVENTS ? (long long)(d->total - DECODER_MAX_EVENTS) : 0;
+    if (IsKeyPressed(KEY_DOWN) && newest >= 0)
+        d->selected = (d->selected < 0) ? newest : (d->selected > oldest ? d->selected - 1 : oldest);
+    if (IsKeyPressed(KEY_UP) && d->selected >= 0)
+        d->selected = (d->selected < newest) ? d->selected + 1 : -1; // вище найновішої — слідкування
+    if (d->selected >= 0 && d->selected < oldest) d->selected = -1;
+    return false;
+}
@@ -0,0 +1,22 @@
+// file draw_decoder.h
+
+#ifndef DRAW_DECODER_H
+#define DRAW_DECODER_H
+
+#include "main.h"
+#include "raylib.h"
+#include "draw_signal.h"
+#include "all_font.h" // Опис шрифтів як структури RasterFont
+
+// Підписи декодованих кадрів під сигналом першого каналу протоколу (викликається з draw_signal)
+void draw_decode_overlay(const OscData *oscData, const SignalLayout *layout);
+
+// Таблиця подій з рядком пошуку; вибрана подія підсвічується і в накладенні
+void draw_decoder_table(OscData *oscData, Rectangle area, RasterFont font);
+
+// Клавіші декодера: D — протокол, E — таблиця, / — пошук значення, N/P — наступний/попередній
+// збіг, стрілки вгору/вниз — вибір події. Повертає true, поки вводиться текст пошуку
+// (інші гарячі клавіші в цей час не обробляються).
+bool decoder_handle_keys(OscData *oscData);
+
+#endif // DRAW_DECODER_H
@@ -0,0 +1,66 @@
+// file draw_measurements.c
+
+#include "draw_measurements.h"
+#include "measurements.h"
+#include "glyphs.h"
+
+#include "raylib.h"
+#include <stdio.h>
+
+extern int spacing;
+extern int padding;
+extern int borderThickness;
+
+// Форматування часу з автоматичним вибором одиниць (с, мс, мкс)
+static void format_time(char *buf, size_t size, float seconds)
+{
+    if (seconds < 0.0f) snprintf(buf, size, "---");
+    else if (seconds >= 1.0f) snprintf(buf, size, "%.3fs", seconds);
+    else if (seconds >= 1e-3f) snprintf(buf, size, "%.3fms", seconds * 1e3f);
+    else snprintf(buf, size, "%.1fus", seconds * 1e6f);
+}
+
+void draw_measurements(OscData *oscData, int x, int y, RasterFont font)
+{
+    Color channel_colors[MAX_CHANNELS] = CHANNEL_TEXT_COLORS;
+    int line_height = font.glyph_height + 2 * padding + 2;
+    bool rate_known = oscData->sample_rate_hz > 0.0f;
+
+    DrawTextWithAutoInvertedBackground(font, x, y,
+                                       rate_known ? TextFormat("Fs: %.0f S/s", oscData->sample_rate_hz)
+                                                  : "Fs: ---",
+                                       spacing, 1, WHITE, padding, borderThickness);
+    y += line_height;
+
+    // З кількох плат — канали плати, до якої належить активний канал
+    int bank = oscData->active_channel / DEVICE_CHANNELS * DEVICE_CHANNELS;
+    for (int i = bank; i < bank + DEVICE_CHANNELS; i++) {
+        if (!oscData->channels[i].active) continue;
+
+        MeasurementResult r = measurements_get(oscData, i);
+        if (!r.valid) continue;
+
+        char freq[24], rise[16], fall[16];
+        if (r.frequency_hz > 0.0f) snprintf(freq, sizeof(freq), "%.2fHz", r.frequency_hz);
+        else if (r.period_samples > 0.0f) snprintf(freq, sizeof(freq), "T=%.1fsmp", r.period_samples);
+        else snprintf(freq, sizeof(freq), "---");
+
+        if (rate_known) {
+            format_time(rise, sizeof(rise), r.rise_s);
+            format_time(fall, sizeof(fall), r.fall_s);
+        } else {
+            // Частота дискретизації ще невідома — час у семплах
+            if (r.rise_samples >= 0.0f) snprintf(rise, sizeof(rise), "%.0fsmp", r.rise_samples);
+            else snprintf(rise, sizeof(rise), "---");
+            if (r.fall_samples >= 0.0f) snprintf(fall, sizeof(fall), "%.0fsmp", r.fall_samples);
+            else snprintf(fall, sizeof(fall), "---");
+        }
+
+        const char *text = TextFormat("Ch%d Vpp %.3f Min %.3f Max %.3f Avg %.3f RMS %.3f  F %s  D %.1f%%  Tr %s Tf %s",
+                                      i + 1, r.vpp_v, r.min_v, r.max_v, r.mean_v, r.rms_v,
+                                      freq, r.duty_percent, rise, fall);
+        DrawTextWithAutoInvertedBackground(font, x, y, text, spacing, 1,
+                                           channel_colors[i], padding, borderThickness);
+        y += line_height;
+    }
+}
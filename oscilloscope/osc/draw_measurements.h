@@ -0,0 +1,12 @@
+// file draw_measurements.h
+
+#ifndef DRAW_MEASUREMENTS_H
+#define DRAW_MEASUREMENTS_H
+
+#include "main.h"
+#include "all_font.h" // Опис шрифтів як структури RasterFont
+
+// Панель автоматичних вимірювань (по рядку на активний канал) з лівим верхнім кутом у (x, y)
+void draw_measurements(OscData *oscData, int x, int y, RasterFont font);
+
+#endif // DRAW_MEASUREMENTS_H
@@ -0,0 +1,153 @@
+// file draw_recording.c
+
+#include "draw_recording.h"
+#include "recording.h"
+#include "read_usb_device.h"
+#include "glyphs.h"
+
+#include <stdio.h>
+#include <string.h>
+
+extern int spacing;
+extern int padding;
+extern int borderThickness;
+
+#define VIEWER_MIN_SPP (1.0 / 16.0) // Найбільше збільшення: 16 пікселів на семпл
+
+static void clamp_view(RecordingViewer *v, float width)
+{
+    double total = (double)v->file.header.total_samples;
+    double max_spp = total / width;
+    if (max_spp < VIEWER_MIN_SPP) max_spp = VIEWER_MIN_SPP;
+    if (v->samples_per_px > max_spp) v->samples_per_px = max_spp;
+    if (v->samples_per_px < VIEWER_MIN_SPP) v->samples_per_px = VIEWER_MIN_SPP;
+
+    double span = v->samples_per_px * width;
+    if (v->first > total - span) v->first = total - span;
+    if (v->first < 0.0) v->first = 0.0;
+}
+
+int recording_viewer_open(OscData *oscData, const char *path, float width)
+{
+    RecordingViewer *v = &oscData->viewer;
+    recording_viewer_close(oscData);
+    if (recording_open(&v->file, path) != 0) return -1;
+
+    v->active = true;
+    snprintf(v->path, sizeof(v->path), "%s", path);
+    v->first = 0.0;
+    v->samples_per_px = (double)v->file.header.total_samples / width;
+    clamp_view(v, width);
+    return 0;
+}
+
+void recording_viewer_close(OscData *oscData)
+{
+    RecordingViewer *v = &oscData->viewer;
+    if (v->active) recording_close(&v->file);
+    v->active = false;
+}
+
+void recording_viewer_handle_input(OscData *oscData, Rectangle area)
+{
+    RecordingViewer *v = &oscData->viewer;
+    if (!v->active) return;
+
+    float wheel = GetMouseWheelMove();
+    Vector2 mouse = GetMousePosition();
+    if (wheel != 0.0f && CheckCollisionPointRec(mouse, area)) {
+        // Семпл під курсором лишається на місці
+        double anchor = v->first + (mouse.x - area.x) * v->samples_per_px;
+        v->samples_per_px *= (wheel > 0.0f) ? 0.8 : 1.25;
+        clamp_view(v, area.width);
+        v->first = anchor - (mouse.x - area.x) * v->samples_per_px;
+    }
+
+    double page = area.width * v->samples_per_px;
+    if (IsKeyPressed(KEY_RIGHT)) v->first += page / 4;
+    if (IsKeyPressed(KEY_LEFT)) v->first -= page / 4;
+    if (IsKeyPressed(KEY_HOME)) v->first = 0.0;
+    if (IsKeyPressed(KEY_END)) v->first = (double)v->file.header.total_samples;
+    clamp_view(v, area.width);
+}
+
+// Форматування часу з автоматичним вибором одиниць
+static const char *format_time(double seconds)
+{
+    if (seconds >= 1.0) return TextFormat("%.3fs", seconds);
+    if (seconds >= 1e-3) return TextFormat("%.3fms", seconds * 1e3);
+    return TextFormat("%.1fus", seconds * 1e6);
+}
+
+void draw_recording_view(OscData *oscData, Rectangle area, RasterFont font)
+{
+    RecordingViewer *v = &oscData->viewer;
+    if (!v->active) return;
+
+    Color channel_colors[MAX_CHANNELS] = CHANNEL_COLORS;
+    const RecordingHeader *h = &v->file.header;
+    int columns = (int)area.width;
+    int bits = recording_extra_bits(h);
+
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        ChannelSettings *ch = &oscData->channels[i];
+        if (!ch->active) continue;
+
+        if (v->samples_per_px < 1.0) {
+            // Збільшення: лінії між окремими семплами
+            uint64_t s0 = (uint64_t)v->first;
+            uint64_t s1 = (uint64_t)(v->first + columns * v->samples_per_px) + 2;
+            Vector2 prev = {0};
+            bool have_prev = false;
+            for (uint64_t s = s0; s < s1; s++) {
+                int16_t lo, hi;
+                if (!recording_minmax(&v->file, i, s, s + 1, &lo, &hi)) { have_prev = false; continue; }
+                Vector2 p = { area.x + (float)((s - v->first) / v->samples_per_px),
+                              ch->offset_y - adc_bits_to_history(oscData, i, lo, bits) * ch->scale_y };
+                if (have_prev) DrawLineV(prev, p, channel_colors[i]);
+                prev = p;
+                have_prev = true;
+            }
+            continue;
+        }
+
+        // Огляд: вертикальний відрізок min..max на стовпчик, з'єднаний із сусіднім
+        float prev_lo = 0.0f, prev_hi = 0.0f;
+        bool have_prev = false;
+        for (int x = 0; x < columns; x++) {
+            uint64_t s0 = (uint64_t)(v->first + x * v->samples_per_px);
+            uint64_t s1 = (uint64_t)(v->first + (x + 1) * v->samples_per_px);
+            if (s1 <= s0) s1 = s0 + 1;
+
+            int16_t lo, hi;
+            if (!recording_minmax(&v->file, i, s0, s1, &lo, &hi)) { have_prev = false; continue; }
+            float y_lo = ch->offset_y - adc_bits_to_history(oscData, i, lo, bits) * ch->scale_y;
+            float y_hi = ch->offset_y - adc_bits_to_history(oscData, i, hi, bits) * ch->scale_y;
+            float top = y_hi, bottom = y_lo;
+            if (have_prev) {
+                if (prev_lo < top) top = prev_lo;       // попередній стовпчик вище — тягнемо вгору
+                if (prev_hi > bottom) bottom = prev_hi; // або вниз
+            }
+            DrawLine(area.x + x, top, area.x + x, bottom + 1, channel_colors[i]);
+            prev_lo = y_lo;
+            prev_hi = y_hi;
+            have_prev = true;
+        }
+    }
+
+    // Стан перегляду: файл, тривалість, видиме вікно і масштаб
+    double rate = h->sample_rate_hz;
+    double span = columns * v->samples_per_px;
+    const char *name = strrchr(v->path, '/');
+    name = name ? name + 1 : v->path;
+    const char *text = (rate > 0.0)
+        ? TextFormat("REC VIEW %s  %llu smp  %s  pos %s  span %s  %.2f smp/px%s", name,
+                     (unsigned long long)h->total_samples, format_time(h->total_samples / rate),
+                     format_time(v->first / rate), format_time(span / rate), v->samples_per_px,
+                     h->complete ? "" : "  (recovered)")
+        : TextFormat("REC VIEW %s  %llu smp  pos %.0f  span %.0f  %.2f smp/px%s", name,
+                     (unsigned long long)h->total_samples, v->first, span, v->samples_per_px,
+                     h->complete ? "" : "  (recovered)");
+    DrawTextWithAutoInvertedBackground(font, area.x + 4, area.y + area.height - 20, text,
+                                       spacing, 1, WHITE, padding, borderThickness);
+}
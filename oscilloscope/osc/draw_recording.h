@@ -0,0 +1,20 @@
+// file draw_recording.h
+
+#ifndef DRAW_RECORDING_H
+#define DRAW_RECORDING_H
+
+#include "main.h"
+#include "raylib.h"
+#include "all_font.h" // Опис шрифтів як структури RasterFont
+
+// Відкриває запис для перегляду (весь файл у вікні). 0 при успіху.
+int recording_viewer_open(OscData *oscData, const char *path, float width);
+void recording_viewer_close(OscData *oscData);
+
+// Колесо миші — масштаб навколо курсора, стрілки — прокрутка, Home/End — початок/кінець
+void recording_viewer_handle_input(OscData *oscData, Rectangle area);
+
+// Малює видиму частину запису: по стовпчику min/max на піксель для кожного каналу
+void draw_recording_view(OscData *oscData, Rectangle area, RasterFont font);
+
+#endif // DRAW_RECORDING_H
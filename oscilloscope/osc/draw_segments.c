@@ -0,0 +1,78 @@
+// file draw_segments.c
+
+#include "draw_segments.h"
+#include "segments.h"
+#include "glyphs.h"
+
+#include "raylib.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <math.h>
+
+extern int spacing;
+extern int padding;
+extern int borderThickness;
+
+// Малює один сегмент каналу як ламану лінію; точка тригера знаходиться на trigger_x_pos
+static void draw_segment_trace(const float *samples, int length, int pre,
+                               ChannelSettings *ch, float trigger_x_pos, float x_step,
+                               float lineThickness, Color color)
+{
+    for (int j = 0; j < length - 1; j++) {
+        Vector2 p1 = { trigger_x_pos + (j - pre) * x_step, ch->offset_y - samples[j] * ch->scale_y };
+        Vector2 p2 = { trigger_x_pos + (j + 1 - pre) * x_step, ch->offset_y - samples[j + 1] * ch->scale_y };
+        if (isnan(p1.y) || isnan(p2.y)) continue; // розрив на втрачених пакетах
+        DrawLineEx(p1, p2, lineThickness, color);
+    }
+}
+
+void draw_segments(OscData *oscData, float osc_width, float lineThickness, RasterFont font)
+{
+    Color channel_colors[MAX_CHANNELS] = CHANNEL_COLORS;
+    SegmentedCapture *seg = &oscData->segments;
+    if (!seg->enabled || seg->length < 2) return;
+
+    // Розподіл по горизонталі: сегмент займає всю ширину, тригер — на своїй позиції в сегменті
+    float x_step = osc_width / (float)(seg->length - 1);
+    float trigger_x_pos = seg->pre_samples * x_step;
+
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        ChannelSettings *ch = &oscData->channels[i];
+        if (!ch->active) continue;
+
+        if (seg->overlay) {
+            // Накладання: всі сегменти напівпрозорі, вибраний — яскравий зверху
+            for (int s = 0; s < seg->captured; s++) {
+                if (s == seg->view_segment) continue;
+                const float *samples = segments_get(oscData, i, s);
+                if (samples)
+                    draw_segment_trace(samples, seg->length, seg->pre_samples, ch, trigger_x_pos,
+                                       x_step, 1.0f, Fade(channel_colors[i], 0.25f));
+            }
+        }
+
+        const float *samples = segments_get(oscData, i, seg->view_segment);
+        if (samples)
+            draw_segment_trace(samples, seg->length, seg->pre_samples, ch, trigger_x_pos,
+                               x_step, lineThickness, channel_colors[i]);
+    }
+
+    // Вертикальна мітка точки тригера
+    DrawLine((int)trigger_x_pos, 0, (int)trigger_x_pos, WORKSPACE_HEIGHT, Fade(RED, 0.6f));
+
+    // Інформація про сегмент: номер, час відносно першого сегмента і інтервал до попереднього
+    const char *status;
+    if (seg->captured == 0) {
+        status = TextFormat("Сегменти: 0/%d  очікування тригера (%d кадрів)",
+                            seg->count, oscData->channels[oscData->active_channel].frames_since_trigger);
+    } else {
+        int v = seg->view_segment;
+        double t_rel = seg->info[v].timestamp - seg->info[0].timestamp;
+        double dt = (v > 0) ? seg->info[v].timestamp - seg->info[v - 1].timestamp : 0.0;
+        status = TextFormat("Сегмент %d/%d (захоплено %d%s)  t=+%.6f с  dt=%.6f с",
+                            v + 1, seg->count, seg->captured,
+                            seg->captured >= seg->count ? ", повний" : "", t_rel, dt);
+    }
+    DrawTextWithAutoInvertedBackground(font, 82, WORKSPACE_HEIGHT - 20, status,
+                                       spacing, 1, WHITE, padding, borderThickness);
+}
@@ -0,0 +1,12 @@
+// file draw_segments.h
+
+#ifndef DRAW_SEGMENTS_H
+#define DRAW_SEGMENTS_H
+
+#include "main.h"
+#include "all_font.h" // Опис шрифтів як структури RasterFont
+
+// Переглядач сегментів: малює вибраний сегмент або накладання всіх захоплених сегментів
+void draw_segments(OscData *oscData, float osc_width, float lineThickness, RasterFont font);
+
+#endif // DRAW_SEGMENTS_H
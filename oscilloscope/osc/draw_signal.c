@@ -5,44 +5,112 @@
 #include "raylib.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <math.h>
 #include "main.h" // Для OscData, ChannelSettings
+#include "draw_decoder.h"
 
-#define MAX_CHANNELS 4
+#define MAX_CHANNELS 16
 
-void draw_signal(OscData *oscData, float osc_width, float lineThickness)
+// Відрізок між сусідніми семплами; NaN в історії — втрачені пакети (GAP_MARK), там лінія розривається
+static inline void draw_trace_segment(Vector2 p1, Vector2 p2, float thick, Color color)
+{
+    if (isnan(p1.y) || isnan(p2.y)) return;
+    DrawLineEx(p1, p2, thick, color);
+}
+
+SignalLayout signal_layout(const OscData *oscData, float osc_width)
 {
-    Color channel_colors[MAX_CHANNELS] = { YELLOW, GREEN, RED, BLUE };
+    SignalLayout l = {0};
 
     // Визначаємо, скільки точок реально можна малювати
     int pts = oscData->points_to_display;
     if (pts > oscData->valid_points) pts = oscData->valid_points;
     if (pts > oscData->history_size) pts = oscData->history_size;
-    if (pts < 2) return; // нічого малювати
+    if (pts < 2) return l; // нічого малювати
+
+    l.valid = true;
+    l.pts = pts;
+    l.reverse = oscData->reverse_signal;
+    l.base_index = oscData->movement_signal ? oscData->history_index : 0;
+
+    // Горизонтальний розподіл навколо тригера
+    if (!l.reverse) {
+        l.points_left = (int)(oscData->trigger_offset_x / osc_width * pts);
+        if (l.points_left < 1) l.points_left = 1;
+        if (l.points_left > pts - 1) l.points_left = pts - 1;
+        l.points_right = pts - l.points_left;
+        l.trigger_x_pos = oscData->trigger_offset_x;
+    } else {
+        l.points_right = (int)(oscData->trigger_offset_x / osc_width * pts);
+        if (l.points_right < 1) l.points_right = 1;
+        if (l.points_right > pts - 1) l.points_right = pts - 1;
+        l.points_left = pts - l.points_right;
+        l.trigger_x_pos = osc_width - oscData->trigger_offset_x;
+    }
+
+    int total_points = l.points_left + l.points_right;
+    if (total_points > pts) total_points = pts;
+    l.x_step = osc_width / (float)(total_points - 1);
+    return l;
+}
+
+// Відповідність "зсув ↔ X" повторює цикли draw_signal(): праворуч від тригера точка j
+// має зсув j, ліворуч — зсув -1 - j (обидві гілки сходяться на trigger_x_pos).
+// У реверсі праві точки йдуть від points_right - 1 до 0, ліві — від -points_left.
+int signal_x_to_offset(const SignalLayout *layout, float x)
+{
+    if (!layout->valid) return 0;
+
+    int j = (int)((x >= layout->trigger_x_pos ? x - layout->trigger_x_pos
+                                              : layout->trigger_x_pos - x) / layout->x_step + 0.5f);
+    int offset;
+    if (!layout->reverse) {
+        offset = (x >= layout->trigger_x_pos) ? j : -1 - j;
+    } else {
+        offset = (x >= layout->trigger_x_pos) ? layout->points_right - 1 - j
+                                              : -layout->points_left + j;
+    }
+
+    if (offset < -layout->points_left) offset = -layout->points_left;
+    if (offset > layout->points_right - 1) offset = layout->points_right - 1;
+    return offset;
+}
+
+float signal_offset_to_x(const SignalLayout *layout, int offset)
+{
+    if (!layout->reverse) {
+        return (offset >= 0) ? layout->trigger_x_pos + offset * layout->x_step
+                             : layout->trigger_x_pos + (offset + 1) * layout->x_step;
+    }
+    return (offset >= 0) ? layout->trigger_x_pos + (layout->points_right - 1 - offset) * layout->x_step
+                         : layout->trigger_x_pos - (offset + layout->points_left) * layout->x_step;
+}
+
+int signal_offset_to_index(const OscData *oscData, const SignalLayout *layout, int channel, int offset)
+{
+    int size = oscData->history_size;
+    int idx = (layout->base_index + oscData->channels[channel].trigger_index + offset) % size;
+    return idx < 0 ? idx + size : idx;
+}
+
+void draw_signal(OscData *oscData, float osc_width, float lineThickness)
+{
+    Color channel_colors[MAX_CHANNELS] = CHANNEL_COLORS;
+
+    SignalLayout layout = signal_layout(oscData, osc_width);
+    if (!layout.valid) return; // нічого малювати
+    int pts = layout.pts;
 
     for (int i = 0; i < MAX_CHANNELS; i++) {
         ChannelSettings *ch = &oscData->channels[i];
         if (!ch->active || ch->channel_history == NULL) continue;
 
-        int history_index = oscData->history_index;
-        if (!oscData->movement_signal) history_index = 0;
+        int history_index = layout.base_index;
 
         // Горизонтальний розподіл навколо тригера
-        int points_left, points_right;
-        float trigger_x_pos;
-
-        if (!oscData->reverse_signal) {
-            points_left = (int)(oscData->trigger_offset_x / osc_width * pts);
-            if (points_left < 1) points_left = 1;
-            if (points_left > pts - 1) points_left = pts - 1;
-            points_right = pts - points_left;
-            trigger_x_pos = oscData->trigger_offset_x;
-        } else {
-            points_right = (int)(oscData->trigger_offset_x / osc_width * pts);
-            if (points_right < 1) points_right = 1;
-            if (points_right > pts - 1) points_right = pts - 1;
-            points_left = pts - points_right;
-            trigger_x_pos = osc_width - oscData->trigger_offset_x;
-        }
+        int points_left = layout.points_left;
+        int points_right = layout.points_right;
+        float trigger_x_pos = layout.trigger_x_pos;
 
         // Downsampling: крок для зменшення кількості ліній
         int total_points = points_left + points_right;
@@ -50,7 +118,7 @@ void draw_signal(OscData *oscData, float osc_width, float lineThickness)
         int step = (total_points > pts) ? (total_points / pts) : 1;
         if (total_points / step < 2) step = 1;
 
-        float x_step = osc_width / (float)(total_points - 1);
+        float x_step = layout.x_step;
 
         // Малюємо сигнал
         if (!oscData->reverse_signal) {
@@ -60,7 +128,7 @@ void draw_signal(OscData *oscData, float osc_width, float lineThickness)
                 int idx2 = (history_index + ch->trigger_index - points_left + j + step + oscData->history_size) % oscData->history_size;
                 Vector2 p1 = { trigger_x_pos - (points_left - 1 - j) * x_step, ch->offset_y - ch->channel_history[idx1] * ch->scale_y };
                 Vector2 p2 = { trigger_x_pos - (points_left - 1 - (j + step)) * x_step, ch->offset_y - ch->channel_history[idx2] * ch->scale_y };
-                DrawLineEx(p1, p2, lineThickness, channel_colors[i]);
+                draw_trace_segment(p1, p2, lineThickness, channel_colors[i]);
             }
             // Права частина (після тригера)
             for (int j = 0; j < points_right - step && points_left + j + step < oscData->valid_points; j += step) {
@@ -68,7 +136,7 @@ void draw_signal(OscData *oscData, float osc_width, float lineThickness)
                 int idx2 = (history_index + ch->trigger_index + j + step) % oscData->history_size;
                 Vector2 p1 = { trigger_x_pos + j * x_step, ch->offset_y - ch->channel_history[idx1] * ch->scale_y };
                 Vector2 p2 = { trigger_x_pos + (j + step) * x_step, ch->offset_y - ch->channel_history[idx2] * ch->scale_y };
-                DrawLineEx(p1, p2, lineThickness, channel_colors[i]);
+                draw_trace_segment(p1, p2, lineThickness, channel_colors[i]);
             }
         } else {
             // Реверс: малюємо справа наліво
@@ -77,16 +145,18 @@ void draw_signal(OscData *oscData, float osc_width, float lineThickness)
                 int idx2 = (history_index + ch->trigger_index + points_right - 1 - (j + step)) % oscData->history_size;
                 Vector2 p1 = { trigger_x_pos + j * x_step, ch->offset_y - ch->channel_history[idx1] * ch->scale_y };
                 Vector2 p2 = { trigger_x_pos + (j + step) * x_step, ch->offset_y - ch->channel_history[idx2] * ch->scale_y };
-                DrawLineEx(p1, p2, lineThickness, channel_colors[i]);
+                draw_trace_segment(p1, p2, lineThickness, channel_colors[i]);
             }
             for (int j = 0; j < points_left - step && points_right + j + step < oscData->valid_points; j += step) {
                 int idx1 = (history_index + ch->trigger_index - points_left + j + oscData->history_size) % oscData->history_size;
                 int idx2 = (history_index + ch->trigger_index - points_left + j + step + oscData->history_size) % oscData->history_size;
                 Vector2 p1 = { trigger_x_pos - j * x_step, ch->offset_y - ch->channel_history[idx1] * ch->scale_y };
                 Vector2 p2 = { trigger_x_pos - (j + step) * x_step, ch->offset_y - ch->channel_history[idx2] * ch->scale_y };
-                DrawLineEx(p1, p2, lineThickness, channel_colors[i]);
+                draw_trace_segment(p1, p2, lineThickness, channel_colors[i]);
             }
         }
     }
-}
 
+    // Підписи декодованих кадрів поверх сигналу
+    draw_decode_overlay(oscData, &layout);
+}
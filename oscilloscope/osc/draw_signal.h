@@ -5,6 +5,29 @@
 
 #include "main.h"
 
+// Розкладка точок сигналу по горизонталі навколо тригера — спільна для малювання і курсорів
+typedef struct {
+    bool valid;          // false, якщо точок для малювання менше двох
+    int pts;             // Кількість точок на екрані
+    int points_left;     // Точок ліворуч від тригера
+    int points_right;    // Точок праворуч від тригера
+    int base_index;      // Зсув початку вікна в кільцевому буфері (history_index або 0)
+    float trigger_x_pos; // Позиція тригера по X (пікселі)
+    float x_step;        // Відстань між сусідніми точками (пікселі)
+    bool reverse;        // Малювання справа наліво
+} SignalLayout;
+
+SignalLayout signal_layout(const OscData *oscData, float osc_width);
+
+// Зсув у семплах відносно точки тригера для координати X (найближчий семпл, O(1))
+int signal_x_to_offset(const SignalLayout *layout, float x);
+
+// Координата X семпла з зсувом offset відносно тригера
+float signal_offset_to_x(const SignalLayout *layout, int offset);
+
+// Індекс у кільцевому буфері каналу для зсуву offset відносно його тригера
+int signal_offset_to_index(const OscData *oscData, const SignalLayout *layout, int channel, int offset);
+
 void draw_signal(OscData *oscData, float osc_width, float lineThickness);
 
 #endif // DRAW_SIGNAL_H
@@ -0,0 +1,102 @@
+// file draw_spectrum.c
+
+#include "draw_spectrum.h"
+#include "spectrum.h"
+#include "glyphs.h"
+
+#include "raylib.h"
+#include <stdio.h>
+
+#define SPECTRUM_TOP_DB 10.0f      // Верхня межа шкали (дБВ)
+#define SPECTRUM_RANGE_DB 120.0f   // Динамічний діапазон шкали
+#define SPECTRUM_MAX_COLUMNS 2048
+
+extern int spacing;
+extern int padding;
+extern int borderThickness;
+
+static const char *averaging_name(SpectrumAveraging a)
+{
+    switch (a) {
+        case SPECTRUM_AVG_LINEAR: return "Linear";
+        case SPECTRUM_AVG_EXPONENTIAL: return "Exp";
+        case SPECTRUM_AVG_PEAK_HOLD: return "Peak hold";
+        default: return "Off";
+    }
+}
+
+// Підпис частоти з автоматичним вибором одиниць
+static const char *format_frequency(float hz)
+{
+    if (hz >= 1e6f) return TextFormat("%.2fMHz", hz / 1e6f);
+    if (hz >= 1e3f) return TextFormat("%.2fkHz", hz / 1e3f);
+    return TextFormat("%.1fHz", hz);
+}
+
+void draw_spectrum(OscData *oscData, Rectangle area, RasterFont font)
+{
+    Color channel_colors[MAX_CHANNELS] = CHANNEL_TEXT_COLORS;
+    SpectrumAnalyzer *sa = &oscData->spectrum;
+
+    DrawRectangleRec(area, Fade(BLACK, 0.85f));
+    DrawRectangleLinesEx(area, 1, DARKGRAY);
+
+    // Горизонтальні лінії сітки кожні 20 дБ
+    for (float db = SPECTRUM_TOP_DB; db >= SPECTRUM_TOP_DB - SPECTRUM_RANGE_DB; db -= 20.0f) {
+        float y = area.y + (SPECTRUM_TOP_DB - db) / SPECTRUM_RANGE_DB * area.height;
+        DrawLine(area.x, y, area.x + area.width, y, Fade(DARKGRAY, 0.8f));
+        DrawTextScaled(font, area.x + 4, y + 2, TextFormat("%.0f dBV", db), spacing, 1, GRAY);
+    }
+
+    const char *header = TextFormat("FFT CH%d  N=%d  %s  Avg: %s", oscData->active_channel + 1,
+                                    sa->fft_size, fft_window_name(sa->window), averaging_name(sa->averaging));
+
+    if (!spectrum_fetch(sa)) {
+        DrawTextScaled(font, area.x + 80, area.y + 4, TextFormat("%s  (очікування даних)", header),
+                       spacing, 1, LIGHTGRAY);
+        return;
+    }
+
+    if (sa->view_size != sa->fft_size)
+        header = TextFormat("%s (фактично %d)", header, sa->view_size);
+    DrawTextScaled(font, area.x + 80, area.y + 4, header, spacing, 1, LIGHTGRAY);
+
+    // На кожну колонку пікселів — максимум бінів, що в неї потрапляють (пікове проріджування)
+    int columns = (int)area.width;
+    if (columns > SPECTRUM_MAX_COLUMNS) columns = SPECTRUM_MAX_COLUMNS;
+    if (columns < 2) return;
+
+    Color color = channel_colors[oscData->active_channel];
+    float bins_per_column = (float)sa->view_bins / columns;
+    Vector2 prev = {0};
+
+    for (int c = 0; c < columns; c++) {
+        int b0 = (int)(c * bins_per_column);
+        int b1 = (int)((c + 1) * bins_per_column);
+        if (b1 <= b0) b1 = b0 + 1;
+        if (b1 > sa->view_bins) b1 = sa->view_bins;
+
+        float peak = SPECTRUM_FLOOR_DB;
+        for (int b = b0; b < b1; b++) if (sa->view_db[b] > peak) peak = sa->view_db[b];
+
+        float norm = (SPECTRUM_TOP_DB - peak) / SPECTRUM_RANGE_DB;
+        if (norm < 0.0f) norm = 0.0f;
+        if (norm > 1.0f) norm = 1.0f;
+
+        Vector2 p = { area.x + c * area.width / columns, area.y + norm * area.height };
+        if (c > 0) DrawLineEx(prev, p, 1.0f, color);
+        prev = p;
+    }
+
+    // Підписи частот: у герцах, якщо частота дискретизації відома, інакше — номер біна
+    for (int t = 1; t <= 4; t++) {
+        float fx = area.x + area.width * t / 5.0f;
+        float frac = t / 5.0f;
+        const char *label = (sa->view_rate > 0.0f)
+                          ? format_frequency(frac * sa->view_rate / 2.0f)
+                          : TextFormat("bin %d", (int)(frac * (sa->view_bins - 1)));
+        DrawLine(fx, area.y + area.height - 6, fx, area.y + area.height, GRAY);
+        DrawTextWithAutoInvertedBackground(font, fx - 20, area.y + area.height - font.glyph_height - 12,
+                                           label, spacing, 1, LIGHTGRAY, padding, borderThickness);
+    }
+}
@@ -0,0 +1,12 @@
+// file draw_spectrum.h
+
+#ifndef DRAW_SPECTRUM_H
+#define DRAW_SPECTRUM_H
+
+#include "main.h"
+#include "all_font.h" // Опис шрифтів як структури RasterFont
+
+// Малює логарифмічний спектр (дБВ) останнього готового результату у вказаній області
+void draw_spectrum(OscData *oscData, Rectangle area, RasterFont font);
+
+#endif // DRAW_SPECTRUM_H
@@ -0,0 +1,101 @@
+// file draw_telemetry.c
+
+#include "draw_telemetry.h"
+#include "telemetry.h"
+#include "firmware_profile.h"
+#include "glyphs.h"
+
+#include "raylib.h"
+#include <stdio.h>
+
+extern int spacing;
+extern int padding;
+extern int borderThickness;
+
+#define TELEMETRY_HUD_LINES (6 + TELEMETRY_STAGE_COUNT)
+
+static void hud_line(RasterFont font, int x, int *y, const char *text)
+{
+    DrawTextWithAutoInvertedBackground(font, x, *y, text, spacing, 1, WHITE, padding, borderThickness);
+    *y += font.glyph_height + 2 * padding + 2;
+}
+
+void draw_telemetry_hud(const OscData *oscData, int x, int bottom, RasterFont font)
+{
+    const Telemetry *t = &oscData->telemetry;
+    DeviceSet *set = (DeviceSet*)&oscData->devices;
+    bool bulk = oscData->transport != USB_TRANSPORT_TTY;
+    const ControlLink *c = &oscData->control;
+    FirmwareProfile fw = c->profile && c->stat_sweeps > 0 ? firmware_profile(c->stats) : (FirmwareProfile){0};
+    int fw_lines = fw.valid ? 1 + CTRL_PROF_SECTIONS : 0;
+    int y = bottom - (TELEMETRY_HUD_LINES + set->count + bulk + fw_lines) * (font.glyph_height + 2 * padding + 2);
+
+    // Кожен рядок малюється одразу: TextFormat повертає один з кількох кільцевих буферів
+    hud_line(font, x, &y, TextFormat("RX %.1f kB/s  %.0f pkt/s  %.1f fps  polls %llu (empty %llu, budget %llu)",
+                                     t->bytes_per_s / 1000.0, t->packets_per_s, t->frames_per_s,
+                                     t->polls, t->empty_polls, t->budget_hits));
+    hud_line(font, x, &y, TextFormat("bad %llu  resync %llu (%llu B lost)  total %llu pkt / %.1f MB%s",
+                                     t->bad_packets, t->resyncs, t->resync_bytes, t->packets, t->bytes / 1048576.0,
+                                     t->delta_blocks ? TextFormat("  delta x%.2f", telemetry_delta_ratio(t)) : ""));
+    hud_line(font, x, &y, TextFormat("seq gaps %llu  lost %llu (%.4f%%)  dup %llu  err %llu  restart %llu  fill %s",
+                                     t->seq_gaps, t->seq_lost, telemetry_loss_ratio(t) * 100.0,
+                                     t->seq_duplicates, t->seq_errors, t->seq_restarts,
+                                     gap_mode_name(oscData->gap_mode)));
+    const EtsComposite *ets = &oscData->ets;
+    hud_line(font, x, &y, TextFormat("history %.0f%% of %d  rec queue %d/%d  rec drop %llu  adc %d bit%s",
+                                     telemetry_history_fill(oscData) * 100.0f, oscData->history_size,
+                                     telemetry_recorder_queue(oscData), REC_QUEUE_DEPTH,
+                                     oscData->recorder.dropped_chunks, 12 + oscData->adc_extra_bits,
+                                     ets->active ? TextFormat("  ets x%d %.2f MS/s sweeps %llu", ets->steps,
+                                                              ets_rate_hz(ets) / 1e6, ets->sweeps) : ""));
+    DeviceClock clock = device_time_clock(&oscData->device_time);
+    hud_line(font, x, &y, TextFormat("latency sample->frame %.1f ms  avg %.1f  max %.1f  clock %s",
+                                     t->latency_ms, t->latency_avg_ms, t->latency_max_ms,
+                                     clock.valid ? TextFormat("board %+.1f ppm", clock.drift_ppm) : "arrival"));
+    hud_line(font, x, &y, TextFormat("ctrl req %llu  ack %llu  nak %llu  retry %llu  timeout %llu  bad %llu  rtt %.1f ms%s",
+                                     c->requests, c->acks, c->naks, c->retries, c->timeouts, c->bad_frames,
+                                     c->rtt_ms, c->busy ? "  (waiting)" : ""));
+
+    // Профіль прошивки за останнє вікно плати: завантаження і запас до найвищої частоти сканів
+    if (fw.valid) {
+        hud_line(font, x, &y, TextFormat("fw window %u  busy %.1f%%  %.0f scans/s (max %.0f)  %.0f pkt/s  "
+                                         "tx busy %u  rx ovf %u  pma ovr %u  usb err %u",
+                                         fw.window, fw.busy * 100.0, fw.scans_per_s, fw.sustainable_scans_per_s,
+                                         fw.packets_per_s, fw.tx_busy, fw.rx_overflows, fw.pma_overruns,
+                                         fw.usb_errors));
+        for (int s = 0; s < CTRL_PROF_SECTIONS; s++) {
+            const FirmwareSection *f = &fw.sections[s];
+            hud_line(font, x, &y, TextFormat("fw %-11s %5.1f%%  n %7u  avg %8.2f us  max %8.2f us  hist %u/%u/%u/%u/%u/%u",
+                                             control_prof_section_name(s), f->load * 100.0, f->count, f->avg_us,
+                                             f->max_us, f->hist[0], f->hist[1], f->hist[2], f->hist[3],
+                                             f->hist[4], f->hist[5]));
+        }
+    }
+
+    // Черга URB: байти на URB — середній розмір пакета, drop — головний потік відстав на ціле кільце
+    if (bulk) {
+        const UsbBulk *b = &oscData->usb_bulk;
+        hud_line(font, x, &y, TextFormat("%s  %d URB x %d B  done %llu  short %llu  err %llu  avg %.0f B/URB  drop %llu B",
+                                         usb_transport_name(oscData->transport), USB_BULK_URBS, USB_BULK_URB_BYTES,
+                                         b->urbs_completed, b->urbs_short, b->urb_errors,
+                                         b->urbs_completed ? (double)t->bytes / b->urbs_completed : 0.0,
+                                         b->ring_dropped));
+    }
+
+    // Плати: частота і зсув годинника відносно опорної, втрати при прийомі і при об'єднанні
+    DeviceClock ref = set->count > 0 ? devices_clock(&set->devices[0]) : (DeviceClock){0};
+    for (int d = 0; d < set->count; d++) {
+        Device *dev = &set->devices[d];
+        DeviceClock c = devices_clock(dev);
+        hud_line(font, x, &y, TextFormat("board %d %s  %.1f S/s  skew %+.2f ms  pkt %llu  lost %llu  merge gaps %llu  %s",
+                                         d + 1, dev->name, c.valid ? 1.0 / c.period : 0.0,
+                                         c.valid && ref.valid ? (c.offset - ref.offset) * 1000.0 : 0.0,
+                                         dev->packets, dev->seq_lost, dev->merge_gaps,
+                                         c.timestamped ? TextFormat("ts %+.1f ppm", c.drift_ppm) : "arrival"));
+    }
+    for (int i = 0; i < TELEMETRY_STAGE_COUNT; i++) {
+        const StageTiming *s = &t->stages[i];
+        hud_line(font, x, &y, TextFormat("%-8s %6.2f ms  avg %6.2f  max %6.2f",
+                                         telemetry_stage_name((TelemetryStage)i), s->last_ms, s->avg_ms, s->max_ms));
+    }
+}
@@ -0,0 +1,12 @@
+// file draw_telemetry.h
+
+#ifndef DRAW_TELEMETRY_H
+#define DRAW_TELEMETRY_H
+
+#include "main.h"
+#include "all_font.h" // Опис шрифтів як структури RasterFont
+
+// Панель телеметрії конвеєра з лівим нижнім кутом у (x, bottom)
+void draw_telemetry_hud(const OscData *oscData, int x, int bottom, RasterFont font);
+
+#endif // DRAW_TELEMETRY_H
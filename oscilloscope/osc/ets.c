@@ -0,0 +1,44 @@
+// file ets.c
+
+#include "ets.h"
+#include "parse_data.h"
+#include <string.h>
+
+void ets_reset(EtsComposite *e)
+{
+    memset(e, 0, sizeof(*e));
+    e->history_start = -1;
+}
+
+int ets_on_capture(EtsComposite *e, const SamplePacket *packet)
+{
+    if (packet->ets_steps > ETS_STEPS_MAX || packet->ets_step >= packet->ets_steps) return 0;
+
+    // Точки з іншим кроком чи набором каналів не складаються з уже зібраними
+    if (!e->active || packet->ets_steps != e->steps || packet->ets_step_cycles != e->step_cycles ||
+        packet->scans != e->scans || packet->mask != e->mask || packet->extra_bits != e->extra_bits) {
+        if (e->active) e->restarts++;
+        e->active = true;
+        e->steps = packet->ets_steps;
+        e->step_cycles = packet->ets_step_cycles;
+        e->scans = packet->scans;
+        e->mask = packet->mask;
+        e->extra_bits = packet->extra_bits;
+        e->filled = 0;
+    }
+
+    for (int s = 0; s < packet->scans; s++)
+        memcpy(e->points[s * e->steps + packet->ets_step], packet->values[s], sizeof(e->points[0]));
+    e->filled |= 1ull << packet->ets_step;
+    e->captures++;
+
+    uint64_t all = e->steps == 64 ? ~0ull : (1ull << e->steps) - 1;
+    if (packet->ets_step != e->steps - 1 || e->filled != all) return 0;
+    e->sweeps++;
+    return e->scans * e->steps;
+}
+
+double ets_rate_hz(const EtsComposite *e)
+{
+    return e->active ? PACKET_ETS_CLOCK_HZ / e->step_cycles : 0.0;
+}
@@ -0,0 +1,42 @@
+// file ets.h
+
+#ifndef ETS_H
+#define ETS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sequence.h"
+
+#define ETS_STEPS_MAX 64                               // CTRL_ETS_STEPS_MAX
+#define ETS_POINTS_MAX (ETS_STEPS_MAX * PACKET_SCANS_MAX)
+
+// Крива в еквівалентному часі із захоплень 0xAF (CTRL_PARAM_ETS_STEPS). Захоплення з кроком step
+// містить скани через step * step_cycles + i * steps * step_cycles тактів після фронту, тож
+// його скан i — точка i * steps + step кривої з кроком step_cycles. Крива готова, коли прийшов
+// останній крок і всі кроки вже є: втрачене захоплення лишає в кривій попереднє того ж кроку
+typedef struct {
+    bool active;                 // Плата надсилає захоплення, а не безперервний потік
+    uint8_t mask;
+    uint8_t extra_bits;
+    uint8_t steps;
+    uint8_t step_cycles;
+    int scans;                   // Сканів у захопленні
+    uint64_t filled;             // Біт step — захоплення цього кроку вже в кривій
+    int16_t points[ETS_POINTS_MAX][SEQ_CHANNELS];
+    int history_start;           // Індекс історії першої точки останньої кривої (мить фронту), -1 — ще немає
+
+    unsigned long long captures; // Прийнято захоплень
+    unsigned long long sweeps;   // Видано кривих
+    unsigned long long restarts; // Крива почалась заново: інші кроки, маска чи роздільність
+} EtsComposite;
+
+void ets_reset(EtsComposite *e);
+
+// Захоплення (packet->ets_steps > 1) лягає в криву. Повертає кількість точок кривої,
+// якщо вона готова, інакше 0
+int ets_on_capture(EtsComposite *e, const SamplePacket *packet);
+
+// Частота точок кривої, Гц; 0 — захоплень немає
+double ets_rate_hz(const EtsComposite *e);
+
+#endif // ETS_H
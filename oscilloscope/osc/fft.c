@@ -0,0 +1,273 @@
+// file fft.c
+//
+// Швидке перетворення Фур'є для спектроаналізатора.
+// Ядро — ітеративний радікс-4 DIT на розділених масивах re/im (з одним радікс-2
+// етапом, якщо log2 розміру непарний). Поворотні множники кожного етапу лежать
+// суцільними масивами, тож внутрішній цикл обробляє по 4 точки векторами GCC
+// (SSE/NEON) без залежності від рівня оптимізації збірки.
+// Дійсний сигнал довжини n перетворюється через комплексне ППФ довжини n/2.
+
+#include "fft.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define FFT_PI 3.14159265358979323846
+
+typedef float v4f __attribute__((vector_size(16)));
+
+static inline v4f load4(const float *p)
+{
+    v4f v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store4(float *p, v4f v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static int ilog2(int n)
+{
+    int l = 0;
+    while ((1 << l) < n) l++;
+    return l;
+}
+
+const char *fft_window_name(FftWindow window)
+{
+    switch (window) {
+        case FFT_WINDOW_HANN: return "Hann";
+        case FFT_WINDOW_BLACKMAN: return "Blackman";
+        case FFT_WINDOW_FLATTOP: return "Flat-top";
+        default: return "Rect";
+    }
+}
+
+static void fill_window(float *w, int n, FftWindow window)
+{
+    for (int i = 0; i < n; i++) {
+        double x = 2.0 * FFT_PI * i / n; // періодичне (DFT-even) вікно
+        switch (window) {
+            case FFT_WINDOW_HANN:
+                w[i] = (float)(0.5 - 0.5 * cos(x));
+                break;
+            case FFT_WINDOW_BLACKMAN:
+                w[i] = (float)(0.42 - 0.5 * cos(x) + 0.08 * cos(2.0 * x));
+                break;
+            case FFT_WINDOW_FLATTOP:
+                w[i] = (float)(0.21557895 - 0.41663158 * cos(x) + 0.277263158 * cos(2.0 * x)
+                               - 0.083578947 * cos(3.0 * x) + 0.006947368 * cos(4.0 * x));
+                break;
+            default:
+                w[i] = 1.0f;
+                break;
+        }
+    }
+}
+
+FftPlan *fft_plan_create(int n, FftWindow window)
+{
+    if (n < FFT_MIN_SIZE || n > FFT_MAX_SIZE || (n & (n - 1)) != 0) return NULL;
+
+    FftPlan *plan = (FftPlan*)calloc(1, sizeof(FftPlan));
+    if (!plan) return NULL;
+
+    int half = n / 2;
+    int bits = ilog2(half);
+    plan->n = n;
+    plan->half = half;
+    plan->window = window;
+
+    plan->win = (float*)malloc(n * sizeof(float));
+    plan->bitrev = (int*)malloc(half * sizeof(int));
+    plan->tw_re = (float*)malloc(3 * half * sizeof(float)); // сума 3h по етапах < 3 * half
+    plan->tw_im = (float*)malloc(3 * half * sizeof(float));
+    plan->post_re = (float*)malloc(half * sizeof(float));
+    plan->post_im = (float*)malloc(half * sizeof(float));
+    plan->re = (float*)malloc(half * sizeof(float));
+    plan->im = (float*)malloc(half * sizeof(float));
+    if (!plan->win || !plan->bitrev || !plan->tw_re || !plan->tw_im ||
+        !plan->post_re || !plan->post_im || !plan->re || !plan->im) {
+        fft_plan_destroy(plan);
+        return NULL;
+    }
+
+    fill_window(plan->win, n, window);
+    plan->win_sum = 0.0f;
+    for (int i = 0; i < n; i++) plan->win_sum += plan->win[i];
+
+    for (int i = 0; i < half; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++)
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        plan->bitrev[i] = r;
+    }
+
+    // Поворотні множники радікс-4 етапів: W^k, W^2k, W^3k, W = exp(-2πi / 4h)
+    int offset = 0;
+    for (int h = (bits & 1) ? 2 : 1; 4 * h <= half; h *= 4) {
+        for (int m = 1; m <= 3; m++) {
+            for (int k = 0; k < h; k++) {
+                double a = -2.0 * FFT_PI * m * k / (4.0 * h);
+                plan->tw_re[offset + (m - 1) * h + k] = (float)cos(a);
+                plan->tw_im[offset + (m - 1) * h + k] = (float)sin(a);
+            }
+        }
+        offset += 3 * h;
+    }
+
+    for (int k = 0; k < half; k++) {
+        double a = -2.0 * FFT_PI * k / n;
+        plan->post_re[k] = (float)cos(a);
+        plan->post_im[k] = (float)sin(a);
+    }
+
+    return plan;
+}
+
+void fft_plan_destroy(FftPlan *plan)
+{
+    if (!plan) return;
+    free(plan->win);
+    free(plan->bitrev);
+    free(plan->tw_re);
+    free(plan->tw_im);
+    free(plan->post_re);
+    free(plan->post_im);
+    free(plan->re);
+    free(plan->im);
+    free(plan);
+}
+
+// Один радікс-4 метелик для точок k, k+h, k+2h, k+3h блоку (скалярний варіант)
+static inline void butterfly4(float *re, float *im, int i0, int h,
+                              float w1r, float w1i, float w2r, float w2i, float w3r, float w3i)
+{
+    int i1 = i0 + h, i2 = i0 + 2 * h, i3 = i0 + 3 * h;
+
+    // Вхідна впорядкованість після радікс-2 бітової інверсії: x1 множиться на W^2k, x2 на W^k
+    float t1r = re[i1] * w2r - im[i1] * w2i, t1i = re[i1] * w2i + im[i1] * w2r;
+    float t2r = re[i2] * w1r - im[i2] * w1i, t2i = re[i2] * w1i + im[i2] * w1r;
+    float t3r = re[i3] * w3r - im[i3] * w3i, t3i = re[i3] * w3i + im[i3] * w3r;
+
+    float ar = re[i0] + t1r, ai = im[i0] + t1i;
+    float br = re[i0] - t1r, bi = im[i0] - t1i;
+    float cr = t2r + t3r, ci = t2i + t3i;
+    float dr = t2r - t3r, di = t2i - t3i;
+
+    re[i0] = ar + cr; im[i0] = ai + ci;
+    re[i2] = ar - cr; im[i2] = ai - ci;
+    re[i1] = br + di; im[i1] = bi - dr;   // (x0 - t1) - i(t2 - t3)
+    re[i3] = br - di; im[i3] = bi + dr;   // (x0 - t1) + i(t2 - t3)
+}
+
+// Той самий метелик для чотирьох сусідніх k одночасно
+static inline void butterfly4_v(float *re, float *im, int i0, int h,
+                                const float *w1r, const float *w1i,
+                                const float *w2r, const float *w2i,
+                                const float *w3r, const float *w3i)
+{
+    int i1 = i0 + h, i2 = i0 + 2 * h, i3 = i0 + 3 * h;
+
+    v4f x0r = load4(re + i0), x0i = load4(im + i0);
+    v4f x1r = load4(re + i1), x1i = load4(im + i1);
+    v4f x2r = load4(re + i2), x2i = load4(im + i2);
+    v4f x3r = load4(re + i3), x3i = load4(im + i3);
+    v4f a1r = load4(w1r), a1i = load4(w1i);
+    v4f a2r = load4(w2r), a2i = load4(w2i);
+    v4f a3r = load4(w3r), a3i = load4(w3i);
+
+    v4f t1r = x1r * a2r - x1i * a2i, t1i = x1r * a2i + x1i * a2r;
+    v4f t2r = x2r * a1r - x2i * a1i, t2i = x2r * a1i + x2i * a1r;
+    v4f t3r = x3r * a3r - x3i * a3i, t3i = x3r * a3i + x3i * a3r;
+
+    v4f ar = x0r + t1r, ai = x0i + t1i;
+    v4f br = x0r - t1r, bi = x0i - t1i;
+    v4f cr = t2r + t3r, ci = t2i + t3i;
+    v4f dr = t2r - t3r, di = t2i - t3i;
+
+    store4(re + i0, ar + cr); store4(im + i0, ai + ci);
+    store4(re + i2, ar - cr); store4(im + i2, ai - ci);
+    store4(re + i1, br + di); store4(im + i1, bi - dr);
+    store4(re + i3, br - di); store4(im + i3, bi + dr);
+}
+
+void fft_complex_forward(FftPlan *plan, float *re, float *im)
+{
+    int half = plan->half;
+
+    // Перестановка з бітовою інверсією
+    for (int i = 0; i < half; i++) {
+        int j = plan->bitrev[i];
+        if (j > i) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    int h = 1;
+    if (ilog2(half) & 1) {
+        // Непарний степінь: один радікс-2 етап без множень
+        for (int i = 0; i < half; i += 2) {
+            float ur = re[i], ui = im[i];
+            re[i] = ur + re[i + 1]; im[i] = ui + im[i + 1];
+            re[i + 1] = ur - re[i + 1]; im[i + 1] = ui - im[i + 1];
+        }
+        h = 2;
+    }
+
+    int offset = 0;
+    for (; 4 * h <= half; h *= 4) {
+        const float *w1r = plan->tw_re + offset, *w1i = plan->tw_im + offset;
+        const float *w2r = w1r + h, *w2i = w1i + h;
+        const float *w3r = w2r + h, *w3i = w2i + h;
+
+        for (int base = 0; base < half; base += 4 * h) {
+            int k = 0;
+            for (; k + 4 <= h; k += 4)
+                butterfly4_v(re, im, base + k, h, w1r + k, w1i + k, w2r + k, w2i + k, w3r + k, w3i + k);
+            for (; k < h; k++)
+                butterfly4(re, im, base + k, h, w1r[k], w1i[k], w2r[k], w2i[k], w3r[k], w3i[k]);
+        }
+        offset += 3 * h;
+    }
+}
+
+void fft_power_spectrum(FftPlan *plan, const float *input, float *power)
+{
+    int half = plan->half;
+    float *re = plan->re, *im = plan->im;
+    const float *w = plan->win;
+
+    // Упаковка парних/непарних відліків у комплексний сигнал довжини n/2
+    for (int m = 0; m < half; m++) {
+        re[m] = input[2 * m] * w[2 * m];
+        im[m] = input[2 * m + 1] * w[2 * m + 1];
+    }
+
+    fft_complex_forward(plan, re, im);
+
+    float norm = 1.0f / (plan->win_sum * plan->win_sum);
+
+    // Постійна складова і частота Найквіста
+    float dc = re[0] + im[0];
+    float nyq = re[0] - im[0];
+    power[0] = dc * dc * norm;
+    power[half] = nyq * nyq * norm;
+
+    // Розділення спектра: X[k] = E[k] + W^k O[k]
+    for (int k = 1; k < half; k++) {
+        float zr = re[k], zi = im[k];
+        float cr = re[half - k], ci = -im[half - k]; // conj(Z[half - k])
+
+        float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+        // O = -i (Z - conj) / 2
+        float or_ = 0.5f * (zi - ci), oi = -0.5f * (zr - cr);
+
+        float xr = er + plan->post_re[k] * or_ - plan->post_im[k] * oi;
+        float xi = ei + plan->post_re[k] * oi + plan->post_im[k] * or_;
+        power[k] = 2.0f * (xr * xr + xi * xi) * norm;
+    }
+}
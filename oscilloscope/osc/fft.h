@@ -0,0 +1,51 @@
+// file fft.h
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdbool.h>
+
+#define FFT_MIN_SIZE 256
+#define FFT_MAX_SIZE 65536
+
+// Вікна для зменшення розтікання спектра
+typedef enum {
+    FFT_WINDOW_RECT = 0,
+    FFT_WINDOW_HANN,
+    FFT_WINDOW_BLACKMAN,
+    FFT_WINDOW_FLATTOP,
+    FFT_WINDOW_COUNT
+} FftWindow;
+
+// План перетворення дійсного сигналу довжини n: усе, що не залежить від даних,
+// обчислюється один раз і перевикористовується між кадрами
+typedef struct {
+    int n;              // Розмір дійсного перетворення (степінь двійки)
+    int half;           // n / 2 — розмір комплексного перетворення всередині
+    FftWindow window;
+    float *win;         // Коефіцієнти вікна (n)
+    float win_sum;      // Сума коефіцієнтів вікна (когерентне підсилення)
+    int *bitrev;        // Таблиця бітової інверсії для half
+    float *tw_re;       // Поворотні множники радікс-4 етапів, по три масиви на етап
+    float *tw_im;
+    float *post_re;     // Множники W_n^k для розділення спектра дійсного сигналу (half)
+    float *post_im;
+    float *re;          // Робочі буфери (half)
+    float *im;
+} FftPlan;
+
+// Створює план; повертає NULL, якщо n не степінь двійки в межах FFT_MIN_SIZE..FFT_MAX_SIZE
+FftPlan *fft_plan_create(int n, FftWindow window);
+void fft_plan_destroy(FftPlan *plan);
+
+// Назва вікна для відображення
+const char *fft_window_name(FftWindow window);
+
+// Спектр потужності дійсного сигналу input (n значень) з накладанням вікна.
+// power отримує n/2 + 1 значень, нормованих так, що синус амплітуди A дає A^2/2 (Vrms^2).
+void fft_power_spectrum(FftPlan *plan, const float *input, float *power);
+
+// Комплексне пряме перетворення in-place розміру plan->half (для перевірки ядра)
+void fft_complex_forward(FftPlan *plan, float *re, float *im);
+
+#endif // FFT_H
@@ -1,38 +1,210 @@
-// file find_usb_device.h
+// file find_usb_device.c
 
 #include "main.h"
 #include "rs232.h"
 #include "find_usb_device.h"
+#include "usb_discovery.h"
+#include "usb_bulk.h"
+#include "telemetry.h"
 #include <stdint.h>
 
-void find_usb_device(OscData *oscData)
+int usb_port_for_path(const char *path, int custom_slot)
+{
+    int port = -1;
+
+    if (strncmp(path, "/dev/", 5) == 0)
+        port = RS232_GetPortnr(path + 5);
+    if (port < 0) {
+        port = custom_slot;
+        RS232_SetPortName(port, path);
+    }
+    return port;
+}
+
+bool usb_device_connected(const OscData *oscData)
 {
-    // Автоматичне відкриття COM-порту
-    int comport_to_find = 0;
+    return oscData->comport_number >= 0 || oscData->usb_bulk.fd >= 0;
+}
+
+void usb_device_write(OscData *oscData, const uint8_t *buf, int len)
+{
+    if (oscData->comport_number >= 0)
+        RS232_SendBuf(oscData->comport_number, (unsigned char*)buf, len);
+    if (oscData->usb_bulk.fd >= 0)
+        usb_bulk_write(&oscData->usb_bulk, buf, len);
+    devices_send(&oscData->devices, buf, len); // Кілька плат: та сама команда всім
+}
+
+// Відкриває порт за шляхом (--port), наприклад псевдотермінал імітатора.
+// Шляхи з вбудованого списку бібліотеки RS-232 використовують свій номер, інші — слот USB_CUSTOM_PORT.
+// Для транспорту usbfs/sim path — вузол usbfs або потік байтів, що читається чергою URB.
+bool open_usb_device_port(OscData *oscData, const char *path)
+{
+    if (oscData->transport != USB_TRANSPORT_TTY) {
+        if (!usb_bulk_open(&oscData->usb_bulk, path, oscData->transport)) return false;
+        seq_reset(&oscData->seq);
+        device_time_reset(&oscData->device_time);
+        ets_reset(&oscData->ets);
+        snprintf(oscData->com_port_name_input, sizeof(oscData->com_port_name_input), "%s", path);
+        return true;
+    }
+
     char mode[] = {'8','N','1',0};
-    bool port_found = false;
-
-    while (comport_to_find < 38) {
-        if (RS232_OpenComport(comport_to_find, 115200, mode, 0) == 0) {
-            oscData->comport_number = comport_to_find;
-            printf("Автоматично відкрито COM порт: %d\n", oscData->comport_number);
-            port_found = true;
-            if (comport_to_find == 24) {
-                strcpy(oscData->com_port_name_input, "/dev/ttyACM0");
-            } else {
-                sprintf(oscData->com_port_name_input, "Port %d", comport_to_find);
-            }
-            break;
+    int port = usb_port_for_path(path, USB_CUSTOM_PORT);
+
+    if (RS232_OpenComport(port, 115200, mode, 0) != 0) {
+        printf("Не вдалося відкрити порт %s\n", path);
+        return false;
+    }
+
+    oscData->comport_number = port;
+    seq_reset(&oscData->seq);
+    device_time_reset(&oscData->device_time);
+    ets_reset(&oscData->ets);
+    snprintf(oscData->com_port_name_input, sizeof(oscData->com_port_name_input), "%s", path);
+    printf("Відкрито порт %s\n", path);
+    return true;
+}
+
+// Перебір вбудованого списку портів RS-232 — лише коли sysfs недоступний (Windows)
+static bool probe_usb_ports(OscData *oscData)
+{
+    char mode[] = {'8','N','1',0};
+
+    for (int port = 0; port < 38; port++) {
+        if (RS232_OpenComport(port, 115200, mode, 0) == 0) {
+            oscData->comport_number = port;
+            seq_reset(&oscData->seq); // Новий потік: номери пакетів рахуються заново
+            device_time_reset(&oscData->device_time);
+            ets_reset(&oscData->ets);
+            printf("Автоматично відкрито COM порт: %d\n", port);
+            if (port == 24) strcpy(oscData->com_port_name_input, "/dev/ttyACM0");
+            else sprintf(oscData->com_port_name_input, "Port %d", port);
+            return true;
         }
-        comport_to_find++;
-        if (comport_to_find == 37) {
-            sleep(1);
+    }
+    printf("Не вдалося автоматично відкрити жоден COM порт.\n");
+    return false;
+}
+
+// Вузол, через який читається плата: tty або usbfs
+static const char *board_path(const OscData *oscData, const UsbBoard *board)
+{
+    return oscData->transport == USB_TRANSPORT_USBFS ? board->usbfs : board->path;
+}
+
+// Відкриває першу плату з потрібним VID:PID. probe — без sysfs перебрати порти.
+static bool connect_usb_board(OscData *oscData, bool probe)
+{
+    UsbWatch *w = &oscData->usb_watch;
+    UsbBoard boards[USB_MAX_BOARDS];
+    int n = usb_scan(w, boards, USB_MAX_BOARDS);
+    if (n < 0) return probe && oscData->transport == USB_TRANSPORT_TTY && probe_usb_ports(oscData);
+
+    for (int i = 0; i < n; i++) {
+        snprintf(w->port_path, sizeof(w->port_path), "%s", board_path(oscData, &boards[i]));
+        if (open_usb_device_port(oscData, w->port_path)) {
+            w->port_node = usb_node_id(w->port_path);
+            return true;
         }
     }
+    return false;
+}
+
+void find_usb_device(OscData *oscData)
+{
+    oscData->auto_connect = true;
+    if (!connect_usb_board(oscData, true)) {
+        printf("Плату %04x:%04x не знайдено, очікування підключення\n",
+               oscData->usb_watch.vid, oscData->usb_watch.pid);
+        strcpy(oscData->com_port_name_input, "no board");
+    }
+}
+
+void usb_device_lost(OscData *oscData)
+{
+    if (!usb_device_connected(oscData)) return;
+    if (oscData->comport_number >= 0) RS232_CloseComport(oscData->comport_number);
+    usb_bulk_close(&oscData->usb_bulk);
+    printf("Зв'язок з платою %s втрачено\n", oscData->com_port_name_input);
+    oscData->comport_number = -1;
+    oscData->usb_watch.rescan = true;
+    strcpy(oscData->com_port_name_input, "no board");
+}
+
+void usb_device_service(OscData *oscData)
+{
+    if (!oscData->auto_connect) return;
+
+    UsbWatch *w = &oscData->usb_watch;
+    bool connected = usb_device_connected(oscData);
+    if (!usb_watch_poll(w, telemetry_now(), connected)) return;
+
+    if (!connected) {
+        connect_usb_board(oscData, false);
+        return;
+    }
 
-    if (!port_found) {
-        printf("Не вдалося автоматично відкрити жоден COM порт.\n");
+    // Подія hot-plug при підключеній платі: чи вона ще в sysfs і чи це той самий вузол
+    // (плату могли від'єднати й підключити знову між переглядами)
+    UsbBoard boards[USB_MAX_BOARDS];
+    int n = usb_scan(w, boards, USB_MAX_BOARDS);
+    if (n < 0) return;
+    for (int i = 0; i < n; i++)
+        if (strcmp(board_path(oscData, &boards[i]), w->port_path) == 0 && usb_node_id(w->port_path) == w->port_node)
+            return;
+    usb_device_lost(oscData);
+}
+
+// Плати стають каналами 1-4, 5-8, ... у порядку відкриття
+static void start_usb_devices(OscData *oscData)
+{
+    DeviceSet *set = &oscData->devices;
+    if (oscData->transport != USB_TRANSPORT_TTY)
+        printf("Кілька плат читаються через tty, --transport %s пропущено\n", usb_transport_name(oscData->transport));
+    if (set->count == 0) {
         strcpy(oscData->com_port_name_input, "/dev/ttyACM0");
+        return;
+    }
+
+    devices_start(set, oscData->gap_mode);
+    oscData->channel_count = set->count * DEVICE_CHANNELS;
+    for (int i = 0; i < MAX_CHANNELS; i++)
+        oscData->channels[i].active = i < oscData->channel_count;
+    snprintf(oscData->com_port_name_input, sizeof(oscData->com_port_name_input), "%d boards", set->count);
+}
+
+int open_usb_devices(OscData *oscData, const char *const *paths, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (!devices_add(&oscData->devices, paths[i], -1))
+            printf("Не вдалося відкрити порт %s\n", paths[i]);
     }
+    start_usb_devices(oscData);
+    return oscData->devices.count;
 }
 
+int find_usb_devices(OscData *oscData, int count)
+{
+    UsbWatch *w = &oscData->usb_watch;
+    UsbBoard boards[USB_MAX_BOARDS];
+    int n = usb_scan(w, boards, USB_MAX_BOARDS);
+
+    if (n >= 0) {
+        // Порядок за серійним номером: канали плати не залежать від порядку підключення
+        for (int i = 0; i < n && oscData->devices.count < count; i++) {
+            if (!devices_add(&oscData->devices, boards[i].path, -1))
+                printf("Не вдалося відкрити порт %s\n", boards[i].path);
+        }
+    } else {
+        for (int port = 0; port < 38 && oscData->devices.count < count; port++) {
+            char name[16];
+            snprintf(name, sizeof(name), "Port %d", port);
+            devices_add(&oscData->devices, port == 24 ? "/dev/ttyACM0" : name, port);
+        }
+    }
+    if (oscData->devices.count < count)
+        printf("Знайдено плат: %d з %d\n", oscData->devices.count, count);
+    start_usb_devices(oscData);
+    return oscData->devices.count;
+}
@@ -6,7 +6,33 @@
 #include "main.h"
 #include <stdint.h>
 
+#define USB_CUSTOM_PORT 0 // Слот бібліотеки RS-232 для довільного шляху (замість /dev/ttyS0)
+
+// Відкриває першу плату з VID:PID осцилографа (sysfs, без sysfs — перебір портів) і вмикає
+// автоматичне перепідключення; якщо плати немає, не чекає — її підхопить usb_device_service
 void find_usb_device(OscData *oscData);
+bool open_usb_device_port(OscData *oscData, const char *path);
+
+// Викликається щокадру: події hot-plug, перепідключення без блокування головного потоку
+void usb_device_service(OscData *oscData);
+
+// Плату відкрито: COM-порт або кінцева точка bulk (oscData->transport)
+bool usb_device_connected(const OscData *oscData);
+
+// Надсилає байти відкритій платі (або всім платам набору); без плати — нікуди
+void usb_device_write(OscData *oscData, const uint8_t *buf, int len);
+
+// Помилка читання порту: плату від'єднано
+void usb_device_lost(OscData *oscData);
+
+// Номер порту бібліотеки RS-232 для шляху: зі вбудованого списку або слот custom_slot
+// (бібліотека зберігає вказівник, тож path має жити, доки порт відкрито)
+int usb_port_for_path(const char *path, int custom_slot);
+
+// Кілька плат одночасно (oscData->devices, канали по 4 на плату): за шляхами (--port кілька разів)
+// або перші count портів, що відкрилися (--devices N). Повертає кількість відкритих плат.
+int open_usb_devices(OscData *oscData, const char *const *paths, int count);
+int find_usb_devices(OscData *oscData, int count);
 
 #endif // FIND_USB_DEVICE_H
 
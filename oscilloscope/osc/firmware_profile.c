@@ -0,0 +1,40 @@
+// file firmware_profile.c
+
+#include "firmware_profile.h"
+#include <string.h>
+
+FirmwareProfile firmware_profile(const uint32_t *stats)
+{
+    FirmwareProfile p;
+    memset(&p, 0, sizeof(p));
+    uint32_t window_cycles = stats[CTRL_STAT_WINDOW_CYCLES];
+    p.window = stats[CTRL_STAT_WINDOW];
+    p.valid = p.window > 0 && window_cycles > 0;
+    if (!p.valid)
+        return p;
+
+    p.window_s = window_cycles / CTRL_PROF_CLOCK_HZ;
+    p.scans_per_s = stats[CTRL_STAT_SCANS] / p.window_s;
+    p.packets_per_s = stats[CTRL_STAT_PACKETS] / p.window_s;
+    p.tx_busy = stats[CTRL_STAT_TX_BUSY];
+    p.rx_overflows = stats[CTRL_STAT_RX_OVERFLOWS];
+    p.pma_overruns = stats[CTRL_STAT_PMA_OVERRUNS];
+    p.usb_errors = stats[CTRL_STAT_USB_ERRORS];
+
+    for (int s = 0; s < CTRL_PROF_SECTIONS; s++) {
+        const uint32_t *src = &stats[CTRL_STAT_SECTIONS + s * CTRL_PROF_FIELDS];
+        FirmwareSection *d = &p.sections[s];
+        d->load = (double)src[CTRL_PROF_CYCLES] / window_cycles;
+        d->count = src[CTRL_PROF_COUNT];
+        d->avg_us = d->count ? src[CTRL_PROF_CYCLES] / (double)d->count / CTRL_PROF_CLOCK_HZ * 1e6 : 0.0;
+        d->max_us = src[CTRL_PROF_MAX] / CTRL_PROF_CLOCK_HZ * 1e6;
+        memcpy(d->hist, &src[CTRL_PROF_HIST], sizeof(d->hist));
+    }
+
+    // Очікування між сканами — запас; без нього ті самі скани зайняли б решту тактів вікна
+    uint32_t pace = stats[CTRL_STAT_SECTIONS + CTRL_PROF_PACE * CTRL_PROF_FIELDS + CTRL_PROF_CYCLES];
+    uint32_t work = window_cycles > pace ? window_cycles - pace : 0;
+    p.busy = (double)work / window_cycles;
+    p.sustainable_scans_per_s = work ? stats[CTRL_STAT_SCANS] * CTRL_PROF_CLOCK_HZ / work : 0.0;
+    return p;
+}
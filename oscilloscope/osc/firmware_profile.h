@@ -0,0 +1,38 @@
+// file firmware_profile.h
+
+#ifndef FIRMWARE_PROFILE_H
+#define FIRMWARE_PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "control_protocol.h"
+
+// Ділянка прошивки за вікно: частка тактів вікна, кількість проходів, середній і найдовший
+typedef struct {
+    double load;                   // 0..1 від тактів вікна
+    uint32_t count;
+    double avg_us;
+    double max_us;
+    uint32_t hist[CTRL_PROF_BUCKETS];
+} FirmwareSection;
+
+// Вікно профілю плати (CTRL_OP_STAT), перераховане у час і частоти
+typedef struct {
+    bool valid;                    // Вікно вже завершене (номер > 0)
+    uint32_t window;
+    double window_s;
+    double scans_per_s;
+    double packets_per_s;
+    double busy;                   // Частка вікна поза очікуванням CTRL_PARAM_RATE
+    double sustainable_scans_per_s; // Скільки сканів за секунду плата встигла б без очікування
+    uint32_t tx_busy;
+    uint32_t rx_overflows;
+    uint32_t pma_overruns;
+    uint32_t usb_errors;
+    FirmwareSection sections[CTRL_PROF_SECTIONS];
+} FirmwareProfile;
+
+// Профіль із прочитаних статів (CTRL_STAT_COUNT значень у порядку CTRL_STAT_*)
+FirmwareProfile firmware_profile(const uint32_t *stats);
+
+#endif // FIRMWARE_PROFILE_H
@@ -13,7 +13,7 @@
 #include <stdlib.h>
 
 #define PACKET_SIZE 13
-#define MAX_CHANNELS 4
+#define MAX_CHANNELS 16
 
 // Структури з вашим визначенням OscData і channels мають містити channel_history як float*
 
@@ -130,7 +130,8 @@ void update_test_signals(OscData *data, float *time, float time_step)
         if (val < 0) val = 0;
         if (val > 4095) val = 4095;
 
-        data->channels[ch].channel_history[idx] = val;
+        if (data->channels[ch].channel_history)
+            data->channels[ch].channel_history[idx] = val;
     }
 
     data->history_index = (idx + 1) % data->history_size;
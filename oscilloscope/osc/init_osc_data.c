@@ -4,9 +4,16 @@
 
 void init_osc_data(OscData *oscData) {
     oscData->comport_number = -1;
+    oscData->channel_count = DEVICE_CHANNELS;
     oscData->active_channel = 0;
     oscData->refresh_rate_ms = 20.0f;
     oscData->auto_connect = false;
+    memset(&oscData->usb_watch, 0, sizeof(oscData->usb_watch)); // налаштовується в usb_watch_init
+    oscData->usb_watch.netlink_fd = -1;
+    oscData->transport = USB_TRANSPORT_TTY;
+    memset(&oscData->usb_bulk, 0, sizeof(oscData->usb_bulk)); // відкривається в usb_bulk_open
+    oscData->usb_bulk.fd = -1;
+    control_link_init(&oscData->control);
     oscData->com_port_name_edit_mode = false;
     strcpy(oscData->com_port_name_input, "COM1");
     oscData->ray_speed = 1000;
@@ -35,6 +42,41 @@ void init_osc_data(OscData *oscData) {
     oscData->valid_points = 0;
     oscData->points_to_display = 500; // Початкове число точок для відображення
     oscData->dynamic_buffer_mode = true;
+    oscData->sample_count = 0;
+    memset(&oscData->segments, 0, sizeof(oscData->segments)); // сегменти вмикаються через segments_setup
+    memset(oscData->measurements, 0, sizeof(oscData->measurements)); // виділяються в setup_channel_buffers
+    oscData->sample_rate_hz = 0.0f;
+    oscData->nominal_rate_hz = 0.0f;
+    oscData->show_measurements = true;
+    memset(&oscData->spectrum, 0, sizeof(oscData->spectrum)); // потік запускається через spectrum_start
+    oscData->spectrum.fft_size = SPECTRUM_DEFAULT_SIZE;
+    oscData->spectrum.window = FFT_WINDOW_HANN;
+    oscData->spectrum.averaging = SPECTRUM_AVG_NONE;
+    memset(&oscData->decoder, 0, sizeof(oscData->decoder)); // журнал виділяється в decoder_set_protocol
+    oscData->decoder.uart_rx = 0;
+    oscData->decoder.uart_baud = DECODER_DEFAULT_BAUD;
+    oscData->decoder.uart_data_bits = 8;
+    oscData->decoder.uart_parity = 0;
+    oscData->decoder.spi_sclk = 0;
+    oscData->decoder.spi_mosi = 1;
+    oscData->decoder.spi_cs = 2;
+    oscData->decoder.spi_miso = 3;
+    oscData->decoder.spi_word_bits = 8;
+    oscData->decoder.i2c_scl = 0;
+    oscData->decoder.i2c_sda = 1;
+    oscData->decoder.selected = -1;
+    memset(&oscData->recorder, 0, sizeof(oscData->recorder)); // файл створюється в recording_start
+    oscData->recorder.fd = -1;
+    memset(&oscData->viewer, 0, sizeof(oscData->viewer));
+    memset(&oscData->replay, 0, sizeof(oscData->replay)); // відкривається з командного рядка (--replay)
+    oscData->replay.raw_fd = -1;
+    oscData->raw_dump = NULL;
+    seq_reset(&oscData->seq);
+    device_time_reset(&oscData->device_time);
+    ets_reset(&oscData->ets);
+    oscData->gap_mode = GAP_MARK;
+    memset(&oscData->devices, 0, sizeof(oscData->devices)); // плати додаються через open_usb_devices
+    telemetry_init(&oscData->telemetry);
     // channel_history виділяється через setup_channel_buffers!
 }
 
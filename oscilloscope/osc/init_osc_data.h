@@ -9,9 +9,27 @@
 #include <stdint.h>
 #include <string.h>
 
-#define MAX_CHANNELS 4
+#include "segments.h"
+#include "measurements.h"
+#include "spectrum.h"
+#include "decoder.h"
+#include "recording.h"
+#include "replay.h"
+#include "telemetry.h"
+#include "sequence.h"
+#include "devices.h"
+#include "device_time.h"
+#include "ets.h"
+#include "usb_discovery.h"
+#include "usb_bulk.h"
+#include "control_link.h"
+
+#define MAX_CHANNELS 16
 #define PACKET_SIZE 13
 
+_Static_assert(MAX_CHANNELS == MAX_DEVICES * DEVICE_CHANNELS, "канали всіх плат мають вміщатися в channels[]");
+_Static_assert(PACKET_MAX_SIZE >= CTRL_FRAME_MAX, "буфер розбору потоку вміщає і пакет семплів, і кадр керування");
+
 typedef struct {
     bool active;
     float scale_y;               // Масштабування по вертикалі (розтягування по вертикалі)
@@ -33,6 +51,7 @@ typedef struct {
 // Структура для зберігання стану осцилографа і параметрів відображення
 typedef struct OscData {
     ChannelSettings channels[MAX_CHANNELS];
+    int channel_count;            // Каналів з буферами історії: 4 на кожну підключену плату
     int active_channel;           // індекс активного каналу
     int comport_number;           // Індекс відкритого COM-порту (-1 якщо не відкрито)
     int ray_speed;                // Затримка читання даних у мікросекундах
@@ -40,9 +59,14 @@ typedef struct OscData {
     int adc_tmp_b;                // Поточне відфільтроване значення ADC каналу B
     int adc_tmp_c;                // Поточне відфільтроване значення ADC каналу A
     int adc_tmp_d;                // Поточне відфільтроване значення ADC каналу B
+    int adc_extra_bits;           // Роздільність потоку: біти понад 12 (передискретизація на платі)
     int history_index;            // Поточний індекс запису в історії (циклічний буфер)
     float refresh_rate_ms;        // Частота оновлення інтерфейсу (мс)
     bool auto_connect;            // Прапорець автоматичного підключення до COM-порту
+    UsbWatch usb_watch;           // Пошук плати в sysfs і події hot-plug (для auto_connect)
+    UsbTransport transport;       // Шлях байтів від плати: tty або черга URB (usb_bulk)
+    UsbBulk usb_bulk;             // Відкрита кінцева точка bulk (замість comport_number), fd == -1 — ні
+    ControlLink control;          // Параметри плати: запити керування з підтвердженням
     char com_port_name_input[20]; // Ім'я COM-порту, введене користувачем
     bool com_port_name_edit_mode; // Режим редагування імені COM-порту
 
@@ -56,6 +80,33 @@ typedef struct OscData {
     int history_size;             // поточний розмір буфера
     int valid_points;             // Кількість реально отриманих точок
     int points_to_display;        // Початкове число точок для відображення
+    unsigned long long sample_count; // Загальна кількість прийнятих семплів від початку роботи
+
+    SegmentedCapture segments;    // Сегментована пам'ять (послідовне захоплення по тригеру)
+
+    ChannelMeasurements measurements[MAX_CHANNELS]; // Накопичувачі автоматичних вимірювань
+    float sample_rate_hz;         // Оцінка частоти дискретизації (семплів/с), 0 — невідома
+    float nominal_rate_hz;        // Відома частота джерела (відтворення), 0 — оцінювати за прийомом
+    bool show_measurements;       // Показувати панель вимірювань
+
+    SpectrumAnalyzer spectrum;    // Спектроаналізатор (ППФ у фоновому потоці)
+
+    ProtocolDecoder decoder;      // Декодер послідовних шин (UART/SPI/I2C)
+
+    Recorder recorder;            // Запис семплів у файл (фоновий потік)
+    RecordingViewer viewer;       // Перегляд записаного файлу
+
+    ReplaySource replay;          // Відтворення файлу замість COM-порту
+    FILE *raw_dump;               // Дамп сирих байтів з порту (--dump), NULL — вимкнено
+
+    SeqTracker seq;               // Перевірка номерів пакетів 0xAB
+    GapMode gap_mode;             // Чим заповнювати пропущені семпли (--gaps)
+    DeviceTime device_time;       // Годинник плати за мітками пакетів (CTRL_PARAM_TIMESTAMPS)
+    EtsComposite ets;             // Крива в еквівалентному часі із захоплень плати (CTRL_PARAM_ETS_STEPS)
+
+    DeviceSet devices;            // Кілька плат одночасно (замість comport_number), count == 0 — вимкнено
+
+    Telemetry telemetry;          // Лічильники конвеєра прийому і кадру (F5 — HUD)
 } OscData;
 
 void init_osc_data(OscData *oscData);
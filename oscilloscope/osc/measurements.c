@@ -0,0 +1,305 @@
+// file measurements.c
+
+#include "main.h"
+#include "measurements.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define MEAS_MIN_VPP 8          // Мінімальний розмах (відліки АЦП), з якого шукаємо фронти
+#define MEAS_RF_SMOOTH 0.25     // Коефіцієнт згладжування часу наростання/спаду
+
+// --- Монотонна черга ---
+
+static int mono_alloc(MonoQueue *q, int capacity)
+{
+    q->value = (int16_t*)malloc((size_t)capacity * sizeof(int16_t));
+    q->sample = (unsigned long long*)malloc((size_t)capacity * sizeof(unsigned long long));
+    q->capacity = capacity;
+    q->head = 0;
+    q->size = 0;
+    return (q->value && q->sample) ? 0 : -1;
+}
+
+static void mono_free(MonoQueue *q)
+{
+    free(q->value);
+    free(q->sample);
+    memset(q, 0, sizeof(*q));
+}
+
+// Додає значення в кінець черги, викидаючи з хвоста всі, що вже ніколи не стануть екстремумом.
+// is_max = true — черга максимумів (спадна), false — черга мінімумів (зростаюча)
+static void mono_push(MonoQueue *q, int16_t v, unsigned long long n, bool is_max)
+{
+    while (q->size > 0) {
+        int tail = (q->head + q->size - 1) % q->capacity;
+        if (is_max ? (q->value[tail] > v) : (q->value[tail] < v)) break;
+        q->size--;
+    }
+    int pos = (q->head + q->size) % q->capacity;
+    q->value[pos] = v;
+    q->sample[pos] = n;
+    q->size++;
+}
+
+// Видаляє з голови елементи, що випали з вікна (номер семпла < first)
+static void mono_expire(MonoQueue *q, unsigned long long first)
+{
+    while (q->size > 0 && q->sample[q->head] < first) {
+        q->head = (q->head + 1) % q->capacity;
+        q->size--;
+    }
+}
+
+// --- Керування накопичувачами ---
+
+static void channel_reset_edges(ChannelMeasurements *m)
+{
+    m->mid_state = 0;
+    m->last_rise = -1.0;
+    m->last_fall = -1.0;
+    m->period_pos = m->period_count = 0;
+    m->high_pos = m->high_count = 0;
+    m->period_sum = m->high_sum = 0.0;
+    m->rf_state = 0;
+    m->last_low = m->last_high = 0;
+    m->rise_samples = m->fall_samples = -1.0;
+}
+
+void measurements_free(OscData *oscData)
+{
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        ChannelMeasurements *m = &oscData->measurements[i];
+        free(m->raw);
+        mono_free(&m->qmin);
+        mono_free(&m->qmax);
+        memset(m, 0, sizeof(*m));
+    }
+}
+
+void measurements_reset(OscData *oscData, int window)
+{
+    measurements_free(oscData);
+    if (window < 2) return;
+
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        if (!oscData->channels[i].channel_history) continue; // Канал поза channel_count
+        ChannelMeasurements *m = &oscData->measurements[i];
+        m->capacity = window;
+        m->raw = (int16_t*)calloc(window, sizeof(int16_t));
+        if (!m->raw || mono_alloc(&m->qmin, window) || mono_alloc(&m->qmax, window)) {
+            fprintf(stderr, "Memory allocation failed for measurements of channel %d\n", i);
+            measurements_free(oscData);
+            return;
+        }
+        channel_reset_edges(m);
+    }
+}
+
+static void push_ring(double *ring, int *pos, int *count, double *sum, double value)
+{
+    if (*count == MEAS_EDGE_HISTORY) *sum -= ring[*pos];
+    else (*count)++;
+    ring[*pos] = value;
+    *sum += value;
+    *pos = (*pos + 1) % MEAS_EDGE_HISTORY;
+}
+
+// Дробова позиція перетину рівня level між попереднім і поточним семплом
+static double crossing_point(int16_t prev, int16_t v, float level, unsigned long long n)
+{
+    if ((prev < level && v >= level) || (prev > level && v <= level)) {
+        float frac = (level - prev) / (float)(v - prev);
+        return (double)n - 1.0 + frac;
+    }
+    return (double)n;
+}
+
+// Оновлення детекторів фронтів за порогами, взятими з поточних мінімуму і максимуму вікна
+static void update_edges(ChannelMeasurements *m, int16_t v, unsigned long long n)
+{
+    int16_t vmin = m->qmin.value[m->qmin.head];
+    int16_t vmax = m->qmax.value[m->qmax.head];
+    int vpp = vmax - vmin;
+    if (vpp < MEAS_MIN_VPP) {
+        m->mid_state = 0;
+        m->rf_state = 0;
+        return;
+    }
+
+    float mid = vmin + vpp * 0.5f;
+    float hyst = vpp * 0.05f;
+    float lo = vmin + vpp * 0.1f;
+    float hi = vmin + vpp * 0.9f;
+
+    // Середній рівень: період і шпаруватість
+    if (m->mid_state != 1 && v >= mid + hyst) {
+        double t = crossing_point(m->prev_value, v, mid, n);
+        if (m->mid_state == -1) {
+            if (m->last_rise >= 0.0)
+                push_ring(m->period, &m->period_pos, &m->period_count, &m->period_sum, t - m->last_rise);
+            m->last_rise = t;
+        }
+        m->mid_state = 1;
+    } else if (m->mid_state != -1 && v <= mid - hyst) {
+        double t = crossing_point(m->prev_value, v, mid, n);
+        if (m->mid_state == 1) {
+            if (m->last_rise >= 0.0)
+                push_ring(m->high_time, &m->high_pos, &m->high_count, &m->high_sum, t - m->last_rise);
+            m->last_fall = t;
+        }
+        m->mid_state = -1;
+    }
+
+    // Рівні 10% / 90%: час наростання і спаду
+    if (v <= lo) {
+        if (m->rf_state == 1) {
+            double fall = (double)(n - m->last_high);
+            m->fall_samples = (m->fall_samples < 0.0) ? fall
+                            : m->fall_samples + MEAS_RF_SMOOTH * (fall - m->fall_samples);
+        }
+        m->rf_state = -1;
+        m->last_low = n;
+    } else if (v >= hi) {
+        if (m->rf_state == -1) {
+            double rise = (double)(n - m->last_low);
+            m->rise_samples = (m->rise_samples < 0.0) ? rise
+                            : m->rise_samples + MEAS_RF_SMOOTH * (rise - m->rise_samples);
+        }
+        m->rf_state = 1;
+        m->last_high = n;
+    }
+}
+
+void measurements_on_sample(OscData *oscData, const int16_t *raw_values)
+{
+    unsigned long long n = oscData->sample_count;
+
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        ChannelMeasurements *m = &oscData->measurements[i];
+        if (!m->raw) continue;
+
+        int16_t v = raw_values[i];
+
+        // Вилучення найстарішого семпла, якщо вікно заповнене
+        if (m->count == m->capacity) {
+            int16_t old = m->raw[m->head];
+            m->sum -= old;
+            m->sum_sq -= (long long)old * old;
+        } else {
+            m->count++;
+        }
+        m->raw[m->head] = v;
+        m->head = (m->head + 1) % m->capacity;
+        m->sum += v;
+        m->sum_sq += (long long)v * v;
+
+        unsigned long long first = (n + 1 >= (unsigned long long)m->count) ? n + 1 - m->count : 0;
+        // Спершу вилучення з голови: черга ємністю у вікно вміщає новий семпл лише після нього
+        mono_expire(&m->qmin, first);
+        mono_expire(&m->qmax, first);
+        mono_push(&m->qmin, v, n, false);
+        mono_push(&m->qmax, v, n, true);
+
+        if (m->count > 1) update_edges(m, v, n);
+        m->prev_value = v;
+    }
+}
+
+void measurements_update(OscData *oscData)
+{
+    static double last_time = -1.0;
+    static unsigned long long last_count = 0;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double now = (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+
+    // Частота джерела відома (відтворення у будь-якому темпі) — оцінка за прийомом не потрібна
+    if (oscData->nominal_rate_hz > 0.0f) {
+        oscData->sample_rate_hz = oscData->nominal_rate_hz;
+        last_time = -1.0;
+        return;
+    }
+
+    // Захоплення в еквівалентному часі: крок між точками кривої задає плата
+    double ets_rate = ets_rate_hz(&oscData->ets);
+    if (ets_rate > 0.0) {
+        oscData->sample_rate_hz = (float)ets_rate;
+        last_time = -1.0;
+        return;
+    }
+
+    // Плата ставить мітки часу: частота — за її кварцом (з поправкою на дрейф), без тремтіння прийому
+    double clock_rate = 0.0;
+    if (oscData->devices.count > 0) {
+        DeviceClock clock = devices_clock(&oscData->devices.devices[0]);
+        if (clock.valid && clock.timestamped) clock_rate = 1.0 / clock.period;
+    } else {
+        clock_rate = device_time_rate(&oscData->device_time);
+    }
+    if (clock_rate > 0.0) {
+        oscData->sample_rate_hz = (float)clock_rate;
+        last_time = -1.0;
+        return;
+    }
+
+    if (last_time < 0.0 || oscData->sample_count < last_count) {
+        last_time = now;
+        last_count = oscData->sample_count;
+        return;
+    }
+
+    // Оцінка частоти дискретизації за кількістю прийнятих семплів (вікно ~0.5 с)
+    double dt = now - last_time;
+    if (dt >= 0.5) {
+        float rate = (float)((oscData->sample_count - last_count) / dt);
+        if (oscData->sample_rate_hz <= 0.0f) oscData->sample_rate_hz = rate;
+        else oscData->sample_rate_hz += 0.3f * (rate - oscData->sample_rate_hz);
+        last_time = now;
+        last_count = oscData->sample_count;
+    }
+}
+
+MeasurementResult measurements_get(const OscData *oscData, int channel)
+{
+    MeasurementResult r = {0};
+    r.rise_s = r.fall_s = -1.0f;
+    r.rise_samples = r.fall_samples = -1.0f;
+    if (channel < 0 || channel >= MAX_CHANNELS) return r;
+
+    const ChannelMeasurements *m = &oscData->measurements[channel];
+    if (!m->raw || m->count == 0) return r;
+
+    const float volts = ADC_VREF_VOLTS / ADC_FULL_SCALE / (float)(1 << oscData->adc_extra_bits);
+    float rate = oscData->sample_rate_hz;
+
+    r.valid = true;
+    r.min_v = m->qmin.value[m->qmin.head] * volts;
+    r.max_v = m->qmax.value[m->qmax.head] * volts;
+    r.vpp_v = r.max_v - r.min_v;
+    r.mean_v = (float)((double)m->sum / m->count) * volts;
+    r.rms_v = (float)sqrt((double)m->sum_sq / m->count) * volts;
+
+    if (m->period_count > 0) {
+        double period = m->period_sum / m->period_count;
+        r.period_samples = (float)period;
+        if (rate > 0.0f) {
+            r.period_s = (float)(period / rate);
+            r.frequency_hz = (float)(rate / period);
+        }
+        if (m->high_count > 0)
+            r.duty_percent = (float)(100.0 * (m->high_sum / m->high_count) / period);
+    }
+
+    r.rise_samples = (float)m->rise_samples;
+    r.fall_samples = (float)m->fall_samples;
+    if (rate > 0.0f) {
+        if (m->rise_samples >= 0.0) r.rise_s = (float)(m->rise_samples / rate);
+        if (m->fall_samples >= 0.0) r.fall_s = (float)(m->fall_samples / rate);
+    }
+    return r;
+}
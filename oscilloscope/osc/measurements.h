@@ -0,0 +1,90 @@
+// file measurements.h
+
+#ifndef MEASUREMENTS_H
+#define MEASUREMENTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef MAX_CHANNELS
+#define MAX_CHANNELS 16
+#endif
+
+#define ADC_VREF_VOLTS 3.3f      // Опорна напруга АЦП STM32F103
+#define ADC_FULL_SCALE 4096.0f   // Кількість рівнів 12-бітного АЦП
+#define MEAS_EDGE_HISTORY 16     // Скільки останніх періодів усереднюється
+
+struct OscData;
+
+// Монотонна черга для мінімуму/максимуму у ковзному вікні (амортизовано O(1) на семпл)
+typedef struct {
+    int16_t *value;
+    unsigned long long *sample;
+    int capacity;
+    int head;   // індекс найстарішого елемента
+    int size;
+} MonoQueue;
+
+// Накопичувачі одного каналу. Вікно вимірювань збігається з буфером історії (history_size)
+typedef struct {
+    int capacity;                 // Розмір вікна у семплах
+    int count;                    // Скільки семплів зараз у вікні
+    int head;                     // Позиція запису в кільці raw
+    int16_t *raw;                 // Сирі значення АЦП у вікні (для вилучення старих семплів)
+    long long sum;                // Сума значень у вікні
+    long long sum_sq;             // Сума квадратів значень у вікні
+    MonoQueue qmin;
+    MonoQueue qmax;
+
+    // Фронти відносно середнього рівня (з гістерезисом)
+    int mid_state;                // -1 нижче, 1 вище, 0 невідомо
+    int16_t prev_value;           // Попередній семпл (для інтерполяції перетину)
+    double last_rise;             // Дробовий номер семпла останнього висхідного перетину
+    double last_fall;             // Дробовий номер семпла останнього спадного перетину
+    double period[MEAS_EDGE_HISTORY];
+    double high_time[MEAS_EDGE_HISTORY];
+    int period_pos;
+    int period_count;
+    int high_pos;
+    int high_count;
+    double period_sum;
+    double high_sum;
+
+    // Час наростання/спаду між рівнями 10% і 90%
+    int rf_state;                 // -1 нижче 10%, 1 вище 90%, 0 невідомо
+    unsigned long long last_low;  // Останній семпл нижче 10%
+    unsigned long long last_high; // Останній семпл вище 90%
+    double rise_samples;          // Згладжений час наростання (семпли), < 0 — ще не виміряно
+    double fall_samples;          // Згладжений час спаду (семпли), < 0 — ще не виміряно
+} ChannelMeasurements;
+
+// Результати вимірювань каналу у фізичних одиницях
+typedef struct {
+    bool valid;
+    float min_v, max_v, mean_v, rms_v, vpp_v; // Вольти
+    float period_samples;         // Період у семплах, 0 — ще не виміряно
+    float frequency_hz;           // 0, якщо період або частота дискретизації невідомі
+    float period_s;
+    float duty_percent;
+    float rise_samples;           // < 0, якщо ще не виміряно
+    float fall_samples;
+    float rise_s;                 // < 0, якщо не виміряно або частота дискретизації невідома
+    float fall_s;
+} MeasurementResult;
+
+// Перевиділяє накопичувачі під вікно window семплів і скидає їх стан
+void measurements_reset(struct OscData *oscData, int window);
+
+// Звільняє пам'ять накопичувачів
+void measurements_free(struct OscData *oscData);
+
+// Додає один набір сирих значень (по одному на канал) — O(1) амортизовано на семпл
+void measurements_on_sample(struct OscData *oscData, const int16_t *raw_values);
+
+// Оновлює оцінку частоти дискретизації; викликається раз на цикл оновлення інтерфейсу
+void measurements_update(struct OscData *oscData);
+
+// Обчислює підсумкові значення каналу з поточних накопичувачів без проходу по буферу
+MeasurementResult measurements_get(const struct OscData *oscData, int channel);
+
+#endif // MEASUREMENTS_H
@@ -3,6 +3,7 @@
 #include <string.h> // strstr
 #include <stdlib.h> // atoi
 #include "parse_data.h"
+#include "sequence.h"
 
 #include <stdint.h>
 #include <stdio.h>
@@ -15,10 +16,24 @@
 // Повертає 0 при успіху, -1 при помилці (наприклад, неправильний стартовий байт)
 int parse_binary_packet(const uint8_t *packet, uint16_t *values)
 {
-    if (packet[0] != 0xAA) {
+    uint32_t seq;
+    return parse_binary_packet_seq(packet, values, &seq);
+}
+
+// У пакеті 0xAB байт ID = канал (біти 0..1) | 6 біт номера (біти 2..7),
+// молодші біти номера — у першому каналі
+int parse_binary_packet_seq(const uint8_t *packet, uint16_t *values, uint32_t *seq)
+{
+    uint8_t id_mask;
+    if (packet[0] == PACKET_START) {
+        id_mask = 0xFF;
+    } else if (packet[0] == PACKET_START_SEQ) {
+        id_mask = 0x03;
+    } else {
         // Неправильний стартовий байт
         return -1;
     }
+    *seq = packet[0] == PACKET_START_SEQ ? 0 : SEQ_NONE;
 
     // Ініціалізуємо всі значення -1 (або 0, якщо хочеш)
     for (int i = 0; i < 4; i++) {
@@ -27,10 +42,14 @@ int parse_binary_packet(const uint8_t *packet, uint16_t *values)
 
     // Розбираємо 4 канали
     for (int i = 0; i < 4; i++) {
-        uint8_t channel_id = packet[1 + i * 3];
+        uint8_t channel_id = packet[1 + i * 3] & id_mask;
         uint16_t val = packet[1 + i * 3 + 1] | (packet[1 + i * 3 + 2] << 8);
 
-        if (channel_id < 4) {
+        if (id_mask != 0xFF)
+            *seq |= (uint32_t)(packet[1 + i * 3] >> 2) << (6 * i);
+
+        // Номер займає старші біти, тож у 0xAB канали мають іти строго по порядку
+        if (channel_id < 4 && (id_mask == 0xFF || channel_id == i)) {
             values[channel_id] = val;
         } else {
             // Невідомий ID каналу, можна ігнорувати або повертати помилку
@@ -41,3 +60,124 @@ int parse_binary_packet(const uint8_t *packet, uint16_t *values)
     return 0;
 }
 
+
+bool packet_start(uint8_t byte)
+{
+    return byte == PACKET_START || byte == PACKET_START_SEQ || byte == PACKET_START_MASK ||
+           byte == PACKET_START_DELTA || byte == PACKET_START_ETS || byte == PACKET_START_RAW;
+}
+
+int packet_size(const uint8_t *packet, int have)
+{
+    if (have < 1) return 0;
+    if (packet[0] == PACKET_START || packet[0] == PACKET_START_SEQ) return PACKET_SIZE;
+    if (!packet_start(packet[0])) return -1;
+    if (have < 2) return 0;
+    int header = (packet[1] & PACKET_TIME_FLAG) ? PACKET_TIME_BYTES : 0;
+    if (packet[0] == PACKET_START_MASK) return PACKET_MASK_SIZE + header;
+    if (packet[0] == PACKET_START_RAW) {
+        if (have < PACKET_RAW_HEADER + header) return 0;
+        int scans = packet[PACKET_RAW_HEADER - 1 + header], channels = __builtin_popcount(packet[1] & 0x0F);
+        int size = PACKET_RAW_HEADER + header + scans * channels * 2;
+        return scans > 0 && channels > 0 && size <= PACKET_RAW_MAX ? size : -1;
+    }
+    if (packet[0] == PACKET_START_ETS) header += PACKET_ETS_BYTES;
+    if (have < PACKET_DELTA_HEADER + header) return 0;
+    // Хоча б байт на значення: інакше LEN пошкоджено, і чекати стільки байтів марно
+    int len = packet[PACKET_DELTA_HEADER - 1 + header];
+    if (len < DELTA_BLOCK_VALUES || len > DELTA_BLOCK_VALUES * DELTA_VALUE_MAX_BYTES) return -1;
+    return PACKET_DELTA_HEADER + header + len;
+}
+
+int packet_scans(const uint8_t *packet)
+{
+    int values;
+    if (packet[0] == PACKET_START_MASK) values = PACKET_MASK_VALUES;
+    else if (packet[0] == PACKET_START_RAW) {
+        // Сирі відліки — завжди 12 біт; скани — з байта за заголовком
+        int header = (packet[1] & PACKET_TIME_FLAG) ? PACKET_TIME_BYTES : 0;
+        int scans = packet[PACKET_RAW_HEADER - 1 + header], channels = __builtin_popcount(packet[1] & 0x0F);
+        bool fits = PACKET_RAW_HEADER + header + scans * channels * 2 <= PACKET_RAW_MAX;
+        return channels > 0 && !(packet[1] & (PACKET_RES_MASK << PACKET_RES_SHIFT)) && fits ? scans : 0;
+    }
+    else if (packet[0] == PACKET_START_DELTA || packet[0] == PACKET_START_ETS) values = DELTA_BLOCK_VALUES;
+    else return packet_start(packet[0]) ? 1 : 0;
+    uint8_t mask = packet[1] & 0x0F;
+    if (mask == 0 || ((packet[1] >> PACKET_RES_SHIFT) & PACKET_RES_MASK) > ADC_EXTRA_BITS_MAX) return 0;
+    return values / __builtin_popcount(mask);
+}
+
+_Static_assert(PACKET_MASK_VALUES <= PACKET_SCANS_MAX && DELTA_BLOCK_VALUES <= PACKET_SCANS_MAX,
+               "SamplePacket вміщає всі скани пакетів 0xAD і 0xAE");
+_Static_assert(PACKET_MASK_VALUES % 3 == 0 && PACKET_MASK_VALUES % 4 == 0, "скани заповнюють пакет для будь-якої кількості каналів");
+_Static_assert(DELTA_BLOCK_VALUES % 3 == 0 && DELTA_BLOCK_VALUES % 4 == 0, "скани заповнюють блок для будь-якої кількості каналів");
+_Static_assert(PACKET_DELTA_MAX - PACKET_DELTA_HEADER <= 0xFF, "довжина блоку вміщається в байт LEN");
+_Static_assert((PACKET_RAW_MAX - PACKET_RAW_HEADER) / 2 <= PACKET_SCANS_MAX &&
+               (PACKET_RAW_MAX - PACKET_RAW_HEADER) / 2 <= DELTA_BLOCK_VALUES, "пакет 0xB0 вміщається в блок розбору");
+
+int parse_packet(const uint8_t *packet, SamplePacket *out, uint32_t *seq)
+{
+    out->ets_steps = 0;
+    if (packet[0] == PACKET_START || packet[0] == PACKET_START_SEQ) {
+        out->mask = 0x0F;
+        out->extra_bits = 0;
+        out->scans = 1;
+        out->has_time = false;
+        return parse_binary_packet_seq(packet, (uint16_t*)out->values[0], seq);
+    }
+
+    int scans = packet_scans(packet);
+    if (scans == 0) return -1;
+    out->mask = packet[1] & 0x0F;
+    out->extra_bits = (packet[1] >> PACKET_RES_SHIFT) & PACKET_RES_MASK;
+    out->scans = scans;
+    *seq = (uint32_t)packet[2] | ((uint32_t)packet[3] << 8) | ((uint32_t)packet[4] << 16);
+
+    out->has_time = (packet[1] & PACKET_TIME_FLAG) != 0;
+    out->time_us = 0;
+    const uint8_t *body = packet + PACKET_MASK_HEADER;
+    if (out->has_time) {
+        out->time_us = (uint32_t)body[0] | ((uint32_t)body[1] << 8) | ((uint32_t)body[2] << 16) |
+                       ((uint32_t)body[3] << 24);
+        body += PACKET_TIME_BYTES;
+    }
+    if (packet[0] == PACKET_START_ETS) {
+        out->ets_step = body[0];
+        out->ets_steps = body[1];
+        out->ets_step_cycles = body[2];
+        if (out->ets_steps < 2 || out->ets_step >= out->ets_steps || out->ets_step_cycles == 0)
+            return -1;
+        body += PACKET_ETS_BYTES;
+    }
+
+    int channels = __builtin_popcount(out->mask);
+    int16_t block[DELTA_BLOCK_VALUES];
+    const int16_t *v = block;
+    if (packet[0] == PACKET_START_RAW) {
+        // За байтом сканів; відлік понад 12 біт — пошкоджений пакет
+        const uint8_t *p = body + 1;
+        for (int i = 0; i < scans * channels; i++, p += 2) {
+            int value = p[0] | (p[1] << 8);
+            if (value > 0x0FFF) return -1;
+            block[i] = (int16_t)(value - ADC_RAW_MIDSCALE);
+        }
+    } else if (packet[0] != PACKET_START_MASK) {
+        if (delta_decode(body + 1, body[0], block, DELTA_BLOCK_VALUES, channels) != 0)
+            return -1;
+    } else {
+        const uint8_t *p = body;
+        for (int i = 0; i < PACKET_MASK_VALUES; i++, p += 2)
+            block[i] = (int16_t)(p[0] | (p[1] << 8));
+    }
+
+    for (int s = 0; s < scans; s++) {
+        for (int ch = 0; ch < SEQ_CHANNELS; ch++)
+            out->values[s][ch] = (out->mask & (1u << ch)) ? *v++ : 0;
+    }
+    return 0;
+}
+
+int adc_rescale(int value, int from_bits, int to_bits)
+{
+    return to_bits >= from_bits ? value * (1 << (to_bits - from_bits)) : value >> (from_bits - to_bits);
+}
@@ -3,9 +3,76 @@
 #ifndef __PARSE_DATA_H
 #define __PARSE_DATA_H
 
-#include "main.h"
+#include <stdbool.h>
 #include <stdint.h>
+#include "sequence.h"
+#include "delta_codec.h"
+
+#define PACKET_START      0xAA // Пакет без номера (старі прошивки, відтворення записів)
+#define PACKET_START_SEQ  0xAB // Пакет з 24-бітним номером у старших 6 бітах кожного байта ID
+#define PACKET_START_MASK 0xAD // Пакет лише з увімкнених каналів (CTRL_PARAM_CHANNEL_MASK)
+#define PACKET_START_DELTA 0xAE // Стиснений блок (CTRL_PARAM_COMPRESSION)
+#define PACKET_START_ETS  0xAF // Захоплення в еквівалентному часі (CTRL_PARAM_ETS_STEPS)
+#define PACKET_START_RAW  0xB0 // Сирі відліки АЦП прямо з DMA плати
+
+// Пакет 0xAD: старт, маска каналів (біти 0..3) і роздільність (біти 4..7), номер (3 байти, молодший першим),
+// PACKET_MASK_VALUES значень int16 LE: скани по черзі, у скані — канали маски за зростанням.
+// Сканів у пакеті PACKET_MASK_VALUES / (кількість каналів): з одним каналом — 12 семплів
+// на 29 байтів замість одного на 13
+#define PACKET_MASK_HEADER 5
+#define PACKET_MASK_VALUES 12
+#define PACKET_MASK_SIZE (PACKET_MASK_HEADER + PACKET_MASK_VALUES * 2)
+
+// Біти 4..6 байта маски (0xAD, 0xAE, 0xAF) — додаткові біти роздільності (CTRL_PARAM_OVERSAMPLE)
+#define PACKET_RES_SHIFT 4
+#define PACKET_RES_MASK 0x07
+#define ADC_EXTRA_BITS_MAX 4   // 256 сканів на семпл: 16-бітні значення
+
+// Біт 7 байта маски (CTRL_PARAM_TIMESTAMPS): одразу за номером — PACKET_TIME_BYTES байтів часу
+// першого скану за лічильником плати (мкс, молодший першим), решта пакета зсувається на них
+#define PACKET_TIME_FLAG 0x80
+#define PACKET_TIME_BYTES 4
+
+// Пакет 0xAE: заголовок як у 0xAD, далі LEN і LEN байтів блоку delta_codec з DELTA_BLOCK_VALUES
+// значень у тому самому порядку. Кожне значення — від 1 байта (різниця до ±63) до 3
+#define PACKET_DELTA_HEADER 6
+#define PACKET_DELTA_MAX (PACKET_DELTA_HEADER + DELTA_BLOCK_VALUES * DELTA_VALUE_MAX_BYTES)
+
+// Пакет 0xAF: заголовок як у 0xAD (з часом), далі PACKET_ETS_BYTES байтів — крок step,
+// кількість кроків steps і крок у тактах плати step_cycles, потім LEN і блок, як у 0xAE.
+// Скани блоку — після фронту тригера: перший через step * step_cycles тактів, далі з періодом
+// steps * step_cycles (ets.h)
+#define PACKET_ETS_BYTES 3
+#define PACKET_ETS_CLOCK_HZ 72000000.0 // Такти плати (step_cycles)
+#define PACKET_MAX_SIZE (PACKET_DELTA_MAX + PACKET_TIME_BYTES + PACKET_ETS_BYTES)
+
+// Пакет 0xB0 (АЦП без стиснення, передискретизації і тестового сигналу): заголовок як у 0xAD
+// (з часом), далі кількість сканів і сирі відліки uint16 LE (0..4095, середина шкали —
+// ADC_RAW_MIDSCALE). Скани — стільки, скільки вміщає пакет до PACKET_RAW_MAX байтів
+#define PACKET_RAW_HEADER 6
+#define PACKET_RAW_MAX 63
+#define ADC_RAW_MIDSCALE 2048
 
 int parse_binary_packet(const uint8_t *packet, uint16_t *values);
 
+// Те саме, що parse_binary_packet, але також повертає номер пакета (SEQ_NONE для 0xAA)
+int parse_binary_packet_seq(const uint8_t *packet, uint16_t *values, uint32_t *seq);
+
+// Стартовий байт пакета семплів
+bool packet_start(uint8_t byte);
+
+// Довжина пакета семплів за першими have байтами: 0 — ще невідома (0xAD до байта маски, 0xAE до байта LEN,
+// 0xB0 до байта сканів),
+// -1 — не пакет семплів або неможлива довжина
+int packet_size(const uint8_t *packet, int have);
+
+// Сканів у пакеті за заголовком (перші PACKET_MASK_HEADER байтів, для 0xB0 — і байт сканів); 0 — хибна маска
+int packet_scans(const uint8_t *packet);
+
+// Будь-який пакет семплів (0xAA, 0xAB, 0xAD, 0xAE, 0xAF, 0xB0) повної довжини packet_size(). 0 при успіху
+int parse_packet(const uint8_t *packet, SamplePacket *out, uint32_t *seq);
+
+// Значення з from_bits додатковими бітами роздільності в масштабі з to_bits
+int adc_rescale(int value, int from_bits, int to_bits);
+
 #endif /* __PARSE_DATA_H */
@@ -3,53 +3,289 @@
 #include "read_usb_device.h"
 #include "rs232.h"
 #include "parse_data.h"
+#include "segments.h"
+#include "measurements.h"
+#include "decoder.h"
+#include "recording.h"
+#include "replay.h"
+#include "telemetry.h"
+#include "sequence.h"
+#include "devices.h"
+#include "find_usb_device.h"
+#include "control_link.h"
+#include <math.h>
+#include <string.h>
+
+// Масштабування сирого значення АЦП до одиниць буфера історії (пікселі відносно сітки).
+// Історія не залежить від роздільності: значення з додатковими бітами лише точніші
+float adc_bits_to_history(const OscData *data, int channel, int raw, int extra_bits)
+{
+    return ((float)raw / (4095 << extra_bits)) * HISTORY_SCALE_HEIGHT * data->channels[channel].signal_level
+           - HISTORY_SCALE_OFFSET;
+}
+
+float adc_to_history(const OscData *data, int channel, int raw)
+{
+    return adc_bits_to_history(data, channel, raw, data->adc_extra_bits);
+}
+
+// Зворотне перетворення значення з буфера історії у вольти на вході АЦП
+float history_to_volts(const OscData *data, int channel, float value)
+{
+    float raw = (value + HISTORY_SCALE_OFFSET) * 4095
+                / (HISTORY_SCALE_HEIGHT * data->channels[channel].signal_level);
+    return raw * ADC_VREF_VOLTS / ADC_FULL_SCALE;
+}
+
+static void process_bytes(OscData *data, const uint8_t *temp_buf, int bytes_read, double now);
+static void merge_devices(OscData *data);
+
+// Джерело байтів: файл відтворення, COM-порт або черга URB. *data — куди лягли байти:
+// buf, або кільце потоку читання URB (без копіювання, дійсне до наступного виклику)
+static int poll_input(OscData *data, uint8_t *buf, int size, const uint8_t **bytes)
+{
+    *bytes = buf;
+    if (data->replay.active) return replay_read(&data->replay, buf, size);
+
+    int n = data->usb_bulk.fd >= 0 ? usb_bulk_read(&data->usb_bulk, bytes)
+                                   : RS232_PollComport(data->comport_number, buf, size);
+    if (n > 0 && data->raw_dump) fwrite(*bytes, 1, (size_t)n, data->raw_dump);
+    return n;
+}
 
 void read_usb_device(OscData *data) {
-    static uint8_t buffer[PACKET_SIZE];
-    static int buf_idx = 0;
+    if (data->devices.count > 0) {
+        merge_devices(data);
+        return;
+    }
+    if (!usb_device_connected(data) && !data->replay.active) return;
+
+    // Вичитуємо все накопичене за кадр (але не більше READ_BUDGET_BYTES, щоб не блокувати
+    // малювання при відтворенні на максимальній швидкості)
+    uint8_t temp_buf[READ_CHUNK_BYTES];
+    const uint8_t *bytes;
+    int total = 0;
+    while (total < READ_BUDGET_BYTES) {
+        int bytes_read = poll_input(data, temp_buf, sizeof(temp_buf), &bytes);
+        double now = telemetry_now();
+        telemetry_on_poll(&data->telemetry, bytes_read, now);
+        if (bytes_read < 0 && !data->replay.active) usb_device_lost(data); // Плату від'єднано
+        if (bytes_read <= 0) break;
+        process_bytes(data, bytes, bytes_read, now);
+        total += bytes_read;
+    }
+    if (total >= READ_BUDGET_BYTES) data->telemetry.budget_hits++;
+}
+
+#define GAP_ALL_CHANNELS 0xFFFFFFFFu
+
+// Один семпл (channel_values — MAX_CHANNELS значень) проходить усю обробку. Біт каналу
+// в gap_mask — його значення вигадане замість втраченого, і в режимі GAP_MARK в історію
+// замість значення пишеться NaN (розрив лінії)
+static void push_sample(OscData *data, int16_t *channel_values, uint32_t gap_mask)
+{
+    // Масштабування сигналу до розміру сітки зі зміщенням до центру
+    if (data->gap_mode != GAP_MARK) gap_mask = 0;
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+        if (data->channels[ch].channel_history)
+            data->channels[ch].channel_history[data->history_index] =
+                (gap_mask >> ch) & 1 ? NAN : adc_to_history(data, ch, channel_values[ch]);
+    }
 
-    if (data->comport_number < 0) return;
+    // Сегментоване захоплення бачить семпл до зсуву індексу запису
+    segments_on_sample(data);
+    measurements_on_sample(data, channel_values);
+    decoder_on_sample(data, channel_values);
+    recording_on_sample(data, channel_values);
+    data->sample_count++;
 
-    uint8_t temp_buf[256];
-    int bytes_read = RS232_PollComport(data->comport_number, temp_buf, sizeof(temp_buf));
-    if (bytes_read <= 0) return;
+    // ОНОВЛЕННЯ: використовуємо динамічний розмір буфера!
+    data->history_index = (data->history_index + 1) % data->history_size;
+    if (data->valid_points < data->history_size)
+        data->valid_points++;
+}
+
+// Заповнює lost пропущених семплів перед next: часова вісь історії і запису лишається рівномірною.
+// Обробники семплів отримують утримане (GAP_MARK) або інтерпольоване значення.
+static void fill_gap(OscData *data, uint32_t lost, const int16_t *next)
+{
+    if (data->gap_mode == GAP_IGNORE) return;
+
+    // Довший розрив однаково перезаписує всю історію
+    int n = lost < (uint32_t)data->history_size ? (int)lost : data->history_size;
+    int16_t prev[4] = { data->adc_tmp_a, data->adc_tmp_b, data->adc_tmp_c, data->adc_tmp_d };
+    int16_t values[MAX_CHANNELS] = {0};
+    for (int k = 1; k <= n; k++) {
+        for (int ch = 0; ch < 4; ch++)
+            values[ch] = seq_gap_value(data->gap_mode, prev[ch], next[ch], k, n);
+        push_sample(data, values, GAP_ALL_CHANNELS);
+    }
+}
+
+// Плата перейшла на іншу роздільність (CTRL_PARAM_OVERSAMPLE або тестовий сигнал). Значення,
+// що лишаються в обробці, переводяться в новий масштаб; вікно вимірювань починається заново,
+// щоб не змішувати відліки різної ваги
+static void set_resolution(OscData *data, int extra_bits)
+{
+    int from = data->adc_extra_bits;
+    if (extra_bits == from) return;
+
+    data->adc_tmp_a = adc_rescale(data->adc_tmp_a, from, extra_bits);
+    data->adc_tmp_b = adc_rescale(data->adc_tmp_b, from, extra_bits);
+    data->adc_tmp_c = adc_rescale(data->adc_tmp_c, from, extra_bits);
+    data->adc_tmp_d = adc_rescale(data->adc_tmp_d, from, extra_bits);
+    for (int i = 0; i < MAX_DEVICES * DEVICE_CHANNELS; i++)
+        data->devices.merged[i] = (int16_t)adc_rescale(data->devices.merged[i], from, extra_bits);
+    decoder_rescale(data, from, extra_bits);
+    data->adc_extra_bits = extra_bits;
+    measurements_reset(data, data->history_size);
+}
+
+// Захоплення в еквівалентному часі: в історію потрапляє лише готова крива, одним шматком від
+// миті фронту — update_trigger_indices ставить на її початок trigger_index. Крива, довша
+// за історію, видна лише з початку
+static void accept_capture(OscData *data, const SamplePacket *packet)
+{
+    data->telemetry.packets += (unsigned long long)packet->scans;
+    int points = ets_on_capture(&data->ets, packet);
+    if (points > data->history_size) points = data->history_size;
+    if (points == 0) return;
+
+    data->ets.history_start = data->history_index;
+    for (int i = 0; i < points; i++) {
+        const int16_t *point = data->ets.points[i];
+        int16_t values[MAX_CHANNELS] = {0};
+        memcpy(values, point, SEQ_CHANNELS * sizeof(int16_t));
+        push_sample(data, values, 0);
+        data->adc_tmp_a = point[0];
+        data->adc_tmp_b = point[1];
+        data->adc_tmp_c = point[2];
+        data->adc_tmp_d = point[3];
+    }
+}
+
+// Прийнятий пакет, скан за сканом; adc_tmp_* — останні справжні значення, від них заповнюється
+// наступний розрив. Мітка часу пакета належить його першому скану
+static void accept_packet(OscData *data, const SamplePacket *packet, double now)
+{
+    set_resolution(data, packet->extra_bits);
+    if (packet->ets_steps) {
+        accept_capture(data, packet);
+        return;
+    }
+    if (data->ets.active) ets_reset(&data->ets); // Плата повернулась до безперервного потоку
+    if (packet->has_time) device_time_observe(&data->device_time, data->sample_count, packet->time_us, now);
+    for (int s = 0; s < packet->scans; s++) {
+        const int16_t *scan = packet->values[s];
+        int16_t values[MAX_CHANNELS] = {0};
+        memcpy(values, scan, SEQ_CHANNELS * sizeof(int16_t));
+        push_sample(data, values, 0);
+        data->adc_tmp_a = scan[0];
+        data->adc_tmp_b = scan[1];
+        data->adc_tmp_c = scan[2];
+        data->adc_tmp_d = scan[3];
+        data->telemetry.packets++;
+    }
+}
+
+// Пакет з номером (0xAB, 0xAD, 0xAE, 0xAF): перевірка номера. Після збою пакет відкладається, доки
+// наступний не покаже, чи це справжній розрив, чи спотворений номер (див. seq_check)
+static void accept_sequenced(OscData *data, uint32_t seq, const SamplePacket *packet, double now)
+{
+    Telemetry *t = &data->telemetry;
+    SamplePacket released;
+    uint32_t lost;
+
+    switch (seq_check(&data->seq, seq, packet, &released, &lost)) {
+    case SEQ_HOLD:
+        return;
+    case SEQ_GAP:
+        // У втрачених пакетах стільки ж сканів, скільки в наступному за ними
+        lost *= (uint32_t)released.scans;
+        t->seq_gaps++;
+        t->seq_lost += lost;
+        set_resolution(data, released.extra_bits);
+        // Між захопленнями немає рівномірної осі: втрачене лише рахується
+        if (!released.ets_steps) fill_gap(data, lost, released.values[0]);
+        accept_packet(data, &released, now);
+        t->seq_packets++;
+        break;
+    case SEQ_CORRUPT:
+        t->seq_errors++;
+        accept_packet(data, &released, now);
+        t->seq_packets++;
+        break;
+    case SEQ_RESTART:
+        t->seq_restarts++;
+        device_time_reset(&data->device_time);
+        accept_packet(data, &released, now);
+        t->seq_packets++;
+        break;
+    case SEQ_DUPLICATE:
+        t->seq_duplicates++;
+        break;
+    default:
+        break;
+    }
+
+    if (data->seq.holding) return; // Поточний відкладено до наступного пакета
+    accept_packet(data, packet, now);
+    t->seq_packets++;
+}
+
+static void process_bytes(OscData *data, const uint8_t *temp_buf, int bytes_read, double now) {
+    static uint8_t buffer[PACKET_MAX_SIZE]; // Пакет семплів або кадр керування
+    static int buf_idx = 0;
 
     for (int i = 0; i < bytes_read; i++) {
         uint8_t byte = temp_buf[i];
 
         if (buf_idx == 0) {
-            if (byte == 0xAA) buffer[buf_idx++] = byte;
+            if (packet_start(byte) || byte == CTRL_START) {
+                buffer[buf_idx++] = byte;
+                data->telemetry.hunting = false;
+            } else {
+                // Поза пакетом: байт втрачено, синхронізація відновлюється по наступному стартовому байту
+                if (!data->telemetry.hunting) data->telemetry.resyncs++;
+                data->telemetry.hunting = true;
+                data->telemetry.resync_bytes++;
+            }
+        } else if (buffer[0] == CTRL_START) {
+            // Відповідь плати на запит керування: довжина відома після байта LEN
+            buffer[buf_idx++] = byte;
+            int size = control_frame_size(buffer, buf_idx);
+            if (size < 0) {
+                data->control.bad_frames++;
+                buf_idx = 0;
+            } else if (size > 0 && buf_idx == size) {
+                control_on_frame(&data->control, buffer, size);
+                buf_idx = 0;
+            }
         } else {
             buffer[buf_idx++] = byte;
-            if (buf_idx == PACKET_SIZE) {
+            int size = packet_size(buffer, buf_idx);
+            if (size < 0) {
+                // Довжину блоку 0xAE пошкоджено
+                data->telemetry.bad_packets++;
+                buf_idx = 0;
+            } else if (buf_idx == size) {
                 // Маємо повний пакет
-                int16_t channel_values[4];
-                if (parse_binary_packet(buffer, channel_values) == 0) {
-                    data->adc_tmp_a = channel_values[0];
-                    data->adc_tmp_b = channel_values[1];
-                    data->adc_tmp_c = channel_values[2];
-                    data->adc_tmp_d = channel_values[3];
-
-                    // Масштабування сигналу до розміру сітки зі зміщенням до центру
-                    static int height = 500;
-                    float scaled_a = ((float)data->adc_tmp_a / 4095) * height * (data->channels[0].signal_level) - 600/2;
-                    float scaled_b = ((float)data->adc_tmp_b / 4095) * height * (data->channels[1].signal_level) - 600/2;
-                    float scaled_c = ((float)data->adc_tmp_c / 4095) * height * (data->channels[2].signal_level) - 600/2;
-                    float scaled_d = ((float)data->adc_tmp_d / 4095) * height * (data->channels[3].signal_level) - 600/2;
-
-                    if (data->channels[0].channel_history)
-                        data->channels[0].channel_history[data->history_index] = scaled_a;
-                    if (data->channels[1].channel_history)
-                        data->channels[1].channel_history[data->history_index] = scaled_b;
-                    if (data->channels[2].channel_history)
-                        data->channels[2].channel_history[data->history_index] = scaled_c;
-                    if (data->channels[3].channel_history)
-                        data->channels[3].channel_history[data->history_index] = scaled_d;
-
-                    // ОНОВЛЕННЯ: використовуємо динамічний розмір буфера!
-                    data->history_index = (data->history_index + 1) % data->history_size;
-                    if (data->valid_points < data->history_size)
-                        data->valid_points++;
+                if (buffer[0] == PACKET_START_DELTA || buffer[0] == PACKET_START_ETS) {
+                    data->telemetry.delta_blocks++;
+                    data->telemetry.delta_bytes += (unsigned long long)size;
+                    data->telemetry.delta_values += DELTA_BLOCK_VALUES;
+                }
+                SamplePacket packet;
+                uint32_t seq;
+                if (parse_packet(buffer, &packet, &seq) != 0) {
+                    data->telemetry.bad_packets++;
+                } else if (seq == SEQ_NONE) {
+                    // Відтворення запису: у пакетах 0xAA немає роздільності, вона — у заголовку файлу
+                    if (data->replay.active && data->replay.format == REPLAY_RECORDING)
+                        packet.extra_bits = (uint8_t)recording_extra_bits(&data->replay.recording.header);
+                    accept_packet(data, &packet, now);
+                } else {
+                    accept_sequenced(data, seq, &packet, now);
                 }
                 buf_idx = 0;
             }
@@ -57,3 +293,120 @@ void read_usb_device(OscData *data) {
     }
 }
 
+// Семпл плати d, найближчий за часом t. false — плата ще не надіслала його і не мовчить
+// довше DEVICE_STALE_S: об'єднання чекає. Відсутній семпл позначається в gap_mask.
+static bool merge_device_sample(OscData *data, int d, const DeviceClock *clock, double t, double now,
+                                int16_t *values, uint32_t *gap_mask)
+{
+    DeviceSet *set = &data->devices;
+    Device *dev = &set->devices[d];
+    int base = d * DEVICE_CHANNELS;
+    DeviceSample s;
+
+    if (clock->valid) {
+        double k = round((t - clock->offset) / clock->period);
+        if (k >= 0.0) {
+            bool stale = now - atomic_load(&dev->last_arrival) > DEVICE_STALE_S;
+            if ((uint64_t)k >= atomic_load(&dev->head) && !stale) return false;
+            if (devices_read(dev, (uint64_t)k, &s)) {
+                // Плати переходять на нову роздільність не одночасно: масштаб — опорної плати
+                for (int ch = 0; ch < DEVICE_CHANNELS; ch++)
+                    values[base + ch] = (int16_t)adc_rescale(s.values[ch], s.extra_bits, data->adc_extra_bits);
+                if (s.gap) *gap_mask |= 0xFu << base;
+                return true;
+            }
+        }
+    }
+
+    dev->merge_gaps++;
+    memcpy(&values[base], &set->merged[base], DEVICE_CHANNELS * sizeof(int16_t));
+    *gap_mask |= 0xFu << base;
+    return true;
+}
+
+// Лічильники плат зводяться в загальну телеметрію
+static void merge_telemetry(OscData *data, double now)
+{
+    DeviceSet *set = &data->devices;
+    Telemetry *t = &data->telemetry;
+    unsigned long long bytes = 0;
+
+    t->bad_packets = t->resyncs = t->resync_bytes = 0;
+    t->seq_packets = t->seq_gaps = t->seq_lost = 0;
+    t->seq_duplicates = t->seq_errors = t->seq_restarts = 0;
+    t->delta_blocks = t->delta_bytes = 0;
+    for (int d = 0; d < set->count; d++) {
+        const Device *dev = &set->devices[d];
+        bytes += dev->bytes;
+        t->bad_packets += dev->bad_packets;
+        t->resyncs += dev->resyncs;
+        t->resync_bytes += dev->resync_bytes;
+        t->seq_packets += dev->packets;
+        t->seq_gaps += dev->seq_gaps;
+        t->seq_lost += dev->seq_lost;
+        t->seq_duplicates += dev->seq_duplicates;
+        t->seq_errors += dev->seq_errors;
+        t->seq_restarts += dev->seq_restarts;
+        t->delta_blocks += dev->delta_blocks;
+        t->delta_bytes += dev->delta_bytes;
+    }
+    t->delta_values = t->delta_blocks * DELTA_BLOCK_VALUES;
+    telemetry_on_poll(t, (int)(bytes - set->seen_bytes), now);
+    set->seen_bytes = bytes;
+}
+
+// Кілька плат: кожна читається своїм потоком (devices.c). Семпли опорної плати 0 задають
+// часову вісь; з інших плат береться семпл, найближчий за часом за оцінкою їхніх годинників.
+static void merge_devices(OscData *data)
+{
+    DeviceSet *set = &data->devices;
+    DeviceClock clocks[MAX_DEVICES];
+    double now = telemetry_now();
+
+    merge_telemetry(data, now);
+    for (int d = 0; d < set->count; d++)
+        clocks[d] = devices_clock(&set->devices[d]);
+    if (!clocks[0].valid) return;
+
+    Device *ref = &set->devices[0];
+    uint64_t head = atomic_load(&ref->head);
+
+    // Старт, коли годинники всіх плат, що надсилають дані, оцінено
+    if (!set->merging) {
+        for (int d = 1; d < set->count; d++) {
+            bool stale = now - atomic_load(&set->devices[d].last_arrival) > DEVICE_STALE_S;
+            if (!clocks[d].valid && !stale) return;
+        }
+        set->merging = true;
+        set->merge_next = head;
+    }
+
+    int budget = READ_BUDGET_BYTES / PACKET_SIZE;
+    while (set->merge_next < head && budget-- > 0) {
+        DeviceSample s;
+        if (!devices_read(ref, set->merge_next, &s)) {
+            // Відстали більше ніж на кільце: продовжуємо з його середини
+            uint64_t resume = head - DEVICE_RING_SAMPLES / 2;
+            set->merge_overruns += resume - set->merge_next;
+            set->merge_next = resume;
+            continue;
+        }
+
+        int16_t values[MAX_CHANNELS] = {0};
+        uint32_t gap_mask = s.gap ? 0xFu : 0;
+        set_resolution(data, s.extra_bits);
+        memcpy(values, s.values, sizeof(s.values));
+
+        double t = clocks[0].offset + (double)s.index * clocks[0].period;
+        bool ready = true;
+        for (int d = 1; d < set->count && ready; d++)
+            ready = merge_device_sample(data, d, &clocks[d], t, now, values, &gap_mask);
+        if (!ready) break;
+
+        push_sample(data, values, gap_mask);
+        memcpy(set->merged, values, sizeof(set->merged));
+        data->telemetry.packets++;
+        set->merge_next++;
+    }
+    if (budget < 0) data->telemetry.budget_hits++;
+}
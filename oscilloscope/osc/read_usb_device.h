@@ -6,7 +6,18 @@
 #include "main.h"
 #include <stdint.h>
 
+#define HISTORY_SCALE_HEIGHT 500  // Висота (пікселі), на яку масштабується повна шкала АЦП
+#define HISTORY_SCALE_OFFSET 300  // Зміщення до центру робочої області
+#define READ_CHUNK_BYTES 4096     // Байтів за одне опитування джерела
+#define READ_BUDGET_BYTES (1 << 20) // Максимум байтів, що обробляються за один виклик
+
 void read_usb_device(OscData *data);
 
+// Перетворення між сирими відліками АЦП, одиницями channel_history і вольтами
+float adc_to_history(const OscData *data, int channel, int raw);
+// Те саме для значення з extra_bits додатковими бітами (запис, зроблений з іншою роздільністю)
+float adc_bits_to_history(const OscData *data, int channel, int raw, int extra_bits);
+float history_to_volts(const OscData *data, int channel, float value);
+
 #endif // READ_USB_DEVICE_H
 
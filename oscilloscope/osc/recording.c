@@ -0,0 +1,459 @@
+// file recording.c
+
+#include "main.h"
+#include "recording.h"
+#include "parse_data.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Заголовок версії 1: масиви розраховані рівно на 4 канали
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t channels;
+    uint32_t chunk_samples;
+    uint32_t block_samples;
+    uint32_t chunk_stride;
+    double sample_rate_hz;
+    uint64_t total_samples;
+    uint64_t chunk_count;
+    int64_t start_time_ns;
+    float volts_per_count[4];
+    float signal_level[4];
+    uint32_t complete;
+    uint32_t reserved;
+} RecordingHeaderV1;
+
+// Заголовок чанка разом з підсумками min/max по каналах
+static inline size_t chunk_head_size(uint32_t channels)
+{
+    return sizeof(RecordingChunkHeader) + 2 * (size_t)channels * sizeof(int16_t);
+}
+
+static size_t chunk_stride(uint32_t channels)
+{
+    return chunk_head_size(channels)
+         + 2 * (size_t)channels * REC_BLOCKS * sizeof(int16_t)
+         + (size_t)channels * REC_CHUNK_SAMPLES * sizeof(int16_t);
+}
+
+// Вказівники на підсумки чанка і блоків та стовпці даних всередині чанка
+static inline int16_t *chunk_min(const uint8_t *chunk, int ch)
+{
+    return (int16_t*)(chunk + sizeof(RecordingChunkHeader)) + ch;
+}
+
+static inline int16_t *chunk_max(const uint8_t *chunk, uint32_t channels, int ch)
+{
+    return chunk_min(chunk, 0) + channels + ch;
+}
+
+static inline int16_t *chunk_bmin(const uint8_t *chunk, uint32_t channels, int ch)
+{
+    return (int16_t*)(chunk + chunk_head_size(channels)) + (size_t)ch * REC_BLOCKS;
+}
+
+static inline int16_t *chunk_bmax(const uint8_t *chunk, uint32_t channels, int ch)
+{
+    return chunk_bmin(chunk, channels, 0) + (size_t)channels * REC_BLOCKS + (size_t)ch * REC_BLOCKS;
+}
+
+static inline int16_t *chunk_data(const uint8_t *chunk, uint32_t channels, int ch)
+{
+    return chunk_bmin(chunk, channels, 0) + 2 * (size_t)channels * REC_BLOCKS + (size_t)ch * REC_CHUNK_SAMPLES;
+}
+
+static int write_all(int fd, const void *buf, size_t size, off_t offset)
+{
+    const uint8_t *p = (const uint8_t*)buf;
+    while (size > 0) {
+        ssize_t n = pwrite(fd, p, size, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        size -= (size_t)n;
+        offset += n;
+    }
+    return 0;
+}
+
+static int write_header(int fd, const RecordingHeader *header)
+{
+    uint8_t block[REC_HEADER_SIZE] = {0};
+    memcpy(block, header, sizeof(*header));
+    return write_all(fd, block, sizeof(block), 0);
+}
+
+// --- Запис ---
+
+static void *writer_thread(void *arg)
+{
+    Recorder *r = (Recorder*)arg;
+    size_t stride = r->header.chunk_stride;
+
+    pthread_mutex_lock(&r->lock);
+    for (;;) {
+        int pos = r->write_pos;
+        if (r->full[pos]) {
+            pthread_mutex_unlock(&r->lock);
+
+            const RecordingChunkHeader *ch = (const RecordingChunkHeader*)r->buffers[pos];
+            off_t offset = REC_HEADER_SIZE + (off_t)(ch->first_sample / REC_CHUNK_SAMPLES) * (off_t)stride;
+            int rc = r->error ? -1 : write_all(r->fd, r->buffers[pos], stride, offset);
+
+            pthread_mutex_lock(&r->lock);
+            if (rc != 0 && !r->error) {
+                fprintf(stderr, "Recording write failed: %s\n", strerror(errno));
+                r->error = true;
+            }
+            if (rc == 0) r->bytes_written += stride;
+            r->full[pos] = false;
+            r->write_pos = (pos + 1) % REC_QUEUE_DEPTH;
+            pthread_cond_broadcast(&r->cond);
+            continue;
+        }
+        if (!r->running) break;
+        pthread_cond_wait(&r->cond, &r->lock);
+    }
+    pthread_mutex_unlock(&r->lock);
+    return NULL;
+}
+
+static void chunk_begin(Recorder *r)
+{
+    uint8_t *chunk = r->buffers[r->fill];
+    uint32_t channels = r->header.channels;
+    RecordingChunkHeader *ch = (RecordingChunkHeader*)chunk;
+    memset(ch, 0, sizeof(*ch));
+    ch->first_sample = r->next_chunk * REC_CHUNK_SAMPLES;
+    for (uint32_t i = 0; i < channels; i++) {
+        *chunk_min(chunk, i) = INT16_MAX;
+        *chunk_max(chunk, channels, i) = INT16_MIN;
+    }
+    r->fill_count = 0;
+}
+
+// Передає заповнений чанк потоку. Якщо черга зайнята, чанк викидається, а буфер
+// використовується повторно — прийом ніколи не чекає на диск.
+static void chunk_submit(Recorder *r)
+{
+    RecordingChunkHeader *ch = (RecordingChunkHeader*)r->buffers[r->fill];
+    ch->count = r->fill_count;
+
+    pthread_mutex_lock(&r->lock);
+    int next = (r->fill + 1) % REC_QUEUE_DEPTH;
+    if (r->full[next]) {
+        r->dropped_chunks++;
+    } else {
+        r->full[r->fill] = true;
+        r->fill = next;
+        pthread_cond_signal(&r->cond);
+    }
+    pthread_mutex_unlock(&r->lock);
+
+    r->next_chunk++;
+    chunk_begin(r);
+}
+
+int recording_start(OscData *oscData, const char *path)
+{
+    Recorder *r = &oscData->recorder;
+    if (r->active) return 0;
+
+    memset(r, 0, sizeof(*r));
+    snprintf(r->path, sizeof(r->path), "%s", path);
+
+    RecordingHeader *h = &r->header;
+    memcpy(h->magic, REC_MAGIC, sizeof(h->magic));
+    h->version = REC_VERSION;
+    h->header_size = REC_HEADER_SIZE;
+    h->channels = (uint32_t)oscData->channel_count;
+    h->chunk_samples = REC_CHUNK_SAMPLES;
+    h->block_samples = REC_BLOCK_SAMPLES;
+    h->chunk_stride = (uint32_t)chunk_stride(h->channels);
+    h->sample_rate_hz = oscData->sample_rate_hz;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    h->start_time_ns = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    r->extra_bits = oscData->adc_extra_bits;
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        h->volts_per_count[i] = ADC_VREF_VOLTS / ADC_FULL_SCALE / (float)(1 << r->extra_bits);
+        h->signal_level[i] = oscData->channels[i].signal_level;
+    }
+
+    for (int i = 0; i < REC_QUEUE_DEPTH; i++) {
+        r->buffers[i] = (uint8_t*)calloc(1, h->chunk_stride);
+        if (!r->buffers[i]) {
+            fprintf(stderr, "Memory allocation failed for recording buffers\n");
+            for (int j = 0; j < i; j++) free(r->buffers[j]);
+            return -1;
+        }
+    }
+
+    r->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (r->fd < 0 || write_header(r->fd, h) != 0) {
+        fprintf(stderr, "Failed to create recording %s: %s\n", path, strerror(errno));
+        if (r->fd >= 0) close(r->fd);
+        for (int i = 0; i < REC_QUEUE_DEPTH; i++) free(r->buffers[i]);
+        return -1;
+    }
+
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->cond, NULL);
+    r->running = true;
+    if (pthread_create(&r->thread, NULL, writer_thread, r) != 0) {
+        fprintf(stderr, "Failed to start recording thread\n");
+        pthread_cond_destroy(&r->cond);
+        pthread_mutex_destroy(&r->lock);
+        close(r->fd);
+        for (int i = 0; i < REC_QUEUE_DEPTH; i++) free(r->buffers[i]);
+        return -1;
+    }
+
+    chunk_begin(r);
+    r->active = true;
+    printf("Recording to %s\n", path);
+    return 0;
+}
+
+void recording_on_sample(OscData *oscData, const int16_t *raw_values)
+{
+    Recorder *r = &oscData->recorder;
+    if (!r->active) return;
+
+    uint8_t *chunk = r->buffers[r->fill];
+    uint32_t channels = r->header.channels;
+    uint32_t i = r->fill_count;
+    uint32_t block = i / REC_BLOCK_SAMPLES;
+    bool block_start = (i % REC_BLOCK_SAMPLES) == 0;
+
+    // Роздільність змінилась під час запису: у файлі лишається та, з якою він почався
+    bool rescale = oscData->adc_extra_bits != r->extra_bits;
+
+    for (uint32_t c = 0; c < channels; c++) {
+        int16_t v = rescale ? (int16_t)adc_rescale(raw_values[c], oscData->adc_extra_bits, r->extra_bits)
+                            : raw_values[c];
+        chunk_data(chunk, channels, c)[i] = v;
+
+        int16_t *bmin = &chunk_bmin(chunk, channels, c)[block];
+        int16_t *bmax = &chunk_bmax(chunk, channels, c)[block];
+        if (block_start || v < *bmin) *bmin = v;
+        if (block_start || v > *bmax) *bmax = v;
+        int16_t *cmin = chunk_min(chunk, c);
+        int16_t *cmax = chunk_max(chunk, channels, c);
+        if (v < *cmin) *cmin = v;
+        if (v > *cmax) *cmax = v;
+    }
+
+    r->samples++;
+    if (++r->fill_count == REC_CHUNK_SAMPLES) chunk_submit(r);
+}
+
+void recording_stop(OscData *oscData)
+{
+    Recorder *r = &oscData->recorder;
+    if (!r->active) return;
+    r->active = false;
+
+    pthread_mutex_lock(&r->lock);
+    if (r->fill_count > 0) {
+        // Останній неповний чанк: хвіст стовпців обнуляється
+        uint8_t *chunk = r->buffers[r->fill];
+        for (uint32_t c = 0; c < r->header.channels; c++)
+            memset(chunk_data(chunk, r->header.channels, c) + r->fill_count, 0,
+                   (REC_CHUNK_SAMPLES - r->fill_count) * sizeof(int16_t));
+        ((RecordingChunkHeader*)chunk)->count = r->fill_count;
+
+        r->full[r->fill] = true;
+        r->next_chunk++;
+    }
+    r->running = false;
+    pthread_cond_broadcast(&r->cond);
+    pthread_mutex_unlock(&r->lock);
+    pthread_join(r->thread, NULL);
+    pthread_cond_destroy(&r->cond);
+    pthread_mutex_destroy(&r->lock);
+
+    r->header.sample_rate_hz = oscData->sample_rate_hz;
+    r->header.total_samples = r->samples;
+    r->header.chunk_count = r->next_chunk;
+    r->header.complete = r->error ? 0 : 1;
+    if (write_header(r->fd, &r->header) != 0)
+        fprintf(stderr, "Failed to finalize recording header: %s\n", strerror(errno));
+    // Викинуті наприкінці чанки лишили б файл коротшим за chunk_count
+    if (ftruncate(r->fd, REC_HEADER_SIZE + (off_t)r->next_chunk * r->header.chunk_stride) != 0)
+        fprintf(stderr, "Failed to size recording: %s\n", strerror(errno));
+    close(r->fd);
+    r->fd = -1;
+
+    for (int i = 0; i < REC_QUEUE_DEPTH; i++) {
+        free(r->buffers[i]);
+        r->buffers[i] = NULL;
+    }
+
+    printf("Recording %s closed: %llu samples, %llu chunks dropped\n",
+           r->path, (unsigned long long)r->samples, r->dropped_chunks);
+}
+
+// --- Читання ---
+
+int recording_open(RecordingFile *file, const char *path)
+{
+    memset(file, 0, sizeof(*file));
+    file->fd = open(path, O_RDONLY);
+    if (file->fd < 0) {
+        fprintf(stderr, "Failed to open recording %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(file->fd, &st) != 0 || st.st_size < REC_HEADER_SIZE) {
+        fprintf(stderr, "Recording %s is too short\n", path);
+        close(file->fd);
+        return -1;
+    }
+
+    file->map_size = (size_t)st.st_size;
+    void *map = mmap(NULL, file->map_size, PROT_READ, MAP_SHARED, file->fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Failed to map recording %s: %s\n", path, strerror(errno));
+        close(file->fd);
+        return -1;
+    }
+    file->map = (const uint8_t*)map;
+    madvise(map, file->map_size, MADV_RANDOM); // перегляд читає підсумки вибірково
+
+    RecordingHeader *h = &file->header;
+    memcpy(h, file->map, sizeof(*h));
+    if (h->version == 1) {
+        // Поля до масивів збігаються, масиви і хвіст — за розкладкою версії 1
+        RecordingHeaderV1 v1;
+        memcpy(&v1, file->map, sizeof(v1));
+        memset(h->volts_per_count, 0, sizeof(h->volts_per_count));
+        memset(h->signal_level, 0, sizeof(h->signal_level));
+        memcpy(h->volts_per_count, v1.volts_per_count, sizeof(v1.volts_per_count));
+        memcpy(h->signal_level, v1.signal_level, sizeof(v1.signal_level));
+        h->complete = v1.complete;
+        h->reserved = v1.reserved;
+    }
+    if (memcmp(h->magic, REC_MAGIC, sizeof(h->magic)) != 0 || h->version < 1 || h->version > REC_VERSION ||
+        h->header_size != REC_HEADER_SIZE || h->channels < 1 || h->channels > MAX_CHANNELS ||
+        (h->version == 1 && h->channels != 4) ||
+        h->chunk_samples != REC_CHUNK_SAMPLES || h->block_samples != REC_BLOCK_SAMPLES ||
+        h->chunk_stride != chunk_stride(h->channels)) {
+        fprintf(stderr, "Recording %s has an unsupported format\n", path);
+        recording_close(file);
+        return -1;
+    }
+
+    // Файл, не закритий коректно: кількість чанків і семплів відновлюється з розміру
+    uint64_t chunks_on_disk = (file->map_size - REC_HEADER_SIZE) / h->chunk_stride;
+    if (!h->complete || h->chunk_count > chunks_on_disk) {
+        h->chunk_count = chunks_on_disk;
+        h->total_samples = 0;
+        for (uint64_t k = 0; k < chunks_on_disk; k++) {
+            const RecordingChunkHeader *c =
+                (const RecordingChunkHeader*)(file->map + REC_HEADER_SIZE + k * h->chunk_stride);
+            if (c->count > 0) h->total_samples = c->first_sample + c->count;
+        }
+    }
+    return 0;
+}
+
+void recording_close(RecordingFile *file)
+{
+    if (file->map) {
+        munmap((void*)file->map, file->map_size);
+        close(file->fd);
+    }
+    memset(file, 0, sizeof(*file));
+    file->fd = -1;
+}
+
+bool recording_minmax(const RecordingFile *file, int channel, uint64_t first, uint64_t last,
+                      int16_t *min, int16_t *max)
+{
+    const RecordingHeader *h = &file->header;
+    if (!file->map || channel < 0 || channel >= (int)h->channels) return false;
+    if (last > h->total_samples) last = h->total_samples;
+    if (first >= last) return false;
+
+    int16_t lo = INT16_MAX, hi = INT16_MIN;
+    bool found = false;
+
+    for (uint64_t k = first / REC_CHUNK_SAMPLES; k * REC_CHUNK_SAMPLES < last; k++) {
+        const uint8_t *chunk = file->map + REC_HEADER_SIZE + k * h->chunk_stride;
+        const RecordingChunkHeader *ch = (const RecordingChunkHeader*)chunk;
+        if (ch->count == 0) continue; // чанк втрачено під час запису
+
+        uint64_t base = k * REC_CHUNK_SAMPLES;
+        uint32_t s0 = first > base ? (uint32_t)(first - base) : 0;
+        uint32_t s1 = last - base < ch->count ? (uint32_t)(last - base) : ch->count;
+        if (s0 >= s1) continue;
+        found = true;
+
+        // Чанк повністю в діапазоні — його підсумок
+        if (s0 == 0 && s1 == ch->count) {
+            int16_t cmin = *chunk_min(chunk, channel);
+            int16_t cmax = *chunk_max(chunk, h->channels, channel);
+            if (cmin < lo) lo = cmin;
+            if (cmax > hi) hi = cmax;
+            continue;
+        }
+
+        const int16_t *bmin = chunk_bmin(chunk, h->channels, channel);
+        const int16_t *bmax = chunk_bmax(chunk, h->channels, channel);
+        const int16_t *data = chunk_data(chunk, h->channels, channel);
+        uint32_t s = s0;
+        while (s < s1) {
+            uint32_t b = s / REC_BLOCK_SAMPLES;
+            uint32_t block_end = (b + 1) * REC_BLOCK_SAMPLES;
+            if (s % REC_BLOCK_SAMPLES == 0 && block_end <= s1) {
+                // Повний блок — його підсумок
+                if (bmin[b] < lo) lo = bmin[b];
+                if (bmax[b] > hi) hi = bmax[b];
+                s = block_end;
+            } else {
+                // Неповний блок на краю діапазону — сирі відліки
+                uint32_t e = block_end < s1 ? block_end : s1;
+                for (; s < e; s++) {
+                    if (data[s] < lo) lo = data[s];
+                    if (data[s] > hi) hi = data[s];
+                }
+            }
+        }
+    }
+
+    if (!found) return false;
+    *min = lo;
+    *max = hi;
+    return true;
+}
+
+void recording_sample(const RecordingFile *file, uint64_t sample, int16_t *values)
+{
+    const RecordingHeader *h = &file->header;
+    const uint8_t *chunk = file->map + REC_HEADER_SIZE + (sample / REC_CHUNK_SAMPLES) * h->chunk_stride;
+    uint32_t i = (uint32_t)(sample % REC_CHUNK_SAMPLES);
+    for (uint32_t c = 0; c < h->channels; c++)
+        values[c] = chunk_data(chunk, h->channels, c)[i];
+}
+
+int recording_extra_bits(const RecordingHeader *header)
+{
+    float v = header->volts_per_count[0];
+    if (!(v > 0.0f)) return 0;
+    int bits = (int)lroundf(log2f(ADC_VREF_VOLTS / ADC_FULL_SCALE / v));
+    return bits < 0 ? 0 : bits > ADC_EXTRA_BITS_MAX ? ADC_EXTRA_BITS_MAX : bits;
+}
@@ -0,0 +1,126 @@
+// file recording.h
+
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#ifndef MAX_CHANNELS
+#define MAX_CHANNELS 16
+#endif
+
+// Формат запису (little-endian, як на хості):
+//   [заголовок RecordingHeader, доповнений нулями до REC_HEADER_SIZE]
+//   [чанк 0][чанк 1]... — кожен чанк має фіксований розмір chunk_stride:
+//     RecordingChunkHeader (номер першого семпла, кількість), int16 min[channels], int16 max[channels]
+//     int16 bmin[channels][blocks], int16 bmax[channels][blocks] — min/max кожного блока
+//     int16 data[channels][chunk_samples] — сирі відліки АЦП, по стовпцю на канал
+// Чанк k починається з REC_HEADER_SIZE + k * chunk_stride, тож доступ до будь-якого
+// семпла і підсумку — O(1) без індексу.
+// Версія 1 — завжди 4 канали (заголовок з масивами на 4 канали); такі файли теж читаються.
+#define REC_MAGIC "OSCREC01"
+#define REC_VERSION 2
+#define REC_HEADER_SIZE 4096
+#define REC_CHUNK_SAMPLES 65536       // Семплів на чанк
+#define REC_BLOCK_SAMPLES 256         // Семплів на блок підсумку всередині чанка
+#define REC_BLOCKS (REC_CHUNK_SAMPLES / REC_BLOCK_SAMPLES)
+#define REC_QUEUE_DEPTH 8             // Чанків у черзі до потоку запису (~4 МБ)
+
+struct OscData;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t channels;
+    uint32_t chunk_samples;
+    uint32_t block_samples;
+    uint32_t chunk_stride;            // Розмір чанка у байтах
+    double sample_rate_hz;            // Оцінка на момент зупинки запису
+    uint64_t total_samples;
+    uint64_t chunk_count;
+    int64_t start_time_ns;            // CLOCK_REALTIME початку запису
+    float volts_per_count[MAX_CHANNELS];
+    float signal_level[MAX_CHANNELS]; // Масштаб відображення каналів під час запису
+    uint32_t complete;                // 1 — файл закрито коректно
+    uint32_t reserved;
+} RecordingHeader;
+
+typedef struct {
+    uint64_t first_sample;
+    uint32_t count;                   // Дійсних семплів у чанку (0 — чанк втрачено)
+    uint32_t reserved;
+    // Далі int16 min[channels], int16 max[channels] — підсумок усього чанка
+} RecordingChunkHeader;
+
+// Запис у файл: прийом лише заповнює буфер чанка, повні чанки пише фоновий потік
+typedef struct {
+    bool active;
+    char path[256];
+    int fd;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool running;
+
+    uint8_t *buffers[REC_QUEUE_DEPTH];
+    bool full[REC_QUEUE_DEPTH];       // Буфер переданий потоку (захищено lock)
+    int fill;                         // Буфер, який зараз заповнюється прийомом
+    int write_pos;                    // Наступний буфер для потоку запису
+    uint32_t fill_count;
+    uint64_t next_chunk;              // Номер чанка, що заповнюється
+
+    int extra_bits;                   // Роздільність файлу (volts_per_count): семпли переводяться в неї
+    uint64_t samples;                 // Прийнято семплів у запис
+    unsigned long long dropped_chunks;// Чанки, викинуті через відставання диска
+    unsigned long long bytes_written;
+    bool error;
+
+    RecordingHeader header;
+} Recorder;
+
+// Відкритий для перегляду запис (mmap, у пам'ять нічого не копіюється)
+typedef struct {
+    int fd;
+    const uint8_t *map;
+    size_t map_size;
+    RecordingHeader header;           // Копія (для незакритих файлів підсумки відновлено)
+} RecordingFile;
+
+// Перегляд запису: масштаб і прокрутка за підсумками, без завантаження в пам'ять
+typedef struct {
+    bool active;
+    char path[256];
+    RecordingFile file;
+    double first;                     // Перший видимий семпл
+    double samples_per_px;            // Масштаб: семплів на стовпчик пікселів
+} RecordingViewer;
+
+// Створює файл і запускає потік запису. 0 при успіху.
+int recording_start(struct OscData *oscData, const char *path);
+
+// Дописує неповний чанк, оновлює заголовок і закриває файл
+void recording_stop(struct OscData *oscData);
+
+// Додає семпл у поточний чанк (викликається при прийомі, ніколи не чекає на диск)
+void recording_on_sample(struct OscData *oscData, const int16_t *raw_values);
+
+int recording_open(RecordingFile *file, const char *path);
+void recording_close(RecordingFile *file);
+
+// Мінімум і максимум каналу на [first, last) через підсумки чанків і блоків.
+// Повертає false, якщо в діапазоні немає записаних семплів.
+bool recording_minmax(const RecordingFile *file, int channel, uint64_t first, uint64_t last,
+                      int16_t *min, int16_t *max);
+
+// Сирі відліки всіх каналів семпла sample (values — header.channels значень)
+void recording_sample(const RecordingFile *file, uint64_t sample, int16_t *values);
+
+// Додаткові біти роздільності відліків файлу (за volts_per_count; старі файли — 0)
+int recording_extra_bits(const RecordingHeader *header);
+
+#endif // RECORDING_H
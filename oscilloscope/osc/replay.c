@@ -0,0 +1,185 @@
+// file replay.c
+
+#include "main.h"
+#include "replay.h"
+#include "parse_data.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int open_raw(ReplaySource *replay, const char *path)
+{
+    replay->raw_fd = open(path, O_RDONLY);
+    if (replay->raw_fd < 0) {
+        fprintf(stderr, "Failed to open replay %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(replay->raw_fd, &st) != 0 || st.st_size < PACKET_SIZE) {
+        fprintf(stderr, "Replay %s is empty\n", path);
+        close(replay->raw_fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, replay->raw_fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Failed to map replay %s: %s\n", path, strerror(errno));
+        close(replay->raw_fd);
+        return -1;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    replay->raw = (const uint8_t*)map;
+    replay->raw_size = (size_t)st.st_size;
+
+    // Темп і кількість семплів — за першим пакетом дампу
+    int have = replay->raw_size < PACKET_MAX_SIZE ? (int)replay->raw_size : PACKET_MAX_SIZE;
+    int size = packet_size(replay->raw, have);
+    int scans = size > 0 ? packet_scans(replay->raw) : 0;
+    replay->raw_sample_bytes = scans > 0 ? (double)size / scans : PACKET_SIZE;
+    return 0;
+}
+
+int replay_open(ReplaySource *replay, const char *path, float speed, float rate_hz, bool loop)
+{
+    memset(replay, 0, sizeof(*replay));
+    replay->raw_fd = -1;
+    snprintf(replay->path, sizeof(replay->path), "%s", path);
+    replay->speed = speed;
+    replay->loop = loop;
+    replay->rate_hz = rate_hz > 0.0f ? rate_hz : REPLAY_DEFAULT_RATE;
+
+    // Сигнатура запису на початку файлу — інакше це сирий дамп
+    char magic[sizeof(((RecordingHeader*)0)->magic)] = {0};
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Failed to open replay %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    size_t got = fread(magic, 1, sizeof(magic), f);
+    fclose(f);
+
+    if (got == sizeof(magic) && memcmp(magic, REC_MAGIC, sizeof(magic)) == 0) {
+        if (recording_open(&replay->recording, path) != 0) return -1;
+        replay->format = REPLAY_RECORDING;
+        if (replay->recording.header.sample_rate_hz > 0.0 && rate_hz <= 0.0f)
+            replay->rate_hz = (float)replay->recording.header.sample_rate_hz;
+    } else {
+        if (open_raw(replay, path) != 0) return -1;
+        replay->format = REPLAY_RAW;
+    }
+
+    replay->start_time = -1.0;
+    replay->active = true;
+    printf("Replay %s (%s) at %s, %.0f S/s%s\n", path,
+           replay->format == REPLAY_RECORDING ? "recording" : "raw dump",
+           speed > 0.0f ? TextFormat("x%.2f", speed) : "max speed", replay->rate_hz, loop ? ", loop" : "");
+    return 0;
+}
+
+void replay_close(ReplaySource *replay)
+{
+    if (!replay->active) return;
+    if (replay->format == REPLAY_RECORDING) {
+        recording_close(&replay->recording);
+    } else {
+        munmap((void*)replay->raw, replay->raw_size);
+        close(replay->raw_fd);
+    }
+    replay->active = false;
+}
+
+// Пакет 0xAA + 4 x (id, lo, hi), як його надсилає прошивка.
+// Із запису кількох плат відтворюються перші 4 канали (потік байтів однієї плати).
+static void build_packet(uint8_t *p, const RecordingFile *file, uint64_t sample)
+{
+    int16_t values[MAX_CHANNELS] = {0};
+    recording_sample(file, sample, values);
+
+    p[0] = 0xAA;
+    for (int c = 0; c < 4; c++) {
+        uint16_t v = (uint16_t)values[c];
+        p[1 + c * 3] = (uint8_t)c;
+        p[2 + c * 3] = (uint8_t)(v & 0xFF);
+        p[3 + c * 3] = (uint8_t)(v >> 8);
+    }
+}
+
+static void report_finished(ReplaySource *replay)
+{
+    double elapsed = now_seconds() - replay->first_read_time;
+    uint64_t samples = replay->format == REPLAY_RAW ? (uint64_t)(replay->raw_size / replay->raw_sample_bytes)
+                                                   : replay->position;
+    printf("Replay finished: %llu samples in %.3f s (%.0f S/s)\n",
+           (unsigned long long)samples, elapsed, elapsed > 0.0 ? samples / elapsed : 0.0);
+    replay->finished = true;
+}
+
+int replay_read(ReplaySource *replay, uint8_t *buf, int size)
+{
+    if (!replay->active || replay->finished) return 0;
+
+    double now = now_seconds();
+    if (replay->start_time < 0.0) {
+        replay->start_time = now;
+        replay->first_read_time = now;
+    }
+
+    // Скільки одиниць (байтів або семплів) дозволено видати до цього моменту
+    uint64_t unit_bytes = replay->format == REPLAY_RAW ? 1 : PACKET_SIZE;
+    uint64_t budget = (uint64_t)size / unit_bytes;
+    if (replay->speed > 0.0f) {
+        double units_per_s = (double)replay->rate_hz * replay->speed
+                           * (replay->format == REPLAY_RAW ? replay->raw_sample_bytes : 1.0);
+        uint64_t allowed = (uint64_t)((now - replay->start_time) * units_per_s);
+        if (allowed <= replay->emitted) return 0;
+        if (allowed - replay->emitted < budget) budget = allowed - replay->emitted;
+    }
+
+    uint64_t total = replay->format == REPLAY_RAW ? replay->raw_size : replay->recording.header.total_samples;
+    uint64_t count = 0;
+    while (count < budget) {
+        if (replay->position >= total) {
+            if (!replay->loop) {
+                if (count == 0) report_finished(replay);
+                break;
+            }
+            replay->position = 0;
+        }
+
+        uint64_t n = budget - count;
+        if (n > total - replay->position) n = total - replay->position;
+
+        if (replay->format == REPLAY_RAW) {
+            memcpy(buf + count, replay->raw + replay->position, (size_t)n);
+        } else {
+            for (uint64_t i = 0; i < n; i++)
+                build_packet(buf + (count + i) * PACKET_SIZE, &replay->recording, replay->position + i);
+        }
+        replay->position += n;
+        count += n;
+    }
+
+    replay->emitted += count;
+    return (int)(count * unit_bytes);
+}
+
+FILE *replay_dump_open(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) fprintf(stderr, "Failed to create dump %s: %s\n", path, strerror(errno));
+    else printf("Dumping received bytes to %s\n", path);
+    return f;
+}
@@ -0,0 +1,53 @@
+// file replay.h
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "recording.h"
+
+#define REPLAY_DEFAULT_RATE 1000.0f  // Семплів/с для сирих дампів без відомої частоти
+
+typedef enum {
+    REPLAY_RAW = 0,                  // Сирий потік байтів, як його прийняв COM-порт (--dump)
+    REPLAY_RECORDING                 // Файл запису .oscrec (F3)
+} ReplayFormat;
+
+// Відтворення з файлу замість COM-порту: read_usb_device() отримує ті самі байти пакетів,
+// що й від пристрою, тож увесь ланцюжок (розбір, тригер, декодери, малювання) працює як наживо
+typedef struct {
+    bool active;
+    bool finished;                   // Файл дочитано (без --loop)
+    char path[256];
+    ReplayFormat format;
+    float speed;                     // 1 — реальний час, >0 — множник, <= 0 — якнайшвидше
+    float rate_hz;                   // Частота дискретизації запису
+    bool loop;
+
+    const uint8_t *raw;              // Сирий дамп (mmap)
+    size_t raw_size;
+    double raw_sample_bytes;         // Байтів дампу на семпл за першим пакетом (0xAD і 0xAE несуть кілька сканів)
+    int raw_fd;
+    RecordingFile recording;
+
+    uint64_t position;               // Байт (сирий дамп) або семпл (запис), що видається наступним
+    uint64_t emitted;                // Видано одиниць від початку відліку часу
+    double start_time;               // Початок відліку для темпу, -1 — ще не почато
+    double first_read_time;          // Для підсумку швидкості наприкінці
+} ReplaySource;
+
+// Відкриває файл для відтворення; формат визначається за сигнатурою.
+// rate_hz використовується для сирих дампів і записів без збереженої частоти.
+int replay_open(ReplaySource *replay, const char *path, float speed, float rate_hz, bool loop);
+void replay_close(ReplaySource *replay);
+
+// Видає до size байтів пакетів у темпі відтворення (аналог RS232_PollComport)
+int replay_read(ReplaySource *replay, uint8_t *buf, int size);
+
+// Дамп сирих байтів з COM-порту для подальшого відтворення
+FILE *replay_dump_open(const char *path);
+
+#endif // REPLAY_H
@@ -0,0 +1,189 @@
+// file segments.c
+
+#include "main.h"
+#include "segments.h"
+#include "trigger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+// Монотонний час у секундах для позначок часу сегментів
+static double monotonic_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int segments_setup(OscData *oscData, int count, int pre_samples, int post_samples)
+{
+    SegmentedCapture *seg = &oscData->segments;
+
+    segments_free(oscData);
+
+    if (count < 1) count = 1;
+    if (count > MAX_SEGMENTS) count = MAX_SEGMENTS;
+    if (pre_samples < 0) pre_samples = 0;
+    if (post_samples < 2) post_samples = 2;
+
+    seg->count = count;
+    seg->pre_samples = pre_samples;
+    seg->post_samples = post_samples;
+    seg->length = pre_samples + post_samples;
+
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        if (!oscData->channels[i].channel_history) continue; // Канал поза channel_count
+        seg->data[i] = (float*)calloc((size_t)count * seg->length, sizeof(float));
+        if (!seg->data[i]) {
+            fprintf(stderr, "Memory allocation failed for segment buffer of channel %d\n", i);
+            segments_free(oscData);
+            return -1;
+        }
+    }
+
+    seg->overlay = false;
+    segments_rearm(oscData);
+    seg->enabled = true;
+    return 0;
+}
+
+void segments_free(OscData *oscData)
+{
+    SegmentedCapture *seg = &oscData->segments;
+
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        free(seg->data[i]);
+        seg->data[i] = NULL;
+    }
+    seg->enabled = false;
+    seg->captured = 0;
+    seg->write_segment = 0;
+    seg->post_remaining = 0;
+}
+
+void segments_rearm(OscData *oscData)
+{
+    SegmentedCapture *seg = &oscData->segments;
+
+    seg->write_segment = 0;
+    seg->captured = 0;
+    seg->post_remaining = 0;
+    seg->zone = 0;
+    seg->view_segment = 0;
+
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        oscData->channels[i].trigger_locked = false;
+        oscData->channels[i].frames_since_trigger = 0;
+    }
+}
+
+// Копіює передтригерне вікно з кільцевого буфера історії в початок сегмента.
+// Якщо історії менше, ніж pre_samples, початок доповнюється найстарішим наявним значенням.
+static void copy_pre_trigger(OscData *oscData, float *dst, const float *history, int pre)
+{
+    int size = oscData->history_size;
+    int avail = oscData->valid_points - 1; // поточна точка тригера не входить у передісторію
+    if (avail > size - 1) avail = size - 1;
+    if (avail > pre) avail = pre;
+    if (avail < 0) avail = 0;
+
+    int pad = pre - avail;
+    int start = (oscData->history_index - avail + size) % size;
+    float first = avail > 0 ? history[start] : history[oscData->history_index];
+
+    for (int j = 0; j < pad; j++) dst[j] = first;
+    for (int j = 0; j < avail; j++) dst[pad + j] = history[(start + j) % size];
+}
+
+void segments_on_sample(OscData *oscData)
+{
+    SegmentedCapture *seg = &oscData->segments;
+    if (!seg->enabled || seg->captured >= seg->count) return;
+
+    int idx = oscData->history_index;
+
+    // Запис післятригерної частини сегмента, що заповнюється
+    if (seg->post_remaining > 0) {
+        int pos = seg->length - seg->post_remaining;
+        float *base[MAX_CHANNELS];
+        for (int i = 0; i < MAX_CHANNELS; i++) {
+            float *history = oscData->channels[i].channel_history;
+            if (!history || !seg->data[i]) continue;
+            base[i] = seg->data[i] + (size_t)seg->write_segment * seg->length;
+            base[i][pos] = history[idx];
+        }
+
+        if (--seg->post_remaining == 0) {
+            // Сегмент заповнено — одразу переходимо до наступного без мертвого часу
+            int src = seg->info[seg->write_segment].channel;
+            oscData->channels[src].trigger_locked = false;
+            seg->view_segment = seg->write_segment;
+            seg->captured++;
+            seg->write_segment++;
+        }
+    }
+
+    // Пошук фронту на каналі-джерелі (тригер Шмітта з гістерезисом), в тому числі
+    // під час запису сегмента — щоб зона була актуальною на момент переозброєння
+    int src = oscData->active_channel;
+    ChannelSettings *ch = &oscData->channels[src];
+    if (!ch->channel_history) return;
+
+    float v = ch->channel_history[idx];
+    float level = ch->trigger_level * WORKSPACE_HEIGHT;
+    float hyst = fabsf(ch->trigger_hysteresis_px);
+    int prev_zone = seg->zone;
+
+    if (v >= level + hyst) seg->zone = 1;
+    else if (v <= level - hyst) seg->zone = -1;
+
+    if (seg->post_remaining > 0 || seg->captured >= seg->count) return;
+    if (prev_zone == 0 || prev_zone == seg->zone) return;
+
+    bool fired;
+    if (ch->trigger_edge == TRIGGER_EDGE_RISING) fired = (seg->zone == 1);
+    else if (ch->trigger_edge == TRIGGER_EDGE_FALLING) fired = (seg->zone == -1);
+    else fired = true; // TRIGGER_EDGE_AUTO — будь-який фронт
+
+    if (!fired) return;
+
+    // Спрацювання: фіксуємо передісторію і точку тригера
+    SegmentInfo *info = &seg->info[seg->write_segment];
+    info->trigger_sample = oscData->sample_count;
+    info->timestamp = monotonic_seconds();
+    info->channel = src;
+
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        float *history = oscData->channels[i].channel_history;
+        if (!history || !seg->data[i]) continue;
+        float *dst = seg->data[i] + (size_t)seg->write_segment * seg->length;
+        copy_pre_trigger(oscData, dst, history, seg->pre_samples);
+        dst[seg->pre_samples] = history[idx];
+    }
+
+    seg->post_remaining = seg->post_samples - 1;
+    ch->trigger_locked = true;
+    ch->frames_since_trigger = 0;
+}
+
+void segments_update(OscData *oscData)
+{
+    SegmentedCapture *seg = &oscData->segments;
+    if (!seg->enabled) return;
+
+    // Лічильник кадрів після останнього спрацювання — показує, як довго чекаємо на тригер
+    oscData->channels[oscData->active_channel].frames_since_trigger++;
+
+    if (seg->view_segment >= seg->captured && seg->captured > 0)
+        seg->view_segment = seg->captured - 1;
+    if (seg->view_segment < 0) seg->view_segment = 0;
+}
+
+const float *segments_get(const OscData *oscData, int channel, int segment)
+{
+    const SegmentedCapture *seg = &oscData->segments;
+    if (!seg->enabled || channel < 0 || channel >= MAX_CHANNELS) return NULL;
+    if (segment < 0 || segment >= seg->captured || !seg->data[channel]) return NULL;
+    return seg->data[channel] + (size_t)segment * seg->length;
+}
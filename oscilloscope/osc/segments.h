@@ -0,0 +1,67 @@
+// file segments.h
+
+#ifndef SEGMENTS_H
+#define SEGMENTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef MAX_CHANNELS
+#define MAX_CHANNELS 16
+#endif
+
+#define MAX_SEGMENTS 256             // Максимальна кількість сегментів у глибокому буфері
+#define DEFAULT_SEGMENTS 32          // Кількість сегментів за замовчуванням
+#define DEFAULT_SEGMENT_PRE 100      // Точок до тригера за замовчуванням
+#define DEFAULT_SEGMENT_POST 400     // Точок після тригера за замовчуванням
+
+struct OscData;
+
+// Опис одного захопленого сегмента
+typedef struct {
+    unsigned long long trigger_sample; // Абсолютний номер семпла, на якому спрацював тригер
+    double timestamp;                  // Час спрацювання (секунди монотонного годинника)
+    int channel;                       // Канал-джерело тригера
+} SegmentInfo;
+
+// Сегментована пам'ять: глибокий буфер, поділений на count сегментів однакової довжини
+typedef struct {
+    bool enabled;               // Режим сегментованого захоплення увімкнено
+    int count;                  // Кількість сегментів N
+    int pre_samples;            // Точок до тригера у кожному сегменті
+    int post_samples;           // Точок після тригера (включно з точкою тригера)
+    int length;                 // Довжина сегмента = pre_samples + post_samples
+    float *data[MAX_CHANNELS];  // Глибокий буфер каналу: count * length значень
+
+    SegmentInfo info[MAX_SEGMENTS];
+    int write_segment;          // Сегмент, що заповнюється зараз
+    int captured;               // Кількість повністю заповнених сегментів
+    int post_remaining;         // Скільки точок після тригера ще треба записати (0 = очікування)
+    int zone;                   // Зона сигналу відносно гістерезису: -1 нижче, 1 вище, 0 невідомо
+
+    int view_segment;           // Сегмент, який показує переглядач
+    bool overlay;               // Накладати всі сегменти один на одного
+} SegmentedCapture;
+
+// Виділяє глибокий буфер на count сегментів по pre + post точок і вмикає режим.
+// Повертає 0 при успіху, -1 при помилці виділення пам'яті.
+int segments_setup(struct OscData *oscData, int count, int pre_samples, int post_samples);
+
+// Вимикає режим і звільняє глибокий буфер
+void segments_free(struct OscData *oscData);
+
+// Скидає захоплені сегменти і заново озброює тригер (без перевиділення пам'яті)
+void segments_rearm(struct OscData *oscData);
+
+// Викликається з тракту прийому для кожного нового семпла, вже записаного в channel_history
+// за індексом oscData->history_index. Працює за O(1) на семпл, окрім моменту
+// спрацювання тригера, коли з кільцевого буфера копіюється передтригерне вікно.
+void segments_on_sample(struct OscData *oscData);
+
+// Оновлення стану один раз на цикл оновлення інтерфейсу (лічильники кадрів)
+void segments_update(struct OscData *oscData);
+
+// Вказівник на дані сегмента segment каналу channel (length значень) або NULL
+const float *segments_get(const struct OscData *oscData, int channel, int segment);
+
+#endif // SEGMENTS_H
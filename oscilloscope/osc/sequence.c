@@ -0,0 +1,99 @@
+// file sequence.c
+
+#include "sequence.h"
+#include <string.h>
+#include <math.h>
+
+static const char *gap_mode_names[GAP_MODE_COUNT] = { "ignore", "mark", "interp" };
+
+void seq_reset(SeqTracker *t)
+{
+    memset(t, 0, sizeof(*t));
+}
+
+// Відстань від a вперед до b за модулем 2^24
+static uint32_t seq_ahead(uint32_t a, uint32_t b)
+{
+    return (b - a) & SEQ_MASK;
+}
+
+static void seq_hold(SeqTracker *t, uint32_t seq, const SamplePacket *packet)
+{
+    t->holding = true;
+    t->held_seq = seq;
+    t->held = *packet;
+}
+
+SeqStatus seq_check(SeqTracker *t, uint32_t seq, const SamplePacket *packet,
+                    SamplePacket *released, uint32_t *lost)
+{
+    *lost = 0;
+    if (!t->valid) {
+        t->valid = true;
+        t->last = seq;
+        return SEQ_OK;
+    }
+
+    if (!t->holding) {
+        if (seq == ((t->last + 1) & SEQ_MASK)) {
+            t->last = seq;
+            return SEQ_OK;
+        }
+        seq_hold(t, seq, packet);
+        return SEQ_HOLD;
+    }
+
+    // Рішення щодо відкладеного пакета за номером поточного
+    const uint32_t half = 1u << (SEQ_BITS - 1);
+    uint32_t held_ahead = seq_ahead(t->last, t->held_seq);
+    uint32_t after_held = seq_ahead(t->held_seq, seq);
+    bool held_forward = held_ahead != 0 && held_ahead < half;
+    SeqStatus status;
+
+    *released = t->held;
+    t->holding = false;
+
+    if (after_held == 1) {
+        // Після відкладеного номера послідовність продовжилась — стрибок справжній
+        if (held_forward) {
+            *lost = held_ahead - 1;
+            status = SEQ_GAP;
+        } else if (t->held_seq == t->last) {
+            status = SEQ_DUPLICATE;
+        } else {
+            status = SEQ_RESTART;
+        }
+    } else if (seq == ((t->last + 2) & SEQ_MASK)) {
+        // Поточний стоїть там, де мав бути наступний після відкладеного — номер того спотворено
+        status = SEQ_CORRUPT;
+    } else if (held_forward && after_held < half) {
+        // Два розриви поспіль: перший підтверджено зростанням номерів, другий ще перевіряється
+        *lost = held_ahead - 1;
+        t->last = t->held_seq;
+        seq_hold(t, seq, packet);
+        return SEQ_GAP;
+    } else {
+        status = SEQ_RESTART;
+    }
+
+    t->last = seq;
+    return status;
+}
+
+int16_t seq_gap_value(GapMode mode, int16_t prev, int16_t next, int k, int n)
+{
+    if (mode != GAP_INTERPOLATE) return prev;
+    return (int16_t)lrintf(prev + (float)(next - prev) * k / (n + 1));
+}
+
+const char *gap_mode_name(GapMode mode)
+{
+    return (mode >= 0 && mode < GAP_MODE_COUNT) ? gap_mode_names[mode] : "?";
+}
+
+int gap_mode_parse(const char *name)
+{
+    for (int i = 0; i < GAP_MODE_COUNT; i++)
+        if (strcmp(name, gap_mode_names[i]) == 0) return i;
+    return -1;
+}
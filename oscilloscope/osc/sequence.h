@@ -0,0 +1,74 @@
+// file sequence.h
+
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SEQ_BITS 24                       // Ширина номера пакета (6 біт у кожному з 4 байтів ID)
+#define SEQ_MASK ((1u << SEQ_BITS) - 1)
+#define SEQ_NONE 0xFFFFFFFFu              // Пакет без номера (0xAA)
+#define SEQ_CHANNELS 4                    // Каналів у пакеті однієї плати
+#define PACKET_SCANS_MAX 48               // Найбільше сканів у пакеті (0xAE, 0xAF з одним каналом)
+
+// Розібраний пакет семплів: scans сканів по SEQ_CHANNELS значень. Канали поза mask
+// плата не вимірювала — їхні значення 0. Значення мають extra_bits додаткових біт
+// роздільності (передискретизація на платі): одиниця — 1/2^extra_bits відліку 12-бітного АЦП
+typedef struct {
+    uint8_t mask;
+    uint8_t extra_bits;
+    int scans;
+    bool has_time;       // Плата поставила мітку часу (CTRL_PARAM_TIMESTAMPS)
+    uint32_t time_us;    // Час першого скану за лічильником плати, мкс (32 біти, обертається)
+    uint8_t ets_steps;   // Захоплення в еквівалентному часі (0xAF): кількість кроків, 0 — звичайний пакет
+    uint8_t ets_step;    // Зсув першого скану від фронту, у кроках
+    uint8_t ets_step_cycles; // Крок, такти плати (PACKET_ETS_CLOCK_HZ)
+    int16_t values[PACKET_SCANS_MAX][SEQ_CHANNELS];
+} SamplePacket;
+
+// Що записувати в історію замість втрачених семплів
+typedef enum {
+    GAP_IGNORE = 0,      // Лише рахувати: часова вісь стискається на розрив
+    GAP_MARK,            // NaN у channel_history — лінія розривається
+    GAP_INTERPOLATE,     // Лінійна інтерполяція між сусідніми семплами
+    GAP_MODE_COUNT
+} GapMode;
+
+// Результат seq_check(): що сталося з відкладеним пакетом (released)
+typedef enum {
+    SEQ_OK = 0,          // Очікуваний номер, відкладеного пакета не було
+    SEQ_HOLD,            // Несподіваний номер: поточний пакет відкладено до наступного
+    SEQ_GAP,             // Підтверджено пропуск *lost пакетів: заповнити їх, потім прийняти released
+    SEQ_CORRUPT,         // Номер released спотворено, сам пакет на своєму місці: прийняти
+    SEQ_RESTART,         // Стрибок назад (лічильник почався заново): прийняти released без заповнення
+    SEQ_DUPLICATE        // released повторює останній прийнятий номер: відкинути
+} SeqStatus;
+
+// Номер перевіряється з відставанням на один пакет лише після збою: одиничний спотворений
+// байт ID не повинен виглядати як розрив на тисячі семплів
+typedef struct {
+    bool valid;          // last вже встановлено
+    uint32_t last;       // Номер останнього прийнятого пакета
+    bool holding;        // Є відкладений пакет
+    uint32_t held_seq;
+    SamplePacket held;   // Відкладений пакет
+} SeqTracker;
+
+void seq_reset(SeqTracker *t);
+
+// Перевіряє номер наступного пакета. Після виклику поточний пакет приймається,
+// якщо t->holding == false; інакше його відкладено (скопійовано в t->held).
+// *lost — втрачених пакетів; семплів у кожному стільки ж сканів, скільки в released
+SeqStatus seq_check(SeqTracker *t, uint32_t seq, const SamplePacket *packet,
+                    SamplePacket *released, uint32_t *lost);
+
+// Значення k-го (1..n) з n пропущених семплів між prev і next: утримане або інтерпольоване
+int16_t seq_gap_value(GapMode mode, int16_t prev, int16_t next, int k, int n);
+
+const char *gap_mode_name(GapMode mode);
+
+// "ignore" | "mark" | "interp"; -1 — невідоме ім'я
+int gap_mode_parse(const char *name);
+
+#endif // SEQUENCE_H
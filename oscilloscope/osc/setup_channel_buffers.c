@@ -7,6 +7,10 @@
 void setup_channel_buffers(OscData *oscData) {
     for (int i = 0; i < MAX_CHANNELS; i++) {
         if (oscData->channels[i].channel_history) free(oscData->channels[i].channel_history);
+        oscData->channels[i].channel_history = NULL;
+
+        // Буфери лише для каналів підключених плат (4 на плату)
+        if (i >= oscData->channel_count) continue;
         oscData->channels[i].channel_history = (float*)calloc(oscData->points_to_display, sizeof(float));
 
         if (!oscData->channels[i].channel_history) {
@@ -18,5 +22,9 @@ void setup_channel_buffers(OscData *oscData) {
     oscData->history_size = oscData->points_to_display;
     oscData->valid_points = 0;
     oscData->history_index = 0;
+    oscData->ets.history_start = -1; // Крива була в старому буфері
+
+    // Вікно вимірювань збігається з буфером історії
+    measurements_reset(oscData, oscData->history_size);
 }
 
@@ -0,0 +1,212 @@
+// file spectrum.c
+
+#include "main.h"
+#include "spectrum.h"
+#include "read_usb_device.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Приватний стан фонового потоку: план ППФ і накопичувач усереднення
+typedef struct {
+    FftPlan *plan;
+    float *power;
+    float *avg;
+    int avg_count;
+    int size;
+    int channel;
+    FftWindow window;
+    SpectrumAveraging averaging;
+} SpectrumWorker;
+
+static void apply_averaging(SpectrumWorker *w, int bins)
+{
+    if (w->averaging == SPECTRUM_AVG_NONE || w->avg_count == 0) {
+        memcpy(w->avg, w->power, bins * sizeof(float));
+    } else if (w->averaging == SPECTRUM_AVG_LINEAR) {
+        // Кумулятивне середнє перших N спектрів, далі — ковзне з вагою 1/N
+        int n = w->avg_count < SPECTRUM_LINEAR_COUNT ? w->avg_count + 1 : SPECTRUM_LINEAR_COUNT;
+        float k = 1.0f / n;
+        for (int i = 0; i < bins; i++) w->avg[i] += (w->power[i] - w->avg[i]) * k;
+    } else if (w->averaging == SPECTRUM_AVG_EXPONENTIAL) {
+        for (int i = 0; i < bins; i++) w->avg[i] += (w->power[i] - w->avg[i]) * SPECTRUM_EXP_ALPHA;
+    } else { // SPECTRUM_AVG_PEAK_HOLD
+        for (int i = 0; i < bins; i++) if (w->power[i] > w->avg[i]) w->avg[i] = w->power[i];
+    }
+    w->avg_count++;
+}
+
+static void *spectrum_thread(void *arg)
+{
+    SpectrumAnalyzer *sa = (SpectrumAnalyzer*)arg;
+    SpectrumWorker w = {0};
+    w.power = (float*)malloc((FFT_MAX_SIZE / 2 + 1) * sizeof(float));
+    w.avg = (float*)malloc((FFT_MAX_SIZE / 2 + 1) * sizeof(float));
+
+    pthread_mutex_lock(&sa->lock);
+    while (sa->running) {
+        if (!sa->job_pending) {
+            pthread_cond_wait(&sa->cond, &sa->lock);
+            continue;
+        }
+
+        int size = sa->job_size;
+        int channel = sa->job_channel;
+        float rate = sa->job_rate;
+        FftWindow window = sa->job_window;
+        SpectrumAveraging averaging = sa->job_averaging;
+        pthread_mutex_unlock(&sa->lock);
+
+        // План перебудовується лише при зміні розміру або вікна
+        if (!w.plan || w.plan->n != size || w.plan->window != window) {
+            fft_plan_destroy(w.plan);
+            w.plan = fft_plan_create(size, window);
+        }
+        // Будь-яка зміна параметрів скидає накопичене усереднення
+        if (w.size != size || w.channel != channel || w.window != window || w.averaging != averaging) {
+            w.avg_count = 0;
+            w.size = size;
+            w.channel = channel;
+            w.window = window;
+            w.averaging = averaging;
+        }
+
+        int bins = size / 2 + 1;
+        if (w.plan && w.power && w.avg) {
+            // Знімок sa->job не змінюється, поки job_pending == true
+            fft_power_spectrum(w.plan, sa->job, w.power);
+            apply_averaging(&w, bins);
+            for (int i = 0; i < bins; i++) {
+                float db = 10.0f * log10f(w.avg[i] + 1e-20f);
+                sa->back_db[i] = db < SPECTRUM_FLOOR_DB ? SPECTRUM_FLOOR_DB : db;
+            }
+        }
+
+        pthread_mutex_lock(&sa->lock);
+        if (w.plan && w.power && w.avg) {
+            float *t = sa->front_db;
+            sa->front_db = sa->back_db;
+            sa->back_db = t;
+            sa->front_bins = bins;
+            sa->front_rate = rate;
+            sa->front_size = size;
+            sa->front_gen++;
+        }
+        sa->job_pending = false;
+    }
+    pthread_mutex_unlock(&sa->lock);
+
+    fft_plan_destroy(w.plan);
+    free(w.power);
+    free(w.avg);
+    return NULL;
+}
+
+int spectrum_start(SpectrumAnalyzer *sa)
+{
+    if (sa->running) return 0;
+
+    int bins = FFT_MAX_SIZE / 2 + 1;
+    sa->job = (float*)calloc(FFT_MAX_SIZE, sizeof(float));
+    sa->front_db = (float*)calloc(bins, sizeof(float));
+    sa->back_db = (float*)calloc(bins, sizeof(float));
+    sa->view_db = (float*)calloc(bins, sizeof(float));
+    if (!sa->job || !sa->front_db || !sa->back_db || !sa->view_db) {
+        fprintf(stderr, "Memory allocation failed for spectrum analyzer\n");
+        spectrum_stop(sa);
+        return -1;
+    }
+
+    if (sa->fft_size == 0) sa->fft_size = SPECTRUM_DEFAULT_SIZE;
+    sa->job_pending = false;
+    sa->front_gen = sa->view_gen = 0;
+    sa->front_bins = sa->view_bins = 0;
+
+    pthread_mutex_init(&sa->lock, NULL);
+    pthread_cond_init(&sa->cond, NULL);
+    sa->running = true;
+    if (pthread_create(&sa->thread, NULL, spectrum_thread, sa) != 0) {
+        fprintf(stderr, "Failed to start spectrum thread\n");
+        sa->running = false;
+        pthread_cond_destroy(&sa->cond);
+        pthread_mutex_destroy(&sa->lock);
+        spectrum_stop(sa);
+        return -1;
+    }
+    return 0;
+}
+
+void spectrum_stop(SpectrumAnalyzer *sa)
+{
+    if (sa->running) {
+        pthread_mutex_lock(&sa->lock);
+        sa->running = false;
+        pthread_cond_signal(&sa->cond);
+        pthread_mutex_unlock(&sa->lock);
+        pthread_join(sa->thread, NULL);
+        pthread_cond_destroy(&sa->cond);
+        pthread_mutex_destroy(&sa->lock);
+    }
+    free(sa->job);
+    free(sa->front_db);
+    free(sa->back_db);
+    free(sa->view_db);
+    sa->job = sa->front_db = sa->back_db = sa->view_db = NULL;
+}
+
+void spectrum_submit(OscData *oscData)
+{
+    SpectrumAnalyzer *sa = &oscData->spectrum;
+    if (!sa->enabled || !sa->running) return;
+
+    int ch = oscData->active_channel;
+    float *history = oscData->channels[ch].channel_history;
+    if (!history) return;
+
+    // Фактичний розмір — найбільший степінь двійки, для якого вже є дані
+    int avail = oscData->valid_points < oscData->history_size ? oscData->valid_points : oscData->history_size;
+    int size = sa->fft_size;
+    while (size > avail && size > FFT_MIN_SIZE) size /= 2;
+    if (size > avail) return;
+
+    if (pthread_mutex_trylock(&sa->lock) != 0) return;
+    if (!sa->job_pending) {
+        // Останні size відліків у хронологічному порядку, у вольтах
+        int start = (oscData->history_index - size + oscData->history_size) % oscData->history_size;
+        // Втрачені семпли (NaN) замінюються попереднім значенням, інакше зіпсують усе ППФ
+        float prev = 0.0f;
+        for (int i = 0; i < size; i++) {
+            float v = history[(start + i) % oscData->history_size];
+            if (isnan(v)) v = prev;
+            sa->job[i] = history_to_volts(oscData, ch, v);
+            prev = v;
+        }
+
+        sa->job_size = size;
+        sa->job_channel = ch;
+        sa->job_rate = oscData->sample_rate_hz;
+        sa->job_window = sa->window;
+        sa->job_averaging = sa->averaging;
+        sa->job_pending = true;
+        pthread_cond_signal(&sa->cond);
+    }
+    pthread_mutex_unlock(&sa->lock);
+}
+
+bool spectrum_fetch(SpectrumAnalyzer *sa)
+{
+    if (!sa->running) return false;
+
+    if (pthread_mutex_trylock(&sa->lock) == 0) {
+        if (sa->front_gen != sa->view_gen && sa->front_bins > 0) {
+            memcpy(sa->view_db, sa->front_db, sa->front_bins * sizeof(float));
+            sa->view_bins = sa->front_bins;
+            sa->view_rate = sa->front_rate;
+            sa->view_size = sa->front_size;
+            sa->view_gen = sa->front_gen;
+        }
+        pthread_mutex_unlock(&sa->lock);
+    }
+    return sa->view_bins > 0;
+}
@@ -0,0 +1,77 @@
+// file spectrum.h
+
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "fft.h"
+
+#define SPECTRUM_DEFAULT_SIZE 4096
+#define SPECTRUM_LINEAR_COUNT 16     // Кількість спектрів для лінійного усереднення
+#define SPECTRUM_EXP_ALPHA 0.2f      // Коефіцієнт експоненційного усереднення
+#define SPECTRUM_FLOOR_DB -160.0f
+
+struct OscData;
+
+typedef enum {
+    SPECTRUM_AVG_NONE = 0,
+    SPECTRUM_AVG_LINEAR,
+    SPECTRUM_AVG_EXPONENTIAL,
+    SPECTRUM_AVG_PEAK_HOLD,
+    SPECTRUM_AVG_COUNT
+} SpectrumAveraging;
+
+// Спектроаналізатор: ППФ виконується у фоновому потоці, цикл малювання лише
+// передає знімок історії (якщо потік вільний) і забирає готовий результат
+typedef struct {
+    bool enabled;                 // Показувати спектр
+    int fft_size;                 // Запитаний розмір ППФ (степінь двійки)
+    FftWindow window;
+    SpectrumAveraging averaging;
+
+    // Стан фонового потоку
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool running;
+
+    // Завдання: знімок сигналу у вольтах (захищено lock, поки job_pending == false)
+    float *job;
+    int job_size;                 // Фактичний розмір ППФ для цього завдання
+    int job_channel;
+    float job_rate;               // Частота дискретизації на момент знімка
+    FftWindow job_window;
+    SpectrumAveraging job_averaging;
+    bool job_pending;             // Знімок переданий потоку і ще не оброблений
+
+    // Результат у дБВ: потік пише в back, під lock міняє місцями з front
+    float *front_db;
+    float *back_db;
+    int front_bins;
+    float front_rate;
+    int front_size;
+    unsigned int front_gen;       // Збільшується з кожним новим результатом
+
+    // Копія результату для малювання (лише в потоці інтерфейсу)
+    float *view_db;
+    int view_bins;
+    float view_rate;
+    int view_size;
+    unsigned int view_gen;
+} SpectrumAnalyzer;
+
+// Запуск фонового потоку і виділення буферів під FFT_MAX_SIZE. 0 при успіху.
+int spectrum_start(SpectrumAnalyzer *sa);
+
+// Зупинка потоку і звільнення буферів
+void spectrum_stop(SpectrumAnalyzer *sa);
+
+// Передає потоку знімок останніх відліків активного каналу, якщо потік вільний.
+// Ніколи не чекає на потік: якщо він зайнятий, кадр просто пропускається.
+void spectrum_submit(struct OscData *oscData);
+
+// Забирає найсвіжіший готовий результат у view_db. Повертає true, якщо дані є.
+bool spectrum_fetch(SpectrumAnalyzer *sa);
+
+#endif // SPECTRUM_H
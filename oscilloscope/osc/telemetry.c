@@ -0,0 +1,203 @@
+// file telemetry.c
+
+#include "main.h"
+#include "telemetry.h"
+#include "firmware_profile.h"
+#include <string.h>
+#include <time.h>
+
+#define TELEMETRY_WINDOW_S 1.0   // Вікно для швидкостей і максимумів
+#define TELEMETRY_EMA 0.1        // Вага нового значення в середньому
+
+static const char *stage_names[TELEMETRY_STAGE_COUNT] = { "read", "process", "draw", "present" };
+
+double telemetry_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void telemetry_init(Telemetry *t)
+{
+    memset(t, 0, sizeof(*t));
+    t->start_time = telemetry_now();
+    t->window_start = t->start_time;
+}
+
+const char *telemetry_stage_name(TelemetryStage stage)
+{
+    return (stage >= 0 && stage < TELEMETRY_STAGE_COUNT) ? stage_names[stage] : "?";
+}
+
+void telemetry_on_poll(Telemetry *t, int bytes, double now)
+{
+    t->polls++;
+    if (bytes <= 0) {
+        t->empty_polls++;
+        return;
+    }
+    t->bytes += (unsigned long long)bytes;
+    t->newest_arrival = now;
+}
+
+void telemetry_stage_begin(Telemetry *t, TelemetryStage stage)
+{
+    t->stages[stage].begin = telemetry_now();
+}
+
+void telemetry_stage_end(Telemetry *t, TelemetryStage stage)
+{
+    StageTiming *s = &t->stages[stage];
+    double ms = (telemetry_now() - s->begin) * 1000.0;
+    s->last_ms = ms;
+    s->avg_ms = s->avg_ms > 0.0 ? s->avg_ms + TELEMETRY_EMA * (ms - s->avg_ms) : ms;
+    if (ms > s->window_max_ms) s->window_max_ms = ms;
+    if (ms > s->total_max_ms) s->total_max_ms = ms;
+}
+
+void telemetry_frame_presented(Telemetry *t)
+{
+    double now = telemetry_now();
+    t->frames++;
+
+    // Затримку рахуємо лише для кадрів, що показали нові дані
+    if (t->newest_arrival > 0.0) {
+        double ms = (now - t->newest_arrival) * 1000.0;
+        t->latency_ms = ms;
+        t->latency_avg_ms = t->latency_avg_ms > 0.0 ? t->latency_avg_ms + TELEMETRY_EMA * (ms - t->latency_avg_ms) : ms;
+        if (ms > t->latency_window_max_ms) t->latency_window_max_ms = ms;
+        if (ms > t->latency_total_max_ms) t->latency_total_max_ms = ms;
+        t->newest_arrival = 0.0;
+    }
+
+    double dt = now - t->window_start;
+    if (dt >= TELEMETRY_WINDOW_S) {
+        t->bytes_per_s = (t->bytes - t->window_bytes) / dt;
+        t->packets_per_s = (t->packets - t->window_packets) / dt;
+        t->frames_per_s = (t->frames - t->window_frames) / dt;
+        t->window_bytes = t->bytes;
+        t->window_packets = t->packets;
+        t->window_frames = t->frames;
+        t->window_start = now;
+
+        t->latency_max_ms = t->latency_window_max_ms;
+        t->latency_window_max_ms = 0.0;
+        for (int i = 0; i < TELEMETRY_STAGE_COUNT; i++) {
+            t->stages[i].max_ms = t->stages[i].window_max_ms;
+            t->stages[i].window_max_ms = 0.0;
+        }
+    }
+}
+
+float telemetry_history_fill(const OscData *oscData)
+{
+    return oscData->history_size > 0 ? (float)oscData->valid_points / oscData->history_size : 0.0f;
+}
+
+int telemetry_recorder_queue(const OscData *oscData)
+{
+    // Без блокування: для індикатора достатньо приблизного значення
+    int n = 0;
+    if (!oscData->recorder.active) return 0;
+    for (int i = 0; i < REC_QUEUE_DEPTH; i++) n += oscData->recorder.full[i];
+    return n;
+}
+
+double telemetry_loss_ratio(const Telemetry *t)
+{
+    unsigned long long expected = t->seq_packets + t->seq_lost;
+    return expected > 0 ? (double)t->seq_lost / expected : 0.0;
+}
+
+double telemetry_delta_ratio(const Telemetry *t)
+{
+    return t->delta_bytes > 0 ? 2.0 * t->delta_values / t->delta_bytes : 0.0;
+}
+
+void telemetry_dump(const OscData *oscData, FILE *f)
+{
+    const Telemetry *t = &oscData->telemetry;
+    double uptime = telemetry_now() - t->start_time;
+
+    fprintf(f, "{\"uptime_s\": %.3f, \"bytes\": %llu, \"packets\": %llu, \"bad_packets\": %llu, "
+               "\"resyncs\": %llu, \"resync_bytes\": %llu, \"polls\": %llu, \"empty_polls\": %llu, "
+               "\"budget_hits\": %llu, \"frames\": %llu, ",
+            uptime, t->bytes, t->packets, t->bad_packets, t->resyncs, t->resync_bytes,
+            t->polls, t->empty_polls, t->budget_hits, t->frames);
+    fprintf(f, "\"avg_bytes_per_s\": %.1f, \"avg_packets_per_s\": %.1f, \"avg_fps\": %.2f, ",
+            uptime > 0.0 ? t->bytes / uptime : 0.0, uptime > 0.0 ? t->packets / uptime : 0.0,
+            uptime > 0.0 ? t->frames / uptime : 0.0);
+    fprintf(f, "\"seq\": {\"packets\": %llu, \"gaps\": %llu, \"lost\": %llu, \"duplicates\": %llu, "
+               "\"errors\": %llu, \"restarts\": %llu, \"loss_ratio\": %.6f}, ",
+            t->seq_packets, t->seq_gaps, t->seq_lost, t->seq_duplicates, t->seq_errors, t->seq_restarts,
+            telemetry_loss_ratio(t));
+    fprintf(f, "\"delta\": {\"blocks\": %llu, \"bytes\": %llu, \"values\": %llu, \"ratio\": %.3f}, ",
+            t->delta_blocks, t->delta_bytes, t->delta_values, telemetry_delta_ratio(t));
+    if (oscData->devices.count > 0) {
+        const DeviceSet *set = &oscData->devices;
+        fprintf(f, "\"merge_overruns\": %llu, \"devices\": [", set->merge_overruns);
+        for (int d = 0; d < set->count; d++) {
+            const Device *dev = &set->devices[d];
+            DeviceClock clock = devices_clock((Device*)dev);
+            fprintf(f, "{\"name\": \"%s\", \"bytes\": %llu, \"packets\": %llu, \"bad_packets\": %llu, "
+                       "\"seq_gaps\": %llu, \"seq_lost\": %llu, \"merge_gaps\": %llu, "
+                       "\"timestamped\": %s, \"rate_hz\": %.3f, \"drift_ppm\": %.2f}%s",
+                    dev->name, dev->bytes, dev->packets, dev->bad_packets, dev->seq_gaps, dev->seq_lost,
+                    dev->merge_gaps, clock.timestamped ? "true" : "false",
+                    clock.valid ? 1.0 / clock.period : 0.0, clock.drift_ppm, d + 1 < set->count ? ", " : "");
+        }
+        fprintf(f, "], ");
+    }
+    if (oscData->transport != USB_TRANSPORT_TTY) {
+        const UsbBulk *b = &oscData->usb_bulk;
+        fprintf(f, "\"usb_bulk\": {\"transport\": \"%s\", \"urbs\": %d, \"urb_bytes\": %d, "
+                   "\"completed\": %llu, \"short\": %llu, \"errors\": %llu, \"ring_dropped\": %llu}, ",
+                usb_transport_name(oscData->transport), USB_BULK_URBS, USB_BULK_URB_BYTES,
+                b->urbs_completed, b->urbs_short, b->urb_errors, b->ring_dropped);
+    }
+    // Годинник за мітками плати (без плат --devices): частота, дрейф кварцу, сегменти темпу
+    const DeviceTime *dt = &oscData->device_time;
+    DeviceClock clock = device_time_clock(dt);
+    fprintf(f, "\"clock\": {\"timestamped\": %s, \"rate_hz\": %.3f, \"drift_ppm\": %.2f, \"segments\": %u}, ",
+            clock.valid ? "true" : "false", clock.valid ? 1.0 / clock.period : 0.0, clock.drift_ppm, dt->segments);
+    // Захоплення в еквівалентному часі: кроки, крок у тактах плати, зібрані криві
+    const EtsComposite *e = &oscData->ets;
+    fprintf(f, "\"ets\": {\"active\": %s, \"steps\": %d, \"step_cycles\": %d, \"rate_hz\": %.1f, "
+               "\"captures\": %llu, \"sweeps\": %llu, \"restarts\": %llu}, ",
+            e->active ? "true" : "false", e->steps, e->step_cycles, ets_rate_hz(e), e->captures, e->sweeps,
+            e->restarts);
+    const ControlLink *c = &oscData->control;
+    fprintf(f, "\"control\": {\"requests\": %llu, \"acks\": %llu, \"naks\": %llu, \"retries\": %llu, "
+               "\"timeouts\": %llu, \"bad_frames\": %llu, \"rtt_ms\": %.3f}, ",
+            c->requests, c->acks, c->naks, c->retries, c->timeouts, c->bad_frames, c->rtt_ms);
+    // Профіль прошивки (--profile): останнє прочитане вікно плати
+    FirmwareProfile fw = c->stat_sweeps > 0 ? firmware_profile(c->stats) : (FirmwareProfile){0};
+    fprintf(f, "\"firmware\": {\"valid\": %s", fw.valid ? "true" : "false");
+    if (fw.valid) {
+        fprintf(f, ", \"window\": %u, \"window_s\": %.4f, \"busy\": %.4f, \"scans_per_s\": %.1f, "
+                   "\"sustainable_scans_per_s\": %.1f, \"packets_per_s\": %.1f, \"tx_busy\": %u, "
+                   "\"rx_overflows\": %u, \"pma_overruns\": %u, \"usb_errors\": %u, \"sections\": {",
+                fw.window, fw.window_s, fw.busy, fw.scans_per_s, fw.sustainable_scans_per_s, fw.packets_per_s,
+                fw.tx_busy, fw.rx_overflows, fw.pma_overruns, fw.usb_errors);
+        for (int s = 0; s < CTRL_PROF_SECTIONS; s++) {
+            const FirmwareSection *fs = &fw.sections[s];
+            fprintf(f, "\"%s\": {\"load\": %.4f, \"count\": %u, \"avg_us\": %.3f, \"max_us\": %.3f, \"hist\": [",
+                    control_prof_section_name(s), fs->load, fs->count, fs->avg_us, fs->max_us);
+            for (int b = 0; b < CTRL_PROF_BUCKETS; b++)
+                fprintf(f, "%u%s", fs->hist[b], b + 1 < CTRL_PROF_BUCKETS ? ", " : "");
+            fprintf(f, "]}%s", s + 1 < CTRL_PROF_SECTIONS ? ", " : "");
+        }
+        fprintf(f, "}");
+    }
+    fprintf(f, "}, ");
+    fprintf(f, "\"latency_ms\": {\"avg\": %.3f, \"max\": %.3f}, ", t->latency_avg_ms, t->latency_total_max_ms);
+    fprintf(f, "\"history_fill\": %.3f, \"recorder_dropped_chunks\": %llu, \"adc_bits\": %d, ",
+            telemetry_history_fill(oscData), oscData->recorder.dropped_chunks, 12 + oscData->adc_extra_bits);
+    fprintf(f, "\"stages_ms\": {");
+    for (int i = 0; i < TELEMETRY_STAGE_COUNT; i++) {
+        fprintf(f, "\"%s\": {\"avg\": %.3f, \"max\": %.3f}%s", stage_names[i],
+                t->stages[i].avg_ms, t->stages[i].total_max_ms, i + 1 < TELEMETRY_STAGE_COUNT ? ", " : "");
+    }
+    fprintf(f, "}}\n");
+}
@@ -0,0 +1,108 @@
+// file telemetry.h
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+struct OscData;
+
+// Етапи кадру, час яких вимірюється окремо
+typedef enum {
+    TELEMETRY_STAGE_READ = 0,    // read_usb_device(): опитування джерела і розбір пакетів
+    TELEMETRY_STAGE_PROCESS,     // Вимірювання, декодер, тригер
+    TELEMETRY_STAGE_DRAW,        // Побудова кадру (BeginDrawing .. перед EndDrawing)
+    TELEMETRY_STAGE_PRESENT,     // EndDrawing(): передача кадру і очікування vsync
+    TELEMETRY_STAGE_COUNT
+} TelemetryStage;
+
+typedef struct {
+    double begin;
+    double last_ms;
+    double avg_ms;               // Експоненційне середнє
+    double max_ms;               // Максимум за останнє завершене вікно
+    double window_max_ms;        // Максимум у поточному вікні
+    double total_max_ms;         // Максимум від початку роботи
+} StageTiming;
+
+// Лічильники конвеєра: завжди ввімкнені, на прийомі — лише інкременти,
+// решта обчислюється раз на кадр
+typedef struct {
+    bool show_hud;
+    double start_time;
+
+    // Прийом (з початку роботи)
+    unsigned long long bytes;
+    unsigned long long packets;          // Розібрані пакети (семпли)
+    unsigned long long bad_packets;      // Пакети семплів, які parse_packet відкинула
+    unsigned long long resync_bytes;     // Байти, відкинуті при пошуку стартового 0xAA
+    unsigned long long resyncs;          // Скільки разів синхронізацію було втрачено
+    bool hunting;                        // Зараз пропускаємо байти до 0xAA
+    unsigned long long polls;
+    unsigned long long empty_polls;
+    unsigned long long budget_hits;      // Виклики, що вичерпали READ_BUDGET_BYTES (джерело відстає)
+
+    // Стиснені блоки 0xAE (CTRL_PARAM_COMPRESSION)
+    unsigned long long delta_blocks;
+    unsigned long long delta_bytes;      // Разом із заголовками
+    unsigned long long delta_values;     // Значень АЦП у блоках
+
+    // Номери пакетів (лише для потоку 0xAB)
+    unsigned long long seq_packets;      // Прийняті пакети з номером
+    unsigned long long seq_gaps;         // Розриви послідовності
+    unsigned long long seq_lost;         // Втрачені семпли за номерами пакетів
+    unsigned long long seq_duplicates;   // Відкинуті повтори
+    unsigned long long seq_errors;       // Спотворені номери (сам пакет прийнято)
+    unsigned long long seq_restarts;     // Лічильник прошивки почався заново
+
+    // Швидкості за останнє вікно (1 с)
+    double window_start;
+    unsigned long long window_bytes;
+    unsigned long long window_packets;
+    unsigned long long window_frames;
+    double bytes_per_s;
+    double packets_per_s;
+    double frames_per_s;
+
+    // Затримка "семпл → кадр": від опитування, що принесло семпл, до кінця EndDrawing
+    double newest_arrival;               // Час опитування з найновішими даними, 0 — нових немає
+    double latency_ms;
+    double latency_avg_ms;
+    double latency_max_ms;               // За останнє вікно
+    double latency_window_max_ms;
+    double latency_total_max_ms;
+
+    unsigned long long frames;
+    StageTiming stages[TELEMETRY_STAGE_COUNT];
+} Telemetry;
+
+double telemetry_now(void);
+
+void telemetry_init(Telemetry *t);
+
+// Підсумок одного опитування джерела: bytes прочитаних байтів на момент now
+void telemetry_on_poll(Telemetry *t, int bytes, double now);
+
+void telemetry_stage_begin(Telemetry *t, TelemetryStage stage);
+void telemetry_stage_end(Telemetry *t, TelemetryStage stage);
+
+// Викликається після EndDrawing(): затримка, кадри, вікно швидкостей
+void telemetry_frame_presented(Telemetry *t);
+
+const char *telemetry_stage_name(TelemetryStage stage);
+
+// Заповненість історії каналів (0..1) і кількість чанків у черзі запису
+float telemetry_history_fill(const struct OscData *oscData);
+int telemetry_recorder_queue(const struct OscData *oscData);
+
+// Частка втрачених пакетів серед пронумерованих (0..1)
+double telemetry_loss_ratio(const Telemetry *t);
+
+// У скільки разів блоки 0xAE коротші за ті самі значення по 2 байти (0 — блоків не було)
+double telemetry_delta_ratio(const Telemetry *t);
+
+// Машинозчитуваний підсумок (JSON)
+void telemetry_dump(const struct OscData *oscData, FILE *f);
+
+#endif // TELEMETRY_H
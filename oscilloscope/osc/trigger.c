@@ -85,6 +85,14 @@ void update_trigger_indices(OscData *oscData) {
     for (int i = 0; i < MAX_CHANNELS; i++) {
         ChannelSettings *ch = &oscData->channels[i];
 
+        // Захоплення в еквівалентному часі: фронт знайшла плата, крива починається з нього
+        if (oscData->ets.active && oscData->ets.history_start >= 0) {
+            int base = oscData->movement_signal ? oscData->history_index : 0;
+            ch->trigger_index = (oscData->ets.history_start - base + oscData->history_size) % oscData->history_size;
+            ch->trigger_locked = true;
+            continue;
+        }
+
         // Перевіряємо, чи канал активний, чи активний тригер і чи є дані історії сигналу
         if (ch->active && ch->trigger_active && ch->channel_history != NULL) {
             // Обчислюємо рівень тригера у пікселях відносно висоти робочої області
@@ -4,7 +4,7 @@
 #include "raylib.h"
 #include <math.h>
 
-static Color channel_colors[MAX_CHANNELS] = { YELLOW, GREEN, RED, BLUE };
+static Color channel_colors[MAX_CHANNELS] = CHANNEL_COLORS;
 
 void trigger_control(OscData *oscData)
 {
@@ -0,0 +1,336 @@
+// file usb_bulk.c
+
+#include "usb_bulk.h"
+#include "parse_data.h"
+#include "control_protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/usbdevice_fs.h>
+#endif
+
+static const char *transport_names[USB_TRANSPORT_COUNT] = { "tty", "usbfs", "sim" };
+
+#ifdef __linux__
+
+#define USB_BULK_RING_MASK ((uint64_t)USB_BULK_RING_BYTES - 1)
+
+struct UsbBulkUrb {
+    bool submitted;
+    int length;                  // Отримано байтів (після завершення)
+    uint8_t data[USB_BULK_URB_BYTES];
+    struct usbdevfs_urb urb;     // Останнім: структура закінчується гнучким масивом
+};
+
+static bool urb_submit(UsbBulk *b, int i)
+{
+    UsbBulkUrb *u = &b->urbs[i];
+    u->length = 0;
+    if (b->sim) {
+        u->submitted = true;
+        return true;
+    }
+
+    memset(&u->urb, 0, sizeof(u->urb));
+    u->urb.type = USBDEVFS_URB_TYPE_BULK;
+    u->urb.endpoint = USB_BULK_EP_IN;
+    u->urb.buffer = u->data;
+    u->urb.buffer_length = USB_BULK_URB_BYTES;
+    u->urb.usercontext = u;
+    u->submitted = ioctl(b->fd, USBDEVFS_SUBMITURB, &u->urb) == 0;
+    return u->submitted;
+}
+
+// Довжина наступного передавання з байтів імітації: пакет семплів або кадр керування цілком
+// (прошивка пише кожен окремо, і контролер завершує його коротким пакетом), інші байти —
+// до наступного стартового. 0 — пакет ще не весь
+static int sim_transfer(const uint8_t *buf, int have)
+{
+    int size = -1;
+    if (packet_start(buf[0])) size = packet_size(buf, have);
+    else if (buf[0] == CTRL_START) size = control_frame_size(buf, have);
+    if (size > 0) return size <= have ? size : 0;
+    if (size == 0) return have == USB_BULK_URB_BYTES ? have : 0;
+
+    int len = 1;
+    while (len < have && !packet_start(buf[len]) && buf[len] != CTRL_START) len++;
+    return len;
+}
+
+// Імітація: URB завершуються в порядку подачі, кожен — одним пакетом з потоку. Поки наступний
+// URB не повернуто в чергу, байти лишаються в потоці — як NAK плати, коли URB немає
+static int urb_reap_sim(UsbBulk *b)
+{
+    UsbBulkUrb *u = &b->urbs[b->sim_next];
+    if (!u->submitted) return -1;
+
+    int len = b->sim_have ? sim_transfer(b->sim_buf, b->sim_have) : 0;
+    if (len == 0) {
+        int n = (int)read(b->fd, b->sim_buf + b->sim_have, sizeof(b->sim_buf) - (size_t)b->sim_have);
+        if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? -1 : -2;
+        if (n == 0) return -2; // Кінець потоку: джерело закрито
+        b->sim_have += n;
+        len = sim_transfer(b->sim_buf, b->sim_have);
+        if (len == 0) return -1;
+    }
+
+    memcpy(u->data, b->sim_buf, (size_t)len);
+    b->sim_have -= len;
+    memmove(b->sim_buf, b->sim_buf + len, (size_t)b->sim_have);
+
+    int i = b->sim_next;
+    b->sim_next = (b->sim_next + 1) % USB_BULK_URBS;
+    u->submitted = false;
+    u->length = len;
+    return i;
+}
+
+// Номер завершеного URB; -1 — ще нічого, -2 — пристрій зник
+static int urb_reap(UsbBulk *b)
+{
+    if (b->sim) return urb_reap_sim(b);
+
+    struct usbdevfs_urb *done = NULL;
+    if (ioctl(b->fd, USBDEVFS_REAPURBNDELAY, &done) != 0)
+        return errno == EAGAIN ? -1 : -2;
+
+    UsbBulkUrb *u = (UsbBulkUrb*)done->usercontext;
+    u->submitted = false;
+    if (done->status == -ENODEV || done->status == -ESHUTDOWN) return -2;
+    if (done->status != 0) {
+        // -EPIPE (stall), -EPROTO і подібні: буфер відкидається, URB іде в чергу знову
+        b->urb_errors++;
+        u->length = 0;
+    } else {
+        u->length = done->actual_length;
+    }
+    return (int)(u - b->urbs);
+}
+
+// Дописує дані URB у кільце; head публікується після запису. Головний потік відстав
+// на ціле кільце — передавання відкидається цілим (розбір знайде наступний пакет)
+static void ring_put(UsbBulk *b, const uint8_t *data, int len)
+{
+    uint64_t head = atomic_load_explicit(&b->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&b->tail, memory_order_acquire);
+    if (USB_BULK_RING_BYTES - (head - tail) < (uint64_t)len) {
+        b->ring_dropped += (unsigned long long)len;
+        return;
+    }
+
+    uint64_t offset = head & USB_BULK_RING_MASK;
+    int first = (int)(USB_BULK_RING_BYTES - offset) < len ? (int)(USB_BULK_RING_BYTES - offset) : len;
+    memcpy(b->ring + offset, data, (size_t)first);
+    memcpy(b->ring, data + first, (size_t)(len - first));
+    atomic_store_explicit(&b->head, head + (uint64_t)len, memory_order_release);
+}
+
+// Потік читання: кожен завершений URB — у кільце і одразу назад у чергу ядра.
+// usbfs сигналізує завершені URB через POLLOUT, імітація — через дані в потоці (POLLIN)
+static void *bulk_thread(void *arg)
+{
+    UsbBulk *b = (UsbBulk*)arg;
+    struct pollfd pfd = { .fd = b->fd, .events = b->sim ? POLLIN : POLLOUT | POLLWRNORM };
+
+    while (atomic_load(&b->running)) {
+        int i = urb_reap(b);
+        if (i == -2) break;
+        if (i == -1) {
+            pfd.revents = 0;
+            if (poll(&pfd, 1, USB_BULK_WAIT_MS) > 0 && (pfd.revents & (POLLERR | POLLNVAL))) break;
+            continue;
+        }
+
+        UsbBulkUrb *u = &b->urbs[i];
+        if (u->length > 0) {
+            // Помилку або пакет нульової довжини не рахуємо; буфер однаково йде в чергу знову
+            b->urbs_completed++;
+            if (u->length < USB_BULK_URB_BYTES) b->urbs_short++;
+            ring_put(b, u->data, u->length);
+        }
+        if (!urb_submit(b, i)) break;
+    }
+    atomic_store(&b->lost, atomic_load(&b->running));
+    return NULL;
+}
+
+// cdc_acm тримає обидва інтерфейси плати; від'єднання від інтерфейсу даних звільняє їх
+static bool claim_interface(UsbBulk *b)
+{
+    struct usbdevfs_ioctl cmd = { .ifno = USB_BULK_DATA_INTERFACE, .ioctl_code = USBDEVFS_DISCONNECT, .data = NULL };
+    if (ioctl(b->fd, USBDEVFS_IOCTL, &cmd) == 0) b->reattach = true;
+
+    unsigned int ifno = USB_BULK_DATA_INTERFACE;
+    if (ioctl(b->fd, USBDEVFS_CLAIMINTERFACE, &ifno) != 0) {
+        printf("Не вдалося захопити інтерфейс %d пристрою %s: %s\n", ifno, b->path, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static void release_interface(UsbBulk *b)
+{
+    unsigned int ifno = USB_BULK_DATA_INTERFACE;
+    ioctl(b->fd, USBDEVFS_RELEASEINTERFACE, &ifno);
+    if (b->reattach) {
+        // Драйвер прив'язується до інтерфейсу керування; після цього знову з'являється tty
+        struct usbdevfs_ioctl cmd = { .ifno = USB_BULK_CONTROL_INTERFACE, .ioctl_code = USBDEVFS_CONNECT, .data = NULL };
+        ioctl(b->fd, USBDEVFS_IOCTL, &cmd);
+        b->reattach = false;
+    }
+}
+
+static void set_raw_mode(int fd)
+{
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) return; // Не термінал (файл, FIFO)
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+}
+
+bool usb_bulk_open(UsbBulk *b, const char *path, UsbTransport transport)
+{
+    memset(b, 0, sizeof(*b));
+    b->fd = -1;
+    b->sim = transport == USB_TRANSPORT_SIM;
+    snprintf(b->path, sizeof(b->path), "%s", path);
+
+    int fd = b->sim ? open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC)
+                    : open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        printf("Не вдалося відкрити %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    b->fd = fd;
+    if (b->sim) set_raw_mode(fd);
+    else if (!claim_interface(b)) {
+        usb_bulk_close(b);
+        return false;
+    }
+
+    b->urbs = (UsbBulkUrb*)calloc(USB_BULK_URBS, sizeof(UsbBulkUrb));
+    b->ring = (uint8_t*)malloc(USB_BULK_RING_BYTES);
+    if (!b->urbs || !b->ring) {
+        fprintf(stderr, "Memory allocation failed for USB transfers\n");
+        usb_bulk_close(b);
+        return false;
+    }
+    for (int i = 0; i < USB_BULK_URBS; i++) {
+        if (!urb_submit(b, i)) {
+            printf("Не вдалося поставити URB у чергу %s: %s\n", path, strerror(errno));
+            usb_bulk_close(b);
+            return false;
+        }
+    }
+    atomic_store(&b->running, true);
+    if (pthread_create(&b->thread, NULL, bulk_thread, b) != 0) {
+        fprintf(stderr, "Failed to start reader thread for %s\n", path);
+        atomic_store(&b->running, false);
+        usb_bulk_close(b);
+        return false;
+    }
+    printf("Відкрито %s (%s, %d URB по %d байт)\n", path, usb_transport_name(transport),
+           USB_BULK_URBS, USB_BULK_URB_BYTES);
+    return true;
+}
+
+void usb_bulk_close(UsbBulk *b)
+{
+    if (b->fd < 0) return;
+
+    if (atomic_load(&b->running)) {
+        atomic_store(&b->running, false);
+        pthread_join(b->thread, NULL);
+    }
+    if (b->urbs && !b->sim) {
+        // Скасовані URB ядро все одно повертає: їх треба забрати до звільнення буферів
+        for (int i = 0; i < USB_BULK_URBS; i++)
+            if (b->urbs[i].submitted) ioctl(b->fd, USBDEVFS_DISCARDURB, &b->urbs[i].urb);
+        for (int i = 0; i < USB_BULK_URBS; i++) {
+            if (!b->urbs[i].submitted) continue;
+            struct usbdevfs_urb *done;
+            if (ioctl(b->fd, USBDEVFS_REAPURB, &done) != 0) break;
+            ((UsbBulkUrb*)done->usercontext)->submitted = false;
+        }
+    }
+    if (!b->sim) release_interface(b);
+
+    close(b->fd);
+    free(b->urbs);
+    free(b->ring);
+    b->urbs = NULL;
+    b->ring = NULL;
+    b->fd = -1;
+    b->taken = 0;
+}
+
+int usb_bulk_read(UsbBulk *b, const uint8_t **data)
+{
+    if (b->fd < 0) return -1;
+
+    // Байти, віддані минулого разу, вже оброблено
+    uint64_t tail = atomic_load_explicit(&b->tail, memory_order_relaxed) + (uint64_t)b->taken;
+    atomic_store_explicit(&b->tail, tail, memory_order_release);
+    b->taken = 0;
+
+    uint64_t head = atomic_load_explicit(&b->head, memory_order_acquire);
+    if (head == tail) return atomic_load(&b->lost) ? -1 : 0;
+
+    // Суцільний шматок до кінця кільця; решту віддасть наступний виклик
+    uint64_t offset = tail & USB_BULK_RING_MASK;
+    uint64_t n = head - tail;
+    if (n > USB_BULK_RING_BYTES - offset) n = USB_BULK_RING_BYTES - offset;
+    b->taken = (int)n;
+    *data = b->ring + offset;
+    return (int)n;
+}
+
+int usb_bulk_write(UsbBulk *b, const uint8_t *buf, int len)
+{
+    if (b->fd < 0) return -1;
+    if (b->sim) return (int)write(b->fd, buf, (size_t)len);
+
+    struct usbdevfs_bulktransfer transfer = {
+        .ep = USB_BULK_EP_OUT,
+        .len = (unsigned int)len,
+        .timeout = USB_BULK_TIMEOUT_MS,
+        .data = (void*)buf,
+    };
+    return ioctl(b->fd, USBDEVFS_BULK, &transfer);
+}
+
+#else // usbfs є лише в Linux
+
+bool usb_bulk_open(UsbBulk *b, const char *path, UsbTransport transport)
+{
+    memset(b, 0, sizeof(*b));
+    b->fd = -1;
+    printf("Транспорт %s недоступний на цій платформі (%s)\n", usb_transport_name(transport), path);
+    return false;
+}
+
+void usb_bulk_close(UsbBulk *b) { b->fd = -1; }
+int usb_bulk_read(UsbBulk *b, const uint8_t **data) { (void)b; (void)data; return -1; }
+int usb_bulk_write(UsbBulk *b, const uint8_t *buf, int len) { (void)b; (void)buf; (void)len; return -1; }
+
+#endif
+
+const char *usb_transport_name(UsbTransport transport)
+{
+    return (transport >= 0 && transport < USB_TRANSPORT_COUNT) ? transport_names[transport] : "?";
+}
+
+int usb_transport_parse(const char *name)
+{
+    for (int i = 0; i < USB_TRANSPORT_COUNT; i++)
+        if (strcmp(name, transport_names[i]) == 0) return i;
+    return -1;
+}
@@ -0,0 +1,83 @@
+// file usb_bulk.h
+
+#ifndef USB_BULK_H
+#define USB_BULK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define USB_BULK_CONTROL_INTERFACE 0 // Інтерфейс керування CDC: до нього прив'язується cdc_acm
+#define USB_BULK_DATA_INTERFACE 1    // Інтерфейс даних CDC (usbd_cdc.c прошивки)
+#define USB_BULK_EP_IN 0x81          // CDC_IN_EP
+#define USB_BULK_EP_OUT 0x03         // CDC_OUT_EP (EP1 прошивки — лише IN, з подвійним буфером)
+#define USB_BULK_PACKET 64           // CDC_DATA_FS_MAX_PACKET_SIZE
+// Кожен пакет прошивки коротший за 64 байти або закінчується коротким пакетом, а короткий пакет
+// завершує URB: один URB — один пакет (29..157 байтів), хоч би яким великим був буфер. Full-speed
+// дає до 19 пакетів за кадр USB 1 мс, тож черга розрахована на частоту пакетів, а не на байти:
+// 256 URB — ~13 мс запасу на затримку потоку читання при найбільшій частоті
+#define USB_BULK_URBS 256            // URB у черзі ядра одночасно
+#define USB_BULK_URB_BYTES 512       // Буфер одного URB: найдовший пакет прошивки і ще запас
+#define USB_BULK_RING_BYTES (1 << 20) // Кільце між потоком читання і головним (~1 с потоку, степінь двійки)
+#define USB_BULK_WAIT_MS 20          // Найдовше очікування потоку читання (і затримка закриття)
+#define USB_BULK_TIMEOUT_MS 100      // Синхронний запис команди
+
+// Шлях байтів від плати
+typedef enum {
+    USB_TRANSPORT_TTY,    // cdc_acm і tty (RS-232), за замовчуванням
+    USB_TRANSPORT_USBFS,  // Кінцева точка bulk IN напряму через usbfs, без tty
+    USB_TRANSPORT_SIM,    // Та сама черга URB, але дані з потоку байтів (pty імітатора)
+    USB_TRANSPORT_COUNT
+} UsbTransport;
+
+typedef struct UsbBulkUrb UsbBulkUrb;
+
+// Читання кінцевої точки bulk IN чергою асинхронних URB. Власний потік забирає кожен завершений
+// URB, копіює дані в кільце і одразу повертає URB у чергу (як cdc_acm у своєму обробнику
+// завершення): частоту пакетів не обмежує частота кадрів головного потоку. Головний потік
+// читає кільце в read_usb_device() без копіювання.
+typedef struct {
+    int fd;                      // -1 — закрито
+    bool sim;                    // fd — потік байтів, URB імітуються
+    bool reattach;               // cdc_acm від'єднано при відкритті — повернути при закритті
+    UsbBulkUrb *urbs;
+    char path[96];
+
+    pthread_t thread;
+    atomic_bool running;
+    atomic_bool lost;            // Пристрій зник: після решти кільця read поверне -1
+
+    uint8_t *ring;
+    _Atomic uint64_t head;       // Записано байтів 0 .. head-1 (пише потік читання)
+    _Atomic uint64_t tail;       // Оброблено байтів 0 .. tail-1 (пише головний потік)
+    int taken;                   // Байтів, відданих останнім read (звільняються наступним)
+
+    // Імітація: байти з потоку, ще не віддані URB, і наступний URB у порядку подачі
+    uint8_t sim_buf[USB_BULK_URB_BYTES];
+    int sim_have;
+    int sim_next;
+
+    // Лічильники (пише лише потік читання)
+    unsigned long long urbs_completed;
+    unsigned long long urbs_short;   // Завершені неповним буфером (короткий пакет)
+    unsigned long long urb_errors;   // Завершені з помилкою (дані відкинуто)
+    unsigned long long ring_dropped; // Байти, що не вмістилися в кільце (головний потік відстав)
+} UsbBulk;
+
+// Вузол usbfs (/dev/bus/usb/BBB/DDD) або, для USB_TRANSPORT_SIM, будь-який потік байтів.
+// false — не відкрито (немає прав на вузол, інтерфейс зайнятий)
+bool usb_bulk_open(UsbBulk *b, const char *path, UsbTransport transport);
+void usb_bulk_close(UsbBulk *b);
+
+// Наступні прийняті байти з кільця: *data дійсне до наступного виклику (тоді місце
+// звільняється). 0 — нічого нового, -1 — пристрій зник і кільце вичитано
+int usb_bulk_read(UsbBulk *b, const uint8_t **data);
+
+// Синхронний запис у bulk OUT; кількість записаних байтів або -1
+int usb_bulk_write(UsbBulk *b, const uint8_t *buf, int len);
+
+const char *usb_transport_name(UsbTransport transport);
+int usb_transport_parse(const char *name); // -1 — невідома назва
+
+#endif // USB_BULK_H
@@ -0,0 +1,188 @@
+// file usb_discovery.c
+
+#include "usb_discovery.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#endif
+
+void usb_watch_init(UsbWatch *w, const char *sysfs_root, const char *dev_root, uint16_t vid, uint16_t pid)
+{
+    memset(w, 0, sizeof(*w));
+    snprintf(w->sysfs_root, sizeof(w->sysfs_root), "%s", sysfs_root ? sysfs_root : "/sys");
+    snprintf(w->dev_root, sizeof(w->dev_root), "%s", dev_root ? dev_root : "/dev");
+    w->vid = vid ? vid : USB_BOARD_VID;
+    w->pid = pid ? pid : USB_BOARD_PID;
+    w->netlink_fd = -1;
+    w->rescan = true;
+
+#ifdef __linux__
+    // Події ядра мають сенс лише для справжнього sysfs; для підготовленого дерева — перегляд за таймером
+    if (strcmp(w->sysfs_root, "/sys") != 0) return;
+
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) return;
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK, .nl_groups = 1 };
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return;
+    }
+    w->netlink_fd = fd;
+#endif
+}
+
+void usb_watch_close(UsbWatch *w)
+{
+#ifdef __linux__
+    if (w->netlink_fd >= 0) close(w->netlink_fd);
+#endif
+    w->netlink_fd = -1;
+}
+
+#ifdef __linux__
+// Повідомлення uevent: "ACTION@DEVPATH\0KEY=VALUE\0..."; цікавлять лише tty і usb
+static bool uevent_is_relevant(const char *msg, int len)
+{
+    for (int i = 0; i < len; i += (int)strlen(msg + i) + 1) {
+        if (strcmp(msg + i, "SUBSYSTEM=tty") == 0 || strcmp(msg + i, "SUBSYSTEM=usb") == 0)
+            return true;
+    }
+    return false;
+}
+#endif
+
+bool usb_watch_poll(UsbWatch *w, double now, bool connected)
+{
+#ifdef __linux__
+    if (w->netlink_fd >= 0) {
+        char msg[4096];
+        int n;
+        while ((n = (int)recv(w->netlink_fd, msg, sizeof(msg) - 1, MSG_DONTWAIT)) > 0) {
+            msg[n] = '\0';
+            if (uevent_is_relevant(msg, n)) w->rescan = true;
+        }
+    }
+#endif
+
+    // Підключену плату стережуть події (і помилка читання), непідключену шукаємо ще й за таймером:
+    // вузол /dev може стати доступним на запис лише після правил udev, що виконуються після події.
+    // Без подій (підготовлене дерево) за таймером перевіряється й підключена плата.
+    if ((!connected || w->netlink_fd < 0) && now >= w->next_scan) w->rescan = true;
+    if (!w->rescan) return false;
+
+    w->rescan = false;
+    w->next_scan = now + USB_RESCAN_S;
+    return true;
+}
+
+#ifdef __linux__
+// Перший рядок файлу без кінцевого переводу рядка; false — файлу немає
+static bool read_attr(const char *dir, const char *attr, char *buf, size_t size)
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", dir, attr);
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+    bool ok = fgets(buf, (int)size, f) != NULL;
+    fclose(f);
+    if (ok) buf[strcspn(buf, "\r\n")] = '\0';
+    return ok;
+}
+
+static bool read_hex_attr(const char *dir, const char *attr, unsigned *value)
+{
+    char buf[16];
+    char *end;
+    if (!read_attr(dir, attr, buf, sizeof(buf))) return false;
+    *value = (unsigned)strtoul(buf, &end, 16);
+    return end != buf;
+}
+
+static int board_compare(const void *a, const void *b)
+{
+    const UsbBoard *x = (const UsbBoard*)a, *y = (const UsbBoard*)b;
+    int c = strcmp(x->serial, y->serial);
+    return c ? c : strcmp(x->name, y->name);
+}
+#endif
+
+int usb_scan(const UsbWatch *w, UsbBoard *boards, int max)
+{
+#ifdef __linux__
+    char dir_path[PATH_MAX];
+    snprintf(dir_path, sizeof(dir_path), "%s/class/tty", w->sysfs_root);
+    DIR *dir = opendir(dir_path);
+    if (!dir) return -1;
+
+    int count = 0;
+    struct dirent *e;
+    while ((e = readdir(dir)) != NULL && count < max) {
+        if (e->d_name[0] == '.') continue;
+
+        // device -> інтерфейс USB (1-1:1.0), його батьківський каталог — сам пристрій з idVendor
+        char link[PATH_MAX], iface[PATH_MAX];
+        snprintf(link, sizeof(link), "%s/%s/device", dir_path, e->d_name);
+        if (!realpath(link, iface)) continue; // Віртуальні tty без пристрою
+        char *slash = strrchr(iface, '/');
+        if (!slash) continue;
+        *slash = '\0';
+
+        unsigned vid, pid;
+        if (!read_hex_attr(iface, "idVendor", &vid) || !read_hex_attr(iface, "idProduct", &pid)) continue;
+        if (vid != w->vid || pid != w->pid) continue;
+
+        // Вузла в /dev ще (udev не встиг) або вже немає — плата недоступна
+        UsbBoard *b = &boards[count];
+        snprintf(b->path, sizeof(b->path), "%s/%s", w->dev_root, e->d_name);
+        if (access(b->path, F_OK) != 0) continue;
+        snprintf(b->name, sizeof(b->name), "%s", e->d_name);
+        count++;
+        if (!read_attr(iface, "serial", b->serial, sizeof(b->serial))) b->serial[0] = '\0';
+        unsigned bus = 0, devnum = 0;
+        char num[16];
+        if (read_attr(iface, "busnum", num, sizeof(num))) bus = (unsigned)strtoul(num, NULL, 10);
+        if (read_attr(iface, "devnum", num, sizeof(num))) devnum = (unsigned)strtoul(num, NULL, 10);
+        snprintf(b->usbfs, sizeof(b->usbfs), "%s/bus/usb/%03u/%03u", w->dev_root, bus, devnum);
+    }
+    closedir(dir);
+
+    qsort(boards, (size_t)count, sizeof(UsbBoard), board_compare);
+    return count;
+#else
+    (void)w; (void)boards; (void)max;
+    return -1;
+#endif
+}
+
+uint64_t usb_node_id(const char *path)
+{
+#ifdef __linux__
+    struct stat st;
+    if (stat(path, &st) != 0) return 0;
+    return (uint64_t)st.st_rdev;
+#else
+    (void)path;
+    return 0;
+#endif
+}
+
+bool usb_parse_id(const char *text, uint16_t *vid, uint16_t *pid)
+{
+    char *end;
+    unsigned long v = strtoul(text, &end, 16);
+    if (end == text || *end != ':' || v > 0xFFFF) return false;
+    const char *p_text = end + 1;
+    unsigned long p = strtoul(p_text, &end, 16);
+    if (end == p_text || *end != '\0' || p > 0xFFFF) return false;
+    *vid = (uint16_t)v;
+    *pid = (uint16_t)p;
+    return true;
+}
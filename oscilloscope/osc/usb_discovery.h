@@ -0,0 +1,54 @@
+// file usb_discovery.h
+
+#ifndef USB_DISCOVERY_H
+#define USB_DISCOVERY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define USB_BOARD_VID 0x0483     // STMicroelectronics (usbd_desc.c прошивки)
+#define USB_BOARD_PID 0x5740     // STM32 Virtual ComPort
+#define USB_MAX_BOARDS 8         // Скільки плат повертає один перегляд sysfs
+#define USB_RESCAN_S 1.0         // Повторний перегляд, поки плату не підключено
+
+// Плата, знайдена в sysfs
+typedef struct {
+    char name[32];               // Ім'я tty (ttyACM0)
+    char path[96];               // Вузол пристрою (/dev/ttyACM0)
+    char serial[64];             // Серійний номер USB, порожній — невідомий
+    char usbfs[128];             // Вузол usbfs (/dev/bus/usb/BBB/DDD) для транспорту usbfs
+} UsbBoard;
+
+// Пошук плат за VID:PID у sysfs (/sys/class/tty/*/device -> інтерфейс USB -> пристрій)
+// і стеження за підключенням через netlink uevent. Корені sysfs і /dev можна замінити
+// на підготовлене дерево каталогів (--sysfs-root, --dev-root) — так пошук перевіряється без плати.
+typedef struct {
+    char sysfs_root[96];
+    char dev_root[96];
+    uint16_t vid;
+    uint16_t pid;
+    int netlink_fd;              // -1 — подій немає, лише періодичний перегляд
+    bool rescan;                 // Була подія tty/usb: переглянути sysfs
+    double next_scan;            // Час наступного періодичного перегляду
+    char port_path[96];          // Шлях відкритої плати (RS-232 зберігає вказівник на нього)
+    uint64_t port_node;          // Номер пристрою цього вузла при відкритті (usb_node_id)
+} UsbWatch;
+
+// sysfs_root/dev_root == NULL — "/sys" і "/dev"; vid/pid == 0 — плата осцилографа
+void usb_watch_init(UsbWatch *w, const char *sysfs_root, const char *dev_root, uint16_t vid, uint16_t pid);
+void usb_watch_close(UsbWatch *w);
+
+// Вичитує події без блокування; true — час переглянути sysfs (подія або минув USB_RESCAN_S)
+bool usb_watch_poll(UsbWatch *w, double now, bool connected);
+
+// Плати з потрібним VID:PID і наявним вузлом у /dev, впорядковані за серійним номером
+// (стабільний порядок каналів для кількох плат). -1 — sysfs недоступний (не Linux): лишається перебір портів.
+int usb_scan(const UsbWatch *w, UsbBoard *boards, int max);
+
+// Номер пристрою (st_rdev) вузла: інший після перепідключення, навіть якщо шлях той самий; 0 — вузла немає
+uint64_t usb_node_id(const char *path);
+
+// "VVVV:PPPP" (шістнадцяткові) -> vid, pid; false — помилка формату
+bool usb_parse_id(const char *text, uint16_t *vid, uint16_t *pid);
+
+#endif // USB_DISCOVERY_H
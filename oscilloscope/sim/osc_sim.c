@@ -0,0 +1,934 @@
+// file osc_sim.c
+//
+// Імітатор пристрою: відкриває псевдотермінал і надсилає ті самі пакети, що й прошивка
+// (0xAD: маска каналів, номер, 12 значень — скани лише увімкнених каналів; відліки АЦП зі зміщенням
+// -2048; --fixed-layout — 0xAB + 4 x (id | номер, lo, hi), як до маски каналів; з compression — блоки 0xAE
+// з delta_codec.h; з oversample — суми 2^N відліків з додатковими бітами в старшій половині байта маски;
+// з timestamps — мікросекунди лічильника плати за номером, --drift задає похибку її кварцу;
+// з ets_steps — захоплення 0xAF від фронту першого каналу маски зі зсувом на крок еквівалентного часу;
+// без стиснення, передискретизації, тестового сигналу і захоплень — сирі відліки 0xB0, як з DMA плати),
+// приймає кадри керування
+// (control_protocol.h) і відповідає ACK/NAK після пакета, як прошивка. Хост підключається через --port <pty>.
+// Збирається окремо від застосунку: make sim
+
+#define _GNU_SOURCE // posix_openpt, ptsname, cfmakeraw
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <termios.h>
+
+#include "control_protocol.h"
+#include "delta_codec.h"
+
+#define PACKET_SIZE 13
+#define PACKET_START 0xAA              // Старий формат, без номера пакета
+#define PACKET_START_SEQ 0xAB          // 24-бітний номер у старших 6 бітах байтів ID
+#define PACKET_START_MASK 0xAD         // Маска каналів, 24-бітний номер, PACKET_MASK_VALUES значень
+#define PACKET_RES_SHIFT 4             // Додаткові біти роздільності — у старшій половині байта маски
+#define PACKET_MASK_HEADER 5
+#define PACKET_MASK_VALUES 12
+#define PACKET_MASK_SIZE (PACKET_MASK_HEADER + PACKET_MASK_VALUES * 2)
+#define PACKET_START_DELTA 0xAE        // Як 0xAD, далі LEN і блок delta_codec з DELTA_BLOCK_VALUES значень
+#define PACKET_DELTA_HEADER 6
+#define PACKET_DELTA_MAX (PACKET_DELTA_HEADER + DELTA_BLOCK_VALUES * DELTA_VALUE_MAX_BYTES)
+#define PACKET_TIME_FLAG 0x80          // Біт 7 байта маски: за номером 4 байти часу плати (мкс)
+#define PACKET_TIME_BYTES 4
+#define PACKET_START_ETS 0xAF          // Захоплення від фронту: як 0xAE, перед LEN — крок, кроків, крок у тактах
+#define PACKET_ETS_BYTES 3
+#define PACKET_START_RAW 0xB0          // Як 0xAD, далі кількість сканів і сирі відліки 0..4095 (DMA плати)
+#define PACKET_RAW_HEADER 6
+#define PACKET_RAW_MAX 63              // Пакет коротший за пакет USB
+#define ETS_CLOCK_HZ 72e6              // Такти плати (ets.h у прошивці)
+#define ETS_CONVERSION_CYCLES 84       // Перетворення з найкоротшою вибіркою
+#define ETS_SCAN_MARGIN_CYCLES 12
+#define ETS_START_CYCLES 1
+#define SIM_CHANNELS 4
+#define RATE_CMD_NS_PER_UNIT 55000.0   // CTRL_PARAM_RATE N у прошивці — N*1000 ітерацій nop (~55 мкс на 72 МГц)
+#define OVERSAMPLE_CONVERSION_S 1.17e-6 // Перетворення АЦП при передискретизації: 14 тактів по 12 МГц
+#define MAX_BATCH_PACKETS 8192         // Пакетів за один запис у pty
+#define TICK_NS 1000000L               // Період циклу генерації (1 мс)
+
+typedef enum { WAVE_SINE, WAVE_SQUARE, WAVE_TRIANGLE, WAVE_SAW, WAVE_PULSE, WAVE_DC } WaveKind;
+
+typedef struct {
+    WaveKind kind;
+    double freq_hz;
+    double amplitude;                  // Відліки АЦП (пік)
+    double offset;                     // Відліки АЦП відносно середини шкали
+    double duty;                       // Для square/pulse
+} Waveform;
+
+typedef struct {
+    double rate_hz;                    // Сканів (семплів кожного каналу) за секунду
+    bool lock_rate;                    // Ігнорувати зміну CTRL_PARAM_RATE
+    bool legacy;                       // Пакети 0xAA без номера (стара прошивка)
+    bool fixed_layout;                 // Пакети 0xAB з усіма 4 каналами незалежно від маски
+    double usb_budget;                 // Байтів за секунду, які пропускає канал; 0 — без обмеження
+    bool wall_clock;                   // Фаза сигналів від CLOCK_MONOTONIC, а не від старту
+    double drift_ppm;                  // Наскільки лічильник міток плати швидший за реальний час
+    Waveform wave[SIM_CHANNELS];
+    double noise;                      // СКВ гаусівського шуму (відліки АЦП)
+    double dropout_prob;               // Імовірність початку пропуску на кожен пакет
+    int dropout_len;                   // Максимальна довжина пропуску (пакетів)
+    double corrupt_prob;               // Імовірність спотворення кожного байта
+    double lose_reply_prob;            // Імовірність не надіслати відповідь на запит керування
+    double duration_s;                 // 0 — без обмеження
+    const char *link_path;             // Символьне посилання на підлеглий pty
+    uint64_t seed;
+} SimConfig;
+
+typedef struct {
+    unsigned long long sent;           // Пакетів передано в pty
+    unsigned long long samples;        // Сканів у переданих пакетах
+    unsigned long long bytes;          // Байтів пакетів семплів
+    unsigned long long delta_blocks;   // З них стиснених блоків 0xAE
+    unsigned long long delta_bytes;
+    unsigned long long dropped;        // Пакетів викинуто імітацією пропусків
+    unsigned long long overflow;       // Пакетів викинуто, бо хост не встигає читати
+    unsigned long long corrupted;      // Спотворених байтів
+    unsigned long long commands;
+    unsigned long long bad_commands;   // Кадри керування з хибною CRC або довжиною
+    unsigned long long lost_replies;
+} SimStats;
+
+static volatile sig_atomic_t stop_requested = 0;
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static void on_signal(int sig) { (void)sig; stop_requested = 1; }
+
+static uint64_t rng_next(void)
+{
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1Dull;
+}
+
+static double rng_uniform(void) { return (rng_next() >> 11) * (1.0 / 9007199254740992.0); }
+
+static double rng_gauss(void)
+{
+    double u1 = rng_uniform(), u2 = rng_uniform();
+    if (u1 < 1e-300) u1 = 1e-300;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static double wave_value(const Waveform *w, double t)
+{
+    double phase = w->freq_hz > 0.0 ? fmod(t * w->freq_hz, 1.0) : 0.0;
+    double v;
+    switch (w->kind) {
+    case WAVE_SINE:     v = sin(2.0 * M_PI * phase); break;
+    case WAVE_SQUARE:   v = phase < w->duty ? 1.0 : -1.0; break;
+    case WAVE_TRIANGLE: v = phase < 0.5 ? 4.0 * phase - 1.0 : 3.0 - 4.0 * phase; break;
+    case WAVE_SAW:      v = 2.0 * phase - 1.0; break;
+    case WAVE_PULSE:    v = phase < w->duty ? 1.0 : -1.0; break;
+    default:            v = 0.0; break;
+    }
+    return w->offset + w->amplitude * v;
+}
+
+// Номер рахує кожен сформований пакет, зокрема викинуті пропуском чи переповненням,
+// як лічильник у прошивці — тож хост бачить втрати
+static void put_packet(uint8_t *p, const int16_t *values, uint32_t seq, bool legacy)
+{
+    p[0] = legacy ? PACKET_START : PACKET_START_SEQ;
+    for (int ch = 0; ch < SIM_CHANNELS; ch++) {
+        p[1 + ch * 3] = legacy ? (uint8_t)ch : (uint8_t)(ch | (((seq >> (6 * ch)) & 0x3F) << 2));
+        p[2 + ch * 3] = (uint8_t)(values[ch] & 0xFF);
+        p[3 + ch * 3] = (uint8_t)((uint16_t)values[ch] >> 8);
+    }
+}
+
+// Заголовок 0xAD/0xAE: старт, маска з роздільністю, номер і, якщо time_us != NULL, мітка часу.
+// Повертає вказівник на байт за заголовком
+static uint8_t *put_header(uint8_t *p, uint8_t start, uint8_t mask, int extra_bits, uint32_t seq,
+                           const uint32_t *time_us)
+{
+    p[0] = start;
+    p[1] = (uint8_t)(mask | (extra_bits << PACKET_RES_SHIFT) | (time_us ? PACKET_TIME_FLAG : 0));
+    p[2] = (uint8_t)seq;
+    p[3] = (uint8_t)(seq >> 8);
+    p[4] = (uint8_t)(seq >> 16);
+    p += PACKET_MASK_HEADER;
+    if (time_us) {
+        for (int i = 0; i < PACKET_TIME_BYTES; i++) *p++ = (uint8_t)(*time_us >> (8 * i));
+    }
+    return p;
+}
+
+// Пакет 0xAD: скани по черзі, у кожному — лише канали маски. Повертає довжину пакета
+static int put_packet_mask(uint8_t *p, int16_t (*scans)[SIM_CHANNELS], int count, uint8_t mask,
+                           int extra_bits, uint32_t seq, const uint32_t *time_us)
+{
+    uint8_t *v = put_header(p, PACKET_START_MASK, mask, extra_bits, seq, time_us);
+    for (int s = 0; s < count; s++) {
+        for (int ch = 0; ch < SIM_CHANNELS; ch++) {
+            if (!(mask & (1u << ch))) continue;
+            *v++ = (uint8_t)(scans[s][ch] & 0xFF);
+            *v++ = (uint8_t)((uint16_t)scans[s][ch] >> 8);
+        }
+    }
+    return (int)(v - p);
+}
+
+// Пакет 0xB0: скани, як у 0xAD, сирими відліками без зміщення. Повертає довжину пакета
+static int put_packet_raw(uint8_t *p, int16_t (*scans)[SIM_CHANNELS], int count, uint8_t mask, uint32_t seq,
+                          const uint32_t *time_us)
+{
+    uint8_t *v = put_header(p, PACKET_START_RAW, mask, 0, seq, time_us);
+    *v++ = (uint8_t)count;
+    for (int s = 0; s < count; s++) {
+        for (int ch = 0; ch < SIM_CHANNELS; ch++) {
+            if (!(mask & (1u << ch))) continue;
+            uint16_t raw = (uint16_t)(scans[s][ch] + 2048);
+            *v++ = (uint8_t)(raw & 0xFF);
+            *v++ = (uint8_t)(raw >> 8);
+        }
+    }
+    return (int)(v - p);
+}
+
+// LEN і блок delta_encode з каналів маски. Повертає вказівник за блоком
+static uint8_t *put_block(uint8_t *v, int16_t (*scans)[SIM_CHANNELS], int count, uint8_t mask)
+{
+    int16_t block[DELTA_BLOCK_VALUES];
+    int n = 0;
+    for (int s = 0; s < count; s++)
+        for (int ch = 0; ch < SIM_CHANNELS; ch++)
+            if (mask & (1u << ch)) block[n++] = scans[s][ch];
+
+    int len = delta_encode(block, n, __builtin_popcount(mask), v + 1);
+    v[0] = (uint8_t)len;
+    return v + 1 + len;
+}
+
+// Пакет 0xAE: ті самі значення, що й у 0xAD, стиснені delta_encode. Повертає довжину пакета
+static int put_packet_delta(uint8_t *p, int16_t (*scans)[SIM_CHANNELS], int count, uint8_t mask,
+                            int extra_bits, uint32_t seq, const uint32_t *time_us)
+{
+    uint8_t *v = put_header(p, PACKET_START_DELTA, mask, extra_bits, seq, time_us);
+    return (int)(put_block(v, scans, count, mask) - p);
+}
+
+// Пакет 0xAF: захоплення з кроком step з steps, крок step_cycles тактів. Повертає довжину пакета
+static int put_packet_ets(uint8_t *p, int16_t (*scans)[SIM_CHANNELS], int count, uint8_t mask, uint32_t seq,
+                          const uint32_t *time_us, int step, int steps, int step_cycles)
+{
+    uint8_t *v = put_header(p, PACKET_START_ETS, mask, 0, seq, time_us);
+    *v++ = (uint8_t)step;
+    *v++ = (uint8_t)steps;
+    *v++ = (uint8_t)step_cycles;
+    return (int)(put_block(v, scans, count, mask) - p);
+}
+
+// ---- Команди від хоста (кадри керування) ----
+
+typedef struct {
+    int32_t params[CTRL_PARAM_COUNT];
+    uint8_t rx[CTRL_FRAME_MAX];        // Кадр, що приймається
+    int rx_len;
+    uint8_t reply[CTRL_FRAME_MAX];     // Відповідь, що чекає на наступний запис у pty
+    int reply_len;
+    double block_bytes;                // Середня довжина блоку 0xAE за минулу секунду (для --usb-budget)
+    uint32_t profile[CTRL_STAT_COUNT]; // Вікно профілю, що набирається (CTRL_OP_STAT), як у profiler.c
+    uint32_t published[CTRL_STAT_COUNT];
+    uint32_t snapshot[CTRL_STAT_COUNT];
+} DeviceState;
+
+#define TEST_PARAMS(first, value) [first] = value, [first + 1] = value, [first + 2] = value, [first + 3] = value
+
+static const int32_t param_min[CTRL_PARAM_COUNT] = { [CTRL_PARAM_CHANNEL_MASK] = 1 };
+static const int32_t param_max[CTRL_PARAM_COUNT] = {
+    [CTRL_PARAM_RATE] = CTRL_RATE_MAX, [CTRL_PARAM_TEST_SIGNAL] = 1, [CTRL_PARAM_TRIGGER_EDGE] = 2,
+    [CTRL_PARAM_LED] = 1, [CTRL_PARAM_CHANNEL_MASK] = CTRL_CHANNEL_MASK_ALL, [CTRL_PARAM_COMPRESSION] = 1,
+    [CTRL_PARAM_OVERSAMPLE] = CTRL_OVERSAMPLE_MAX, [CTRL_PARAM_TIMESTAMPS] = 1,
+    [CTRL_PARAM_ETS_STEPS] = CTRL_ETS_STEPS_MAX,
+    TEST_PARAMS(CTRL_PARAM_TEST_WAVE, CTRL_TEST_WAVE_COUNT - 1),
+    TEST_PARAMS(CTRL_PARAM_TEST_FREQ, CTRL_TEST_FREQ_MAX),
+    TEST_PARAMS(CTRL_PARAM_TEST_AMPLITUDE, CTRL_TEST_AMPLITUDE_MAX),
+    TEST_PARAMS(CTRL_PARAM_TEST_NOISE, CTRL_TEST_AMPLITUDE_MAX),
+};
+
+// Тестовий сигнал за замовчуванням — як у прошивці (control_protocol.c)
+static const int32_t test_defaults[4][CTRL_TEST_CHANNELS] = {
+    { CTRL_TEST_WAVE_SINE, CTRL_TEST_WAVE_SQUARE, CTRL_TEST_WAVE_SAW, CTRL_TEST_WAVE_PULSE },
+    { 100, 50, 20, 10 },
+    { 1000, 800, 600, 500 },
+    { 0, 0, 0, 50 },
+};
+
+// Генератор тестового сигналу прошивки (dds.c) як Waveform. Порядок форм CtrlTestWave збігається з WaveKind
+static Waveform test_wave(const DeviceState *dev, int ch)
+{
+    int kind = dev->params[CTRL_PARAM_TEST_WAVE + ch];
+    double amplitude = dev->params[CTRL_PARAM_TEST_AMPLITUDE + ch];
+    return (Waveform){
+        .kind = (WaveKind)kind,
+        .freq_hz = dev->params[CTRL_PARAM_TEST_FREQ + ch] / 10.0,
+        .amplitude = kind == CTRL_TEST_WAVE_DC ? 0.0 : amplitude,
+        .offset = kind == CTRL_TEST_WAVE_DC ? amplitude : 0.0,
+        .duty = kind == CTRL_TEST_WAVE_PULSE ? 0.125 : 0.5,
+    };
+}
+
+// Форма за фазою, що йде з часом, і рівномірний шум
+static int16_t test_value(const DeviceState *dev, int ch, double t)
+{
+    Waveform w = test_wave(dev, ch);
+    double v = wave_value(&w, t) + dev->params[CTRL_PARAM_TEST_NOISE + ch] * (2.0 * rng_uniform() - 1.0);
+    if (v < -2048.0) v = -2048.0;
+    if (v > 2047.0) v = 2047.0;
+    return (int16_t)lrint(v);
+}
+
+// Блоки 0xAE замість 0xAD; стара прошивка і --fixed-layout параметр приймають, але не знають
+static bool compressed(const SimConfig *cfg, const DeviceState *dev)
+{
+    return dev->params[CTRL_PARAM_COMPRESSION] && !cfg->legacy && !cfg->fixed_layout;
+}
+
+// Мітки часу — лише в пакетах 0xAD/0xAE
+static bool timestamped(const SimConfig *cfg, const DeviceState *dev)
+{
+    return dev->params[CTRL_PARAM_TIMESTAMPS] && !cfg->legacy && !cfg->fixed_layout;
+}
+
+// Кроків еквівалентного часу, 0 — безперервний потік (стара прошивка параметра не знає)
+static int ets_steps(const SimConfig *cfg, const DeviceState *dev)
+{
+    int steps = dev->params[CTRL_PARAM_ETS_STEPS];
+    return steps > 1 && !cfg->legacy && !cfg->fixed_layout ? steps : 0;
+}
+
+// Крок у тактах, як у прошивці: період сканів — найменше кратне кроків, у яке вміщається скан
+static int ets_step_cycles(const DeviceState *dev, int steps)
+{
+    int channels = __builtin_popcount((unsigned)dev->params[CTRL_PARAM_CHANNEL_MASK]);
+    int scan = ETS_CONVERSION_CYCLES * channels + ETS_SCAN_MARGIN_CYCLES;
+    return (scan + steps - 1) / steps;
+}
+
+// Найближчий після t фронт сигналу w (перетин середини шкали, як dds_next_edge); < 0 — фронтів немає.
+// CTRL_PARAM_TRIGGER_EDGE 1 — спадаючий, інакше зростаючий (будь-який змішав би півперіоди)
+static double next_edge(const Waveform *w, int edge, double t)
+{
+    if (w->freq_hz <= 0.0 || w->kind == WAVE_DC) return -1.0;
+    double rising, falling;
+    switch (w->kind) {
+    case WAVE_TRIANGLE: rising = 0.25; falling = 0.75; break;
+    case WAVE_SAW:      rising = 0.5; falling = 0.0; break;
+    case WAVE_SQUARE:
+    case WAVE_PULSE:    rising = 0.0; falling = w->duty; break;
+    default:            rising = 0.0; falling = 0.5; break;
+    }
+    double cycles = t * w->freq_hz;
+    double at = floor(cycles) + (edge == 1 ? falling : rising);
+    if (at < cycles) at += 1.0;
+    return at / w->freq_hz;
+}
+
+// log2 відліків на значення; пакети 0xAA/0xAB не мають куди записати роздільність,
+// захоплення завжди по одному відліку
+static int oversampling(const SimConfig *cfg, const DeviceState *dev)
+{
+    return cfg->legacy || cfg->fixed_layout || ets_steps(cfg, dev) ? 0 : dev->params[CTRL_PARAM_OVERSAMPLE];
+}
+
+// Додаткові біти в пакеті: половина log2 кратності, як ADC_OVERSAMPLE_EXTRA_BITS; тестова таблиця — 12 біт
+static int resolution_bits(const SimConfig *cfg, const DeviceState *dev)
+{
+    return dev->params[CTRL_PARAM_TEST_SIGNAL] ? 0 : oversampling(cfg, dev) / 2;
+}
+
+// Пакети 0xB0: АЦП без обробки на платі — скани пише DMA
+static bool raw_packets(const SimConfig *cfg, const DeviceState *dev)
+{
+    return !cfg->legacy && !cfg->fixed_layout && !compressed(cfg, dev) && !ets_steps(cfg, dev) &&
+           !oversampling(cfg, dev) && !dev->params[CTRL_PARAM_TEST_SIGNAL];
+}
+
+// Сканів у пакеті і байтів пакета за форматом і маскою каналів
+static int packet_scans(const SimConfig *cfg, const DeviceState *dev)
+{
+    if (cfg->legacy || cfg->fixed_layout) return 1;
+    int channels = __builtin_popcount((unsigned)dev->params[CTRL_PARAM_CHANNEL_MASK]);
+    if (raw_packets(cfg, dev))
+        return (PACKET_RAW_MAX - PACKET_RAW_HEADER - (timestamped(cfg, dev) ? PACKET_TIME_BYTES : 0)) / (2 * channels);
+    int values = compressed(cfg, dev) || ets_steps(cfg, dev) ? DELTA_BLOCK_VALUES : PACKET_MASK_VALUES;
+    return values / channels;
+}
+
+// Довжина стисненого блоку залежить від сигналу: до першого заміру — як без стиснення
+static double packet_bytes(const SimConfig *cfg, const DeviceState *dev)
+{
+    int time_bytes = timestamped(cfg, dev) ? PACKET_TIME_BYTES : 0;
+    if (ets_steps(cfg, dev)) time_bytes += PACKET_ETS_BYTES;
+    if (compressed(cfg, dev) || ets_steps(cfg, dev))
+        return dev->block_bytes > 0.0 ? dev->block_bytes : PACKET_DELTA_HEADER + time_bytes + DELTA_BLOCK_VALUES * 2;
+    if (raw_packets(cfg, dev))
+        return PACKET_RAW_HEADER + time_bytes +
+               packet_scans(cfg, dev) * __builtin_popcount((unsigned)dev->params[CTRL_PARAM_CHANNEL_MASK]) * 2;
+    return cfg->legacy || cfg->fixed_layout ? PACKET_SIZE : PACKET_MASK_SIZE + time_bytes;
+}
+
+// Частота сканів: задана, але не більша, ніж пропускає канал (--usb-budget). Передискретизація
+// додає до періоду скану 2^N перетворень кожного увімкненого каналу
+static double scan_rate(const SimConfig *cfg, const DeviceState *dev)
+{
+    double rate = cfg->rate_hz;
+    int n = oversampling(cfg, dev);
+    if (n > 0) {
+        int channels = __builtin_popcount((unsigned)dev->params[CTRL_PARAM_CHANNEL_MASK]);
+        rate = 1.0 / (1.0 / rate + (double)(1 << n) * channels * OVERSAMPLE_CONVERSION_S);
+    }
+    if (cfg->usb_budget <= 0.0) return rate;
+    double limit = cfg->usb_budget * packet_scans(cfg, dev) / packet_bytes(cfg, dev);
+    return limit < rate ? limit : rate;
+}
+
+// Значення каналу в момент t: один відлік АЦП або сума 2^N відліків з власним шумом кожен,
+// зсунута так, щоб лишилось 12 + extra біт (як ADC_ReadOversampled)
+static int16_t adc_value(const SimConfig *cfg, const Waveform *w, double t, int n, int extra)
+{
+    double ideal = wave_value(w, t);
+    int32_t sum = 0;
+    for (int i = 0; i < (1 << n); i++) {
+        double v = ideal;
+        if (cfg->noise > 0.0) v += cfg->noise * rng_gauss();
+        if (v < -2048.0) v = -2048.0;
+        if (v > 2047.0) v = 2047.0;
+        sum += (int32_t)lrint(v);
+    }
+    return (int16_t)(sum >> (n - extra));
+}
+
+// Ділянка профілю тривалістю seconds у тактах плати: сума, кількість, найдовша, кошик гістограми
+static void profile_add(DeviceState *dev, int section, double seconds)
+{
+    uint32_t cycles = (uint32_t)fmin(seconds * CTRL_PROF_CLOCK_HZ, 4294967295.0);
+    uint32_t *s = &dev->profile[CTRL_STAT_SECTIONS + section * CTRL_PROF_FIELDS];
+    s[CTRL_PROF_CYCLES] += cycles;
+    s[CTRL_PROF_COUNT]++;
+    if (cycles > s[CTRL_PROF_MAX]) s[CTRL_PROF_MAX] = cycles;
+    int bucket = 0;
+    for (uint32_t limit = 256; bucket < CTRL_PROF_BUCKETS - 1 && cycles >= limit; limit *= 4) bucket++;
+    s[CTRL_PROF_HIST + bucket]++;
+}
+
+// Завершене вікно стає доступним запитам CTRL_OP_STAT; очікування — решта тактів вікна
+static void profile_publish(DeviceState *dev, double window_s)
+{
+    uint32_t cycles = (uint32_t)(window_s * CTRL_PROF_CLOCK_HZ);
+    uint32_t work = 0;
+    for (int s = 0; s < CTRL_PROF_SECTIONS; s++)
+        work += dev->profile[CTRL_STAT_SECTIONS + s * CTRL_PROF_FIELDS + CTRL_PROF_CYCLES];
+    dev->profile[CTRL_STAT_SECTIONS + CTRL_PROF_PACE * CTRL_PROF_FIELDS + CTRL_PROF_CYCLES] =
+        cycles > work ? cycles - work : 0;
+    dev->profile[CTRL_STAT_WINDOW] = dev->published[CTRL_STAT_WINDOW] + 1;
+    dev->profile[CTRL_STAT_WINDOW_CYCLES] = cycles;
+    memcpy(dev->published, dev->profile, sizeof(dev->profile));
+    memset(dev->profile, 0, sizeof(dev->profile));
+}
+
+static void apply_param(SimConfig *cfg, DeviceState *dev, int param)
+{
+    int32_t value = dev->params[param];
+    if (param == CTRL_PARAM_RATE) {
+        if (!cfg->lock_rate && value > 0) {
+            cfg->rate_hz = 1e9 / (value * RATE_CMD_NS_PER_UNIT);
+            fprintf(stderr, "cmd: rate %d -> %.0f S/s\n", value, cfg->rate_hz);
+        } else {
+            fprintf(stderr, "cmd: rate %d (rate locked at %.0f S/s)\n", value, cfg->rate_hz);
+        }
+    } else if (param == CTRL_PARAM_CHANNEL_MASK) {
+        fprintf(stderr, "cmd: channel_mask 0x%X -> %d scans per packet, %.0f S/s\n",
+                value, packet_scans(cfg, dev), scan_rate(cfg, dev));
+    } else if (param == CTRL_PARAM_OVERSAMPLE) {
+        fprintf(stderr, "cmd: oversample %d -> %d readings per value, %d bit, %.0f S/s%s\n", value,
+                1 << oversampling(cfg, dev), 12 + resolution_bits(cfg, dev), scan_rate(cfg, dev),
+                value && !oversampling(cfg, dev) ? " (ignored by this packet format)" : "");
+    } else if (param == CTRL_PARAM_COMPRESSION) {
+        dev->block_bytes = 0.0;
+        fprintf(stderr, "cmd: compression %d -> %s, %d scans per packet%s\n", value,
+                compressed(cfg, dev) ? "0xAE delta blocks" : "uncompressed packets", packet_scans(cfg, dev),
+                value && !compressed(cfg, dev) ? " (ignored by this packet format)" : "");
+    } else if (param == CTRL_PARAM_TIMESTAMPS) {
+        if (value && !timestamped(cfg, dev))
+            fprintf(stderr, "cmd: timestamps %d (ignored by this packet format)\n", value);
+        else
+            fprintf(stderr, "cmd: timestamps %d, board clock %+.1f ppm\n", value, cfg->drift_ppm);
+    } else if (param == CTRL_PARAM_ETS_STEPS) {
+        dev->block_bytes = 0.0;
+        int steps = ets_steps(cfg, dev);
+        if (steps)
+            fprintf(stderr, "cmd: ets_steps %d -> 0xAF captures, step %d cycles, %.2f MS/s equivalent\n", value,
+                    ets_step_cycles(dev, steps), ETS_CLOCK_HZ / ets_step_cycles(dev, steps) / 1e6);
+        else
+            fprintf(stderr, "cmd: ets_steps %d%s\n", value, value > 1 ? " (ignored by this packet format)" : "");
+    } else if (param >= CTRL_PARAM_TEST_WAVE && param < CTRL_PARAM_TEST_FREQ) {
+        fprintf(stderr, "cmd: %s %s\n", control_param_name(param), control_test_wave_name(value));
+    } else {
+        fprintf(stderr, "cmd: %s %d\n", control_param_name(param), value);
+    }
+}
+
+// Як control_poll у прошивці: перевірка, застосування, ACK зі значенням, що діє, або NAK
+static ControlFrame handle_request(SimConfig *cfg, DeviceState *dev, const ControlFrame *req)
+{
+    switch (req->op) {
+    case CTRL_OP_PING:
+        return control_ack(req, 0, 0);
+    case CTRL_OP_GET:
+    case CTRL_OP_SET: {
+        if (req->len != (req->op == CTRL_OP_GET ? 1 : 5)) return control_nak(req, CTRL_ERR_LENGTH);
+        int param = req->payload[0];
+        if (param >= CTRL_PARAM_COUNT) return control_nak(req, CTRL_ERR_PARAM);
+        if (req->op == CTRL_OP_SET) {
+            int32_t value = (int32_t)((uint32_t)req->payload[1] | ((uint32_t)req->payload[2] << 8) |
+                                      ((uint32_t)req->payload[3] << 16) | ((uint32_t)req->payload[4] << 24));
+            if (value < param_min[param] || value > param_max[param]) return control_nak(req, CTRL_ERR_RANGE);
+            if (dev->params[param] != value) {
+                dev->params[param] = value;
+                apply_param(cfg, dev, param);
+            }
+        }
+        return control_ack(req, (uint8_t)param, dev->params[param]);
+    }
+    case CTRL_OP_STAT: {
+        // Профіль симулятора: такти плати — час формування і запису пакетів у pty
+        if (req->len != 1) return control_nak(req, CTRL_ERR_LENGTH);
+        int stat = req->payload[0];
+        if (stat >= CTRL_STAT_COUNT) return control_nak(req, CTRL_ERR_PARAM);
+        if (stat == CTRL_STAT_WINDOW) memcpy(dev->snapshot, dev->published, sizeof(dev->published));
+        return control_ack(req, (uint8_t)stat, (int32_t)dev->snapshot[stat]);
+    }
+    default:
+        return control_nak(req, CTRL_ERR_OPCODE);
+    }
+}
+
+static void handle_frame(SimConfig *cfg, DeviceState *dev, SimStats *st, int size)
+{
+    ControlFrame req, reply;
+    st->commands++;
+    if (control_decode(dev->rx, size, &req)) {
+        reply = handle_request(cfg, dev, &req);
+    } else {
+        // ID пошкодженого кадру може бути хибним, але хост усе одно впізнає свій запит і повторить
+        st->bad_commands++;
+        req.id = dev->rx[2];
+        req.op = dev->rx[3];
+        reply = control_nak(&req, CTRL_ERR_CRC);
+    }
+    if (cfg->lose_reply_prob > 0.0 && rng_uniform() < cfg->lose_reply_prob) {
+        st->lost_replies++;
+        return;
+    }
+    dev->reply_len = control_encode(dev->reply, &reply);
+}
+
+static void poll_commands(int fd, SimConfig *cfg, DeviceState *dev, SimStats *st)
+{
+    uint8_t buf[256];
+    ssize_t n;
+    // Наступний кадр чекає, поки не піде відповідь на попередній (як у прошивці)
+    while (dev->reply_len == 0 && (n = read(fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            if (dev->rx_len == 0 && buf[i] != CTRL_START) continue;
+            dev->rx[dev->rx_len++] = buf[i];
+            int size = control_frame_size(dev->rx, dev->rx_len);
+            if (size < 0) {
+                st->bad_commands++;
+                dev->rx_len = 0;
+            } else if (size > 0 && dev->rx_len == size) {
+                handle_frame(cfg, dev, st, size);
+                dev->rx_len = 0;
+            }
+        }
+    }
+}
+
+// ---- Налаштування ----
+
+static void print_usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --rate HZ            samples per second (default 1000)\n"
+        "  --lock-rate          acknowledge but ignore rate changes from the host\n"
+        "  --legacy             send 0xAA packets without sequence numbers (old firmware)\n"
+        "  --fixed-layout       send 0xAB packets with all 4 channels, ignoring the channel mask\n"
+        "  --usb-budget BPS     bytes per second the link carries; caps the sample rate\n"
+        "  --wall-clock         waveform phase follows the system clock, so several simulators\n"
+        "                       show the same signal at the same instant (multi-board tests)\n"
+        "  --drift PPM          the board timestamp counter runs PPM fast (negative: slow)\n"
+        "  --chN KIND[:FREQ[:AMP[:OFFSET[:DUTY]]]]\n"
+        "                       waveform of channel N (0..3): sine, square, triangle, saw, pulse, dc;\n"
+        "                       AMP and OFFSET in ADC counts around mid-scale\n"
+        "  --noise SIGMA        gaussian noise, ADC counts RMS\n"
+        "  --dropout P[:LEN]    start a dropout of up to LEN packets with probability P per packet\n"
+        "  --corrupt P          flip a random bit in each byte with probability P\n"
+        "  --lose-replies P     drop the reply to a control request with probability P\n"
+        "  --duration S         stop after S seconds\n"
+        "  --link PATH          create a symlink to the pty (e.g. /tmp/ttyOSC)\n"
+        "  --seed N             random seed\n", prog);
+}
+
+static int parse_wave(const char *spec, Waveform *w)
+{
+    char kind[16] = {0};
+    double freq = w->freq_hz, amp = w->amplitude, offset = w->offset, duty = w->duty;
+    int n = sscanf(spec, "%15[a-z]:%lf:%lf:%lf:%lf", kind, &freq, &amp, &offset, &duty);
+    if (n < 1) return -1;
+
+    static const char *names[] = { "sine", "square", "triangle", "saw", "pulse", "dc" };
+    int k = -1;
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+        if (strcmp(kind, names[i]) == 0) k = i;
+    if (k < 0) return -1;
+
+    w->kind = (WaveKind)k;
+    w->freq_hz = freq;
+    w->amplitude = amp;
+    w->offset = offset;
+    w->duty = (n < 5 && k == WAVE_PULSE) ? 0.1 : duty;
+    return 0;
+}
+
+static int parse_args(int argc, char **argv, SimConfig *cfg)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(a, "--lock-rate") == 0) { cfg->lock_rate = true; continue; }
+        if (strcmp(a, "--legacy") == 0) { cfg->legacy = true; continue; }
+        if (strcmp(a, "--fixed-layout") == 0) { cfg->fixed_layout = true; continue; }
+        if (strcmp(a, "--wall-clock") == 0) { cfg->wall_clock = true; continue; }
+        if (strcmp(a, "--help") == 0 || strcmp(a, "-h") == 0) { print_usage(argv[0]); exit(0); }
+        if (!v) { fprintf(stderr, "Option %s needs a value\n", a); return -1; }
+        i++;
+
+        if (strcmp(a, "--rate") == 0) {
+            cfg->rate_hz = atof(v);
+            if (cfg->rate_hz <= 0.0) { fprintf(stderr, "Invalid rate: %s\n", v); return -1; }
+        } else if (strncmp(a, "--ch", 4) == 0 && a[4] >= '0' && a[4] < '0' + SIM_CHANNELS && a[5] == '\0') {
+            if (parse_wave(v, &cfg->wave[a[4] - '0']) != 0) {
+                fprintf(stderr, "Invalid waveform: %s\n", v);
+                return -1;
+            }
+        } else if (strcmp(a, "--drift") == 0) {
+            cfg->drift_ppm = atof(v);
+        } else if (strcmp(a, "--usb-budget") == 0) {
+            cfg->usb_budget = atof(v);
+        } else if (strcmp(a, "--noise") == 0) {
+            cfg->noise = atof(v);
+        } else if (strcmp(a, "--dropout") == 0) {
+            cfg->dropout_len = 1;
+            sscanf(v, "%lf:%d", &cfg->dropout_prob, &cfg->dropout_len);
+            if (cfg->dropout_len < 1) cfg->dropout_len = 1;
+        } else if (strcmp(a, "--corrupt") == 0) {
+            cfg->corrupt_prob = atof(v);
+        } else if (strcmp(a, "--lose-replies") == 0) {
+            cfg->lose_reply_prob = atof(v);
+        } else if (strcmp(a, "--duration") == 0) {
+            cfg->duration_s = atof(v);
+        } else if (strcmp(a, "--link") == 0) {
+            cfg->link_path = v;
+        } else if (strcmp(a, "--seed") == 0) {
+            cfg->seed = strtoull(v, NULL, 0);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", a);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// ---- Псевдотермінал ----
+
+static int open_pty(char *slave_name, size_t size, int *slave_fd)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        perror("posix_openpt");
+        return -1;
+    }
+    snprintf(slave_name, size, "%s", ptsname(master));
+
+    // Тримаємо підлеглий кінець відкритим, щоб запис не давав EIO до підключення хоста,
+    // і одразу вимикаємо луну та перетворення символів
+    *slave_fd = open(slave_name, O_RDWR | O_NOCTTY);
+    if (*slave_fd >= 0) {
+        struct termios tio;
+        if (tcgetattr(*slave_fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            tcsetattr(*slave_fd, TCSANOW, &tio);
+        }
+    }
+
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    return master;
+}
+
+int main(int argc, char **argv)
+{
+    SimConfig cfg = {
+        .rate_hz = 1000.0,
+        .wave = {
+            { WAVE_SINE,     10.0, 1200.0, 0.0, 0.5 },
+            { WAVE_SQUARE,    5.0,  800.0, 0.0, 0.5 },
+            { WAVE_TRIANGLE,  2.0, 1000.0, 0.0, 0.5 },
+            { WAVE_SAW,       1.0,  600.0, 0.0, 0.5 },
+        },
+        .seed = (uint64_t)time(NULL),
+    };
+    if (parse_args(argc, argv, &cfg) != 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    rng_state ^= cfg.seed * 0x9E3779B97F4A7C15ull;
+    if (rng_state == 0) rng_state = 1;
+
+    char slave_name[128];
+    int slave_fd = -1;
+    int fd = open_pty(slave_name, sizeof(slave_name), &slave_fd);
+    if (fd < 0) return 1;
+
+    if (cfg.link_path) {
+        unlink(cfg.link_path);
+        if (symlink(slave_name, cfg.link_path) != 0) perror("symlink");
+    }
+    printf("Simulator on %s%s%s — run: application --port %s\n", slave_name,
+           cfg.link_path ? " -> " : "", cfg.link_path ? cfg.link_path : "",
+           cfg.link_path ? cfg.link_path : slave_name);
+    fflush(stdout);
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    DeviceState dev = { .params = { [CTRL_PARAM_CHANNEL_MASK] = CTRL_CHANNEL_MASK_ALL } };
+    for (int ch = 0; ch < CTRL_TEST_CHANNELS; ch++) {
+        dev.params[CTRL_PARAM_TEST_WAVE + ch] = test_defaults[0][ch];
+        dev.params[CTRL_PARAM_TEST_FREQ + ch] = test_defaults[1][ch];
+        dev.params[CTRL_PARAM_TEST_AMPLITUDE + ch] = test_defaults[2][ch];
+        dev.params[CTRL_PARAM_TEST_NOISE + ch] = test_defaults[3][ch];
+    }
+    SimStats st = {0};
+    static uint8_t batch[MAX_BATCH_PACKETS * (PACKET_DELTA_MAX + PACKET_TIME_BYTES + PACKET_ETS_BYTES) + CTRL_FRAME_MAX];
+    size_t pending = 0, pending_off = 0;   // Недописаний у pty хвіст попереднього запису
+
+    double start = now_seconds();
+    // Лічильник плати стартує з довільного значення: хост мусить розгортати 32 біти
+    double time_origin_us = (double)(rng_next() & 0xFFFFFFFFu);
+    double rate_base_time = start;
+    double rate = scan_rate(&cfg, &dev);
+    uint64_t sample = 0, base_sample = 0;  // Скани від старту
+    uint32_t packet_seq = 0;
+    int ets_step = 0;                      // Зсув наступного захоплення, у кроках
+    int dropout_left = 0;
+    double last_report = start, profile_start = start;
+    unsigned long long last_sent = 0, last_samples = 0, last_bytes = 0;
+    unsigned long long last_delta_blocks = 0, last_delta_bytes = 0;
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (!stop_requested) {
+        double now = now_seconds();
+        if (cfg.duration_s > 0.0 && now - start >= cfg.duration_s) break;
+
+        poll_commands(fd, &cfg, &dev, &st);
+        profile_add(&dev, CTRL_PROF_CONTROL, now_seconds() - now);
+        if (scan_rate(&cfg, &dev) != rate) {
+            // Зміна частоти (команда або інша маска при --usb-budget) — новий відлік
+            // від поточного семпла, без стрибка
+            rate = scan_rate(&cfg, &dev);
+            rate_base_time = now;
+            base_sample = sample;
+        }
+
+        // Спочатку дописуємо залишок, щоб не розривати пакет
+        if (pending > 0) {
+            ssize_t w = write(fd, batch + pending_off, pending);
+            if (w > 0) { pending -= (size_t)w; pending_off += (size_t)w; }
+        }
+
+        uint8_t mask = (uint8_t)dev.params[CTRL_PARAM_CHANNEL_MASK];
+        int scans = packet_scans(&cfg, &dev);
+        bool delta = compressed(&cfg, &dev);
+        bool raw = raw_packets(&cfg, &dev);
+        int oversample = oversampling(&cfg, &dev);
+        int extra = resolution_bits(&cfg, &dev);
+        bool stamp = timestamped(&cfg, &dev);
+        int steps = ets_steps(&cfg, &dev);
+        if (ets_step >= steps) ets_step = 0;
+        uint64_t due = base_sample + (uint64_t)((now - rate_base_time) * rate);
+        if (due >= sample + (uint64_t)scans) {
+            uint64_t count = (due - sample) / (uint64_t)scans;
+            if (count > MAX_BATCH_PACKETS) {
+                st.overflow += count - MAX_BATCH_PACKETS;
+                sample += (count - MAX_BATCH_PACKETS) * (uint64_t)scans;
+                packet_seq += (uint32_t)(count - MAX_BATCH_PACKETS);
+                count = MAX_BATCH_PACKETS;
+            }
+
+            if (pending > 0) {
+                // Хост не встигає — як CDC_Transmit_FS у стані BUSY, пакети губляться
+                st.overflow += count;
+                dev.profile[CTRL_STAT_TX_BUSY] += (uint32_t)count;
+                sample += count * (uint64_t)scans;
+                packet_seq += (uint32_t)count;
+            } else {
+                size_t bytes = 0;
+                double encode_start = now_seconds();
+                for (uint64_t i = 0; i < count; i++, sample += (uint64_t)scans, packet_seq++) {
+                    if (dropout_left > 0) { dropout_left--; st.dropped++; continue; }
+                    if (cfg.dropout_prob > 0.0 && rng_uniform() < cfg.dropout_prob) {
+                        dropout_left = (int)(rng_next() % (uint64_t)cfg.dropout_len);
+                        st.dropped++;
+                        continue;
+                    }
+
+                    // Захоплення: скани від найближчого фронту першого каналу маски, а не в темпі rate.
+                    // Без фронту прошивка пакет не формує — і номер не рахує
+                    double t0 = (cfg.wall_clock ? start : 0.0) + (double)sample / rate, spacing = 1.0 / rate;
+                    int step_cycles = 0;
+                    if (steps) {
+                        int trigger_channel = __builtin_ctz(mask);
+                        Waveform w = dev.params[CTRL_PARAM_TEST_SIGNAL] ? test_wave(&dev, trigger_channel)
+                                                                        : cfg.wave[trigger_channel];
+                        double edge = next_edge(&w, dev.params[CTRL_PARAM_TRIGGER_EDGE], t0);
+                        if (edge < 0.0) { packet_seq--; continue; }
+                        step_cycles = ets_step_cycles(&dev, steps);
+                        t0 = edge + (ETS_START_CYCLES + ets_step * step_cycles) / ETS_CLOCK_HZ;
+                        spacing = steps * step_cycles / ETS_CLOCK_HZ;
+                    }
+
+                    int16_t values[DELTA_BLOCK_VALUES][SIM_CHANNELS];
+                    for (int k = 0; k < scans; k++) {
+                        double t = t0 + k * spacing;
+                        if (dev.params[CTRL_PARAM_TEST_SIGNAL]) {
+                            for (int ch = 0; ch < SIM_CHANNELS; ch++) values[k][ch] = test_value(&dev, ch, t);
+                        } else {
+                            for (int ch = 0; ch < SIM_CHANNELS; ch++)
+                                values[k][ch] = (mask & (1u << ch)) || cfg.legacy || cfg.fixed_layout
+                                              ? adc_value(&cfg, &cfg.wave[ch], t, oversample, extra) : 0;
+                        }
+                    }
+
+                    // Мітка першого скану пакета за кварцом плати
+                    double scan_time = rate_base_time + (double)(sample - base_sample) / rate - start;
+                    uint32_t time_us = (uint32_t)fmod(time_origin_us + scan_time * (1.0 + cfg.drift_ppm * 1e-6) * 1e6,
+                                                      4294967296.0);
+
+                    uint8_t *p = batch + bytes;
+                    int size;
+                    if (cfg.legacy || cfg.fixed_layout) {
+                        put_packet(p, values[0], packet_seq, cfg.legacy);
+                        size = PACKET_SIZE;
+                    } else if (steps) {
+                        size = put_packet_ets(p, values, scans, mask, packet_seq, stamp ? &time_us : NULL,
+                                              ets_step, steps, step_cycles);
+                        ets_step = (ets_step + 1) % steps;
+                        st.delta_blocks++;
+                        st.delta_bytes += (unsigned long long)size;
+                    } else if (delta) {
+                        size = put_packet_delta(p, values, scans, mask, extra, packet_seq, stamp ? &time_us : NULL);
+                        st.delta_blocks++;
+                        st.delta_bytes += (unsigned long long)size;
+                    } else if (raw) {
+                        size = put_packet_raw(p, values, scans, mask, packet_seq, stamp ? &time_us : NULL);
+                    } else {
+                        size = put_packet_mask(p, values, scans, mask, extra, packet_seq, stamp ? &time_us : NULL);
+                    }
+                    if (cfg.corrupt_prob > 0.0) {
+                        for (int b = 0; b < size; b++) {
+                            if (rng_uniform() < cfg.corrupt_prob) {
+                                p[b] ^= (uint8_t)(1u << (rng_next() & 7));
+                                st.corrupted++;
+                            }
+                        }
+                    }
+                    bytes += (size_t)size;
+                    st.bytes += (unsigned long long)size;
+                    st.sent++;
+                    st.samples += (unsigned long long)scans;
+                    dev.profile[CTRL_STAT_PACKETS]++;
+                    dev.profile[CTRL_STAT_SCANS] += (uint32_t)scans;
+                }
+
+                // Відповідь на запит керування — за останнім пакетом, як у прошивці
+                if (dev.reply_len > 0) {
+                    memcpy(batch + bytes, dev.reply, (size_t)dev.reply_len);
+                    bytes += (size_t)dev.reply_len;
+                    dev.reply_len = 0;
+                }
+                double transmit_start = now_seconds();
+                profile_add(&dev, CTRL_PROF_ENCODE, transmit_start - encode_start);
+                ssize_t w = bytes > 0 ? write(fd, batch, bytes) : 0;
+                profile_add(&dev, CTRL_PROF_TRANSMIT, now_seconds() - transmit_start);
+                if (w < 0) w = 0;
+                pending = bytes - (size_t)w;
+                pending_off = (size_t)w;
+            }
+        }
+
+        if (now - profile_start >= 1.0) {
+            profile_publish(&dev, now - profile_start);
+            profile_start = now;
+        }
+
+        if (now - last_report >= 1.0) {
+            // Стиснення: у скільки разів блок з заголовком коротший за ті самі значення по 2 байти
+            unsigned long long blocks = st.delta_blocks - last_delta_blocks;
+            double block_bytes = blocks > 0 ? (double)(st.delta_bytes - last_delta_bytes) / blocks : 0.0;
+            char ratio[32] = "";
+            if (blocks > 0) {
+                dev.block_bytes = block_bytes;
+                snprintf(ratio, sizeof(ratio), "  delta x%.2f", 2.0 * DELTA_BLOCK_VALUES / block_bytes);
+            }
+            fprintf(stderr, "%.0f pkt/s  %.0f S/s  %.0f B/s  sent %llu  dropout %llu  overflow %llu  corrupted %llu B  cmds %llu%s%s\n",
+                    (st.sent - last_sent) / (now - last_report), (st.samples - last_samples) / (now - last_report),
+                    (st.bytes - last_bytes) / (now - last_report), st.sent, st.dropped, st.overflow,
+                    st.corrupted, st.commands, dev.params[CTRL_PARAM_TEST_SIGNAL] ? "  [test signal]" : "",
+                    ratio);
+            last_report = now;
+            last_sent = st.sent;
+            last_samples = st.samples;
+            last_bytes = st.bytes;
+            last_delta_blocks = st.delta_blocks;
+            last_delta_bytes = st.delta_bytes;
+        }
+
+        next.tv_nsec += TICK_NS;
+        if (next.tv_nsec >= 1000000000L) { next.tv_nsec -= 1000000000L; next.tv_sec++; }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+
+    fprintf(stderr, "Total: sent %llu  dropout %llu  overflow %llu  corrupted %llu B  "
+                    "cmds %llu (bad %llu, replies lost %llu)\n",
+            st.sent, st.dropped, st.overflow, st.corrupted, st.commands, st.bad_commands, st.lost_replies);
+    if (cfg.link_path) unlink(cfg.link_path);
+    if (slave_fd >= 0) close(slave_fd);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,26 @@
+// file test.h
+//
+// Перевірки модулів osc/ без вікна і без плати: make test. Кожен набір — функція test_*,
+// що повертає кількість невдалих перевірок; osc_tests завершується з ненульовим кодом, якщо є хоч одна.
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+// Невдала перевірка друкується з місцем і збільшує лічильник failed набору
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__); \
+        fputc('\n', stderr); \
+        failed++; \
+    } \
+} while (0)
+
+int test_measurements(void);
+int test_decoder(void);
+int test_usb_discovery(void);
+int test_usb_bulk(void);
+
+#endif // TEST_H
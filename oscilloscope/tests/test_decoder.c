@@ -0,0 +1,286 @@
+// file test_decoder.c
+//
+// Декодери UART, SPI і I2C на центрованих семплах (нуль — середина шкали, як у потоці плати).
+// UART перевіряється на сигналі, набагато довшому за вікно вимірювань: пороги 40% / 60% беруться
+// з мінімуму і максимуму вікна (голови монотонних черг) і мають збігатися з прямим перебором.
+// Рівень одиниці в паузах, довших за вікно, спадає до самого старт-біта, тож черга максимумів
+// заповнюється до ємності вікна. Лінія в спокої не має давати жодної події ще до вимірювань.
+
+#include <stdlib.h>
+
+#include "main.h"
+#include "setup_channel_buffers.h"
+#include "measurements.h"
+#include "decoder.h"
+#include "parse_data.h"
+#include "test.h"
+
+#define TEST_WINDOW 128
+#define TEST_CHANNELS 4
+#define TEST_MAX_SAMPLES 8192
+#define TEST_UPDATE 100               // Семплів між decoder_update (кадр застосунку)
+
+#define TEST_BAUD 9600
+#define TEST_SPB 16                   // UART: семплів на біт
+#define TEST_IDLE 140                 // UART: семплів паузи перед кожним байтом (довше за вікно)
+#define TEST_PERIOD (TEST_IDLE + 10 * TEST_SPB)
+#define TEST_HIGH 1800                // UART: рівень одиниці на початку сигналу
+#define TEST_LOW (-1000)
+
+#define TEST_BUS_HIGH 1500            // SPI, I2C: рівні шини
+#define TEST_BUS_LOW (-1500)
+#define TEST_HALF 8                   // SPI, I2C: семплів на половину такту
+
+static OscData osc;
+static int16_t trace[TEST_CHANNELS][TEST_MAX_SAMPLES];
+static int trace_len;
+static const char message[] = "Hello, UART!";
+
+// Цифрові рівні каналів (біт ch — канал ch) протягом count семплів
+static void put(unsigned levels, int count)
+{
+    for (int k = 0; k < count && trace_len < TEST_MAX_SAMPLES; k++, trace_len++)
+        for (int ch = 0; ch < TEST_CHANNELS; ch++)
+            trace[ch][trace_len] = (levels >> ch) & 1 ? TEST_BUS_HIGH : TEST_BUS_LOW;
+}
+
+static void decoder_setup(DecodeProtocol protocol, int extra_bits)
+{
+    init_osc_data(&osc);
+    osc.points_to_display = TEST_WINDOW;
+    setup_channel_buffers(&osc);
+    osc.adc_extra_bits = extra_bits;
+    osc.sample_rate_hz = (float)(TEST_BAUD * TEST_SPB);
+    osc.decoder.uart_baud = TEST_BAUD;
+    decoder_set_protocol(&osc, protocol);
+    trace_len = 0;
+}
+
+static void decoder_teardown(void)
+{
+    decoder_free(&osc);
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+        free(osc.channels[ch].channel_history);
+        osc.channels[ch].channel_history = NULL;
+    }
+    measurements_free(&osc);
+}
+
+// Проганяє trace через вимірювання і декодер, як push_sample() і кадр застосунку.
+// check_thresholds — після кожного оновлення порівнювати пороги каналу 0 з прямим перебором вікна.
+static int run_trace(bool check_thresholds)
+{
+    int failed = 0;
+    int16_t lo = osc.decoder.dig[0].lo, hi = osc.decoder.dig[0].hi;
+
+    for (int i = 0; i < trace_len; i++) {
+        int16_t raw[MAX_CHANNELS] = {0};
+        for (int ch = 0; ch < TEST_CHANNELS; ch++) raw[ch] = trace[ch][i];
+        measurements_on_sample(&osc, raw);
+        decoder_on_sample(&osc, raw);
+        osc.sample_count++;
+
+        if ((i + 1) % TEST_UPDATE != 0 && i + 1 != trace_len) continue;
+        decoder_update(&osc);
+        if (!check_thresholds) continue;
+
+        // Малий розмах лишає попередні пороги
+        int first = i + 1 > TEST_WINDOW ? i + 1 - TEST_WINDOW : 0;
+        int vmin = trace[0][first], vmax = trace[0][first];
+        for (int k = first + 1; k <= i; k++) {
+            if (trace[0][k] < vmin) vmin = trace[0][k];
+            if (trace[0][k] > vmax) vmax = trace[0][k];
+        }
+        if (vmax - vmin >= DECODER_MIN_SWING << osc.adc_extra_bits) {
+            lo = (int16_t)(vmin + (vmax - vmin) * 2 / 5);
+            hi = (int16_t)(vmin + (vmax - vmin) * 3 / 5);
+        }
+        CHECK(osc.decoder.dig[0].lo == lo && osc.decoder.dig[0].hi == hi,
+              "семпл %d: пороги %d/%d, очікувано %d/%d", i, osc.decoder.dig[0].lo, osc.decoder.dig[0].hi, lo, hi);
+        if (failed) break;
+    }
+    return failed;
+}
+
+// Рівень одиниці спадає на відлік за кожен семпл паузи і тримається під час байта
+static int16_t uart_value(int i)
+{
+    int byte = i / TEST_PERIOD, offset = i % TEST_PERIOD;
+    if (offset < TEST_IDLE) return (int16_t)(TEST_HIGH - byte * TEST_IDLE - offset);
+
+    int16_t high = (int16_t)(TEST_HIGH - (byte + 1) * TEST_IDLE);
+    int bit = (offset - TEST_IDLE) / TEST_SPB;
+    if (bit == 0) return TEST_LOW;                    // Старт-біт
+    if (bit > 8) return high;                         // Стоп-біт
+    return ((uint8_t)message[byte] >> (bit - 1)) & 1 ? high : TEST_LOW;
+}
+
+static int test_uart(void)
+{
+    int failed = 0;
+    const int bytes = (int)sizeof(message) - 1;
+
+    decoder_setup(DECODE_UART, 0);
+    for (trace_len = 0; trace_len < bytes * TEST_PERIOD; trace_len++)
+        trace[0][trace_len] = uart_value(trace_len);
+    failed += run_trace(true);
+
+    CHECK(osc.decoder.total == (unsigned long long)bytes, "UART: декодовано %llu байтів, очікувано %d",
+          osc.decoder.total, bytes);
+    for (int b = 0; b < bytes && !failed; b++) {
+        const DecodedEvent *e = decoder_event(&osc.decoder, b);
+        unsigned long long start = (unsigned long long)b * TEST_PERIOD + TEST_IDLE;
+        CHECK(e->type == DECODE_EVT_UART_BYTE && e->value == (uint8_t)message[b] && e->flags == 0,
+              "UART, байт %d: 0x%02x (прапорці 0x%02x), очікувано 0x%02x", b, e->value, e->flags, (uint8_t)message[b]);
+        CHECK(e->start == start, "UART, байт %d: початок %llu, очікувано %llu", b, e->start, start);
+    }
+    decoder_teardown();
+    return failed;
+}
+
+// Лінія в спокої вище середини шкали: до першого розмаху діють пороги за замовчуванням
+static int test_idle(DecodeProtocol protocol, int extra_bits)
+{
+    int failed = 0;
+
+    decoder_setup(protocol, extra_bits);
+    CHECK(osc.decoder.dig[0].lo < osc.decoder.dig[0].hi, "%s, +%d біт: пороги %d/%d без гістерезису",
+          decoder_protocol_name(protocol), extra_bits, osc.decoder.dig[0].lo, osc.decoder.dig[0].hi);
+    for (trace_len = 0; trace_len < 2000; trace_len++)
+        for (int ch = 0; ch < TEST_CHANNELS; ch++)
+            trace[ch][trace_len] = (int16_t)(1000 << extra_bits);
+    failed += run_trace(false);
+    CHECK(osc.decoder.total == 0, "%s, +%d біт: лінія в спокої дала %llu подій",
+          decoder_protocol_name(protocol), extra_bits, osc.decoder.total);
+    decoder_teardown();
+    return failed;
+}
+
+// Режим 0: SCLK — канал 0, MOSI — 1, CS — 2 (активний нулем), MISO — 3; старшим бітом першим
+static int test_spi(void)
+{
+    int failed = 0;
+    static const uint8_t mosi[] = { 0xA5, 0x3C, 0x00, 0xFF };
+    static const uint8_t miso[] = { 0x5A, 0xC3, 0x81, 0x7E };
+    const int words = (int)sizeof(mosi);
+    unsigned long long start[sizeof(mosi)];
+
+    decoder_setup(DECODE_SPI, 0);
+    put(0x4, 64);                                     // CS неактивний, такт у нулі
+    for (int w = 0; w < words; w++) {
+        put(0x0, TEST_HALF);                          // CS активний
+        for (int bit = 7; bit >= 0; bit--) {
+            unsigned data = (((mosi[w] >> bit) & 1) << 1) | (((miso[w] >> bit) & 1) << 3);
+            put(data, TEST_HALF);
+            if (bit == 7) start[w] = (unsigned long long)trace_len;
+            put(data | 0x1, TEST_HALF);               // Вибірка по наростанню
+        }
+        put(0x0, TEST_HALF);
+        put(0x4, 32);
+    }
+    failed += run_trace(false);
+
+    CHECK(osc.decoder.total == (unsigned long long)words, "SPI: декодовано %llu слів, очікувано %d",
+          osc.decoder.total, words);
+    for (int w = 0; w < words && !failed; w++) {
+        const DecodedEvent *e = decoder_event(&osc.decoder, w);
+        CHECK(e->type == DECODE_EVT_SPI_WORD && e->value == mosi[w] && e->value2 == miso[w] && e->flags == 0,
+              "SPI, слово %d: 0x%02x/0x%02x (прапорці 0x%02x), очікувано 0x%02x/0x%02x",
+              w, e->value, e->value2, e->flags, mosi[w], miso[w]);
+        CHECK(e->start == start[w], "SPI, слово %d: початок %llu, очікувано %llu", w, e->start, start[w]);
+    }
+    decoder_teardown();
+    return failed;
+}
+
+// Один такт I2C (SCL — канал 0, SDA — 1): SDA змінюється лише при низькому SCL
+static void i2c_bit(int b)
+{
+    put((unsigned)b << 1, TEST_HALF);
+    put(((unsigned)b << 1) | 0x1, TEST_HALF);
+}
+
+static void i2c_byte(uint8_t value, bool nak)
+{
+    for (int bit = 7; bit >= 0; bit--) i2c_bit((value >> bit) & 1);
+    i2c_bit(nak);
+}
+
+static int test_i2c(void)
+{
+    int failed = 0;
+    static const struct { uint8_t type; uint16_t value; uint8_t flags; } expected[] = {
+        { DECODE_EVT_I2C_START, 0, 0 },
+        { DECODE_EVT_I2C_ADDRESS, 0x48, 0 },
+        { DECODE_EVT_I2C_DATA, 0x12, 0 },
+        { DECODE_EVT_I2C_START, 0, DECODE_FLAG_RESTART },
+        { DECODE_EVT_I2C_ADDRESS, 0x48, DECODE_FLAG_READ },
+        { DECODE_EVT_I2C_DATA, 0x34, DECODE_FLAG_NAK },
+        { DECODE_EVT_I2C_STOP, 0, 0 },
+    };
+    const int count = (int)(sizeof(expected) / sizeof(expected[0]));
+
+    decoder_setup(DECODE_I2C, 0);
+    put(0x3, 64);                                     // Шина вільна
+    put(0x1, TEST_HALF);                              // START
+    put(0x0, TEST_HALF);
+    i2c_byte(0x48 << 1, false);
+    i2c_byte(0x12, false);
+    put(0x2, TEST_HALF);                              // Повторний START
+    put(0x3, TEST_HALF);
+    put(0x1, TEST_HALF);
+    put(0x0, TEST_HALF);
+    i2c_byte((0x48 << 1) | 1, false);
+    i2c_byte(0x34, true);
+    put(0x0, TEST_HALF);                              // STOP
+    put(0x1, TEST_HALF);
+    put(0x3, 64);
+    failed += run_trace(false);
+
+    CHECK(osc.decoder.total == (unsigned long long)count, "I2C: декодовано %llu подій, очікувано %d",
+          osc.decoder.total, count);
+    for (int i = 0; i < count && !failed; i++) {
+        const DecodedEvent *e = decoder_event(&osc.decoder, i);
+        CHECK(e->type == expected[i].type && e->value == expected[i].value && e->flags == expected[i].flags,
+              "I2C, подія %d: %s 0x%02x (прапорці 0x%02x), очікувано тип %d 0x%02x (прапорці 0x%02x)",
+              i, decoder_event_name(e), e->value, e->flags, expected[i].type, expected[i].value, expected[i].flags);
+    }
+    decoder_teardown();
+    return failed;
+}
+
+// Пороги за замовчуванням при зміні роздільності: гістерезис не перевертається
+static int test_rescale(void)
+{
+    int failed = 0;
+
+    decoder_setup(DECODE_UART, 0);
+    decoder_rescale(&osc, 0, ADC_EXTRA_BITS_MAX);
+    CHECK(osc.decoder.dig[0].lo == -(DECODER_IDLE_HYST << ADC_EXTRA_BITS_MAX) &&
+          osc.decoder.dig[0].hi == (DECODER_IDLE_HYST << ADC_EXTRA_BITS_MAX),
+          "0 -> +%d біт: пороги %d/%d", ADC_EXTRA_BITS_MAX, osc.decoder.dig[0].lo, osc.decoder.dig[0].hi);
+    decoder_rescale(&osc, ADC_EXTRA_BITS_MAX, 0);
+    CHECK(osc.decoder.dig[0].lo == -DECODER_IDLE_HYST && osc.decoder.dig[0].hi == DECODER_IDLE_HYST,
+          "+%d -> 0 біт: пороги %d/%d", ADC_EXTRA_BITS_MAX, osc.decoder.dig[0].lo, osc.decoder.dig[0].hi);
+    decoder_teardown();
+
+    decoder_setup(DECODE_UART, ADC_EXTRA_BITS_MAX);
+    CHECK(osc.decoder.dig[0].lo == -(DECODER_IDLE_HYST << ADC_EXTRA_BITS_MAX) &&
+          osc.decoder.dig[0].hi == (DECODER_IDLE_HYST << ADC_EXTRA_BITS_MAX),
+          "+%d біт: пороги за замовчуванням %d/%d", ADC_EXTRA_BITS_MAX, osc.decoder.dig[0].lo, osc.decoder.dig[0].hi);
+    decoder_teardown();
+    return failed;
+}
+
+int test_decoder(void)
+{
+    int failed = 0;
+    failed += test_uart();
+    failed += test_idle(DECODE_UART, 0);
+    failed += test_idle(DECODE_UART, ADC_EXTRA_BITS_MAX);
+    failed += test_idle(DECODE_I2C, ADC_EXTRA_BITS_MAX);
+    failed += test_rescale();
+    failed += test_spi();
+    failed += test_i2c();
+    return failed;
+}
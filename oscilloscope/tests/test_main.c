@@ -0,0 +1,37 @@
+// file test_main.c
+//
+// Запуск усіх наборів перевірок: make test (збирає і запускає build/test/osc_tests)
+
+#include <stdio.h>
+
+#include "test.h"
+
+// Глобальні параметри тексту, які застосунок визначає в main.c
+int LineSpacing = 0;
+int spacing = 2;
+int scale = 1;
+int padding = 3;
+int borderThickness = 1;
+
+typedef struct {
+    const char *name;
+    int (*run)(void);
+} TestSuite;
+
+static const TestSuite suites[] = {
+    { "measurements", test_measurements },
+    { "decoder", test_decoder },
+    { "usb_discovery", test_usb_discovery },
+    { "usb_bulk", test_usb_bulk },
+};
+
+int main(void)
+{
+    int total = 0;
+    for (size_t i = 0; i < sizeof(suites) / sizeof(suites[0]); i++) {
+        int failed = suites[i].run();
+        fprintf(stderr, "%-16s %s\n", suites[i].name, failed ? "FAIL" : "ok");
+        total += failed;
+    }
+    return total ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+// file test_measurements.c
+//
+// Мінімум, максимум і розмах ковзного вікна (монотонні черги) проти прямого перебору вікна
+// на сигналах, довших за вікно: висхідна і спадна пилки заповнюють черги до самої ємності.
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "main.h"
+#include "setup_channel_buffers.h"
+#include "measurements.h"
+#include "test.h"
+
+#define TEST_WINDOW 64
+#define TEST_SAMPLES (TEST_WINDOW * 5)
+
+static OscData osc;
+
+// Сигнали каналів: висхідна пилка, спадна пилка, трикутник з періодом більшим за вікно
+static int16_t signal_value(int channel, int i)
+{
+    switch (channel) {
+        case 0: return (int16_t)(100 + 10 * i);
+        case 1: return (int16_t)(4000 - 10 * i);
+        default: {
+            int phase = i % (TEST_WINDOW * 3);
+            return (int16_t)(1000 + 8 * (phase < TEST_WINDOW * 3 / 2 ? phase : TEST_WINDOW * 3 - phase));
+        }
+    }
+}
+
+int test_measurements(void)
+{
+    int failed = 0;
+    const float volts = ADC_VREF_VOLTS / ADC_FULL_SCALE;
+
+    init_osc_data(&osc);
+    osc.points_to_display = TEST_WINDOW;
+    setup_channel_buffers(&osc);
+
+    for (int i = 0; i < TEST_SAMPLES; i++) {
+        int16_t raw[MAX_CHANNELS] = {0};
+        for (int ch = 0; ch < 3; ch++) raw[ch] = signal_value(ch, i);
+        measurements_on_sample(&osc, raw);
+        osc.sample_count++;
+
+        int first = i + 1 > TEST_WINDOW ? i + 1 - TEST_WINDOW : 0;
+        for (int ch = 0; ch < 3; ch++) {
+            int16_t lo = signal_value(ch, first), hi = lo;
+            for (int k = first + 1; k <= i; k++) {
+                int16_t v = signal_value(ch, k);
+                if (v < lo) lo = v;
+                if (v > hi) hi = v;
+            }
+
+            MeasurementResult r = measurements_get(&osc, ch);
+            CHECK(r.valid, "канал %d, семпл %d: результат недійсний", ch, i);
+            CHECK(fabsf(r.min_v - lo * volts) < 1e-4f, "канал %d, семпл %d: мінімум %.4f В, очікувано %.4f В",
+                  ch, i, r.min_v, lo * volts);
+            CHECK(fabsf(r.max_v - hi * volts) < 1e-4f, "канал %d, семпл %d: максимум %.4f В, очікувано %.4f В",
+                  ch, i, r.max_v, hi * volts);
+            CHECK(fabsf(r.vpp_v - (hi - lo) * volts) < 1e-4f, "канал %d, семпл %d: розмах %.4f В, очікувано %.4f В",
+                  ch, i, r.vpp_v, (hi - lo) * volts);
+            CHECK(osc.measurements[ch].qmin.size <= TEST_WINDOW && osc.measurements[ch].qmax.size <= TEST_WINDOW,
+                  "канал %d, семпл %d: черга більша за вікно", ch, i);
+        }
+        if (failed) break; // Після першої розбіжності решта семплів лише повторює її
+    }
+
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+        free(osc.channels[ch].channel_history);
+        osc.channels[ch].channel_history = NULL;
+    }
+    measurements_free(&osc);
+    return failed;
+}
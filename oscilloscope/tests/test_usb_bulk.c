@@ -0,0 +1,145 @@
+// file test_usb_bulk.c
+//
+// Черга URB проти частоти пакетів прошивки. Імітація (USB_TRANSPORT_SIM) завершує один URB
+// на пакет, як контролер на коротких пакетах, і не бере байтів, поки URB не повернуто в чергу
+// (NAK). Плата пише у FIFO пакети 0xAD і 0xB0 по одному з частотою, вищою за кадри застосунку
+// у сотні разів, а головний потік читає раз на кадр: усі байти мають прийти по порядку, один
+// URB на пакет, і не повільніше, ніж їх пише плата.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "parse_data.h"
+#include "usb_bulk.h"
+#include "test.h"
+
+#define TEST_PACKETS 40000
+#define TEST_BURST 64                 // Пакетів плати за 1 мс (більше за 19 пакетів full-speed)
+#define TEST_FRAME_US 16667           // Кадр головного потоку (60 Гц)
+#define TEST_DEADLINE_S 5.0
+#define TEST_RAW_SCANS 28             // 0xB0 з одним каналом: 6 + 28 * 2 = 62 байти
+
+static char fifo[64];
+
+// Пакет номер i: парні — 0xAD з чотирма каналами (29 байтів), непарні — 0xB0 (62 байти)
+static int make_packet(uint32_t i, uint8_t *p)
+{
+    p[0] = i & 1 ? PACKET_START_RAW : PACKET_START_MASK;
+    p[1] = i & 1 ? 0x01 : 0x0F;
+    p[2] = (uint8_t)i;
+    p[3] = (uint8_t)(i >> 8);
+    p[4] = (uint8_t)(i >> 16);
+    int size;
+    if (i & 1) {
+        p[5] = TEST_RAW_SCANS;
+        size = PACKET_RAW_HEADER + TEST_RAW_SCANS * 2;
+        for (int k = PACKET_RAW_HEADER; k < size; k++) p[k] = (uint8_t)(i * 7 + k);
+    } else {
+        size = PACKET_MASK_SIZE;
+        for (int k = PACKET_MASK_HEADER; k < size; k++) p[k] = (uint8_t)(i * 3 + k);
+    }
+    return size;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Плата: кожен пакет — окремий запис; запис блокується, поки FIFO повний
+static void *board_thread(void *arg)
+{
+    (void)arg;
+    int fd = open(fifo, O_WRONLY);
+    if (fd < 0) return NULL;
+    uint8_t packet[PACKET_MAX_SIZE];
+    for (uint32_t i = 0; i < TEST_PACKETS; i++) {
+        int size = make_packet(i, packet);
+        if (write(fd, packet, (size_t)size) != size) break;
+        if ((i + 1) % TEST_BURST == 0) usleep(1000);
+    }
+    close(fd);
+    return NULL;
+}
+
+int test_usb_bulk(void)
+{
+    int failed = 0;
+    size_t expected_bytes = 0;
+    uint8_t packet[PACKET_MAX_SIZE];
+    for (uint32_t i = 0; i < TEST_PACKETS; i++) expected_bytes += (size_t)make_packet(i, packet);
+
+    uint8_t *received = (uint8_t*)malloc(expected_bytes);
+    if (!received) return 1;
+    snprintf(fifo, sizeof(fifo), "/tmp/osc_bulk_%d", (int)getpid());
+    unlink(fifo);
+    if (mkfifo(fifo, 0600) != 0) {
+        perror(fifo);
+        free(received);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    UsbBulk bulk;
+    CHECK(usb_bulk_open(&bulk, fifo, USB_TRANSPORT_SIM), "FIFO %s не відкрито", fifo);
+    pthread_t board;
+    if (failed || pthread_create(&board, NULL, board_thread, NULL) != 0) {
+        usb_bulk_close(&bulk);
+        unlink(fifo);
+        free(received);
+        return failed + 1;
+    }
+
+    // Головний потік: усе прийняте за кадр, потім пауза до наступного кадру
+    size_t total = 0;
+    int frames = 0;
+    double start = now_seconds();
+    while (total < expected_bytes && now_seconds() - start < TEST_DEADLINE_S) {
+        const uint8_t *data;
+        int n;
+        while ((n = usb_bulk_read(&bulk, &data)) > 0 && total + (size_t)n <= expected_bytes) {
+            memcpy(received + total, data, (size_t)n);
+            total += (size_t)n;
+        }
+        CHECK(n >= 0, "кадр %d: usb_bulk_read повернув %d", frames, n);
+        if (n < 0) break;
+        frames++;
+        usleep(TEST_FRAME_US);
+    }
+    double elapsed = now_seconds() - start;
+    // Плата, що ще пише у FIFO, отримує EPIPE після закриття, а не блокує тест
+    unsigned long long completed = bulk.urbs_completed, short_urbs = bulk.urbs_short, dropped = bulk.ring_dropped;
+    usb_bulk_close(&bulk);
+    pthread_join(board, NULL);
+
+    CHECK(total == expected_bytes, "прийнято %zu байтів з %zu за %.2f с (%d кадрів)",
+          total, expected_bytes, elapsed, frames);
+    size_t pos = 0;
+    for (uint32_t i = 0; i < TEST_PACKETS && pos < total; i++) {
+        int size = make_packet(i, packet);
+        if (pos + (size_t)size > total || memcmp(received + pos, packet, (size_t)size) != 0) {
+            CHECK(false, "пакет %u (зміщення %zu) прийнято пошкодженим", i, pos);
+            break;
+        }
+        pos += (size_t)size;
+    }
+    CHECK(completed == TEST_PACKETS, "завершено %llu URB, очікувано %d (один на пакет)", completed, TEST_PACKETS);
+    CHECK(short_urbs == completed, "коротких URB %llu з %llu", short_urbs, completed);
+    CHECK(dropped == 0, "відкинуто %llu байтів", dropped);
+    // URB, що повертаються в чергу лише раз на кадр, дали б щонайбільше USB_BULK_URBS пакетів за кадр
+    CHECK(frames < TEST_PACKETS / USB_BULK_URBS, "%d кадрів на %d пакетів: черга URB обмежує потік",
+          frames, TEST_PACKETS);
+
+    unlink(fifo);
+    free(received);
+    return failed;
+}
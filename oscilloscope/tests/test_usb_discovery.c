@@ -0,0 +1,234 @@
+// file test_usb_discovery.c
+//
+// Пошук плат у підготовленому дереві sysfs (class/tty/<ім'я>/device -> .../1-N:1.0, атрибути
+// пристрою на рівень вище) з підробленим коренем /dev: фільтр VID:PID, порядок за серійним номером,
+// плата без вузла в /dev. Вузли плат — псевдотермінали, тож usb_device_service справді відкриває
+// порт і бачить від'єднання та повторне підключення (той самий шлях, інший номер пристрою).
+
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "main.h"
+#include "usb_discovery.h"
+#include "find_usb_device.h"
+#include "rs232.h"
+#include "test.h"
+
+static char root[64];
+static char sys_root[96];
+static char dev_root[96];
+static OscData osc;
+
+static void write_attr(const char *dir, const char *attr, const char *text)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", dir, attr);
+    FILE *f = fopen(path, "w");
+    if (!f) return;
+    fprintf(f, "%s\n", text);
+    fclose(f);
+}
+
+// Пристрій USB з інтерфейсом 1-devnum:1.0 і tty name на ньому
+static void add_board(const char *name, const char *vid, const char *pid, const char *serial, int devnum)
+{
+    char dev[192], iface[224], tty[192], link[224], num[16];
+    snprintf(dev, sizeof(dev), "%s/devices/1-%d", sys_root, devnum);
+    snprintf(iface, sizeof(iface), "%s/1-%d:1.0", dev, devnum);
+    mkdir(dev, 0755);
+    mkdir(iface, 0755);
+    write_attr(dev, "idVendor", vid);
+    write_attr(dev, "idProduct", pid);
+    if (serial) write_attr(dev, "serial", serial);
+    write_attr(dev, "busnum", "1");
+    snprintf(num, sizeof(num), "%d", devnum);
+    write_attr(dev, "devnum", num);
+
+    snprintf(tty, sizeof(tty), "%s/class/tty/%s", sys_root, name);
+    snprintf(link, sizeof(link), "%s/device", tty);
+    mkdir(tty, 0755);
+    if (symlink(iface, link) != 0) perror(link);
+}
+
+// tty зникає з sysfs разом із пристроєм
+static void remove_board(const char *name)
+{
+    char tty[192], link[224];
+    snprintf(tty, sizeof(tty), "%s/class/tty/%s", sys_root, name);
+    snprintf(link, sizeof(link), "%s/device", tty);
+    unlink(link);
+    rmdir(tty);
+}
+
+// Вузол /dev/<name>: посилання на підлеглий бік нового псевдотерміналу; повертає ведучий бік
+static int add_node(const char *name)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return -1;
+    char path[160];
+    snprintf(path, sizeof(path), "%s/%s", dev_root, name);
+    unlink(path);
+    if (symlink(ptsname(master), path) != 0) perror(path);
+    return master;
+}
+
+static void remove_node(const char *name)
+{
+    char path[160];
+    snprintf(path, sizeof(path), "%s/%s", dev_root, name);
+    unlink(path);
+}
+
+static int remove_entry(const char *path, const struct stat *st, int flag, struct FTW *ftw)
+{
+    (void)st; (void)flag; (void)ftw;
+    return remove(path);
+}
+
+// Подія hot-plug і один кадр застосунку
+static void service_event(void)
+{
+    osc.usb_watch.rescan = true;
+    usb_device_service(&osc);
+}
+
+static int test_scan(void)
+{
+    int failed = 0;
+    UsbWatch w;
+    UsbBoard boards[USB_MAX_BOARDS];
+
+    usb_watch_init(&w, sys_root, dev_root, 0, 0);
+    CHECK(w.netlink_fd < 0, "підготовлене дерево не слухає netlink");
+    int n = usb_scan(&w, boards, USB_MAX_BOARDS);
+    CHECK(n == 2, "знайдено %d плат, очікувано 2 (ttyACM1, ttyACM0)", n);
+    if (n == 2) {
+        CHECK(strcmp(boards[0].name, "ttyACM1") == 0 && strcmp(boards[0].serial, "A1") == 0,
+              "перша плата %s (%s), очікувано ttyACM1 (A1)", boards[0].name, boards[0].serial);
+        CHECK(strcmp(boards[1].name, "ttyACM0") == 0 && strcmp(boards[1].serial, "B2") == 0,
+              "друга плата %s (%s), очікувано ttyACM0 (B2)", boards[1].name, boards[1].serial);
+
+        char path[160];
+        snprintf(path, sizeof(path), "%s/ttyACM1", dev_root);
+        CHECK(strcmp(boards[0].path, path) == 0, "вузол %s, очікувано %s", boards[0].path, path);
+        snprintf(path, sizeof(path), "%s/bus/usb/001/002", dev_root);
+        CHECK(strcmp(boards[0].usbfs, path) == 0, "вузол usbfs %s, очікувано %s", boards[0].usbfs, path);
+    }
+
+    // Інший VID:PID — лише сторонній пристрій
+    usb_watch_init(&w, sys_root, dev_root, 0x1234, 0x5678);
+    n = usb_scan(&w, boards, USB_MAX_BOARDS);
+    CHECK(n == 1 && strcmp(boards[0].name, "ttyUSB0") == 0, "1234:5678: знайдено %d плат", n);
+
+    // Без подій підключена плата перевіряється за таймером
+    usb_watch_init(&w, sys_root, dev_root, 0, 0);
+    CHECK(usb_watch_poll(&w, 100.0, true), "перший перегляд одразу");
+    CHECK(!usb_watch_poll(&w, 100.0 + USB_RESCAN_S / 2, true), "перегляд раніше за USB_RESCAN_S");
+    CHECK(usb_watch_poll(&w, 100.0 + USB_RESCAN_S, true), "перегляд через USB_RESCAN_S");
+
+    char missing[128];
+    snprintf(missing, sizeof(missing), "%s/nothing", root);
+    usb_watch_init(&w, missing, dev_root, 0, 0);
+    CHECK(usb_scan(&w, boards, USB_MAX_BOARDS) == -1, "без sysfs — -1");
+    return failed;
+}
+
+static int test_hotplug(void)
+{
+    int failed = 0;
+    char path[160];
+    snprintf(path, sizeof(path), "%s/ttyACM1", dev_root);
+
+    // Лишається одна плата осцилографа
+    remove_board("ttyACM0");
+    remove_node("ttyACM0");
+
+    init_osc_data(&osc);
+    usb_watch_init(&osc.usb_watch, sys_root, dev_root, 0, 0);
+    find_usb_device(&osc);
+    CHECK(usb_device_connected(&osc), "плату не відкрито");
+    CHECK(strcmp(osc.usb_watch.port_path, path) == 0, "відкрито %s, очікувано %s", osc.usb_watch.port_path, path);
+    uint64_t node = osc.usb_watch.port_node;
+    CHECK(node != 0 && node == usb_node_id(path), "номер вузла не збережено");
+
+    service_event();
+    CHECK(usb_device_connected(&osc), "подія без змін розірвала з'єднання");
+
+    // Від'єднання: плата зникає з sysfs і /dev
+    remove_board("ttyACM1");
+    remove_node("ttyACM1");
+    service_event();
+    CHECK(!usb_device_connected(&osc), "від'єднання не помічено");
+    service_event();
+    CHECK(!usb_device_connected(&osc), "підключено відсутню плату");
+
+    // Повторне підключення: той самий шлях, новий пристрій
+    add_board("ttyACM1", "0483", "5740", "A1", 2);
+    int master = add_node("ttyACM1");
+    service_event();
+    CHECK(usb_device_connected(&osc), "повторне підключення не помічено");
+    CHECK(osc.usb_watch.port_node == usb_node_id(path) && osc.usb_watch.port_node != node,
+          "номер вузла після перепідключення не оновлено");
+    node = osc.usb_watch.port_node;
+
+    // Від'єднання й підключення між двома переглядами: у sysfs без змін, вузол інший
+    int replug = add_node("ttyACM1");
+    service_event();
+    CHECK(!usb_device_connected(&osc), "заміну вузла не помічено");
+    service_event();
+    CHECK(usb_device_connected(&osc) && osc.usb_watch.port_node == usb_node_id(path) && osc.usb_watch.port_node != node,
+          "плату з новим вузлом не відкрито");
+
+    usb_device_lost(&osc);
+    usb_watch_close(&osc.usb_watch);
+    if (master >= 0) close(master);
+    if (replug >= 0) close(replug);
+    return failed;
+}
+
+int test_usb_discovery(void)
+{
+    int failed = 0;
+    char dir[192];
+
+    snprintf(root, sizeof(root), "/tmp/osc_usb_XXXXXX");
+    if (!mkdtemp(root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(sys_root, sizeof(sys_root), "%s/sys", root);
+    snprintf(dev_root, sizeof(dev_root), "%s/dev", root);
+    mkdir(sys_root, 0755);
+    mkdir(dev_root, 0755);
+    snprintf(dir, sizeof(dir), "%s/devices", sys_root);
+    mkdir(dir, 0755);
+    snprintf(dir, sizeof(dir), "%s/class", sys_root);
+    mkdir(dir, 0755);
+    snprintf(dir, sizeof(dir), "%s/class/tty", sys_root);
+    mkdir(dir, 0755);
+
+    // Дві плати (порядок серійних номерів зворотний до імен), стороння плата, плата без вузла
+    // в /dev і віртуальний tty без пристрою
+    add_board("ttyACM0", "0483", "5740", "B2", 1);
+    add_board("ttyACM1", "0483", "5740", "A1", 2);
+    add_board("ttyUSB0", "1234", "5678", "X", 3);
+    add_board("ttyACM2", "0483", "5740", "A0", 4);
+    snprintf(dir, sizeof(dir), "%s/class/tty/ttyS0", sys_root);
+    mkdir(dir, 0755);
+    int nodes[3] = { add_node("ttyACM0"), add_node("ttyACM1"), add_node("ttyUSB0") };
+    CHECK(nodes[0] >= 0 && nodes[1] >= 0 && nodes[2] >= 0, "псевдотермінали недоступні");
+
+    if (!failed) failed += test_scan();
+    if (!failed) failed += test_hotplug();
+
+    for (int i = 0; i < 3; i++)
+        if (nodes[i] >= 0) close(nodes[i]);
+    nftw(root, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    return failed;
+}
@@ -1,5 +1,6 @@
 #include "DrawHorizontalScale.h"
 #include <stdio.h>
+#include <math.h>
 
 void DrawHorizontalScale(int channel, float scale, float offset_x, Rectangle area, RasterFont font, Color color)
 {
@@ -53,3 +54,58 @@ void DrawHorizontalScale(int channel, float scale, float offset_x, Rectangle are
     }
 }
 
+
+// Найменший крок 1-2-5, не менший за min_step
+static double time_step_125(double min_step)
+{
+    double decade = pow(10.0, floor(log10(min_step)));
+    if (decade >= min_step) return decade;
+    if (2.0 * decade >= min_step) return 2.0 * decade;
+    if (5.0 * decade >= min_step) return 5.0 * decade;
+    return 10.0 * decade;
+}
+
+static void format_time_label(char *buf, size_t size, double t, double step)
+{
+    const char *unit = "s";
+    double k = 1.0;
+    if (step < 1e-6) { unit = "ns"; k = 1e9; } // Еквівалентний час: мегасемпли за секунду
+    else if (step < 1e-3) { unit = "us"; k = 1e6; }
+    else if (step < 1.0) { unit = "ms"; k = 1e3; }
+    // Крок 1-2-5 у своїх одиницях цілий, окрім 0.5 на межі діапазону
+    double v = t * k;
+    if (fabs(v) < 0.5 * step * k) v = 0.0;
+    snprintf(buf, size, step * k < 1.0 ? "%.1f%s" : "%.0f%s", v, unit);
+}
+
+void DrawHorizontalTimeScale(float seconds_per_px, float zero_x, Rectangle area, RasterFont font, Color color)
+{
+    int spacing = 2;
+    int y_end = area.y + area.height;
+    float margin = font.glyph_height;
+    float x_min = area.x + margin;
+    float x_max = area.x + area.width - margin;
+
+    DrawLine(area.x, y_end, area.x + area.width, y_end, color);
+    if (seconds_per_px == 0.0f || !isfinite(seconds_per_px)) return;
+
+    // Мітка на кшталт "-150ms" — до 7 знаків, між мітками ще стільки ж
+    double px_per_s = 1.0 / fabs(seconds_per_px);
+    double step = time_step_125(font.glyph_width * 14.0 / px_per_s);
+    double t_left = (x_min - zero_x) * seconds_per_px;
+    double t_right = (x_max - zero_x) * seconds_per_px;
+    double t_min = fmin(t_left, t_right), t_max = fmax(t_left, t_right);
+
+    for (double t = ceil(t_min / step) * step; t <= t_max; t += step)
+    {
+        float x = zero_x + (float)(t / seconds_per_px);
+        if (x < x_min || x > x_max) continue;
+
+        char label[16];
+        format_time_label(label, sizeof(label), t, step);
+        int text_width = utf8_strlen(label) * font.glyph_width;
+
+        DrawLine(x, y_end, x, y_end - 10, color);
+        DrawTextScaled(font, x - text_width / 2, y_end - font.glyph_height - 15, label, spacing, 1, color);
+    }
+}
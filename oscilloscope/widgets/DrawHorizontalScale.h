@@ -9,4 +9,8 @@
 
 void DrawHorizontalScale(int channel, float scale, float offset_x, Rectangle area, RasterFont font, Color color);
 
+// Шкала часу: мітки з кроком 1-2-5 у с/мс/мкс відносно zero_x (точка тригера).
+// seconds_per_px < 0 — час зростає справа наліво (реверс)
+void DrawHorizontalTimeScale(float seconds_per_px, float zero_x, Rectangle area, RasterFont font, Color color);
+
 #endif // DRAWHORIZONTALSCALE_H
@@ -19,6 +19,7 @@ Cursor InitCursor(float startX, float topY, float width, float height, Color col
     cursor.isDragging = false;        // Спочатку не перетягується
     cursor.minValue = minValue;       // Мінімальне значення
     cursor.maxValue = maxValue;       // Максимальне значення
+    cursor.bound = false;             // Підписи в пікселях, доки власник не прив'яже курсор
 
     // Обчислення початкового значення курсора пропорційно позиції по X
     cursor.value = minValue + (maxValue - minValue) * ((startX) / GetScreenWidth());
@@ -201,6 +202,9 @@ void DrawCursorsAndDistance(Cursor *cursors, int count, RasterFont font, DragRec
         // Малюємо центральний прямокутник (ручку) у центрі лінії
         DrawRectangle(centerRect->x - centerRect->width / 2, centerRect->y - centerRect->height / 2, centerRect->width, centerRect->height, centerRect->color);
 
+        // Прив'язані курсори підписує власник (час і напруга замість пікселів)
+        if (cursorA.bound && cursorB.bound) return;
+
         // Формуємо текст відстані між курсорами у пікселях
         char distanceText[32];
         sprintf(distanceText, "%i px", (int)distance);
@@ -212,6 +216,8 @@ void DrawCursorsAndDistance(Cursor *cursors, int count, RasterFont font, DragRec
         DrawTextScaled(font, textPos.x, textPos.y, distanceText, spacing, 1, LIGHTGRAY);
     }
 
+    if (count >= 2 && cursors[0].bound && cursors[1].bound) return;
+
     // Вивід значень курсорів у правій верхній частині екрану
     Vector2 curPosA = {500, 10};
     DrawTextScaled(font, curPosA.x, curPosA.y, TextFormat("A:%i", cursors[0].value), spacing, 1, cursors[0].color);
@@ -219,3 +225,77 @@ void DrawCursorsAndDistance(Cursor *cursors, int count, RasterFont font, DragRec
     DrawTextScaled(font, curPosB.x, curPosB.y, TextFormat("B:%i", cursors[1].value), spacing, 1, cursors[1].color);
 }
 
+
+/*
+ * Ініціалізація горизонтального курсора.
+ */
+HCursor InitHCursor(float startY, float x, float width, float height, Color color) {
+    HCursor cursor;
+    cursor.y = startY;
+    cursor.x = x;
+    cursor.width = width;
+    cursor.height = height;
+    cursor.color = color;
+    cursor.isDragging = false;
+    cursor.min_Y = 0;
+    cursor.max_Y = GetScreenHeight();
+    return cursor;
+}
+
+static bool IsMouseOverHCursor(Vector2 mousePos, HCursor cursor) {
+    int Sticking = 2; // Розширення області прилипання по вертикалі
+    return (mousePos.x > cursor.x - cursor.width &&
+            mousePos.x < cursor.x + cursor.width &&
+            mousePos.y > cursor.y - cursor.height / 2 * Sticking &&
+            mousePos.y < cursor.y + cursor.height / 2 * Sticking);
+}
+
+/*
+ * Оновлює горизонтальні курсори: тягнеться лише один, за який взялися першим.
+ */
+void UpdateAndHandleHCursors(HCursor *cursors, int count, Vector2 mousePos, bool mouseButtonPressed, bool mouseButtonDown, bool mouseButtonReleased) {
+    for (int i = 0; i < count; ++i) {
+        HCursor *cursor = &cursors[i];
+
+        if (mouseButtonPressed && IsMouseOverHCursor(mousePos, *cursor)) {
+            cursor->isDragging = true;
+            break; // Ручки можуть перекриватися — беремо верхню
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        HCursor *cursor = &cursors[i];
+
+        if (cursor->isDragging && mouseButtonDown) {
+            cursor->y = mousePos.y;
+            if (cursor->y < cursor->min_Y) cursor->y = cursor->min_Y;
+            if (cursor->y > cursor->max_Y) cursor->y = cursor->max_Y;
+        }
+
+        if (mouseButtonReleased) {
+            cursor->isDragging = false;
+        }
+    }
+}
+
+/*
+ * Малює горизонтальні курсори пунктирною лінією з ручкою праворуч.
+ */
+void DrawHCursors(HCursor *cursors, int count, float left, float right) {
+    UpdateAndHandleHCursors(cursors, count, GetMousePosition(),
+                            IsMouseButtonPressed(MOUSE_LEFT_BUTTON),
+                            IsMouseButtonDown(MOUSE_LEFT_BUTTON),
+                            IsMouseButtonReleased(MOUSE_LEFT_BUTTON));
+
+    for (int i = 0; i < count; ++i) {
+        HCursor cursor = cursors[i];
+
+        // Пунктир: відрізки по 6 пікселів з проміжками по 4
+        for (float x = left; x < right; x += 10) {
+            float x2 = (x + 6 < right) ? x + 6 : right;
+            DrawLine(x, cursor.y, x2, cursor.y, cursor.color);
+        }
+
+        DrawRectangle(cursor.x - cursor.width / 2, cursor.y - cursor.height / 2, cursor.width, cursor.height, cursor.color);
+    }
+}
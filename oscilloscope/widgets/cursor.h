@@ -35,8 +35,25 @@ typedef struct {
     int min_X;     // Мінімальна позиція курсора (початкове обмеження)
     int max_X;     // Максимальна позиція курсора (обмеження по X)
 
+    bool bound;    // Курсор прив'язаний до семплів: підписи і відстань формує власник
+
 } Cursor;
 
+/*
+ * Структура для горизонтального курсора (рухомий маркер рівня по вертикалі)
+ */
+typedef struct {
+    float y;          // Позиція лінії курсора по вертикалі
+    float x;          // Позиція ручки по горизонталі (центр прямокутника)
+    float width;      // Ширина ручки
+    float height;     // Висота ручки
+    Color color;      // Колір курсора
+    bool isDragging;  // Чи перетягується курсор зараз
+
+    int min_Y;     // Мінімальна позиція по Y
+    int max_Y;     // Максимальна позиція по Y
+} HCursor;
+
 /*
  * Структура для центрального прямокутника (ручки), що розміщується на горизонтальній лінії між курсорами
  */
@@ -90,6 +107,27 @@ void UpdateAndHandleCursors(Cursor *cursors, int count, Vector2 mousePos, bool m
  */
 void DrawCursorsAndDistance(Cursor *cursors, int count, RasterFont font, DragRect *centerRect);
 
+/*
+ * Ініціалізує горизонтальний курсор.
+ *
+ * Параметри:
+ *   startY - початкова позиція лінії по Y
+ *   x - позиція ручки по X
+ *   width, height - розміри ручки
+ *   color - колір курсора
+ */
+HCursor InitHCursor(float startY, float x, float width, float height, Color color);
+
+/*
+ * Оновлює позиції горизонтальних курсорів при перетягуванні мишею за ручку.
+ */
+void UpdateAndHandleHCursors(HCursor *cursors, int count, Vector2 mousePos, bool mouseButtonPressed, bool mouseButtonDown, bool mouseButtonReleased);
+
+/*
+ * Обробляє ввід і малює горизонтальні курсори: пунктирну лінію від left до right і ручку.
+ */
+void DrawHCursors(HCursor *cursors, int count, float left, float right);
+
 /*
  * Перевіряє, чи знаходиться курсор миші над прямокутником.
  *
@@ -9,17 +9,16 @@
 #include "adc_read.h"
 #include "gpio_init.h"
 #include "SystemClock_Config.h"
-#include "generate_test_signals.h"
-
-#define HISTORY_SIZE 500
-#define CHANNELS_TO_SEND 2 // Наприклад, канал 2 та 3
-#define PACKET_SIZE 13 // 1 байт старт + 4 канали * 3 байти (ID + 2 байти даних)
+#include "dds.h"
+#include "timestamp.h"
+#include "ets.h"
+#include "control_protocol.h"
+#include "profiler.h"
+#include "stream.h"
 
 extern USBD_DescriptorsTypeDef FS_Desc;
 extern USBD_ClassTypeDef  USBD_CDC;
 extern USBD_HandleTypeDef hUsbDeviceFS;
-extern uint16_t new_rate;
-extern uint16_t test_signal;
 
 // void LL_mDelay(uint32_t Delay);
 void SystemClock_Config(void);
@@ -69,20 +68,6 @@ void USB_DEVICE_Init(void)
   USBD_Start(&hUsbDeviceFS);
 }
 
-void init_osc_data(OscData *oscData) {
-    static float channel_a_history[HISTORY_SIZE] = {0};
-    static float channel_b_history[HISTORY_SIZE] = {0};
-    static float channel_c_history[HISTORY_SIZE] = {0};
-    static float channel_d_history[HISTORY_SIZE] = {0};
-
-    float *channel_history[MAX_CHANNELS]; // Ініціалізуйте і виділіть пам'ять десь у init
-
-    oscData->channel_history[0] = channel_a_history;
-    oscData->channel_history[1] = channel_b_history;
-    oscData->channel_history[2] = channel_c_history;
-    oscData->channel_history[3] = channel_d_history;
-}
-
 int main(void)
 {
   /* USER CODE BEGIN 1 */
@@ -111,14 +96,8 @@ int main(void)
 
   LL_mDelay(100);
 
-  float *channel_history[MAX_CHANNELS]; // Ініціалізуйте і виділіть пам'ять десь у init
-  OscData oscData = { .channel_history = {channel_history[0], channel_history[1], channel_history[2], channel_history[3]} };
-  uint16_t usb_send_buf[CHANNELS_TO_SEND * HISTORY_SIZE];
-
   LL_mDelay(100);
 
-  init_osc_data(&oscData);
-
   // Ініціалізуємо піни для PA0, PA1, PA2, PA3
   Init_ADC_Pin(GPIOA, 0); // Налаштувати PA0 як аналоговий вхід
   Init_ADC_Pin(GPIOA, 1); // Налаштувати PA1 як аналоговий вхід
@@ -128,66 +107,18 @@ int main(void)
   // Ініціалізація ADC
   Init_ADC(ADC1);
 
-  // Читання значень з каналів PA0, PA1, PA2, PA3
-  uint16_t value_PA0; // PA0
-  uint16_t value_PA1; // PA1
-  uint16_t value_PA2; // PA2
-  uint16_t value_PA3; // PA3
-
-  uint8_t Temp_Buffer[APP_RX_DATA_SIZE] = { 0 };
-
-  // generate_test_signals4(&oscData, 500, 0.0f);
-  // generate_test_signals(&oscData, 500, 0.0f);
-  // generate_gaussian_envelope_signal(&oscData, 500, 0.0f);
-  generate_test_signals_extended(&oscData, 500, 0.0f);
+  // Тестовий сигнал рахується на льоту в кожному скані (замість таблиць 4 x 500 float у RAM)
+  dds_init();
+  timestamp_init();
+  ets_init();
+  profiler_init();
 
-  static uint16_t history_index = 0;
+  stream_init();
 
   while (1)
   {
-      uint8_t usb_send_buf[PACKET_SIZE];
-      usb_send_buf[0] = 0xAA; // Стартовий байт
-
-      if (test_signal)
-      {
-          // Відправляємо дані з генератора тестових сигналів
-          for (int ch = 0; ch < 4; ch++)
-          {
-              int16_t val = (int16_t)oscData.channel_history[ch][history_index];
-              usb_send_buf[1 + ch * 3] = ch; // ID каналу
-              usb_send_buf[1 + ch * 3 + 1] = val & 0xFF; // Молодший байт
-              usb_send_buf[1 + ch * 3 + 2] = (val >> 8); // Старший байт
-          }
-          history_index++;
-          if (history_index >= HISTORY_SIZE)
-              history_index = 0;
-      }
-      else
-      {
-          // Зчитуємо актуальні значення з АЦП
-          // Читання значень з каналів PA0, PA1, PA2, PA3
-          /* Інтерпретуємо дані як негативні якщо вони нижчі за 2048 (умовний нуль)
-          для центування даних на осцилоскопі */
-          value_PA0 = Read_ADC(ADC1,0) - 2048; // PA0
-          value_PA1 = Read_ADC(ADC1,1) - 2048; // PA1
-          value_PA2 = Read_ADC(ADC1,2) - 2048; // PA2
-          value_PA3 = Read_ADC(ADC1,3) - 2048; // PA2
-
-          int16_t adc_values[4] = {value_PA0, value_PA1, value_PA2, value_PA3};
-
-          for (int ch = 0; ch < 4; ch++)
-          {
-              usb_send_buf[1 + ch * 3] = ch; // ID каналу
-              usb_send_buf[1 + ch * 3 + 1] = adc_values[ch] & 0xFF; // Молодший байт
-              usb_send_buf[1 + ch * 3 + 2] = (adc_values[ch] >> 8); // Старший байт
-          }
-      }
-
-      CDC_Transmit_FS(usb_send_buf, PACKET_SIZE);
-
-      // Затримка або інтервал між відправками (можна замінити на таймер)
-      for (volatile uint32_t delay = 0; delay < new_rate * 1000; delay++)
-          __asm volatile ("nop");
+      // Пакети 0xB0 формує DMA: тоді прохід повертається після сну, без пакета
+      bool formed = stream_step();
 
       // Індикатори стану (за вашим кодом)
       if (new_rate % 10)
@@ -195,8 +126,11 @@ int main(void)
       else
           gpio_write_pin(GPIOC, 13, 1);
 
-      if (test_signal)
+      if (test_signal && formed)
           gpio_toggle_pin(GPIOC, 13);
+
+      if (led_on)
+          gpio_write_pin(GPIOC, 13, 0); // Увімкнено хостом (CTRL_PARAM_LED)
   }
 
 }
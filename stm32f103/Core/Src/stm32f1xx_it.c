@@ -22,6 +22,8 @@
 #include "stm32f1xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "profiler.h"
+#include "tx_ring.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -204,11 +206,14 @@ void SysTick_Handler(void)
 void USB_LP_CAN1_RX0_IRQHandler(void)
 {
   /* USER CODE BEGIN USB_LP_CAN1_RX0_IRQn 0 */
-
+  uint32_t profile_start = profiler_now();
+  uint32_t profile_istr = USB->ISTR; // Обробник скидає прапорці — для обліку вони потрібні до нього
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 0 */
   USBD_PCD_IRQHandler(&hpcd_USB_FS);
   /* USER CODE BEGIN USB_LP_CAN1_RX0_IRQn 1 */
-
+  // Наступний слот кільця: одразу після кінця попереднього передавання або за stream_hal_kick
+  tx_ring_service();
+  profiler_usb_irq(profile_start, profile_istr);
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 1 */
 }
 
@@ -71,3 +71,178 @@ uint16_t Read_ADC(ADC_TypeDef *ADCx, uint8_t channel) {
     return result;
 }
 
+
+// Результати скану: DMA переписує ADC_DR сюди після кожного перетворення
+static volatile uint16_t scan_buffer[4];
+static uint8_t scan_length;
+static uint8_t scan_channels_mask;
+
+// Передискретизація: усі перетворення 2^N сканів підряд
+static volatile uint16_t oversample_buffer[(1 << ADC_OVERSAMPLE_MAX) * 4];
+
+// === Режим сканування (лише ADC1: DMA1 канал 1) ===
+// Довжина черги SQR1.L і порядок каналів SQR3 — за маскою: АЦП перетворює лише увімкнені
+// канали, і скан коротшає пропорційно їх кількості
+uint8_t ADC_ConfigScan(ADC_TypeDef *ADCx, uint8_t mask) {
+    uint32_t sqr3 = 0;
+    uint8_t count = 0;
+
+    for (uint8_t channel = 0; channel < 4; channel++) {
+        if (!(mask & (1 << channel))) continue;
+        sqr3 |= (uint32_t)channel << (5 * count);
+        ADCx->SMPR2 = (ADCx->SMPR2 & ~(0b111 << (channel * 3))) | (0b101 << (channel * 3)); // 55.5 циклів, як Read_ADC
+        count++;
+    }
+    if (count == 0) return 0;
+
+    ADCx->SQR3 = sqr3;
+    ADCx->SQR1 = (ADCx->SQR1 & ~ADC_SQR1_L) | ((uint32_t)(count - 1) << ADC_SQR1_L_Pos);
+    ADCx->CR1 |= ADC_CR1_SCAN; // Уся черга одним запуском
+    ADCx->CR2 |= ADC_CR2_DMA;  // Без DMA в ADC_DR лишився б тільки останній канал черги
+
+    RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+    DMA1_Channel1->CCR = 0;
+    DMA1_Channel1->CPAR = (uint32_t)&ADCx->DR;
+    DMA1_Channel1->CMAR = (uint32_t)scan_buffer;
+    DMA1_Channel1->CCR = DMA_CCR_MINC | DMA_CCR_PSIZE_0 | DMA_CCR_MSIZE_0; // 16 біт, периферія -> пам'ять
+
+    scan_length = count;
+    scan_channels_mask = mask;
+    return count;
+}
+
+// === Один скан усієї черги ===
+void ADC_ReadScan(ADC_TypeDef *ADCx, uint16_t *out) {
+    DMA1_Channel1->CCR &= ~DMA_CCR_EN;
+    DMA1_Channel1->CNDTR = scan_length;
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+    DMA1_Channel1->CCR |= DMA_CCR_EN;
+
+    // Запуск (ADON вже встановлено: повторний запис починає перетворення)
+    ADCx->CR2 |= ADC_CR2_ADON;
+
+    // Чекати, поки DMA забере останній канал черги
+    while (!(DMA1->ISR & DMA_ISR_TCIF1));
+
+    for (uint8_t i = 0; i < scan_length; i++)
+        out[i] = scan_buffer[i];
+}
+
+// === Час вибірки каналів скану для передискретизації ===
+void ADC_ConfigOversample(ADC_TypeDef *ADCx, uint8_t log2_ratio) {
+    // 1.5 цикли: 14 тактів ADCCLK (12 МГц) на перетворення, ~860 тис. перетворень/с — шум
+    // від короткої вибірки усереднюється; без передискретизації — 55.5 циклів, як Read_ADC
+    uint32_t smp = log2_ratio ? 0b000 : 0b101;
+    for (uint8_t channel = 0; channel < 4; channel++) {
+        if (!(scan_channels_mask & (1 << channel))) continue;
+        ADCx->SMPR2 = (ADCx->SMPR2 & ~(0b111 << (channel * 3))) | (smp << (channel * 3));
+    }
+}
+
+// === 2^log2_ratio сканів з максимальною швидкістю і сума по каналу (boxcar) ===
+void ADC_ReadOversampled(ADC_TypeDef *ADCx, uint8_t log2_ratio, int16_t *out) {
+    uint16_t count = (uint16_t)(scan_length << log2_ratio);
+    uint32_t sums[4] = {0};
+
+    DMA1_Channel1->CCR &= ~DMA_CCR_EN;
+    DMA1_Channel1->CMAR = (uint32_t)oversample_buffer;
+    DMA1_Channel1->CNDTR = count;
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+    DMA1_Channel1->CCR |= DMA_CCR_EN;
+
+    // Безперервний режим: наступний скан починається одразу після попереднього, без ядра
+    ADCx->CR2 |= ADC_CR2_CONT;
+    ADCx->CR2 |= ADC_CR2_ADON;
+
+    // Сума рахується, поки DMA дописує буфер: CNDTR показує, скільки перетворень уже в пам'яті
+    uint16_t done = 0;
+    uint8_t channel = 0;
+    while (done < count) {
+        uint16_t ready = count - (uint16_t)DMA1_Channel1->CNDTR;
+        while (done < ready) {
+            sums[channel] += oversample_buffer[done++];
+            if (++channel == scan_length) channel = 0;
+        }
+    }
+
+    // Скан, що вже почався, обривається вимкненням АЦП: інакше його перетворення потрапили б
+    // у наступний запуск DMA зі зсувом каналів. Після ввімкнення — стабілізація (tSTAB ~1 мкс)
+    ADCx->CR2 &= ~(ADC_CR2_CONT | ADC_CR2_ADON);
+    DMA1_Channel1->CCR &= ~DMA_CCR_EN;
+    DMA1_Channel1->CMAR = (uint32_t)scan_buffer;
+    ADCx->CR2 |= ADC_CR2_ADON;
+    for (volatile uint32_t i = 0; i < 100; i++);
+
+    // Сума 2^N відліків — 12 + N біт; лишається 12 + N/2 (шум зменшується в 2^(N/2) разів)
+    uint8_t shift = log2_ratio - ADC_OVERSAMPLE_EXTRA_BITS(log2_ratio);
+    for (uint8_t i = 0; i < scan_length; i++)
+        out[i] = (int16_t)(((int32_t)sums[i] - ((int32_t)2048 << log2_ratio)) >> shift);
+}
+
+// === Захоплення за тригером: DMA у буфер передискретизації, АЦП чекає подій extsel ===
+static uint16_t triggered_count;
+
+void ADC_StartTriggered(ADC_TypeDef *ADCx, uint32_t extsel, uint8_t scans) {
+    triggered_count = (uint16_t)(scan_length * scans);
+
+    DMA1_Channel1->CCR &= ~DMA_CCR_EN;
+    DMA1_Channel1->CMAR = (uint32_t)oversample_buffer;
+    DMA1_Channel1->CNDTR = triggered_count;
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+    DMA1_Channel1->CCR |= DMA_CCR_EN;
+
+    ADCx->CR2 = (ADCx->CR2 & ~ADC_CR2_EXTSEL) | extsel | ADC_CR2_EXTTRIG;
+}
+
+bool ADC_FinishTriggered(ADC_TypeDef *ADCx, uint32_t timeout_cycles, int16_t *out) {
+    uint32_t start = DWT->CYCCNT;
+    bool done;
+    while (!(done = (DMA1->ISR & DMA_ISR_TCIF1) != 0) && DWT->CYCCNT - start < timeout_cycles);
+
+    // Зовнішній запуск вимикається; недочекане захоплення обривається, як у ADC_ReadOversampled,
+    // щоб його перетворення не потрапили в наступний скан
+    ADCx->CR2 &= ~(ADC_CR2_EXTTRIG | ADC_CR2_EXTSEL);
+    if (!done) {
+        ADCx->CR2 &= ~ADC_CR2_ADON;
+        ADCx->CR2 |= ADC_CR2_ADON;
+        for (volatile uint32_t i = 0; i < 100; i++);
+    }
+    DMA1_Channel1->CCR &= ~DMA_CCR_EN;
+    DMA1_Channel1->CMAR = (uint32_t)scan_buffer;
+    if (!done) return false;
+
+    for (uint16_t i = 0; i < triggered_count; i++)
+        out[i] = (int16_t)(oversample_buffer[i] - 2048);
+    return true;
+}
+
+// === Потік сканів за подією таймера: DMA з перериванням у кінці кожного буфера ===
+void ADC_StartStream(ADC_TypeDef *ADCx, uint32_t extsel, uint16_t *buffer, uint16_t count) {
+    DMA1_Channel1->CCR &= ~DMA_CCR_EN;
+    DMA1_Channel1->CMAR = (uint32_t)buffer;
+    DMA1_Channel1->CNDTR = count;
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+    DMA1_Channel1->CCR |= DMA_CCR_TCIE | DMA_CCR_EN;
+
+    ADCx->CR2 = (ADCx->CR2 & ~ADC_CR2_EXTSEL) | extsel | ADC_CR2_EXTTRIG;
+}
+
+void ADC_StreamNext(uint16_t *buffer, uint16_t count) {
+    // Адресу каналу DMA змінює лише вимкненим. Наступна подія таймера — не раніше ніж за період
+    // скану від попередньої, тож перше перетворення ще не закінчилось
+    DMA1_Channel1->CCR &= ~DMA_CCR_EN;
+    DMA1_Channel1->CMAR = (uint32_t)buffer;
+    DMA1_Channel1->CNDTR = count;
+    DMA1_Channel1->CCR |= DMA_CCR_EN;
+}
+
+void ADC_StopStream(ADC_TypeDef *ADCx) {
+    // Як в ADC_FinishTriggered: скан, що почався, обривається, щоб не зсунути наступний
+    ADCx->CR2 &= ~(ADC_CR2_EXTTRIG | ADC_CR2_EXTSEL);
+    ADCx->CR2 &= ~ADC_CR2_ADON;
+    DMA1_Channel1->CCR &= ~(DMA_CCR_EN | DMA_CCR_TCIE);
+    DMA1_Channel1->CMAR = (uint32_t)scan_buffer;
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+    ADCx->CR2 |= ADC_CR2_ADON;
+    for (volatile uint32_t i = 0; i < 100; i++);
+}
@@ -7,8 +7,13 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include "stm32f103xb.h"
 
+#define ADC_OVERSAMPLE_MAX 8 // Найбільше 2^8 = 256 сканів на семпл
+// Додаткових біт після усереднення 2^N сканів: кожні 4x — один біт (ефективні, не лише формальні)
+#define ADC_OVERSAMPLE_EXTRA_BITS(log2_ratio) ((log2_ratio) / 2)
+
 // === Функція для ініціалізації пінів для аналогових входів ===
 void Init_ADC_Pin(GPIO_TypeDef *GPIOx, uint32_t pin);
 // === Функція для запуску калібрування ADC ===
@@ -17,6 +22,30 @@ void ADC_StartCalibration(ADC_TypeDef *ADCx);
 void Init_ADC(ADC_TypeDef *ADCx);
 // === Функція для отримання значення з ADC ===
 uint16_t Read_ADC(ADC_TypeDef *ADCx, uint8_t channel);
+// === Режим сканування: канали 0..3 з маски одним запуском, результати через DMA1 канал 1 ===
+// Повертає кількість каналів у скані
+uint8_t ADC_ConfigScan(ADC_TypeDef *ADCx, uint8_t mask);
+// === Один скан: значення каналів маски за зростанням номера в out ===
+void ADC_ReadScan(ADC_TypeDef *ADCx, uint16_t *out);
+// === Час вибірки каналів скану: 0 — звичайний, інакше найкоротший (після ADC_ConfigScan) ===
+void ADC_ConfigOversample(ADC_TypeDef *ADCx, uint8_t log2_ratio);
+// === Висока роздільність: 2^log2_ratio сканів підряд (DMA, безперервний режим), сума по каналу,
+// зсув до 12 + ADC_OVERSAMPLE_EXTRA_BITS біт. out — значення відносно середини шкали (2048 << біти) ===
+void ADC_ReadOversampled(ADC_TypeDef *ADCx, uint8_t log2_ratio, int16_t *out);
+// === Захоплення за подією таймера: кожна подія extsel (ADC_CR2_EXTSEL) запускає скан черги,
+// scans сканів через DMA. Джерело подій запускати після ADC_StartTriggered ===
+void ADC_StartTriggered(ADC_TypeDef *ADCx, uint32_t extsel, uint8_t scans);
+// === Чекає останній скан не довше timeout_cycles тактів DWT CYCCNT і повертає АЦП до
+// програмного запуску. out — значення відносно середини шкали; false — сканів не дочекались ===
+bool ADC_FinishTriggered(ADC_TypeDef *ADCx, uint32_t timeout_cycles, int16_t *out);
+// === Потік без ядра: кожна подія extsel запускає скан черги, DMA пише сирі відліки (0..4095) у
+// buffer і після count перетворень викликає DMA1_Channel1_IRQHandler (TC). Джерело подій
+// запускати після ADC_StartStream ===
+void ADC_StartStream(ADC_TypeDef *ADCx, uint32_t extsel, uint16_t *buffer, uint16_t count);
+// === З переривання DMA: наступний буфер потоку ===
+void ADC_StreamNext(uint16_t *buffer, uint16_t count);
+// === Зупиняє потік і повертає АЦП до програмного запуску (джерело подій зупинити раніше) ===
+void ADC_StopStream(ADC_TypeDef *ADCx);
 
 #ifdef __cplusplus
 }
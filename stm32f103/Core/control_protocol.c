@@ -0,0 +1,215 @@
+// file control_protocol.c
+#include <string.h>
+#include "control_protocol.h"
+#include "adc_read.h"
+#include "dds.h"
+#include "profiler.h"
+
+#define CTRL_RX_MASK (CTRL_RX_SIZE - 1)
+
+uint16_t new_rate;
+uint16_t test_signal;
+uint16_t trigger_edge;
+uint16_t led_on;
+uint16_t channel_mask = 0x0F;
+uint16_t compression;
+uint16_t oversample;
+uint16_t timestamps;
+uint16_t ets_steps;
+// Як тестова таблиця до генератора: гармоніки, прямокутник, пилка, імпульси з шумом
+uint16_t test_wave[CTRL_TEST_CHANNELS] = { DDS_WAVE_SINE, DDS_WAVE_SQUARE, DDS_WAVE_SAW, DDS_WAVE_PULSE };
+uint16_t test_freq[CTRL_TEST_CHANNELS] = { 100, 50, 20, 10 };
+uint16_t test_amplitude[CTRL_TEST_CHANNELS] = { 1000, 800, 600, 500 };
+uint16_t test_noise[CTRL_TEST_CHANNELS] = { 0, 0, 0, 50 };
+
+// Кільце прийому: голову рухає переривання USB, хвіст — основний цикл
+static volatile uint8_t rx_ring[CTRL_RX_SIZE];
+static volatile uint16_t rx_head;
+static volatile uint16_t rx_tail;
+
+static uint8_t frame[CTRL_FRAME_MAX];
+static uint16_t frame_len;
+static uint8_t reply[CTRL_FRAME_MAX];
+static uint16_t reply_len;
+
+typedef struct {
+    uint16_t *value;
+    uint16_t min;
+    uint16_t max;
+} ParamEntry;
+
+#define TEST_CHANNEL_PARAMS(ch)                                                         \
+    [CTRL_PARAM_TEST_WAVE + (ch)]      = { &test_wave[ch], 0, DDS_WAVE_COUNT - 1 },       \
+    [CTRL_PARAM_TEST_FREQ + (ch)]      = { &test_freq[ch], 0, DDS_FREQ_MAX },             \
+    [CTRL_PARAM_TEST_AMPLITUDE + (ch)] = { &test_amplitude[ch], 0, DDS_AMPLITUDE_MAX },   \
+    [CTRL_PARAM_TEST_NOISE + (ch)]     = { &test_noise[ch], 0, DDS_AMPLITUDE_MAX }
+
+static const ParamEntry params[CTRL_PARAM_COUNT] = {
+    [CTRL_PARAM_RATE]         = { &new_rate, 0, 1000 },
+    [CTRL_PARAM_TEST_SIGNAL]  = { &test_signal, 0, 1 },
+    [CTRL_PARAM_TRIGGER_EDGE] = { &trigger_edge, 0, 2 },
+    [CTRL_PARAM_LED]          = { &led_on, 0, 1 },
+    [CTRL_PARAM_CHANNEL_MASK] = { &channel_mask, 1, 0x0F }, // Хоча б один канал
+    [CTRL_PARAM_COMPRESSION]  = { &compression, 0, 1 },
+    [CTRL_PARAM_OVERSAMPLE]   = { &oversample, 0, ADC_OVERSAMPLE_MAX }, // x1 .. x256
+    TEST_CHANNEL_PARAMS(0),
+    TEST_CHANNEL_PARAMS(1),
+    TEST_CHANNEL_PARAMS(2),
+    TEST_CHANNEL_PARAMS(3),
+    [CTRL_PARAM_TIMESTAMPS]   = { &timestamps, 0, 1 },
+    [CTRL_PARAM_ETS_STEPS]    = { &ets_steps, 0, CTRL_ETS_STEPS_MAX },
+};
+
+void control_rx_push(const uint8_t *data, uint32_t length)
+{
+    uint16_t head = rx_head;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        uint16_t next = (head + 1) & CTRL_RX_MASK;
+        if (next == rx_tail)
+        {
+            // Решта кадру пропадає: хост не отримає відповіді й повторить запит
+            profiler_count(CTRL_STAT_RX_OVERFLOWS, length - i);
+            break;
+        }
+        rx_ring[head] = data[i];
+        head = next;
+    }
+    rx_head = head;
+}
+
+static uint16_t crc16(const uint8_t *buf, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)buf[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+static void put_reply(uint8_t id, uint8_t op, const uint8_t *payload, uint8_t len)
+{
+    reply[0] = CTRL_START;
+    reply[1] = len;
+    reply[2] = id;
+    reply[3] = op;
+    memcpy(reply + CTRL_HEADER, payload, len);
+    uint16_t crc = crc16(reply + 1, CTRL_HEADER - 1 + len);
+    reply[CTRL_HEADER + len] = crc & 0xFF;
+    reply[CTRL_HEADER + len + 1] = crc >> 8;
+    reply_len = CTRL_HEADER + len + 2;
+}
+
+static void nak(uint8_t id, uint8_t op, uint8_t error)
+{
+    uint8_t payload[2] = { op, error };
+    put_reply(id, CTRL_OP_NAK, payload, 2);
+}
+
+// ACK з параметром і значенням, що діє після запиту
+static void ack_param(uint8_t id, uint8_t op, uint8_t param)
+{
+    uint16_t value = *params[param].value;
+    uint8_t payload[6] = { op, param, value & 0xFF, value >> 8, 0, 0 };
+    put_reply(id, CTRL_OP_ACK, payload, 6);
+}
+
+static void handle_frame(void)
+{
+    uint8_t len = frame[1], id = frame[2], op = frame[3];
+    const uint8_t *payload = frame + CTRL_HEADER;
+    uint16_t crc = frame[CTRL_HEADER + len] | (frame[CTRL_HEADER + len + 1] << 8);
+
+    if (crc16(frame + 1, CTRL_HEADER - 1 + len) != crc)
+    {
+        nak(id, op, CTRL_ERR_CRC);
+        return;
+    }
+
+    if (op == CTRL_OP_PING)
+    {
+        put_reply(id, CTRL_OP_ACK, &op, 1);
+        return;
+    }
+    if (op != CTRL_OP_GET && op != CTRL_OP_SET && op != CTRL_OP_STAT)
+    {
+        nak(id, op, CTRL_ERR_OPCODE);
+        return;
+    }
+    if (len != (op == CTRL_OP_SET ? 5 : 1))
+    {
+        nak(id, op, CTRL_ERR_LENGTH);
+        return;
+    }
+
+    uint8_t param = payload[0];
+    if (op == CTRL_OP_STAT)
+    {
+        if (param >= CTRL_STAT_COUNT)
+        {
+            nak(id, op, CTRL_ERR_PARAM);
+            return;
+        }
+        uint32_t value = profiler_stat(param);
+        uint8_t reply_payload[6] = { op, param, value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, value >> 24 };
+        put_reply(id, CTRL_OP_ACK, reply_payload, 6);
+        return;
+    }
+    if (param >= CTRL_PARAM_COUNT)
+    {
+        nak(id, op, CTRL_ERR_PARAM);
+        return;
+    }
+
+    if (op == CTRL_OP_SET)
+    {
+        int32_t value = (int32_t)((uint32_t)payload[1] | ((uint32_t)payload[2] << 8) |
+                                  ((uint32_t)payload[3] << 16) | ((uint32_t)payload[4] << 24));
+        if (value < params[param].min || value > params[param].max)
+        {
+            nak(id, op, CTRL_ERR_RANGE);
+            return;
+        }
+        *params[param].value = (uint16_t)value;
+    }
+    ack_param(id, op, param);
+}
+
+void control_poll(void)
+{
+    while (reply_len == 0 && rx_tail != rx_head)
+    {
+        uint8_t byte = rx_ring[rx_tail];
+        rx_tail = (rx_tail + 1) & CTRL_RX_MASK;
+
+        if (frame_len == 0 && byte != CTRL_START)
+            continue; // Пошук початку кадру
+        frame[frame_len++] = byte;
+        if (frame_len < 2)
+            continue;
+        if (frame[1] > CTRL_PAYLOAD_MAX)
+        {
+            frame_len = 0;
+            continue;
+        }
+        if (frame_len == CTRL_HEADER + frame[1] + 2)
+        {
+            handle_frame();
+            frame_len = 0;
+        }
+    }
+}
+
+uint16_t control_reply(uint8_t *out)
+{
+    memcpy(out, reply, reply_len);
+    return reply_len;
+}
+
+void control_reply_sent(void)
+{
+    reply_len = 0;
+}
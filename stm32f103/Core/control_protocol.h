@@ -0,0 +1,114 @@
+// file control_protocol.h
+
+#ifndef CONTROL_PROTOCOL_H
+#define CONTROL_PROTOCOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Кадр керування (той самий, що osc/control_protocol.h хоста):
+//   START LEN ID OP payload[LEN] CRC16 (CRC-16/CCITT-FALSE від LEN до кінця payload, молодший байт першим)
+#define CTRL_START 0xAC
+#define CTRL_HEADER 4
+#define CTRL_PAYLOAD_MAX 8
+#define CTRL_FRAME_MAX (CTRL_HEADER + CTRL_PAYLOAD_MAX + 2)
+
+#define CTRL_OP_PING 0x01
+#define CTRL_OP_GET  0x02 // [param]
+#define CTRL_OP_SET  0x03 // [param, value int32 LE]
+#define CTRL_OP_STAT 0x04 // [stat] — лічильник профілю (profiler.h)
+#define CTRL_OP_ACK  0x80 // [op] + для GET/SET/STAT: [param або stat, value int32 LE]
+#define CTRL_OP_NAK  0x81 // [op, помилка]
+
+#define CTRL_ERR_CRC    1
+#define CTRL_ERR_OPCODE 2
+#define CTRL_ERR_LENGTH 3
+#define CTRL_ERR_PARAM  4
+#define CTRL_ERR_RANGE  5
+
+#define CTRL_PARAM_RATE         0 // new_rate: затримка N*1000 ітерацій nop між пакетами
+#define CTRL_PARAM_TEST_SIGNAL  1 // test_signal: 1 — генератор тестового сигналу (dds.h) замість АЦП
+#define CTRL_PARAM_TRIGGER_EDGE 2 // trigger_edge: фронт тригера захоплень ets_steps (1 — спадаючий, інакше зростаючий)
+#define CTRL_PARAM_LED          3 // led_on: світлодіод PC13 замість індикації стану
+#define CTRL_PARAM_CHANNEL_MASK 4 // channel_mask: канали PA0..PA3 у скані АЦП і пакеті 0xAD, 1..0x0F
+#define CTRL_PARAM_COMPRESSION  5 // compression: 1 — блоки 0xAE (дельта + varint) замість пакетів 0xAD
+#define CTRL_PARAM_OVERSAMPLE   6 // oversample: N — 2^N сканів АЦП на семпл (висока роздільність), 0 — вимкнено
+// Тестовий сигнал, по параметру на канал 0..3 (номер = перший + канал)
+#define CTRL_PARAM_TEST_WAVE       7 // test_wave[ch]: форма, DdsWave
+#define CTRL_PARAM_TEST_FREQ      11 // test_freq[ch]: частота, 0.1 Гц
+#define CTRL_PARAM_TEST_AMPLITUDE 15 // test_amplitude[ch]: пік, відліки АЦП
+#define CTRL_PARAM_TEST_NOISE     19 // test_noise[ch]: пік рівномірного шуму, відліки АЦП
+#define CTRL_PARAM_TIMESTAMPS     23 // timestamps: 1 — мітка часу TIM2 (мкс) у кожному пакеті 0xAD/0xAE
+#define CTRL_PARAM_ETS_STEPS      24 // ets_steps: M > 1 — захоплення 0xAF від фронту в еквівалентному часі (ets.h), 0/1 — вимкнено
+#define CTRL_PARAM_COUNT          25
+
+#define CTRL_ETS_STEPS_MAX 64
+
+// Лічильники профілю (CTRL_OP_STAT) за останнє завершене вікно PROFILER_WINDOW_CYCLES.
+// Запит стату 0 фіксує знімок вікна: решта статів читається з того самого знімка
+#define CTRL_STAT_WINDOW        0 // Номер вікна
+#define CTRL_STAT_WINDOW_CYCLES 1 // Тривалість вікна, такти
+#define CTRL_STAT_SCANS         2 // Скани в сформованих пакетах
+#define CTRL_STAT_PACKETS       3 // Сформовані пакети
+#define CTRL_STAT_TX_BUSY       4 // Пакети, не передані: кільце передавання повне (tx_ring.h)
+#define CTRL_STAT_RX_OVERFLOWS  5 // Байти запитів, що не вмістились у кільце прийому
+#define CTRL_STAT_PMA_OVERRUNS  6 // ISTR.PMAOVR: ядро USB не встигло до пам'яті пакетів
+#define CTRL_STAT_USB_ERRORS    7 // ISTR.ERR: помилки на шині
+#define CTRL_STAT_SECTIONS      8 // Далі по CTRL_PROF_FIELDS статів на ділянку
+// Ділянки
+#define CTRL_PROF_ACQUIRE     0 // Скани АЦП, генератора чи захоплення ETS
+#define CTRL_PROF_PACE        1 // Затримка new_rate між сканами; у потоці DMA — сон ядра (WFI)
+#define CTRL_PROF_ENCODE      2 // Заголовок і значення пакета; у потоці DMA — переривання DMA
+#define CTRL_PROF_TRANSMIT    3 // Пакет у кільце передавання (tx_ring_commit)
+#define CTRL_PROF_CONTROL     4 // control_poll
+#define CTRL_PROF_USB_IRQ     5 // Переривання USB
+#define CTRL_PROF_USB_LATENCY 6 // Запізнення обробки SOF понад період 1 мс
+#define CTRL_PROF_SECTIONS    7
+// Поля ділянки: сума тактів, кількість, найдовша і гістограма тривалостей
+#define CTRL_PROF_CYCLES  0
+#define CTRL_PROF_COUNT   1
+#define CTRL_PROF_MAX     2
+#define CTRL_PROF_HIST    3
+#define CTRL_PROF_BUCKETS 6       // < 256 тактів, далі межі x4, останній — від 64K тактів
+#define CTRL_PROF_FIELDS (CTRL_PROF_HIST + CTRL_PROF_BUCKETS)
+#define CTRL_STAT_COUNT (CTRL_STAT_SECTIONS + CTRL_PROF_SECTIONS * CTRL_PROF_FIELDS)
+
+#define CTRL_TEST_CHANNELS 4
+
+#define CTRL_RX_SIZE 256 // Кільце прийому (степінь двійки)
+
+// Параметри збору даних (змінюються лише в control_poll, тобто в основному циклі)
+extern uint16_t new_rate;
+extern uint16_t test_signal;
+extern uint16_t trigger_edge;
+extern uint16_t led_on;
+extern uint16_t channel_mask;
+extern uint16_t compression;
+extern uint16_t oversample;
+extern uint16_t timestamps;
+extern uint16_t ets_steps;
+extern uint16_t test_wave[CTRL_TEST_CHANNELS];
+extern uint16_t test_freq[CTRL_TEST_CHANNELS];
+extern uint16_t test_amplitude[CTRL_TEST_CHANNELS];
+extern uint16_t test_noise[CTRL_TEST_CHANNELS];
+
+// З переривання USB: лише копіює байти в кільце, розбір — у control_poll
+void control_rx_push(const uint8_t *data, uint32_t length);
+
+// З основного циклу: розбирає прийняті кадри, застосовує параметри, готує відповідь.
+// Поки відповідь не надіслано, нові запити чекають у кільці.
+void control_poll(void);
+
+// Готова відповідь (копіюється в out, до CTRL_FRAME_MAX байтів); 0 — немає
+uint16_t control_reply(uint8_t *out);
+// Відповідь передано разом з пакетом семплів
+void control_reply_sent(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTROL_PROTOCOL_H */
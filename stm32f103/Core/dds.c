@@ -0,0 +1,187 @@
+// file dds.c
+#include "dds.h"
+#include "control_protocol.h"
+#include "stm32f103xb.h"
+
+#define DDS_FRAC_BITS (32 - DDS_TABLE_BITS)
+#define DDS_PULSE_WIDTH (1u << 29) // 1/8 періоду
+
+// sin(2*pi*i/256) у Q15; остання точка повторює першу для інтерполяції
+static const int16_t sine_q15[(1 << DDS_TABLE_BITS) + 1] = {
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602,
+    6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+    12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+    18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+    23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+    27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+    32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+    32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285,
+    32137, 31971, 31785, 31580, 31356, 31113, 30852, 30571,
+    30273, 29956, 29621, 29268, 28898, 28510, 28105, 27683,
+    27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731,
+    23170, 22594, 22005, 21403, 20787, 20159, 19519, 18868,
+    18204, 17530, 16846, 16151, 15446, 14732, 14010, 13279,
+    12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179,
+    6393, 5602, 4808, 4011, 3212, 2410, 1608, 804,
+    0, -804, -1608, -2410, -3212, -4011, -4808, -5602,
+    -6393, -7179, -7962, -8739, -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
+    -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+    -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+    -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+    -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+    -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+    -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+    -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+    -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
+    -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278, -9512, -8739, -7962, -7179,
+    -6393, -5602, -4808, -4011, -3212, -2410, -1608, -804,
+    0,
+};
+
+typedef struct
+{
+    uint32_t phase;
+    uint32_t tuning;    // Крок фази за такт, Q8
+    uint16_t freq;      // test_freq, для якого пораховано tuning
+} DdsChannel;
+
+static DdsChannel channels[CTRL_TEST_CHANNELS];
+static uint32_t last_cycles;
+static uint32_t noise_state = 0x12345678;
+
+void dds_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    last_cycles = 0;
+    for (uint8_t ch = 0; ch < CTRL_TEST_CHANNELS; ch++)
+    {
+        channels[ch].phase = 0;
+        channels[ch].freq = 0;
+        channels[ch].tuning = 0;
+    }
+}
+
+// Ділення 64-бітне (бібліотечне), тому лише при зміні частоти
+static uint32_t dds_tuning(uint16_t freq_dhz)
+{
+    return (uint32_t)(((uint64_t)freq_dhz << (32 + DDS_TUNING_SHIFT)) / (DDS_CLOCK_HZ * 10ull));
+}
+
+// xorshift32: рівномірний шум без множень
+static uint32_t noise_next(void)
+{
+    uint32_t x = noise_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return noise_state = x;
+}
+
+// Форма сигналу за фазою, Q15
+static int32_t dds_wave(uint8_t wave, uint32_t phase)
+{
+    switch (wave)
+    {
+    case DDS_WAVE_SINE:
+    {
+        uint32_t i = phase >> DDS_FRAC_BITS;
+        int32_t frac = (int32_t)((phase >> (DDS_FRAC_BITS - 15)) & 0x7FFF);
+        int32_t a = sine_q15[i];
+        return a + (((sine_q15[i + 1] - a) * frac) >> 15);
+    }
+    case DDS_WAVE_SQUARE:
+        return phase < 0x80000000u ? 32767 : -32767;
+    case DDS_WAVE_TRIANGLE:
+    {
+        int32_t p = (int32_t)(phase >> 16);
+        return (p < 0x8000 ? 2 * p : 2 * (0xFFFF - p)) - 0x7FFF;
+    }
+    case DDS_WAVE_SAW:
+        return (int32_t)(phase >> 16) - 0x8000;
+    case DDS_WAVE_PULSE:
+        return phase < DDS_PULSE_WIDTH ? 32767 : -32767;
+    default:
+        return 32767;
+    }
+}
+
+// Фази всіх каналів — на мить at
+static void dds_advance(uint32_t at)
+{
+    uint32_t elapsed = at - last_cycles; // Переповнення CYCCNT (~60 с) віднімання переживає
+    last_cycles = at;
+
+    for (uint8_t ch = 0; ch < CTRL_TEST_CHANNELS; ch++)
+    {
+        DdsChannel *c = &channels[ch];
+        if (c->freq != test_freq[ch])
+        {
+            c->freq = test_freq[ch];
+            c->tuning = dds_tuning(c->freq);
+        }
+        // 32x32 -> 64 — одна інструкція UMULL
+        c->phase += (uint32_t)(((uint64_t)c->tuning * elapsed) >> DDS_TUNING_SHIFT);
+    }
+}
+
+void dds_scan(uint8_t mask, int16_t *out)
+{
+    dds_scan_at(mask, DWT->CYCCNT, out);
+}
+
+void dds_scan_at(uint8_t mask, uint32_t at, int16_t *out)
+{
+    dds_advance(at);
+
+    for (uint8_t ch = 0; ch < CTRL_TEST_CHANNELS; ch++)
+    {
+        if (!(mask & (1 << ch)))
+            continue;
+
+        int32_t v = (dds_wave((uint8_t)test_wave[ch], channels[ch].phase) * test_amplitude[ch]) >> 15;
+        if (test_noise[ch])
+            v += ((int32_t)(noise_next() >> 16) - 0x8000) * test_noise[ch] >> 15;
+        if (v < -2048)
+            v = -2048;
+        if (v > 2047)
+            v = 2047;
+        *out++ = (int16_t)v;
+    }
+}
+
+// Фаза, на якій форма перетинає середину шкали в заданому напрямку
+static uint32_t dds_edge_phase(uint8_t wave, uint8_t falling)
+{
+    switch (wave)
+    {
+    case DDS_WAVE_TRIANGLE:
+        return falling ? 0xC0000000u : 0x40000000u;
+    case DDS_WAVE_SAW:
+        return falling ? 0 : 0x80000000u; // Спад — скид пилки
+    case DDS_WAVE_PULSE:
+        return falling ? DDS_PULSE_WIDTH : 0;
+    default:
+        return falling ? 0x80000000u : 0;
+    }
+}
+
+bool dds_next_edge(uint8_t ch, bool falling, uint32_t *at)
+{
+    dds_advance(DWT->CYCCNT);
+    const DdsChannel *c = &channels[ch];
+    uint8_t wave = (uint8_t)test_wave[ch];
+    if (c->tuning == 0 || wave == DDS_WAVE_DC)
+        return false;
+
+    uint32_t ahead = dds_edge_phase(wave, falling) - c->phase;
+    // Ділення 64-бітне, але одне на захоплення; з округленням угору — щоб не раніше фронту
+    *at = last_cycles + (uint32_t)((((uint64_t)ahead << DDS_TUNING_SHIFT) + c->tuning - 1) / c->tuning);
+    return true;
+}
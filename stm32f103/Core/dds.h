@@ -0,0 +1,52 @@
+#ifndef DDS_H
+#define DDS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Тестовий сигнал без таблиць у RAM: кожен канал — фазовий акумулятор (32 біти на період),
+// форма з Q15-таблиці синуса у flash або просто з фази. Фаза росте за тактами DWT CYCCNT,
+// тож частота в герцах не залежить від темпу сканів, а семпли рахуються в мить скану,
+// як відліки АЦП. Параметри — test_wave/test_freq/test_amplitude/test_noise (control_protocol.h)
+#define DDS_CLOCK_HZ 72000000u  // Такти CYCCNT за секунду (SYSCLK)
+#define DDS_TUNING_SHIFT 8      // Крок фази на такт у Q8 понад 32 біти: 1 Гц — 15271, похибка < 0.01%
+#define DDS_TABLE_BITS 8        // 256 точок синуса, між ними — лінійна інтерполяція
+
+typedef enum
+{
+    DDS_WAVE_SINE,
+    DDS_WAVE_SQUARE,
+    DDS_WAVE_TRIANGLE,
+    DDS_WAVE_SAW,
+    DDS_WAVE_PULSE,             // 1/8 періоду вгорі
+    DDS_WAVE_DC,                // Рівень amplitude
+    DDS_WAVE_COUNT
+} DdsWave;
+
+#define DDS_FREQ_MAX 65535      // test_freq у 0.1 Гц: до 6553.5 Гц
+#define DDS_AMPLITUDE_MAX 2047  // Пік у відліках АЦП від середини шкали
+
+// Вмикає лічильник тактів DWT і скидає фази
+void dds_init(void);
+
+// Один скан: значення каналів маски за зростанням номера в out (як ADC_ReadScan, мінус 2048).
+// Фази вимкнених каналів теж ідуть, тож після зміни маски сигнал не зсувається
+void dds_scan(uint8_t mask, int16_t *out);
+
+// Те саме в мить at (такти CYCCNT, не раніше попереднього скану) — для захоплень
+// з точним зсувом від фронту (ets.h), які рахуються наперед
+void dds_scan_at(uint8_t mask, uint32_t at, int16_t *out);
+
+// Мить (такти CYCCNT) найближчого фронту каналу ch — перетину середини шкали вгору або,
+// з falling, вниз; false — фронтів немає (частота 0, DC)
+bool dds_next_edge(uint8_t ch, bool falling, uint32_t *at);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DDS_H */
@@ -0,0 +1,22 @@
+// file delta_codec.c
+#include "delta_codec.h"
+
+uint16_t delta_encode(const int16_t *values, uint16_t count, uint8_t channels, uint8_t *out)
+{
+    uint8_t *p = out;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        // Різниця за модулем 2^16: декодер додає її так само, переповнення не буває
+        uint16_t prev = i >= channels ? (uint16_t)values[i - channels] : 0;
+        int16_t delta = (int16_t)((uint16_t)values[i] - prev);
+        // Zig-zag: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ... — малі за модулем різниці дають малі числа
+        uint16_t zz = (uint16_t)(((uint16_t)delta << 1) ^ (uint16_t)(delta >> 15));
+        while (zz >= 0x80)
+        {
+            *p++ = (uint8_t)(zz | 0x80);
+            zz >>= 7;
+        }
+        *p++ = (uint8_t)zz;
+    }
+    return (uint16_t)(p - out);
+}
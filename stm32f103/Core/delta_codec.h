@@ -0,0 +1,29 @@
+#ifndef DELTA_CODEC_H
+#define DELTA_CODEC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Пакет 0xAE: старт, маска каналів, номер (3 байти, молодший першим), LEN, LEN байтів блоку.
+// Блок — DELTA_BLOCK_VALUES значень у порядку пакета 0xAD (скани по черзі, у скані — канали
+// маски), кожне як різниця з попереднім значенням того самого каналу, zig-zag, varint
+// (7 біт на байт, старший біт — продовження). Перший скан блоку — різниця з нулем:
+// кожен пакет розбирається сам, втрачений пакет не псує наступні
+#define PACKET_START_DELTA 0xAE
+#define PACKET_DELTA_HEADER 6
+#define DELTA_BLOCK_VALUES 48  // Ділиться на 1..4 канали
+#define DELTA_VALUE_MAX_BYTES 3 // 16-бітна різниця після zig-zag
+#define PACKET_DELTA_MAX (PACKET_DELTA_HEADER + DELTA_BLOCK_VALUES * DELTA_VALUE_MAX_BYTES)
+
+// Кодує count значень з channels каналами в out (до count * DELTA_VALUE_MAX_BYTES байтів).
+// Лише цілі зсуви і порівняння — без ділення і плаваючої коми. Повертає кількість байтів
+uint16_t delta_encode(const int16_t *values, uint16_t count, uint8_t channels, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DELTA_CODEC_H */
@@ -0,0 +1,97 @@
+// file ets.c
+#include "ets.h"
+#include "adc_read.h"
+#include "dds.h"
+#include "stm32f103xb.h"
+
+static uint8_t step;
+static uint8_t step_steps; // M, для якого рахується step
+
+void ets_init(void)
+{
+    // PA8 — плаваючий вхід (TIM1_CH1); CH2 на PA9 не виводиться: пін не в режимі альтернативної функції
+    RCC->APB2ENR |= RCC_APB2ENR_IOPAEN | RCC_APB2ENR_TIM1EN;
+    GPIOA->CRH = (GPIOA->CRH & ~(GPIO_CRH_MODE8 | GPIO_CRH_CNF8)) | GPIO_CRH_CNF8_0;
+
+    TIM1->CR1 = 0;
+    TIM1->PSC = 0;                           // Такт лічильника — такт ядра
+    TIM1->CCMR1 = TIM_CCMR1_CC1S_0           // CC1 — вхід TI1
+                | TIM_CCMR1_IC1F_1           // Фільтр 4 такти проти брязкоту фронту
+                | TIM_CCMR1_OC2M_2 | TIM_CCMR1_OC2M_1 | TIM_CCMR1_OC2M_0; // PWM 2: OC2REF росте на CCR2
+    TIM1->CCER = TIM_CCER_CC2E;              // Подія CC2 для АЦП — лише з увімкненим виходом каналу
+    TIM1->BDTR = TIM_BDTR_MOE;
+    step = 0;
+    step_steps = 0;
+}
+
+// Період сканів — найменше кратне M, у яке вміщається скан
+static uint8_t ets_step_cycles(uint8_t scan_channels, uint8_t steps)
+{
+    uint16_t scan = ETS_CONVERSION_CYCLES * scan_channels + ETS_SCAN_MARGIN_CYCLES;
+    return (uint8_t)((scan + steps - 1) / steps);
+}
+
+// Тестовий сигнал: фронт відомий наперед, скани рахуються в ті самі миті, що й таймер
+static bool ets_capture_test(uint8_t mask, uint8_t scan_channels, uint8_t scans, bool falling,
+                             uint32_t first, uint32_t period, int16_t *out)
+{
+    uint32_t edge;
+    uint8_t trigger_channel = (uint8_t)__builtin_ctz(mask);
+    if (!dds_next_edge(trigger_channel, falling, &edge))
+        return false;
+    if (edge - DWT->CYCCNT > ETS_TRIGGER_TIMEOUT_CYCLES)
+        return false;
+
+    uint32_t at = edge + first;
+    for (uint8_t scan = 0; scan < scans; scan++, at += period)
+        dds_scan_at(mask, at, out + scan * scan_channels);
+    // Як АЦП: захоплення закінчується не раніше останнього скану
+    while ((int32_t)(DWT->CYCCNT - at) < 0);
+    return true;
+}
+
+static bool ets_capture_adc(uint8_t scans, bool falling, uint32_t first, uint32_t period, int16_t *out)
+{
+    TIM1->CR1 = 0;
+    TIM1->SMCR = 0;
+    TIM1->CNT = 0;
+    TIM1->ARR = period - 1;
+    TIM1->CCR2 = first;
+    TIM1->CCER = TIM_CCER_CC2E | (falling ? TIM_CCER_CC1P : 0); // Полярність TI1FP1
+    TIM1->SR = 0;
+
+    // Спершу АЦП чекає подій CC2 (EXTSEL 001), потім таймер чекає фронту TI1FP1: режим Trigger
+    // сам вмикає лічильник, і кожен його період — скан
+    ADC_StartTriggered(ADC1, ADC_CR2_EXTSEL_0, scans);
+    TIM1->SMCR = TIM_SMCR_TS_2 | TIM_SMCR_TS_0 | TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1;
+    bool done = ADC_FinishTriggered(ADC1, ETS_TRIGGER_TIMEOUT_CYCLES, out);
+    TIM1->CR1 = 0;
+    TIM1->SMCR = 0;
+    return done;
+}
+
+bool ets_capture(uint8_t mask, uint8_t scan_channels, uint8_t scans, int16_t *out, EtsCapture *info)
+{
+    uint8_t steps = (uint8_t)ets_steps;
+    if (steps != step_steps)
+    {
+        step_steps = steps;
+        step = 0;
+    }
+    uint8_t step_cycles = ets_step_cycles(scan_channels, steps);
+    uint32_t period = (uint32_t)steps * step_cycles;
+    uint32_t first = ETS_START_CYCLES + (uint32_t)step * step_cycles;
+
+    bool falling = trigger_edge == 1;
+    bool done = test_signal ? ets_capture_test(mask, scan_channels, scans, falling, first, period, out)
+                            : ets_capture_adc(scans, falling, first, period, out);
+    if (!done)
+        return false;
+
+    info->step = step;
+    info->steps = steps;
+    info->step_cycles = step_cycles;
+    if (++step >= steps)
+        step = 0;
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef ETS_H
+#define ETS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "control_protocol.h"
+
+// Вибірка в еквівалентному часі для періодичного сигналу (ets_steps = M > 1): кожне захоплення
+// чекає фронту тригера (trigger_edge), TIM1 від фронту запускає скани АЦП з періодом
+// M * step_cycles тактів, перший — із зсувом step * step_cycles. step іде 0..M-1 по колу,
+// тож M захоплень разом дають семпли через step_cycles тактів — у M разів частіше, ніж
+// дозволяє перетворення АЦП. Фронт АЦП — на PA8 (TIM1_CH1), тестового сигналу — з фази
+// першого каналу маски (dds_next_edge). Будь-який фронт (trigger_edge 2) змішав би в кривій
+// протилежні півперіоди — тут він зростаючий
+#define ETS_CONVERSION_CYCLES 84   // Перетворення з вибіркою 1.5 цикли: 14 тактів ADCCLK (12 МГц) = 84 такти ядра
+#define ETS_SCAN_MARGIN_CYCLES 12  // Запас, щоб подія таймера не прийшла, поки скан ще триває
+#define ETS_START_CYCLES 1         // Порівняння з CNT = 0 не спрацьовує в мить запуску лічильника
+#define ETS_TRIGGER_TIMEOUT_CYCLES (72000000u / 10) // Без фронту 100 мс — захоплення немає
+
+typedef struct
+{
+    uint8_t step;          // Зсув першого скану, у кроках
+    uint8_t steps;         // M
+    uint8_t step_cycles;   // Крок еквівалентного часу, такти 72 МГц
+} EtsCapture;
+
+// PA8 — вхід тригера, TIM1 — лічильник від фронту
+void ets_init(void);
+
+// Одне захоплення: scans сканів каналів mask (scan_channels значень кожен) в out.
+// false — фронту не було за ETS_TRIGGER_TIMEOUT_CYCLES
+bool ets_capture(uint8_t mask, uint8_t scan_channels, uint8_t scans, int16_t *out, EtsCapture *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ETS_H */
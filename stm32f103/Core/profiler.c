@@ -0,0 +1,94 @@
+// file profiler.c
+#include <string.h>
+#include "profiler.h"
+
+// Поточне вікно: ділянки переривання USB і його лічильники пише лише переривання, решту —
+// основний цикл або, в потоці DMA, лише переривання DMA (пакети, скани, ENCODE), тож слова не
+// перетинаються; скидання вікна — з вимкненими перериваннями
+static uint32_t current[CTRL_STAT_COUNT];
+static uint32_t published[CTRL_STAT_COUNT];
+static uint32_t snapshot[CTRL_STAT_COUNT];
+static uint32_t window_start;
+static uint32_t window_number;
+static uint32_t last_sof;
+static uint8_t have_sof;
+
+void profiler_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    memset(current, 0, sizeof(current));
+    memset(published, 0, sizeof(published));
+    memset(snapshot, 0, sizeof(snapshot));
+    window_start = profiler_now();
+    window_number = 0;
+    have_sof = 0;
+}
+
+// < 256 тактів, < 1K, < 4K, < 16K, < 64K, решта
+static uint8_t bucket(uint32_t cycles)
+{
+    if (cycles < (1u << PROFILER_FIRST_BUCKET_BITS))
+        return 0;
+    uint32_t b = (31u - __CLZ(cycles) - PROFILER_FIRST_BUCKET_BITS) / 2 + 1;
+    return b < CTRL_PROF_BUCKETS ? (uint8_t)b : CTRL_PROF_BUCKETS - 1;
+}
+
+void profiler_add(uint8_t section, uint32_t cycles)
+{
+    uint32_t *s = &current[CTRL_STAT_SECTIONS + section * CTRL_PROF_FIELDS];
+    s[CTRL_PROF_CYCLES] += cycles;
+    s[CTRL_PROF_COUNT]++;
+    if (cycles > s[CTRL_PROF_MAX])
+        s[CTRL_PROF_MAX] = cycles;
+    s[CTRL_PROF_HIST + bucket(cycles)]++;
+}
+
+void profiler_count(uint8_t stat, uint32_t n)
+{
+    current[stat] += n;
+}
+
+void profiler_usb_irq(uint32_t start, uint32_t istr)
+{
+    profiler_section(CTRL_PROF_USB_IRQ, start);
+
+    // Обробник з CTR_TX/CTR_RX повертається раніше, і решту прапорців (SOF теж) скидає наступний
+    // вхід — тоді й рахуються. Запізнення SOF — наскільки довший за 1 мс проміжок між ними
+    if (istr & USB_ISTR_CTR)
+        return;
+    if (istr & USB_ISTR_SOF)
+    {
+        uint32_t interval = start - last_sof;
+        if (have_sof && interval < 2 * PROFILER_SOF_CYCLES) // Пропущений кадр (suspend) — не запізнення
+            profiler_add(CTRL_PROF_USB_LATENCY, interval > PROFILER_SOF_CYCLES ? interval - PROFILER_SOF_CYCLES : 0);
+        last_sof = start;
+        have_sof = 1;
+    }
+    if (istr & USB_ISTR_PMAOVR)
+        current[CTRL_STAT_PMA_OVERRUNS]++;
+    if (istr & USB_ISTR_ERR)
+        current[CTRL_STAT_USB_ERRORS]++;
+}
+
+void profiler_poll(void)
+{
+    uint32_t now = profiler_now();
+    if (now - window_start < PROFILER_WINDOW_CYCLES)
+        return;
+    current[CTRL_STAT_WINDOW] = ++window_number;
+    current[CTRL_STAT_WINDOW_CYCLES] = now - window_start;
+    window_start = now;
+
+    __disable_irq();
+    memcpy(published, current, sizeof(current));
+    memset(current, 0, sizeof(current));
+    __enable_irq();
+}
+
+uint32_t profiler_stat(uint8_t stat)
+{
+    if (stat == CTRL_STAT_WINDOW)
+        memcpy(snapshot, published, sizeof(published));
+    return snapshot[stat];
+}
@@ -0,0 +1,54 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "stm32f103xb.h"
+#include "control_protocol.h"
+
+// Облік тактів за DWT CYCCNT: ділянки основного циклу і переривання USB складаються у вікно
+// PROFILER_WINDOW_CYCLES (сума, кількість, найдовша, гістограма тривалостей), разом з
+// лічильниками втрат. Завершене вікно публікується цілим, хост читає його запитами
+// CTRL_OP_STAT (розкладка статів — control_protocol.h). Читання CYCCNT — один такт,
+// тож облік лишається увімкненим завжди
+#define PROFILER_WINDOW_CYCLES 72000000u // 1 с
+#define PROFILER_SOF_CYCLES 72000u       // Період SOF (1 мс) у тактах
+#define PROFILER_FIRST_BUCKET_BITS 8     // Перший кошик гістограми — до 2^8 тактів
+
+// Вмикає CYCCNT (як і dds_init), не скидаючи: фаза генератора від нього залежить
+void profiler_init(void);
+
+static inline uint32_t profiler_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+// Ділянка section (CTRL_PROF_*) тривалістю cycles
+void profiler_add(uint8_t section, uint32_t cycles);
+
+// Ділянка section від start до цієї миті
+static inline void profiler_section(uint8_t section, uint32_t start)
+{
+    profiler_add(section, profiler_now() - start);
+}
+
+// Лічильник stat (CTRL_STAT_*) вікна += n
+void profiler_count(uint8_t stat, uint32_t n);
+
+// З переривання USB: вхід у мить start, ISTR до обробки
+void profiler_usb_irq(uint32_t start, uint32_t istr);
+
+// З основного циклу: завершує вікно, якщо минуло PROFILER_WINDOW_CYCLES
+void profiler_poll(void);
+
+// Стат завершеного вікна для CTRL_OP_STAT (CTRL_STAT_WINDOW фіксує знімок)
+uint32_t profiler_stat(uint8_t stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILER_H */
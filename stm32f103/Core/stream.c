@@ -0,0 +1,243 @@
+// file stream.c
+#include "stream.h"
+#include "stream_hal.h"
+#include "control_protocol.h"
+#include "adc_read.h"
+#include "dds.h"
+#include "ets.h"
+#include "delta_codec.h"
+#include "profiler.h"
+#include "tx_ring.h"
+
+// Номер кожного сформованого пакета, зокрема не прийнятого повним кільцем передавання:
+// хост бачить розрив номерів і рахує втрачені семпли
+static uint32_t packet_seq;
+static uint16_t scan_mask;      // Маска, за якою налаштовано скан АЦП
+static uint8_t scan_channels;
+static uint16_t scan_oversample;
+static bool scan_ets;
+
+// Потік 0xB0 через DMA: параметри, з якими його запущено
+static bool dma_running;
+static bool dma_time;
+static uint16_t dma_rate;
+static uint8_t dma_scans;
+static uint32_t dma_span_us;    // Від першого скану пакета до кінця останнього
+
+void stream_init(void)
+{
+    packet_seq = 0;
+    scan_mask = 0;
+    scan_channels = 0;
+    scan_oversample = 0;
+    scan_ets = false;
+    dma_running = false;
+    tx_ring_init();
+}
+
+// Відповідь на запит — окремим слотом, поперед пакетів у черзі
+static void stream_reply(void)
+{
+    uint8_t *slot = tx_ring_reply_slot();
+    if (!slot)
+        return;
+    uint16_t len = control_reply(slot);
+    if (len)
+    {
+        tx_ring_reply_commit(len);
+        control_reply_sent();
+    }
+}
+
+// Заголовок 0xAD/0xAE/0xAF/0xB0 до часу включно. Повертає вказівник за ним
+static uint8_t *put_header(uint8_t *p, uint8_t start, uint8_t mask, bool time, uint32_t time_us)
+{
+    p[0] = start;
+    p[1] = time ? mask | PACKET_TIME_FLAG : mask;
+    p[2] = packet_seq & 0xFF;
+    p[3] = (packet_seq >> 8) & 0xFF;
+    p[4] = (packet_seq >> 16) & 0xFF;
+    p += PACKET_MASK_HEADER;
+    if (time)
+    {
+        *p++ = time_us & 0xFF;
+        *p++ = (time_us >> 8) & 0xFF;
+        *p++ = (time_us >> 16) & 0xFF;
+        *p++ = time_us >> 24;
+    }
+    return p;
+}
+
+// Слот 0xB0: заголовок з поточними номером і часом, за ним — місце для відліків DMA
+static uint16_t *dma_values(uint8_t *slot, uint32_t time_us)
+{
+    uint8_t *p = put_header(slot, PACKET_START_RAW, (uint8_t)scan_mask, dma_time, time_us);
+    *p++ = dma_scans;
+    return (uint16_t *)(void *)p;
+}
+
+static void dma_start(void)
+{
+    dma_time = timestamps != 0;
+    dma_rate = new_rate;
+    dma_scans = PACKET_RAW_SCANS(scan_channels, dma_time);
+    // Той самий темп, що й у програмних сканів: скан і затримка new_rate
+    uint32_t scan = STREAM_SCAN_CHANNEL_CYCLES * scan_channels;
+    uint32_t period = scan + (uint32_t)dma_rate * 1000u * STREAM_PACE_LOOP_CYCLES;
+    dma_span_us = ((uint32_t)(dma_scans - 1) * period + scan) / STREAM_CYCLES_PER_US;
+    dma_running = true;
+    stream_hal_dma_start(period, dma_values(tx_ring_head(), 0), (uint16_t)(dma_scans * scan_channels));
+}
+
+static void dma_stop(void)
+{
+    if (!dma_running)
+        return;
+    stream_hal_dma_stop();
+    dma_running = false;
+}
+
+uint16_t *stream_dma_block(void)
+{
+    uint32_t profile_start = profiler_now();
+    uint8_t *slot = tx_ring_head();
+    // Номер і час відомі лише тепер: скани пакета вже закінчились
+    dma_values(slot, stream_hal_time_us() - dma_span_us);
+    uint16_t len = (uint16_t)(PACKET_RAW_HEADER + (dma_time ? PACKET_TIME_BYTES : 0) + dma_scans * scan_channels * 2);
+    if (!tx_ring_commit(len))
+        profiler_count(CTRL_STAT_TX_BUSY, 1);
+    profiler_count(CTRL_STAT_PACKETS, 1);
+    profiler_count(CTRL_STAT_SCANS, dma_scans);
+    packet_seq = (packet_seq + 1) & PACKET_SEQ_MASK;
+    uint16_t *next = dma_values(tx_ring_head(), 0);
+    profiler_section(CTRL_PROF_ENCODE, profile_start);
+    return next;
+}
+
+bool stream_step(void)
+{
+    // Запити хоста: розбір і застосування параметрів між пакетами, а не в перериванні USB
+    uint32_t profile_start = profiler_now();
+    control_poll();
+    profiler_section(CTRL_PROF_CONTROL, profile_start);
+    profiler_poll();
+    stream_reply();
+
+    bool ets = ets_steps > 1;
+    bool raw = !test_signal && !compression && !oversample && !ets;
+    // Нова маска каналів: коротша черга АЦП і більше сканів у пакеті
+    if (channel_mask != scan_mask || oversample != scan_oversample || ets != scan_ets)
+    {
+        // Чергу АЦП і DMA переналаштовує stream_hal_config — потік зупиняється до того
+        dma_stop();
+        scan_mask = channel_mask;
+        scan_oversample = oversample;
+        scan_ets = ets;
+        // Захопленню потрібна та сама найкоротша вибірка, що й передискретизації:
+        // скан має вміститися в період M * step_cycles
+        scan_channels = stream_hal_config((uint8_t)scan_mask, scan_ets ? 1 : (uint8_t)scan_oversample);
+    }
+
+    if (raw)
+    {
+        // Скани, пакети і передавання — DMA і переривання; ядро спить до наступного
+        if (dma_running && (dma_rate != new_rate || dma_time != (timestamps != 0)))
+            dma_stop();
+        if (!dma_running)
+            dma_start();
+        profile_start = profiler_now();
+        stream_hal_idle();
+        profiler_section(CTRL_PROF_PACE, profile_start);
+        return false;
+    }
+    dma_stop();
+
+    // Тестовий сигнал і захоплення — звичайні 12-бітні значення
+    uint8_t extra_bits = test_signal || ets ? 0 : ADC_OVERSAMPLE_EXTRA_BITS(scan_oversample);
+    // Стиснений блок довший: заголовок і передавання USB діляться на вчетверо більше сканів
+    uint8_t block_values = compression || ets ? DELTA_BLOCK_VALUES : PACKET_MASK_VALUES;
+    uint8_t scans = block_values / scan_channels;
+    int16_t block[DELTA_BLOCK_VALUES];
+    int16_t *values = block;
+    uint32_t block_time = stream_hal_time_us();
+    EtsCapture capture;
+
+    if (ets)
+    {
+        // Еквівалентний час: семпли після фронту, темп задає крок, а не new_rate
+        profile_start = profiler_now();
+        bool captured = stream_hal_capture((uint8_t)scan_mask, scan_channels, scans, block, &capture);
+        profiler_section(CTRL_PROF_ACQUIRE, profile_start);
+        if (!captured)
+            return false; // Фронту немає: пакета теж
+    }
+    else
+    {
+        // Скани і затримки між ними — окремими ділянками, по одній на пакет
+        uint32_t acquire_cycles = 0, pace_cycles = 0;
+        for (uint8_t scan = 0; scan < scans; scan++)
+        {
+            uint32_t scan_start = profiler_now();
+            if (test_signal)
+            {
+                // Дані з генератора тестових сигналів: у мить скану, з тим самим темпом, що й АЦП
+                dds_scan((uint8_t)scan_mask, values);
+            }
+            else if (scan_oversample)
+            {
+                // Висока роздільність: 2^N сканів на максимальній швидкості АЦП, усереднені
+                // на платі — семплів менше, біт більше, потік USB коротшає в 2^N разів
+                stream_hal_scan_oversampled((uint8_t)scan_oversample, values);
+            }
+            else
+            {
+                stream_hal_scan(values);
+            }
+            values += scan_channels;
+            uint32_t pace_start = profiler_now();
+            acquire_cycles += pace_start - scan_start;
+            stream_hal_pace(new_rate);
+            pace_cycles += profiler_now() - pace_start;
+        }
+        profiler_add(CTRL_PROF_ACQUIRE, acquire_cycles);
+        profiler_add(CTRL_PROF_PACE, pace_cycles);
+    }
+
+    // Пакет — прямо в слоті кільця: звідти його забирає ядро USB
+    profile_start = profiler_now();
+    uint8_t *slot = tx_ring_head();
+    uint8_t start = ets ? PACKET_START_ETS : compression ? PACKET_START_DELTA : PACKET_START_MASK;
+    uint8_t *out = put_header(slot, start, (uint8_t)(scan_mask | (extra_bits << PACKET_RES_SHIFT)), timestamps != 0,
+                              block_time);
+    if (ets)
+    {
+        *out++ = capture.step;
+        *out++ = capture.steps;
+        *out++ = capture.step_cycles;
+    }
+    if (compression || ets)
+    {
+        // Повільний сигнал: різниці до ±63 займають байт замість двох
+        uint16_t len = delta_encode(block, block_values, scan_channels, out + 1);
+        *out = (uint8_t)len;
+        out += 1 + len;
+    }
+    else
+    {
+        for (uint8_t i = 0; i < block_values; i++)
+        {
+            *out++ = block[i] & 0xFF; // Молодший байт
+            *out++ = (block[i] >> 8); // Старший байт
+        }
+    }
+    profiler_section(CTRL_PROF_ENCODE, profile_start);
+
+    profile_start = profiler_now();
+    if (!tx_ring_commit((uint16_t)(out - slot)))
+        profiler_count(CTRL_STAT_TX_BUSY, 1);
+    profiler_section(CTRL_PROF_TRANSMIT, profile_start);
+    profiler_count(CTRL_STAT_PACKETS, 1);
+    profiler_count(CTRL_STAT_SCANS, scans);
+    packet_seq = (packet_seq + 1) & PACKET_SEQ_MASK;
+    return true;
+}
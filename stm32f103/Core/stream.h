@@ -0,0 +1,57 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Пакет 0xAD: старт, маска каналів, номер (3 байти, молодший першим), 12 значень int16:
+// скани по черзі, у скані — лише канали маски. Сканів у пакеті 12 / (кількість каналів)
+#define PACKET_START_MASK 0xAD
+#define PACKET_MASK_HEADER 5
+#define PACKET_MASK_VALUES 12
+#define PACKET_MASK_SIZE (PACKET_MASK_HEADER + PACKET_MASK_VALUES * 2)
+#define PACKET_SEQ_MASK 0xFFFFFF // 24 біти
+// Або, з compression, пакет 0xAE з блоком DELTA_BLOCK_VALUES стиснених значень (delta_codec.h).
+// Біти 4..6 байта маски — додаткові біти роздільності значень (oversample), 0 — 12 біт
+#define PACKET_RES_SHIFT 4
+// Старший біт байта маски (з timestamps): за номером — 4 байти часу першого скану пакета
+// (timestamp_now, мкс, молодший першим), далі LEN і блок або значення
+#define PACKET_TIME_FLAG 0x80
+#define PACKET_TIME_BYTES 4
+// З ets_steps — захоплення від фронту, пакет 0xAF: заголовок як у 0xAD (з часом), далі крок,
+// кількість кроків і крок у тактах (EtsCapture), потім LEN і блок, як у 0xAE
+#define PACKET_START_ETS 0xAF
+#define PACKET_ETS_BYTES 3
+// Без тестового сигналу, стиснення, передискретизації і захоплень — пакет 0xB0, який пише DMA АЦП:
+// заголовок як у 0xAD (з часом), далі кількість сканів і сирі відліки АЦП uint16 (0..4095, середина
+// шкали 2048 — віднімає хост). Байт сканів вирівнює відліки на 2 для DMA. Пакет коротший за пакет
+// USB (64 байти), тож кожен — одна транзакція без ZLP
+#define PACKET_START_RAW 0xB0
+#define PACKET_RAW_HEADER (PACKET_MASK_HEADER + 1)
+#define PACKET_RAW_MAX 63
+#define PACKET_RAW_SCANS(channels, time) \
+    ((PACKET_RAW_MAX - PACKET_RAW_HEADER - ((time) ? PACKET_TIME_BYTES : 0)) / (2 * (channels)))
+
+// Потік пакетів семплів: параметри хоста (control_protocol.h), скани, формування пакета прямо в
+// слоті кільця передавання (tx_ring.h), відповідь на запит. Залізо — лише через stream_hal.h, тож
+// той самий код збирається й на ПК (host/, make host)
+void stream_init(void);
+
+// Один прохід основного циклу: запити хоста, скани одного пакета, пакет у кільце передавання.
+// Пакети 0xB0 формує DMA без ядра — прохід лише чекає переривання (WFI).
+// false — пакета основний цикл не сформував (захоплення без фронту, потік DMA)
+bool stream_step(void);
+
+// З переривання DMA (stream_hal_dma_start): відліки пакета 0xB0 дописано. Дописує заголовок,
+// віддає слот у кільце і повертає, куди писати наступний пакет
+uint16_t *stream_dma_block(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STREAM_H */
@@ -0,0 +1,100 @@
+// file stream_hal.c
+#include "stream_hal.h"
+#include "stream.h"
+#include "adc_read.h"
+#include "timestamp.h"
+#include "usbd_cdc_if.h"
+
+static uint8_t scan_channels;
+static uint16_t dma_count;
+
+uint8_t stream_hal_config(uint8_t mask, uint8_t oversample)
+{
+    scan_channels = ADC_ConfigScan(ADC1, mask);
+    ADC_ConfigOversample(ADC1, oversample);
+    return scan_channels;
+}
+
+void stream_hal_scan(int16_t *out)
+{
+    // Увімкнені канали PA0..PA3 одним сканом. Інтерпретуємо дані як негативні, якщо вони нижчі
+    // за 2048 (умовний нуль), для центрування даних на осцилоскопі
+    uint16_t adc_values[4];
+    ADC_ReadScan(ADC1, adc_values);
+    for (uint8_t i = 0; i < scan_channels; i++)
+        out[i] = adc_values[i] - 2048;
+}
+
+void stream_hal_scan_oversampled(uint8_t oversample, int16_t *out)
+{
+    ADC_ReadOversampled(ADC1, oversample, out);
+}
+
+bool stream_hal_capture(uint8_t mask, uint8_t channels, uint8_t scans, int16_t *out, EtsCapture *info)
+{
+    return ets_capture(mask, channels, scans, out, info);
+}
+
+void stream_hal_pace(uint16_t rate)
+{
+    // Затримка або інтервал між сканами (можна замінити на таймер)
+    for (volatile uint32_t delay = 0; delay < rate * 1000u; delay++)
+        __asm volatile ("nop");
+}
+
+uint32_t stream_hal_time_us(void)
+{
+    return timestamp_now();
+}
+
+bool stream_hal_transmit(uint8_t *buf, uint16_t len)
+{
+    return CDC_Transmit_FS(buf, len) == USBD_OK;
+}
+
+void stream_hal_kick(void)
+{
+    NVIC_SetPendingIRQ(USB_LP_CAN1_RX0_IRQn);
+}
+
+void stream_hal_dma_start(uint32_t period_cycles, uint16_t *values, uint16_t count)
+{
+    // TIM3 (72 МГц, як TIM2) — подія оновлення на TRGO кожні period_cycles тактів; до 8 млн тактів
+    // (new_rate 1000) вміщаються в 16-бітний ARR з подільником
+    RCC->APB1ENR |= RCC_APB1ENR_TIM3EN;
+    uint32_t psc = (period_cycles - 1) >> 16;
+    TIM3->CR1 = 0;
+    TIM3->PSC = psc;
+    TIM3->ARR = period_cycles / (psc + 1) - 1;
+    TIM3->CR2 = TIM_CR2_MMS_1;                // TRGO — подія оновлення
+    TIM3->EGR = TIM_EGR_UG;                   // Завантажити PSC одразу
+    TIM3->SR = 0;
+
+    // Переривання DMA — пріоритетніше за USB (usbd_conf.c): наступний буфер має бути готовий
+    // до кінця першого перетворення наступного скану, а обробник USB буває довшим
+    dma_count = count;
+    NVIC_SetPriority(DMA1_Channel1_IRQn, 0);
+    NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+    ADC_StartStream(ADC1, ADC_CR2_EXTSEL_2, values, count); // EXTSEL 100 — TIM3_TRGO
+    TIM3->CR1 = TIM_CR1_CEN;
+}
+
+void stream_hal_dma_stop(void)
+{
+    TIM3->CR1 = 0;
+    NVIC_DisableIRQ(DMA1_Channel1_IRQn);
+    ADC_StopStream(ADC1);
+    NVIC_ClearPendingIRQ(DMA1_Channel1_IRQn);
+}
+
+// Замінює слабкий обробник зі startup_stm32f103xb.s
+void DMA1_Channel1_IRQHandler(void)
+{
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+    ADC_StreamNext(stream_dma_block(), dma_count);
+}
+
+void stream_hal_idle(void)
+{
+    __WFI();
+}
@@ -0,0 +1,59 @@
+#ifndef STREAM_HAL_H
+#define STREAM_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ets.h"
+
+// Залізо потоку пакетів (stream.c): АЦП, таймер захоплень, пауза між сканами, мітки часу, CDC.
+// На платі — Core/stream_hal.c, на ПК — host/host_hal.c (імітація АЦП і приймач замість CDC).
+// Такти DWT CYCCNT (dds.c, profiler.c) на ПК — лічильник імітованого часу плати
+
+#define STREAM_CYCLES_PER_US 72u        // Такти ядра на мікросекунду
+#define STREAM_SCAN_CHANNEL_CYCLES 408u // Канал скану: 55.5 + 12.5 тактів ADCCLK (12 МГц)
+#define STREAM_PACE_LOOP_CYCLES 8u      // Ітерація затримки stream_hal_pace (volatile-лічильник, -Og): оцінка
+
+// Черга АЦП на канали mask, час вибірки для передискретизації 2^oversample (0 — звичайний).
+// Повертає кількість каналів у скані
+uint8_t stream_hal_config(uint8_t mask, uint8_t oversample);
+
+// Один скан: значення каналів маски відносно середини шкали (мінус 2048)
+void stream_hal_scan(int16_t *out);
+
+// 2^oversample сканів, усереднених до 12 + ADC_OVERSAMPLE_EXTRA_BITS біт
+void stream_hal_scan_oversampled(uint8_t oversample, int16_t *out);
+
+// Захоплення від фронту (ets_capture); false — фронту не було
+bool stream_hal_capture(uint8_t mask, uint8_t channels, uint8_t scans, int16_t *out, EtsCapture *info);
+
+// Затримка між сканами за CTRL_PARAM_RATE
+void stream_hal_pace(uint16_t rate);
+
+// Мітка часу пакета, мкс (timestamp_now)
+uint32_t stream_hal_time_us(void);
+
+// Передати len байтів хосту (з переривання USB, tx_ring_service): буфер читається, доки
+// передавання не завершиться (tx_ring_done). false — попереднє ще триває, байти не прийнято
+bool stream_hal_transmit(uint8_t *buf, uint16_t len);
+
+// Запросити переривання USB, щоб воно почало передавання готового слота (tx_ring_service)
+void stream_hal_kick(void);
+
+// Скани без ядра: таймер запускає скан черги АЦП кожні period_cycles тактів, DMA пише сирі
+// відліки (0..4095) по count у буфер values і після кожного буфера викликає stream_dma_block()
+// з переривання — той дає наступний буфер
+void stream_hal_dma_start(uint32_t period_cycles, uint16_t *values, uint16_t count);
+void stream_hal_dma_stop(void);
+
+// Очікування переривання: у потоці DMA основному циклу більше нічого робити
+void stream_hal_idle(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STREAM_HAL_H */
@@ -0,0 +1,42 @@
+// file timestamp.c
+#include "timestamp.h"
+#include "stm32f103xb.h"
+
+static volatile uint16_t timestamp_high;
+
+void timestamp_init(void)
+{
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+    TIM2->CR1 = 0;
+    TIM2->PSC = 72000000u / TIMESTAMP_HZ - 1; // Тактова TIM2 — APB1 x2 = 72 МГц
+    TIM2->ARR = 0xFFFF;
+    TIM2->EGR = TIM_EGR_UG;                   // Завантажити PSC одразу
+    TIM2->SR = 0;
+    TIM2->DIER = TIM_DIER_UIE;
+    timestamp_high = 0;
+    NVIC_EnableIRQ(TIM2_IRQn);
+    TIM2->CR1 = TIM_CR1_CEN;
+}
+
+// Замінює слабкий обробник зі startup_stm32f103xb.s
+void TIM2_IRQHandler(void)
+{
+    TIM2->SR = (uint32_t)~TIM_SR_UIF; // rc_w0: нулем скидається лише UIF
+    timestamp_high++;
+}
+
+uint32_t timestamp_now(void)
+{
+    uint16_t high, low;
+    uint32_t pending;
+    do
+    {
+        high = timestamp_high;
+        low = (uint16_t)TIM2->CNT;
+        pending = TIM2->SR & TIM_SR_UIF;
+    } while (high != timestamp_high); // Переривання встигло виконатись — ще раз
+    // Лічильник перейшов через нуль до читання CNT, а переривання ще не виконалось
+    if (pending && low < 0x8000)
+        high++;
+    return ((uint32_t)high << 16) | low;
+}
@@ -0,0 +1,24 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Вільний лічильник мікросекунд для міток часу пакетів: TIM2 рахує 1 МГц (72 МГц / 72),
+// переповнення кожні 65.536 мс додає старші 16 біт у перериванні. 32 біти — повний оберт
+// за ~71.6 хв, хост розгортає його сам
+#define TIMESTAMP_HZ 1000000u
+
+void timestamp_init(void);
+
+// Поточний час, мкс (з основного циклу)
+uint32_t timestamp_now(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMESTAMP_H */
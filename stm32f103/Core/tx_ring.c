@@ -0,0 +1,94 @@
+// file tx_ring.c
+#include <stddef.h>
+#include "tx_ring.h"
+#include "stream.h"
+#include "stream_hal.h"
+#include "control_protocol.h"
+#include "delta_codec.h"
+#include "stm32f103xb.h"
+
+_Static_assert(PACKET_DELTA_MAX + PACKET_TIME_BYTES + PACKET_ETS_BYTES <= TX_SLOT_BYTES,
+               "слот вміщає найдовший пакет");
+_Static_assert(PACKET_RAW_MAX <= TX_SLOT_BYTES, "слот вміщає пакет 0xB0");
+
+enum { TX_IDLE, TX_SLOT, TX_REPLY };
+
+static uint8_t slots[TX_SLOTS][TX_SLOT_BYTES] __attribute__((aligned(4)));
+static uint8_t reply[CTRL_FRAME_MAX] __attribute__((aligned(4)));
+static volatile uint16_t lengths[TX_SLOTS];
+static volatile uint8_t head;      // Пише лише виробник
+static volatile uint8_t tail;      // Пише лише переривання USB
+static volatile uint16_t reply_len; // Ставить основний цикл, скидає переривання USB
+static volatile uint8_t sending;   // Лише переривання USB
+static uint32_t dropped;
+
+void tx_ring_init(void)
+{
+    head = 0;
+    tail = 0;
+    reply_len = 0;
+    sending = TX_IDLE;
+    dropped = 0;
+}
+
+uint8_t *tx_ring_head(void)
+{
+    return slots[head];
+}
+
+bool tx_ring_commit(uint16_t len)
+{
+    uint8_t next = (uint8_t)((head + 1) % TX_SLOTS);
+    if (next == tail)
+    {
+        dropped++;
+        return false;
+    }
+    lengths[head] = len;
+    __DMB(); // Слот дописано раніше, ніж його побачить переривання USB
+    head = next;
+    stream_hal_kick();
+    return true;
+}
+
+uint8_t *tx_ring_reply_slot(void)
+{
+    return reply_len ? NULL : reply;
+}
+
+void tx_ring_reply_commit(uint16_t len)
+{
+    __DMB();
+    reply_len = len;
+    stream_hal_kick();
+}
+
+void tx_ring_service(void)
+{
+    if (sending != TX_IDLE)
+        return;
+    if (reply_len)
+    {
+        if (stream_hal_transmit(reply, reply_len))
+            sending = TX_REPLY;
+    }
+    else if (tail != head)
+    {
+        if (stream_hal_transmit(slots[tail], lengths[tail]))
+            sending = TX_SLOT;
+    }
+}
+
+void tx_ring_done(void)
+{
+    if (sending == TX_REPLY)
+        reply_len = 0;
+    else if (sending == TX_SLOT)
+        tail = (uint8_t)((tail + 1) % TX_SLOTS);
+    sending = TX_IDLE;
+}
+
+uint32_t tx_ring_dropped(void)
+{
+    return dropped;
+}
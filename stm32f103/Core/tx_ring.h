@@ -0,0 +1,45 @@
+#ifndef TX_RING_H
+#define TX_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Кільце слотів передавання: пакет формується прямо в слоті (основним циклом або DMA АЦП), а
+// переривання USB віддає слоти в CDC по черзі — ядро USB само переписує слот у PMA, проміжних
+// копій немає. Слот звільняється лише після кінця його передавання: CDC читає буфер частинами по
+// 64 байти, поки передавання триває. Відповідь на запит — в окремому слоті, іде першою.
+// Пише в кільце один виробник за раз, забирає лише переривання USB — блокувань не потрібно
+#define TX_SLOTS 8
+#define TX_SLOT_BYTES 160 // Найдовший пакет — 0xAF з часом (157 байтів), кратно 4
+
+void tx_ring_init(void);
+
+// Слот наступного пакета, вирівняний на 4. Є завжди: з повним кільцем — той самий слот
+uint8_t *tx_ring_head(void);
+
+// Пакет len байтів у tx_ring_head() готовий до передавання. false — кільце повне: пакет
+// втрачено (CTRL_STAT_TX_BUSY), слот лишається тим самим
+bool tx_ring_commit(uint16_t len);
+
+// Слот відповіді на запит; NULL — попередня ще не передана
+uint8_t *tx_ring_reply_slot(void);
+void tx_ring_reply_commit(uint16_t len);
+
+// З переривання USB: почати передавання наступного слота, якщо попереднє завершилось
+void tx_ring_service(void);
+
+// З переривання USB: передавання завершилось (або обірване скиданням CDC) — слот вільний
+void tx_ring_done(void);
+
+// Пакетів, не прийнятих tx_ring_commit від tx_ring_init
+uint32_t tx_ring_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TX_RING_H */
@@ -1,6 +1,7 @@
 // usbd_cdc_if.c
 
 #include "usbd_cdc_if.h"
+#include "tx_ring.h"
 
 uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
 uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
@@ -11,13 +12,10 @@ static int8_t CDC_Init_FS(void);
 static int8_t CDC_DeInit_FS(void);
 static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length);
 static int8_t CDC_Receive_FS(uint8_t* pbuf, uint32_t *Len);
+static int8_t CDC_TransmitCplt_FS(uint8_t *pbuf, uint32_t *Len, uint8_t epnum);
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_DECLARATION */
 
-uint8_t APP_RX_DATA[APP_RX_DATA_SIZE];
-uint32_t APP_RX_DATA_LEN = 0;  // довжина прийнятих даних
-
-void trim_string(char* str);
 // Функція обробки прийнятих даних
 void USB_CDC_RxHandler(uint8_t* data, uint32_t length);
 
@@ -26,7 +24,8 @@ USBD_CDC_ItfTypeDef USBD_Interface_fops_FS =
   CDC_Init_FS,
   CDC_DeInit_FS,
   CDC_Control_FS,
-  CDC_Receive_FS
+  CDC_Receive_FS,
+  CDC_TransmitCplt_FS
 };
 
 static int8_t CDC_Init_FS(void)
@@ -35,6 +34,8 @@ static int8_t CDC_Init_FS(void)
   /* Set Application Buffers */
   USBD_CDC_SetTxBuffer(&hUsbDeviceFS, UserTxBufferFS, 0);
   USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+  // Передавання, обірване скиданням USB, не завершиться: його слот звільняється тут
+  tx_ring_done();
   return (USBD_OK);
   /* USER CODE END 3 */
 }
@@ -119,35 +120,7 @@ static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
     USBD_CDC_SetRxBuffer(&hUsbDeviceFS, Buf);
     USBD_CDC_ReceivePacket(&hUsbDeviceFS);
 
-    // Перевіряємо, щоб не вийти за межі буфера
-    if (*Len + APP_RX_DATA_LEN > APP_RX_DATA_SIZE)
-    {
-        // Якщо даних більше, ніж можемо прийняти — обнуляємо накопичувач
-        APP_RX_DATA_LEN = 0;
-    }
-
-    // Копіюємо нові дані у буфер, пропускаючи символи '\r' та '\n'
-    for (uint32_t i = 0; i < *Len; i++)
-    {
-        if (Buf[i] != '\r' && Buf[i] != '\n')
-        {
-            APP_RX_DATA[APP_RX_DATA_LEN++] = Buf[i];
-        }
-    }
-
-    // За бажанням, додаємо нульовий символ для зручності роботи з рядками
-    if (APP_RX_DATA_LEN < APP_RX_DATA_SIZE)
-    {
-        APP_RX_DATA[APP_RX_DATA_LEN] = '\0';
-    }
-    else
-    {
-        APP_RX_DATA[APP_RX_DATA_SIZE - 1] = '\0';
-    }
-
-    // Тепер APP_RX_DATA містить накопичені дані без '\r' і '\n'
-
-    // Обробка прийнятих даних одразу
+    // Буфер прийому вже знову відданий ядру USB: дані копіюються до наступного OUT-пакета
     USB_CDC_RxHandler(Buf, *Len);  // Функція обробки прийому
 
     return (USBD_OK);
@@ -169,4 +142,15 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
+// Кінець передавання IN (без ZLP або після нього): слот кільця вільний, наступний почне
+// USB_LP_CAN1_RX0_IRQHandler (tx_ring_service)
+static int8_t CDC_TransmitCplt_FS(uint8_t *Buf, uint32_t *Len, uint8_t epnum)
+{
+  (void)Buf;
+  (void)Len;
+  (void)epnum;
+  tx_ring_done();
+  return (USBD_OK);
+}
+
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
@@ -31,6 +31,13 @@ USBD_StatusTypeDef USBD_PCDEx_PMAConfig(PCD_HandleTypeDef *hpcd, uint16_t ep_add
     ep->doublebuffer = 0U;
     ep->pmaadress = (uint16_t)pmaadress;
   }
+  else
+  {
+    // Подвійний буфер: адреса буфера 0 — у молодших 16 бітах, буфера 1 — у старших
+    ep->doublebuffer = 1U;
+    ep->pmaaddr0 = (uint16_t)(pmaadress & 0xFFFFU);
+    ep->pmaaddr1 = (uint16_t)(pmaadress >> 16);
+  }
   return USBD_OK;
 }
 
@@ -263,6 +270,16 @@ static USBD_StatusTypeDef Handle_IN_Transfer(PCD_HandleTypeDef *hpcd, uint8_t ep
     ep->xfer_len = 0U;
     USBD_LL_DataInStage((USBD_HandleTypeDef*)hpcd->pData, ep->num, ep->xfer_buff);
   }
+  else if (ep->doublebuffer != 0U)
+  {
+    // Подвійний буфер bulk: пакет пішов — наступний, уже скопійований, віддається ядру
+    // перемиканням SW_BUF; передавання завершене, коли віддавати вже нічого
+    if (USB_DBufTxNext(hpcd->Instance, ep) == 0U)
+    {
+      ep->xfer_len = 0U;
+      USBD_LL_DataInStage((USBD_HandleTypeDef*)hpcd->pData, ep->num, ep->xfer_buff);
+    }
+  }
   else
   {
     if ((wEPVal & USB_EP_KIND) == 0U)
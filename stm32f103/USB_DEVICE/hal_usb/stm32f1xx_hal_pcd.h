@@ -687,6 +687,38 @@ USBD_PCD_SET_EP_RX_CNT(USB_TypeDef* USBx, uint8_t bEpNum, uint16_t wCount) {
   } while(0);
 }
 
+/**
+  * @brief  sets buffer addresses and tx counters of a double-buffered IN endpoint:
+  *         buffer 0 uses the ADDRn_TX/COUNTn_TX descriptor, buffer 1 the RX one
+  *         (COUNTn_TX_1 is a plain byte count, not the RX block format).
+  * @param  USBx USB peripheral instance register address.
+  * @param  bEpNum Endpoint Number.
+  * @retval None
+  */
+static inline void
+USBD_PCD_SET_EP_DBUF_ADDR(USB_TypeDef* USBx, uint8_t bEpNum, uint16_t wBuf0Addr, uint16_t wBuf1Addr) {
+  USBD_PCD_SET_EP_TX_ADDRESS((USBx), (bEpNum), (wBuf0Addr));
+  USBD_PCD_SET_EP_RX_ADDRESS((USBx), (bEpNum), (wBuf1Addr));
+}
+
+static inline void
+USBD_PCD_SET_EP_TX_DBUF0_CNT(USB_TypeDef* USBx, uint8_t bEpNum, uint16_t wCount) {
+  USBD_PCD_SET_EP_TX_CNT((USBx), (bEpNum), (wCount));
+}
+
+static inline void
+USBD_PCD_SET_EP_TX_DBUF1_CNT(USB_TypeDef* USBx, uint8_t bEpNum, uint16_t wCount) {
+  do {
+    uint32_t _wRegBase = (uint32_t)(USBx);
+    __IO uint16_t *_wRegVal;
+
+    _wRegBase += (uint32_t)(USBx)->BTABLE;
+    _wRegVal = (__IO uint16_t *)(_wRegBase + 0x400U +
+    ((((uint32_t)(bEpNum) * 8U) + 6U) * PMA_ACCESS));
+    *_wRegVal = (uint16_t)(wCount);
+  } while(0);
+}
+
 /**
   * @brief  gets counter of the tx buffer.
   * @param  USBx USB peripheral instance register address.
@@ -86,59 +86,108 @@ uint32_t USB_ReadInterrupts(const USB_TypeDef *USBx)
   return USBx->ISTR;
 }
 
+// Адреса слова PMA: 16-бітні слова лежать з кроком 32 біти (PMA_ACCESS)
+static inline __IO uint16_t *USB_PMA(USB_TypeDef const *USBx, uint16_t wPMABufAddr)
+{
+  return (__IO uint16_t *)((uint32_t)USBx + 0x400U + ((uint32_t)wPMABufAddr * PMA_ACCESS));
+}
+
+// Копіювання розгорнуте по вісім слів: пакет 64 байти — чотири ітерації без лічильника
+// між словами. Буфер користувача — байтовий масив без гарантії вирівнювання, але Cortex-M3
+// читає й пише невирівняні півслова однією інструкцією
 void USB_ReadPMA(USB_TypeDef const *USBx, uint8_t *pbUsrBuf, uint16_t wPMABufAddr, uint16_t wNBytes)
 {
   uint32_t n = (uint32_t)wNBytes >> 1;
-  uint32_t BaseAddr = (uint32_t)USBx;
-  uint32_t count;
-  uint32_t RdVal;
-  __IO uint16_t *pdwVal;
+  __IO uint16_t *pma = USB_PMA(USBx, wPMABufAddr);
   uint8_t *pBuf = pbUsrBuf;
 
-  pdwVal = (__IO uint16_t *)(BaseAddr + 0x400U + ((uint32_t)wPMABufAddr * PMA_ACCESS));
-
-  for (count = n; count != 0U; count--)
+  for (; n >= 8U; n -= 8U, pma += 8U * PMA_ACCESS, pBuf += 16)
+  {
+    __UNALIGNED_UINT16_WRITE(pBuf + 0, pma[0 * PMA_ACCESS]);
+    __UNALIGNED_UINT16_WRITE(pBuf + 2, pma[1 * PMA_ACCESS]);
+    __UNALIGNED_UINT16_WRITE(pBuf + 4, pma[2 * PMA_ACCESS]);
+    __UNALIGNED_UINT16_WRITE(pBuf + 6, pma[3 * PMA_ACCESS]);
+    __UNALIGNED_UINT16_WRITE(pBuf + 8, pma[4 * PMA_ACCESS]);
+    __UNALIGNED_UINT16_WRITE(pBuf + 10, pma[5 * PMA_ACCESS]);
+    __UNALIGNED_UINT16_WRITE(pBuf + 12, pma[6 * PMA_ACCESS]);
+    __UNALIGNED_UINT16_WRITE(pBuf + 14, pma[7 * PMA_ACCESS]);
+  }
+  for (; n != 0U; n--, pma += PMA_ACCESS, pBuf += 2)
   {
-    RdVal = *(__IO uint16_t *)pdwVal;
-    pdwVal++;
-    *pBuf = (uint8_t)((RdVal >> 0) & 0xFFU);
-    pBuf++;
-    *pBuf = (uint8_t)((RdVal >> 8) & 0xFFU);
-    pBuf++;
-    #if PMA_ACCESS > 1U
-    pdwVal++;
-    #endif /* PMA_ACCESS */
+    __UNALIGNED_UINT16_WRITE(pBuf, *pma);
   }
   if ((wNBytes % 2U) != 0U)
   {
-    RdVal = *pdwVal;
-    *pBuf = (uint8_t)((RdVal >> 0) & 0xFFU);
+    *pBuf = (uint8_t)(*pma & 0xFFU);
   }
 }
 
 void USB_WritePMA(USB_TypeDef const *USBx, uint8_t *pbUsrBuf, uint16_t wPMABufAddr, uint16_t wNBytes)
 {
   uint32_t n = ((uint32_t)wNBytes + 1U) >> 1;
-  uint32_t BaseAddr = (uint32_t)USBx;
-  uint32_t count;
-  uint16_t WrVal;
-  __IO uint16_t *pdwVal;
-  uint8_t *pBuf = pbUsrBuf;
+  __IO uint16_t *pma = USB_PMA(USBx, wPMABufAddr);
+  const uint8_t *pBuf = pbUsrBuf;
+
+  for (; n >= 8U; n -= 8U, pma += 8U * PMA_ACCESS, pBuf += 16)
+  {
+    pma[0 * PMA_ACCESS] = __UNALIGNED_UINT16_READ(pBuf + 0);
+    pma[1 * PMA_ACCESS] = __UNALIGNED_UINT16_READ(pBuf + 2);
+    pma[2 * PMA_ACCESS] = __UNALIGNED_UINT16_READ(pBuf + 4);
+    pma[3 * PMA_ACCESS] = __UNALIGNED_UINT16_READ(pBuf + 6);
+    pma[4 * PMA_ACCESS] = __UNALIGNED_UINT16_READ(pBuf + 8);
+    pma[5 * PMA_ACCESS] = __UNALIGNED_UINT16_READ(pBuf + 10);
+    pma[6 * PMA_ACCESS] = __UNALIGNED_UINT16_READ(pBuf + 12);
+    pma[7 * PMA_ACCESS] = __UNALIGNED_UINT16_READ(pBuf + 14);
+  }
+  // Непарна довжина: старший байт останнього слова — будь-який, його не передано
+  for (; n != 0U; n--, pma += PMA_ACCESS, pBuf += 2)
+  {
+    *pma = __UNALIGNED_UINT16_READ(pBuf);
+  }
+}
+
+// Наступний пакет передавання в буфер buf подвійного ендпоінта IN
+static void USB_WriteDBufPacket(USB_TypeDef *USBx, USB_EPTypeDef *ep, uint8_t buf)
+{
+  uint32_t len = ep->xfer_len_db > ep->maxpacket ? ep->maxpacket : ep->xfer_len_db;
+
+  USB_WritePMA(USBx, ep->xfer_buff, buf != 0U ? ep->pmaaddr1 : ep->pmaaddr0, (uint16_t)len);
+  if (buf != 0U)
+  {
+    USBD_PCD_SET_EP_TX_DBUF1_CNT(USBx, ep->num, (uint16_t)len);
+  }
+  else
+  {
+    USBD_PCD_SET_EP_TX_DBUF0_CNT(USBx, ep->num, (uint16_t)len);
+  }
+  ep->xfer_buff += len;
+  ep->xfer_len_db -= len;
+}
 
-  pdwVal = (__IO uint16_t *)(BaseAddr + 0x400U + ((uint32_t)wPMABufAddr * PMA_ACCESS));
+// Буфер, яким зараз володіє прошивка: SW_BUF (біт DTOG_RX ендпоінта IN)
+static uint8_t USB_DBufUser(USB_TypeDef *USBx, uint8_t num)
+{
+  return (USBD_PCD_GET_ENDPOINT(USBx, num) & USB_EP_DTOG_RX) != 0U ? 1U : 0U;
+}
 
-  for (count = n; count != 0U; count--)
+/** Подвійний буфер bulk IN: віддає ядру наступний заповнений пакет (після CTR_TX).
+  * Повертає 0, коли щойно надісланий пакет був останнім у передаванні */
+uint8_t USB_DBufTxNext(USB_TypeDef *USBx, USB_EPTypeDef *ep)
+{
+  if (ep->xfer_fill_db == 0U)
   {
-    WrVal = pBuf[0];
-    WrVal |= (uint16_t)pBuf[1] << 8;
-    *pdwVal = (WrVal & 0xFFFFU);
-    pdwVal++;
-    #if PMA_ACCESS > 1U
-    pdwVal++;
-    #endif /* PMA_ACCESS */
-    pBuf++;
-    pBuf++;
+    return 0U;
   }
+  // Ядро вже чекає з NAK (DTOG_TX == SW_BUF): перемикання SW_BUF — і пакет іде наступним
+  // IN-токеном, а копіювання ще одного пакета відбувається вже під час його передавання
+  USBD_PCD_FREE_USER_BUFFER(USBx, ep->num, 1U);
+  ep->xfer_fill_db = 0U;
+  if (ep->xfer_len_db != 0U)
+  {
+    USB_WriteDBufPacket(USBx, ep, USB_DBufUser(USBx, ep->num));
+    ep->xfer_fill_db = 1U;
+  }
+  return 1U;
 }
 
 USBD_StatusTypeDef USB_ActivateEndpoint(USB_TypeDef *USBx, USB_EPTypeDef *ep)
@@ -204,11 +253,33 @@ USBD_StatusTypeDef USB_ActivateEndpoint(USB_TypeDef *USBx, USB_EPTypeDef *ep)
       }
     }
   }
+  else if ((ep->is_in != 0U) && (ep->type == EP_TYPE_BULK))
+  {
+    // Подвійний буфер: регістр ендпоінта лише для IN, обидва дескриптори — буфери передавання.
+    // DTOG_TX == SW_BUF — ядру нічого передавати (NAK), прошивка пише в буфер SW_BUF
+    USBD_PCD_SET_BULK_EP_DBUF(USBx, ep->num);
+    USBD_PCD_SET_EP_DBUF_ADDR(USBx, ep->num, ep->pmaaddr0, ep->pmaaddr1);
+    USBD_PCD_CLEAR_TX_DTOG(USBx, ep->num);
+    USBD_PCD_CLEAR_RX_DTOG(USBx, ep->num);
+    USBD_PCD_SET_EP_TX_STATUS(USBx, ep->num, USB_EP_TX_NAK);
+    USBD_PCD_SET_EP_RX_STATUS(USBx, ep->num, USB_EP_RX_DIS);
+    ep->xfer_fill_db = 0U;
+  }
+  else
+  {
+    // Подвійний буфер прийому не підтримано
+    ret = USBD_FAIL;
+  }
   return ret;
 }
 
 USBD_StatusTypeDef USB_DeactivateEndpoint(USB_TypeDef *USBx, USB_EPTypeDef *ep)
 {
+  if (ep->doublebuffer != 0U)
+  {
+    USBD_PCD_CLEAR_BULK_EP_DBUF(USBx, ep->num);
+    ep->xfer_fill_db = 0U;
+  }
   USBD_PCD_CLEAR_TX_DTOG(USBx, ep->num);
   USBD_PCD_CLEAR_RX_DTOG(USBx, ep->num);
   /* Configure DISABLE status for the Endpoint */
@@ -237,8 +308,26 @@ USBD_StatusTypeDef USB_EPStartXfer(USB_TypeDef *USBx, USB_EPTypeDef *ep)
     {
       USB_WritePMA(USBx, ep->xfer_buff, ep->pmaadress, (uint16_t)len);
       USBD_PCD_SET_EP_TX_CNT(USBx, ep->num, len);
+      USBD_PCD_SET_EP_TX_STATUS(USBx, ep->num, USB_EP_TX_VALID);
+    }
+    else
+    {
+      // Передавання починається з простою ендпоінта (DTOG_TX == SW_BUF): обидва буфери вільні.
+      // Перший пакет — у буфер прошивки, другий — у другий буфер, і лише потім SW_BUF
+      // перемикається: ядро забирає перший, а другий уже чекає в буфері прошивки
+      uint8_t buf = USB_DBufUser(USBx, ep->num);
+      ep->xfer_len_db = ep->xfer_len;
+      ep->xfer_fill_db = 0U;
+      USB_WriteDBufPacket(USBx, ep, buf);
+      if (ep->xfer_len_db != 0U)
+      {
+        USB_WriteDBufPacket(USBx, ep, buf ^ 1U);
+        ep->xfer_fill_db = 1U;
+      }
+      USBD_PCD_SET_EP_TX_STATUS(USBx, ep->num, USB_EP_TX_VALID);
+      // Далі ендпоінт належить перериванню: Handle_IN_Transfer може спрацювати одразу
+      USBD_PCD_FREE_USER_BUFFER(USBx, ep->num, 1U);
     }
-    USBD_PCD_SET_EP_TX_STATUS(USBx, ep->num, USB_EP_TX_VALID);
   }
   else /* OUT endpoint */
   {
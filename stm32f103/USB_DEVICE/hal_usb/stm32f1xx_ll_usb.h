@@ -233,6 +233,7 @@ USBD_StatusTypeDef USB_EPStartXfer(USB_TypeDef *USBx, USB_EPTypeDef *ep);
 USBD_StatusTypeDef USB_EPSetStall(USB_TypeDef *USBx, USB_EPTypeDef *ep);
 USBD_StatusTypeDef USB_EPClearStall(USB_TypeDef *USBx, USB_EPTypeDef *ep);
 USBD_StatusTypeDef USB_EPStopXfer(USB_TypeDef *USBx, USB_EPTypeDef *ep);
+uint8_t           USB_DBufTxNext(USB_TypeDef *USBx, USB_EPTypeDef *ep);
 
 
 USBD_StatusTypeDef USB_SetDevAddress(USB_TypeDef *USBx, uint8_t address);
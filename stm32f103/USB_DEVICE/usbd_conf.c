@@ -17,7 +17,7 @@ void USBD_PCD_MspInit(PCD_HandleTypeDef* pcdHandle)
     SET_BIT(RCC->APB1ENR, RCC_APB1ENR_USBEN);
     while (READ_BIT(RCC->APB1ENR, RCC_APB1ENR_USBEN) == 0) {}
 
-    NVIC_SetPriority(USB_LP_CAN1_RX0_IRQn, 0);
+    NVIC_SetPriority(USB_LP_CAN1_RX0_IRQn, 1); // Нижче за DMA потоку сканів (stream_hal.c)
     NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
   }
 }
@@ -55,13 +55,16 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef * pdev)
   }
 
   /* USER CODE BEGIN EndPoint_Configuration */
-  USBD_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x00 , USBD_PCD_SNG_BUF, 0x18);
-  USBD_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x80 , USBD_PCD_SNG_BUF, 0x58);
+  // PMA (512 байт): 0x00..0x1F — таблиця дескрипторів EP0..EP3, далі буфери
+  USBD_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x00 , USBD_PCD_SNG_BUF, 0x20);
+  USBD_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x80 , USBD_PCD_SNG_BUF, 0x60);
   /* USER CODE END EndPoint_Configuration */
   /* USER CODE BEGIN EndPoint_Configuration_CDC */
-  USBD_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x81 , USBD_PCD_SNG_BUF, 0xC0);
-  USBD_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x01 , USBD_PCD_SNG_BUF, 0x110);
-  USBD_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x82 , USBD_PCD_SNG_BUF, 0x100);
+  // Дані IN — подвійний буфер (0xA0 і 0xE0): поки ядро передає один пакет, наступний
+  // уже скопійовано в інший. Такий ендпоінт односпрямований, тож OUT — на EP3
+  USBD_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x81 , USBD_PCD_DBL_BUF, 0xA0 | (0xE0 << 16));
+  USBD_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x82 , USBD_PCD_SNG_BUF, 0x120);
+  USBD_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x03 , USBD_PCD_SNG_BUF, 0x130);
   /* USER CODE END EndPoint_Configuration_CDC */
   return USBD_OK;
 }
@@ -0,0 +1,329 @@
+// file fw_host.c
+//
+// Тракт даних прошивки на ПК: stream.c, tx_ring.c, control_protocol.c, dds.c, delta_codec.c і
+// profiler.c без змін, залізо — host_hal.c. Параметри кожного випадку задаються кадрами керування,
+// як з хоста, далі stream_step() формує пакети (випадки adc_* без стиснення — через імітований
+// DMA, пакети 0xB0), а приймач перевіряє їх розбір і номери.
+// Звіт — ціна значення на ПК і байти на значення в потоці USB, JSON.
+// Код повернення 1 — кадр не розібрався, NAK або розрив номерів більший за втрачені кільцем
+// передавання пакети (для CI).
+// Збирається окремо від прошивки: make host && build/host/fw_host --out host.json
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_hal.h"
+#include "stream.h"
+#include "stream_hal.h"
+#include "control_protocol.h"
+#include "dds.h"
+#include "profiler.h"
+
+#define HOST_REPS 5                // Повторів на випадок; у звіт іде медіана і найкращий
+#define HOST_BATCH_PACKETS 1000    // Пакетів між читаннями годинника
+#define HOST_REPLY_STEPS 16        // Проходів основного циклу, за які має прийти відповідь
+
+typedef struct {
+    uint8_t param;
+    int32_t value;
+} HostSetting;
+
+typedef struct {
+    const char *name;
+    HostSetting settings[8];
+    int setting_count;
+} HostCase;
+
+typedef struct {
+    const char *name;
+    double ns_per_value;           // Медіана повторів
+    double best_ns_per_value;
+    double ns_per_packet;
+    double bytes_per_value;
+    double values_per_packet;
+    double board_values_per_s;     // За імітованим часом плати (host_hal.h), не за ПК
+    unsigned long long packets;
+    unsigned long long values;
+    unsigned long long busy;
+    unsigned long long seq_gaps;
+    unsigned long long bad;
+    bool ok;
+} HostResult;
+
+static const HostCase cases[] = {
+    { "adc_4ch", { { CTRL_PARAM_CHANNEL_MASK, 0x0F } }, 1 },
+    { "adc_1ch", { { CTRL_PARAM_CHANNEL_MASK, 0x01 } }, 1 },
+    { "adc_4ch_notime", { { CTRL_PARAM_CHANNEL_MASK, 0x0F }, { CTRL_PARAM_TIMESTAMPS, 0 } }, 2 },
+    { "adc_4ch_delta", { { CTRL_PARAM_CHANNEL_MASK, 0x0F }, { CTRL_PARAM_COMPRESSION, 1 } }, 2 },
+    { "adc_1ch_delta", { { CTRL_PARAM_CHANNEL_MASK, 0x01 }, { CTRL_PARAM_COMPRESSION, 1 } }, 2 },
+    { "adc_4ch_oversample16", { { CTRL_PARAM_CHANNEL_MASK, 0x0F }, { CTRL_PARAM_OVERSAMPLE, 4 } }, 2 },
+    { "test_4ch", { { CTRL_PARAM_CHANNEL_MASK, 0x0F }, { CTRL_PARAM_TEST_SIGNAL, 1 } }, 2 },
+    { "test_4ch_delta", { { CTRL_PARAM_CHANNEL_MASK, 0x0F }, { CTRL_PARAM_TEST_SIGNAL, 1 },
+                          { CTRL_PARAM_COMPRESSION, 1 } }, 3 },
+    { "ets_1ch_x8", { { CTRL_PARAM_CHANNEL_MASK, 0x01 }, { CTRL_PARAM_ETS_STEPS, 8 } }, 2 },
+    { "ets_test_2ch_x16", { { CTRL_PARAM_CHANNEL_MASK, 0x03 }, { CTRL_PARAM_TEST_SIGNAL, 1 },
+                            { CTRL_PARAM_ETS_STEPS, 16 } }, 3 },
+};
+#define CASE_COUNT (int)(sizeof(cases) / sizeof(cases[0]))
+
+// Параметри, які випадок не задає: як після старту плати, але без паузи між сканами
+static const HostSetting defaults[] = {
+    { CTRL_PARAM_RATE, 0 }, { CTRL_PARAM_TEST_SIGNAL, 0 }, { CTRL_PARAM_COMPRESSION, 0 },
+    { CTRL_PARAM_OVERSAMPLE, 0 }, { CTRL_PARAM_TIMESTAMPS, 1 }, { CTRL_PARAM_ETS_STEPS, 0 },
+};
+
+static double min_time_s = 0.5;
+static long min_packets = 20000;
+static double busy_probability = 0.0;
+static uint8_t request_id;
+static HostResult results[CASE_COUNT + 1];
+static int result_count;
+static bool failed;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Кадр запиту в кільце прийому, як з переривання USB
+static uint8_t push_request(uint8_t op, const uint8_t *payload, uint8_t len)
+{
+    uint8_t frame[CTRL_FRAME_MAX];
+    uint8_t id = ++request_id;
+    frame[0] = CTRL_START;
+    frame[1] = len;
+    frame[2] = id;
+    frame[3] = op;
+    memcpy(frame + CTRL_HEADER, payload, len);
+    uint16_t crc = host_crc16(frame + 1, CTRL_HEADER - 1 + len);
+    frame[CTRL_HEADER + len] = crc & 0xFF;
+    frame[CTRL_HEADER + len + 1] = crc >> 8;
+    control_rx_push(frame, CTRL_HEADER + len + 2);
+    return id;
+}
+
+// Запит через основний цикл: відповідь приходить за пакетом. false — NAK або немає відповіді
+static bool request(uint8_t op, const uint8_t *payload, uint8_t len, uint32_t *value)
+{
+    uint8_t id = push_request(op, payload, len);
+    unsigned long long replies = host_sink()->replies;
+    for (int i = 0; i < HOST_REPLY_STEPS; i++)
+    {
+        stream_step();
+        const HostSink *s = host_sink();
+        if (s->replies == replies || s->reply[2] != id)
+            continue;
+        if (s->reply[3] != CTRL_OP_ACK)
+            return false;
+        if (value)
+            *value = s->reply[6] | (s->reply[7] << 8) | ((uint32_t)s->reply[8] << 16) | ((uint32_t)s->reply[9] << 24);
+        return true;
+    }
+    return false;
+}
+
+static bool set_param(uint8_t param, int32_t value)
+{
+    uint8_t payload[5] = { param, value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, (uint32_t)value >> 24 };
+    if (request(CTRL_OP_SET, payload, 5, NULL))
+        return true;
+    fprintf(stderr, "SET param %u = %d: no ACK\n", param, value);
+    return false;
+}
+
+// ---- Випадки ----
+
+// Пакети до min_packets і min_time_s; повертає нс на значення
+static double measure(unsigned long long *packets_out)
+{
+    const HostSink *s = host_sink();
+    unsigned long long first_packets = s->packets + s->busy, first_values = s->values;
+    double start = now_seconds(), elapsed;
+    do
+    {
+        for (int i = 0; i < HOST_BATCH_PACKETS; i++)
+            stream_step();
+        elapsed = now_seconds() - start;
+    } while (elapsed < min_time_s || (long)(s->packets + s->busy - first_packets) < min_packets);
+    *packets_out = s->packets + s->busy - first_packets;
+    unsigned long long values = s->values - first_values;
+    return values ? elapsed * 1e9 / (double)values : 0.0;
+}
+
+static void run_case(const HostCase *c)
+{
+    HostResult *r = &results[result_count++];
+    memset(r, 0, sizeof(*r));
+    r->name = c->name;
+    r->ok = true;
+
+    host_hal_set_busy(0.0);
+    for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++)
+        r->ok &= set_param(defaults[i].param, defaults[i].value);
+    for (int i = 0; i < c->setting_count; i++)
+        r->ok &= set_param(c->settings[i].param, c->settings[i].value);
+    // Перший пакет після зміни маски ще міг піти за старою: лічильники — з наступного
+    stream_step();
+    host_hal_set_busy(busy_probability);
+    host_sink_reset();
+
+    uint64_t start_cycles = host_cycles();
+    double reps[HOST_REPS];
+    unsigned long long packets = 0;
+    for (int rep = 0; rep < HOST_REPS; rep++)
+        reps[rep] = measure(&packets);
+    qsort(reps, HOST_REPS, sizeof(reps[0]), compare_double);
+
+    const HostSink *s = host_sink();
+    r->ns_per_value = reps[HOST_REPS / 2];
+    r->best_ns_per_value = reps[0];
+    r->packets = s->packets;
+    r->values = s->values;
+    r->busy = s->busy;
+    r->seq_gaps = s->seq_gaps;
+    r->bad = s->bad;
+    r->values_per_packet = s->packets ? (double)s->values / s->packets : 0.0;
+    r->ns_per_packet = r->ns_per_value * r->values_per_packet;
+    r->bytes_per_value = s->values ? (double)s->bytes / s->values : 0.0;
+    double board_s = (double)(host_cycles() - start_cycles) / HOST_CLOCK_HZ;
+    r->board_values_per_s = board_s > 0.0 ? s->values / board_s : 0.0;
+    // Кожен номер мусить прийти, крім пакетів, не прийнятих повним кільцем передавання
+    r->ok &= s->bad == 0 && s->seq_gaps <= s->busy && s->packets > 0;
+    failed |= !r->ok;
+
+    fprintf(stderr, "%-22s %7.1f ns/value  %6.3f B/value  %5.1f values/packet  %s\n", r->name,
+            r->ns_per_value, r->bytes_per_value, r->values_per_packet, r->ok ? "ok" : "FAILED");
+    (void)packets;
+}
+
+// Розбір кадру керування з кільця прийому до готової відповіді, без пакетів
+static void run_control(void)
+{
+    HostResult *r = &results[result_count++];
+    memset(r, 0, sizeof(*r));
+    r->name = "control_get";
+    r->ok = true;
+
+    double reps[HOST_REPS];
+    uint8_t reply[CTRL_FRAME_MAX];
+    for (int rep = 0; rep < HOST_REPS; rep++)
+    {
+        unsigned long long count = 0;
+        double start = now_seconds(), elapsed;
+        do
+        {
+            for (int i = 0; i < HOST_BATCH_PACKETS; i++, count++)
+            {
+                uint8_t param = CTRL_PARAM_CHANNEL_MASK;
+                push_request(CTRL_OP_GET, &param, 1);
+                control_poll();
+                r->ok &= control_reply(reply) == CTRL_HEADER + 6 + 2 && reply[3] == CTRL_OP_ACK;
+                control_reply_sent();
+            }
+            elapsed = now_seconds() - start;
+        } while (elapsed < min_time_s);
+        reps[rep] = elapsed * 1e9 / (double)count;
+        r->packets += count;
+    }
+    qsort(reps, HOST_REPS, sizeof(reps[0]), compare_double);
+    r->ns_per_value = reps[HOST_REPS / 2];
+    r->best_ns_per_value = reps[0];
+    failed |= !r->ok;
+    fprintf(stderr, "%-22s %7.1f ns/request  %s\n", r->name, r->ns_per_value, r->ok ? "ok" : "FAILED");
+}
+
+// ---- Звіт ----
+
+static void write_json(FILE *f)
+{
+    fprintf(f, "{\n  \"board_model\": {\"clock_hz\": %u, \"scan_cycles\": %u, \"oversample_cycles\": %u, "
+               "\"pace_loop_cycles\": %u},\n  \"busy\": %.4f,\n  \"cases\": [\n",
+            HOST_CLOCK_HZ, STREAM_SCAN_CHANNEL_CYCLES, HOST_OVERSAMPLE_CYCLES, STREAM_PACE_LOOP_CYCLES,
+            busy_probability);
+    for (int i = 0; i < result_count; i++)
+    {
+        const HostResult *r = &results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"ok\": %s, \"ns_per_value\": %.2f, \"best_ns_per_value\": %.2f, "
+                   "\"ns_per_packet\": %.1f, \"bytes_per_value\": %.4f, \"values_per_packet\": %.1f, "
+                   "\"board_values_per_s\": %.0f, \"packets\": %llu, \"values\": %llu, \"busy\": %llu, "
+                   "\"seq_gaps\": %llu, \"bad\": %llu}%s\n",
+                r->name, r->ok ? "true" : "false", r->ns_per_value, r->best_ns_per_value, r->ns_per_packet,
+                r->bytes_per_value, r->values_per_packet, r->board_values_per_s, r->packets, r->values, r->busy,
+                r->seq_gaps, r->bad, i + 1 < result_count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+static void print_usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --out FILE        write the JSON report to FILE (default: stdout)\n"
+        "  --dump FILE       also write the transmitted byte stream (raw dump for --replay)\n"
+        "  --min-time S      measuring time per repetition in seconds (default 0.5)\n"
+        "  --packets N       at least N packets per repetition (default 20000)\n"
+        "  --quick           --min-time 0.05 --packets 2000\n"
+        "  --busy P          a USB transfer completes one time step late with probability P\n"
+        "  --filter NAME     run only cases whose name contains NAME\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *out_path = NULL, *dump_path = NULL, *filter = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0) { min_time_s = 0.05; min_packets = 2000; }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) out_path = argv[++i];
+        else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) dump_path = argv[++i];
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) min_time_s = atof(argv[++i]);
+        else if (strcmp(argv[i], "--packets") == 0 && i + 1 < argc) min_packets = atol(argv[++i]);
+        else if (strcmp(argv[i], "--busy") == 0 && i + 1 < argc) busy_probability = atof(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else { print_usage(argv[0]); return strcmp(argv[i], "--help") == 0 ? 0 : 2; }
+    }
+
+    FILE *dump = NULL;
+    if (dump_path && !(dump = fopen(dump_path, "wb")))
+    {
+        perror(dump_path);
+        return 2;
+    }
+
+    // Як main() прошивки, без периферії
+    host_hal_reset(0x12345678);
+    host_hal_set_dump(dump);
+    dds_init();
+    profiler_init();
+    stream_init();
+
+    for (int i = 0; i < CASE_COUNT; i++)
+        if (!filter || strstr(cases[i].name, filter))
+            run_case(&cases[i]);
+    if (!filter || strstr("control_get", filter))
+        run_control();
+
+    if (dump)
+        fclose(dump);
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out)
+    {
+        perror(out_path);
+        return 2;
+    }
+    write_json(out);
+    if (out != stdout)
+        fclose(out);
+    return failed ? 1 : 0;
+}
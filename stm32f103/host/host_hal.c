@@ -0,0 +1,372 @@
+// file host_hal.c
+#include <math.h>
+#include <string.h>
+#include "host_hal.h"
+#include "stm32f103xb.h"
+#include "stream.h"
+#include "stream_hal.h"
+#include "control_protocol.h"
+#include "adc_read.h"
+#include "dds.h"
+#include "delta_codec.h"
+#include "tx_ring.h"
+
+DWT_Type host_dwt;
+CoreDebug_Type host_core_debug;
+
+// Період синуса каналу, такти: 50, 120, 330 і 1000 Гц — цілі, щоб фронт рахувався точно
+static const uint32_t adc_period[4] = { HOST_CLOCK_HZ / 50, HOST_CLOCK_HZ / 120, HOST_CLOCK_HZ / 330,
+                                        HOST_CLOCK_HZ / 1000 };
+
+#define ADC_TABLE_BITS 10
+static int16_t adc_table[1 << ADC_TABLE_BITS]; // Синус з амплітудою HOST_ADC_AMPLITUDE: АЦП не дорожчий за прошивку
+
+static uint64_t cycles;            // Час плати; молодші 32 біти — DWT->CYCCNT
+static uint32_t noise_state;
+static uint8_t scan_mask;
+static uint8_t scan_channels;
+static uint8_t ets_step;
+static uint8_t ets_step_steps;
+
+static bool dma_running;
+static uint64_t dma_at;            // Подія таймера першого скану наступного буфера
+static uint32_t dma_period;
+static uint16_t *dma_values;
+static uint16_t dma_count;
+
+static HostSink sink;
+static bool sink_synced;           // Номер наступного пакета відомий
+static uint32_t sink_next_seq;
+static uint32_t sink_dropped;      // tx_ring_dropped() на host_sink_reset
+static bool usb_sending;           // Передавання прийнято, кінця ще не було
+static double busy_probability;
+static FILE *dump_file;
+
+static uint32_t random_next(void)
+{
+    uint32_t x = noise_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return noise_state = x;
+}
+
+// Переривання USB між кроками часу: кінець передавання і початок наступного слота кільця
+static void usb_complete(void)
+{
+    while (usb_sending)
+    {
+        if (busy_probability > 0.0 && random_next() < busy_probability * 4294967296.0)
+            return;
+        usb_sending = false;
+        tx_ring_done();
+        tx_ring_service();
+    }
+}
+
+static void advance(uint32_t n)
+{
+    cycles += n;
+    host_dwt.CYCCNT += n;
+    usb_complete();
+}
+
+uint16_t host_crc16(const uint8_t *buf, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)buf[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+void host_hal_reset(uint32_t seed)
+{
+    for (int i = 0; i < (1 << ADC_TABLE_BITS); i++)
+        adc_table[i] = (int16_t)lrint(HOST_ADC_AMPLITUDE * sin(2.0 * M_PI * i / (1 << ADC_TABLE_BITS)));
+    cycles = 0;
+    host_dwt.CYCCNT = 0;
+    noise_state = seed ? seed : 1;
+    scan_mask = 0;
+    scan_channels = 0;
+    ets_step = 0;
+    ets_step_steps = 0;
+    dma_running = false;
+    usb_sending = false;
+    busy_probability = 0.0;
+    dump_file = NULL;
+    host_sink_reset();
+}
+
+void host_sink_reset(void)
+{
+    memset(&sink, 0, sizeof(sink));
+    sink_synced = false;
+    sink_dropped = tx_ring_dropped();
+}
+
+const HostSink *host_sink(void)
+{
+    sink.busy = tx_ring_dropped() - sink_dropped;
+    return &sink;
+}
+
+void host_hal_set_busy(double probability)
+{
+    busy_probability = probability;
+}
+
+void host_hal_set_dump(FILE *dump)
+{
+    dump_file = dump;
+}
+
+uint64_t host_cycles(void)
+{
+    return cycles;
+}
+
+// ---- Імітований АЦП ----
+
+// Відлік каналу ch у мить at відносно середини шкали
+static int16_t adc_value(uint8_t ch, uint64_t at)
+{
+    uint32_t phase = (uint32_t)((at % adc_period[ch]) * (1u << ADC_TABLE_BITS) / adc_period[ch]);
+    int32_t noise = (int32_t)(random_next() % (2 * HOST_ADC_NOISE + 1)) - HOST_ADC_NOISE;
+    return (int16_t)(adc_table[phase] + noise); // |синус| + шум < 2048
+}
+
+static void adc_scan_at(uint64_t at, int16_t *out)
+{
+    for (uint8_t ch = 0; ch < 4; ch++)
+        if (scan_mask & (1u << ch))
+            *out++ = adc_value(ch, at);
+}
+
+uint8_t stream_hal_config(uint8_t mask, uint8_t oversample)
+{
+    (void)oversample;
+    scan_mask = mask;
+    scan_channels = (uint8_t)__builtin_popcount(mask);
+    return scan_channels;
+}
+
+void stream_hal_scan(int16_t *out)
+{
+    adc_scan_at(cycles, out);
+    advance(STREAM_SCAN_CHANNEL_CYCLES * scan_channels);
+}
+
+void stream_hal_scan_oversampled(uint8_t oversample, int16_t *out)
+{
+    // Як ADC_ReadOversampled: сума 2^N сканів підряд, зсув до 12 + N/2 біт
+    int32_t sums[4] = { 0 };
+    int16_t scan[4];
+    for (uint16_t i = 0; i < (1u << oversample); i++)
+    {
+        adc_scan_at(cycles, scan);
+        for (uint8_t ch = 0; ch < scan_channels; ch++)
+            sums[ch] += scan[ch];
+        advance(HOST_OVERSAMPLE_CYCLES * scan_channels);
+    }
+    uint8_t shift = oversample - ADC_OVERSAMPLE_EXTRA_BITS(oversample);
+    for (uint8_t ch = 0; ch < scan_channels; ch++)
+        out[ch] = (int16_t)(sums[ch] >> shift);
+}
+
+// Як ets_capture: крок по колу, період сканів — найменше кратне M, у яке вміщається скан.
+// Фронт імітованого АЦП — перетин нуля синусом каналу, тестового сигналу — dds_next_edge
+bool stream_hal_capture(uint8_t mask, uint8_t channels, uint8_t scans, int16_t *out, EtsCapture *info)
+{
+    uint8_t steps = (uint8_t)ets_steps;
+    if (steps != ets_step_steps)
+    {
+        ets_step_steps = steps;
+        ets_step = 0;
+    }
+    uint16_t scan = ETS_CONVERSION_CYCLES * channels + ETS_SCAN_MARGIN_CYCLES;
+    uint8_t step_cycles = (uint8_t)((scan + steps - 1) / steps);
+    uint32_t period = (uint32_t)steps * step_cycles;
+    uint32_t first = ETS_START_CYCLES + (uint32_t)ets_step * step_cycles;
+    bool falling = trigger_edge == 1;
+    uint8_t trigger_channel = (uint8_t)__builtin_ctz(mask);
+
+    uint64_t edge;
+    if (test_signal)
+    {
+        uint32_t at;
+        if (!dds_next_edge(trigger_channel, falling, &at))
+        {
+            advance(ETS_TRIGGER_TIMEOUT_CYCLES);
+            return false;
+        }
+        edge = cycles + (uint32_t)(at - host_dwt.CYCCNT);
+    }
+    else
+    {
+        uint64_t p = adc_period[trigger_channel];
+        edge = (cycles + p - 1) / p * p + (falling ? p / 2 : 0);
+        if (edge < cycles)
+            edge += p;
+    }
+
+    uint64_t at = edge + first;
+    for (uint8_t i = 0; i < scans; i++, at += period)
+    {
+        if (test_signal)
+            dds_scan_at(mask, (uint32_t)(host_dwt.CYCCNT + (at - cycles)), out + i * channels);
+        else
+            adc_scan_at(at, out + i * channels);
+    }
+    advance((uint32_t)(at - period - cycles));
+
+    info->step = ets_step;
+    info->steps = steps;
+    info->step_cycles = step_cycles;
+    if (++ets_step >= steps)
+        ets_step = 0;
+    return true;
+}
+
+void stream_hal_pace(uint16_t rate)
+{
+    advance((uint32_t)rate * 1000u * STREAM_PACE_LOOP_CYCLES);
+}
+
+void stream_hal_dma_start(uint32_t period_cycles, uint16_t *values, uint16_t count)
+{
+    dma_running = true;
+    dma_at = cycles + period_cycles;
+    dma_period = period_cycles;
+    dma_values = values;
+    dma_count = count;
+}
+
+void stream_hal_dma_stop(void)
+{
+    dma_running = false;
+}
+
+// Сон до переривання DMA: скани буфера — в моменти подій таймера, сирі відліки, як з ADC_DR
+void stream_hal_idle(void)
+{
+    if (!dma_running)
+        return;
+    uint16_t scans = dma_count / scan_channels;
+    int16_t scan[4];
+    uint16_t *out = dma_values;
+    for (uint16_t i = 0; i < scans; i++)
+    {
+        adc_scan_at(dma_at + (uint64_t)i * dma_period, scan);
+        for (uint8_t ch = 0; ch < scan_channels; ch++)
+            *out++ = (uint16_t)(scan[ch] + 2048);
+    }
+    uint64_t done = dma_at + (uint64_t)(scans - 1) * dma_period + STREAM_SCAN_CHANNEL_CYCLES * scan_channels;
+    dma_at += (uint64_t)scans * dma_period;
+    if (done > cycles)
+        advance((uint32_t)(done - cycles));
+    dma_values = stream_dma_block();
+}
+
+uint32_t stream_hal_time_us(void)
+{
+    return (uint32_t)(cycles / (HOST_CLOCK_HZ / 1000000u));
+}
+
+// ---- Приймач замість CDC ----
+
+// Довжина пакета семплів з початку buf (have байтів), 0 — не пакет або неповний
+static uint16_t packet_size(const uint8_t *buf, uint16_t have, uint16_t *values)
+{
+    if (have < PACKET_MASK_HEADER)
+        return 0;
+    uint8_t start = buf[0];
+    uint16_t size = PACKET_MASK_HEADER + ((buf[1] & PACKET_TIME_FLAG) ? PACKET_TIME_BYTES : 0);
+    if (start == PACKET_START_MASK)
+    {
+        size += PACKET_MASK_VALUES * 2;
+        *values = PACKET_MASK_VALUES;
+    }
+    else if (start == PACKET_START_RAW)
+    {
+        if (have <= size)
+            return 0;
+        uint8_t channels = (uint8_t)__builtin_popcount(buf[1] & 0x0F);
+        *values = (uint16_t)(buf[size] * channels);
+        size += 1 + 2 * *values;
+    }
+    else if (start == PACKET_START_DELTA || start == PACKET_START_ETS)
+    {
+        if (start == PACKET_START_ETS)
+            size += PACKET_ETS_BYTES;
+        if (have <= size)
+            return 0;
+        size += 1 + buf[size];
+        *values = DELTA_BLOCK_VALUES;
+    }
+    else
+    {
+        return 0;
+    }
+    return size <= have ? size : 0;
+}
+
+static void sink_receive(const uint8_t *buf, uint16_t len)
+{
+    uint16_t pos = 0;
+    while (pos < len)
+    {
+        const uint8_t *p = buf + pos;
+        uint16_t have = len - pos, values = 0, size;
+        if (p[0] == CTRL_START)
+        {
+            size = have >= 2 && p[1] <= CTRL_PAYLOAD_MAX ? CTRL_HEADER + p[1] + 2 : 0;
+            if (size == 0 || size > have)
+                break;
+            uint16_t crc = p[size - 2] | (p[size - 1] << 8);
+            if (host_crc16(p + 1, size - 3) != crc)
+                break;
+            sink.replies++;
+            memcpy(sink.reply, p, size);
+            sink.reply_len = (uint8_t)size;
+        }
+        else if ((size = packet_size(p, have, &values)) != 0)
+        {
+            uint32_t seq = p[2] | (p[3] << 8) | ((uint32_t)p[4] << 16);
+            if (sink_synced && seq != sink_next_seq)
+                sink.seq_gaps += (seq - sink_next_seq) & PACKET_SEQ_MASK;
+            sink_synced = true;
+            sink_next_seq = (seq + 1) & PACKET_SEQ_MASK;
+            sink.packets++;
+            sink.values += values;
+        }
+        else
+        {
+            break;
+        }
+        pos += size;
+    }
+    if (pos < len)
+        sink.bad++;
+}
+
+bool stream_hal_transmit(uint8_t *buf, uint16_t len)
+{
+    if (usb_sending)
+        return false;
+    usb_sending = true;
+    sink.transmits++;
+    sink.bytes += len;
+    sink_receive(buf, len);
+    if (dump_file)
+        fwrite(buf, 1, len, dump_file);
+    return true;
+}
+
+void stream_hal_kick(void)
+{
+    tx_ring_service();
+}
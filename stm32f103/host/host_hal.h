@@ -0,0 +1,53 @@
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Плата для stream.c на ПК: імітований АЦП (синус на канал, свій період, шум) замість ADC1/DMA,
+// приймач замість CDC, що розбирає кожне передавання як хост — пакети 0xAD/0xAE/0xAF/0xB0, номери,
+// кадри відповідей 0xAC. Час плати — такти DWT CYCCNT (host/stm32f103xb.h), що їх додають
+// скани, паузи CTRL_PARAM_RATE, очікування фронту і сон до переривання DMA; ні від швидкості ПК,
+// ні від годинника не залежить. Кінець передавання (tx_ring_done) — на кожному кроці часу
+#define HOST_CLOCK_HZ 72000000u
+#define HOST_OVERSAMPLE_CYCLES 84u     // Канал з найкоротшою вибіркою 1.5 + 12.5 тактів ADCCLK
+#define HOST_ADC_AMPLITUDE 1500        // Пік синуса, відліки АЦП
+#define HOST_ADC_NOISE 8               // Пік рівномірного шуму, відліки АЦП
+
+// Що отримав би хост
+typedef struct
+{
+    unsigned long long transmits;      // Прийнятих передавань
+    unsigned long long busy;           // Пакетів, не прийнятих повним кільцем передавання (tx_ring_dropped)
+    unsigned long long bytes;          // Байтів у прийнятих передаваннях
+    unsigned long long packets;        // Пакетів семплів
+    unsigned long long values;         // Значень у них (скани x канали)
+    unsigned long long seq_gaps;       // Пакетів, пропущених у номерах
+    unsigned long long bad;            // Передавань, хвіст яких не розібрався
+    unsigned long long replies;        // Кадрів відповідей з правильною CRC
+    uint8_t reply[16];                 // Останній кадр відповіді
+    uint8_t reply_len;
+} HostSink;
+
+// CRC-16/CCITT-FALSE кадрів керування (як crc16 у control_protocol.c)
+uint16_t host_crc16(const uint8_t *buf, uint16_t len);
+
+// Початковий стан імітації: такти, шум з seed, приймач (і номер очікуваного пакета)
+void host_hal_reset(uint32_t seed);
+
+// Лише лічильники приймача; наступний пакет може мати будь-який номер
+void host_sink_reset(void);
+const HostSink *host_sink(void);
+
+// Імовірність, що кінець передавання запізниться на крок часу: кільце передавання наповнюється,
+// а повне губить пакети, як на платі
+void host_hal_set_busy(double probability);
+
+// Прийняті байти ще й у файл (сирий дамп для oscilloscope --replay), NULL — ні
+void host_hal_set_dump(FILE *dump);
+
+// Такти імітованого часу від host_hal_reset
+uint64_t host_cycles(void);
+
+#endif /* HOST_HAL_H */
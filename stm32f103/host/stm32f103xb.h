@@ -0,0 +1,49 @@
+#ifndef HOST_STM32F103XB_H
+#define HOST_STM32F103XB_H
+
+// Замість CMSIS-заголовка в збірці на ПК (make host): лише те, чого торкаються модулі без
+// заліза (dds.c, profiler.c, control_protocol.c, stream.c, tx_ring.c). DWT->CYCCNT — імітований час
+// плати: його рухає host_hal.c (скани, паузи, очікування фронту), а не годинник ПК
+
+#include <stdint.h>
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern DWT_Type host_dwt;
+extern CoreDebug_Type host_core_debug;
+
+#define DWT (&host_dwt)
+#define CoreDebug (&host_core_debug)
+#define DWT_CTRL_CYCCNTENA_Msk (1u << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk (1u << 24)
+
+#define USB_ISTR_CTR    0x8000u
+#define USB_ISTR_PMAOVR 0x4000u
+#define USB_ISTR_ERR    0x2000u
+#define USB_ISTR_SOF    0x0200u
+
+// Периферія в прототипах adc_read.h; на ПК лише як вказівники
+typedef struct GPIO_TypeDef GPIO_TypeDef;
+typedef struct ADC_TypeDef ADC_TypeDef;
+
+static inline uint32_t __CLZ(uint32_t value)
+{
+    return value ? (uint32_t)__builtin_clz(value) : 32u;
+}
+
+// Переривань на ПК немає: stream.c і control_protocol.c працюють в одному потоці, а переривання
+// DMA і USB host_hal.c викликає сам між кроками імітованого часу
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+static inline void __DMB(void) { __asm__ volatile ("" ::: "memory"); }
+
+#endif /* HOST_STM32F103XB_H */